@@ -39,4 +39,15 @@ void _cally_actor_get_top_level_origin (ClutterActor *actor,
                                         gint         *x,
                                         gint         *y);
 
+typedef void (* CallyNotifyFunc) (CallyActor *cally_actor);
+
+void _cally_actor_queue_notify (CallyActor      *cally_actor,
+                                CallyNotifyFunc  notify_func);
+
+void _cally_actor_flush_notifications (CallyActor *cally_actor);
+
+void _cally_actor_queue_state_change (CallyActor *cally_actor,
+                                      AtkState    state,
+                                      gboolean    value);
+
 #endif /* __CALLY_ACTOR_PRIVATE_H__ */
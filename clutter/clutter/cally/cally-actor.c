@@ -65,6 +65,15 @@
  *
  *  https://bugzilla.gnome.org/show_bug.cgi?id=649804
  *
+ * Notifications: emitting ATK signals is expensive once an assistive
+ * technology is listening, as each one goes through AT-SPI. So state
+ * changes, and the text notifications of #CallyText, are queued per
+ * object and flushed once per frame, after the stages are painted.
+ * Notifications superseded by a later one of the same kind are
+ * dropped. In order to keep the latency bounded, the queue is also
+ * flushed after a timeout if no frame is painted, and when too many
+ * objects are waiting.
+ *
  */
 
 #include "clutter-build-config.h"
@@ -81,6 +90,12 @@
 #include "cally-actor.h"
 #include "cally-actor-private.h"
 
+/* maximum time a notification can be delayed when no frame is painted */
+#define NOTIFY_TIMEOUT_MS 100
+
+/* maximum number of objects with notifications waiting for a flush */
+#define MAX_PENDING_NOTIFY 256
+
 typedef struct _CallyActorActionInfo CallyActorActionInfo;
 
 /*< private >
@@ -178,8 +193,17 @@ struct _CallyActorPrivate
   GList  *action_list;
 
   GList *children;
+
+  /* queued notifications */
+  GSList *notify_funcs;
+  guint64 pending_states;
+  guint64 pending_state_values;
 };
 
+static GQueue pending_notify = G_QUEUE_INIT;
+static guint notify_repaint_id = 0;
+static guint notify_timeout_id = 0;
+
 G_DEFINE_TYPE_WITH_CODE (CallyActor,
                          cally_actor,
                          ATK_TYPE_GOBJECT_ACCESSIBLE,
@@ -297,6 +321,8 @@ cally_actor_init (CallyActor *cally_actor)
   priv->action_list = NULL;
 
   priv->children = NULL;
+
+  priv->notify_funcs = NULL;
 }
 
 static void
@@ -323,6 +349,9 @@ cally_actor_finalize (GObject *obj)
       priv->children = NULL;
     }
 
+  /* queued objects are referenced until they are flushed */
+  g_warn_if_fail (priv->notify_funcs == NULL);
+
   G_OBJECT_CLASS (cally_actor_parent_class)->finalize (obj);
 }
 
@@ -986,7 +1015,174 @@ cally_actor_real_notify_clutter (GObject    *obj,
   else
     return;
 
-  atk_object_notify_state_change (atk_obj, state, value);
+  _cally_actor_queue_state_change (CALLY_ACTOR (atk_obj), state, value);
+}
+
+static void
+flush_all_notifications (void)
+{
+  GQueue queue = G_QUEUE_INIT;
+  CallyActor *cally_actor;
+
+  g_clear_handle_id (&notify_timeout_id, g_source_remove);
+
+  /* notifications queued while flushing are delivered with the next
+   * batch */
+  queue = pending_notify;
+  g_queue_init (&pending_notify);
+
+  while ((cally_actor = g_queue_pop_head (&queue)) != NULL)
+    {
+      _cally_actor_flush_notifications (cally_actor);
+      g_object_unref (cally_actor);
+    }
+}
+
+static gboolean
+notify_repaint_func (gpointer data)
+{
+  notify_repaint_id = 0;
+
+  flush_all_notifications ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+notify_timeout_func (gpointer data)
+{
+  notify_timeout_id = 0;
+
+  g_clear_handle_id (&notify_repaint_id, clutter_threads_remove_repaint_func);
+  flush_all_notifications ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+emit_state_changes (CallyActor *cally_actor)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+  guint64 states = priv->pending_states;
+  guint64 values = priv->pending_state_values;
+  AtkState state;
+
+  priv->pending_states = 0;
+  priv->pending_state_values = 0;
+
+  for (state = 0; states != 0; state++, states >>= 1, values >>= 1)
+    {
+      if (states & 1)
+        atk_object_notify_state_change (ATK_OBJECT (cally_actor),
+                                        state, values & 1);
+    }
+}
+
+/*< private >
+ * _cally_actor_queue_notify:
+ * @cally_actor: a #CallyActor
+ * @notify_func: the function emitting the pending notifications
+ *
+ * Queues @cally_actor so that @notify_func is called with the next
+ * batch of notifications. @notify_func is called only once per batch,
+ * no matter how many times it was queued, so it is expected to emit
+ * the notifications accumulated by the object since the last batch.
+ */
+void
+_cally_actor_queue_notify (CallyActor      *cally_actor,
+                           CallyNotifyFunc  notify_func)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+
+  if (g_slist_find (priv->notify_funcs, notify_func) != NULL)
+    return;
+
+  if (priv->notify_funcs == NULL)
+    g_queue_push_tail (&pending_notify, g_object_ref (cally_actor));
+
+  priv->notify_funcs = g_slist_append (priv->notify_funcs, notify_func);
+
+  if (pending_notify.length > MAX_PENDING_NOTIFY)
+    {
+      g_clear_handle_id (&notify_repaint_id,
+                         clutter_threads_remove_repaint_func);
+      flush_all_notifications ();
+      return;
+    }
+
+  if (notify_repaint_id == 0)
+    {
+      notify_repaint_id =
+        clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                               notify_repaint_func,
+                                               NULL, NULL);
+    }
+
+  if (notify_timeout_id == 0)
+    {
+      notify_timeout_id = g_timeout_add (NOTIFY_TIMEOUT_MS,
+                                         notify_timeout_func,
+                                         NULL);
+      g_source_set_name_by_id (notify_timeout_id,
+                               "[clutter] cally notify_timeout_func");
+    }
+}
+
+/*< private >
+ * _cally_actor_flush_notifications:
+ * @cally_actor: a #CallyActor
+ *
+ * Emits the notifications queued for @cally_actor right away, for
+ * instance because a notification which cannot be delayed has to be
+ * emitted after them.
+ */
+void
+_cally_actor_flush_notifications (CallyActor *cally_actor)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+
+  while (priv->notify_funcs != NULL)
+    {
+      CallyNotifyFunc notify_func = priv->notify_funcs->data;
+
+      priv->notify_funcs = g_slist_delete_link (priv->notify_funcs,
+                                                priv->notify_funcs);
+      notify_func (cally_actor);
+    }
+}
+
+/*< private >
+ * _cally_actor_queue_state_change:
+ * @cally_actor: a #CallyActor
+ * @state: the #AtkState which changed
+ * @value: the new value of @state
+ *
+ * Queues a state change notification; if @state changes again before
+ * the notifications are flushed, only the last value is notified.
+ */
+void
+_cally_actor_queue_state_change (CallyActor *cally_actor,
+                                 AtkState    state,
+                                 gboolean    value)
+{
+  CallyActorPrivate *priv = cally_actor->priv;
+  guint64 mask;
+
+  if (state >= 64)
+    {
+      atk_object_notify_state_change (ATK_OBJECT (cally_actor), state, value);
+      return;
+    }
+
+  mask = G_GUINT64_CONSTANT (1) << state;
+
+  priv->pending_states |= mask;
+  if (value)
+    priv->pending_state_values |= mask;
+  else
+    priv->pending_state_values &= ~mask;
+
+  _cally_actor_queue_notify (cally_actor, emit_state_changes);
 }
 
 static void
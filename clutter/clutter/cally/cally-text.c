@@ -130,8 +130,8 @@ static void                 _cally_text_delete_text_cb           (ClutterText *c
                                                                   gint         start_pos,
                                                                   gint         end_pos,
                                                                   gpointer     data);
-static gboolean             _idle_notify_insert                  (gpointer data);
 static void                 _notify_insert                       (CallyText *cally_text);
+static void                 _notify_text_changes                 (CallyActor *cally_actor);
 static void                 _notify_delete                       (CallyText *cally_text);
 
 /* AtkEditableText */
@@ -178,11 +178,15 @@ struct _CallyTextPrivate
   gint cursor_position;
   gint selection_bound;
 
+  /* queued text_caret_moved and text_selection_changed */
+  gint notified_cursor_position;
+  gboolean caret_moved;
+  gboolean selection_changed;
+
   /* text_changed::insert stuff */
   const gchar *signal_name_insert;
   gint position_insert;
   gint length_insert;
-  guint insert_idle_handler;
 
   /* text_changed::delete stuff */
   const gchar *signal_name_delete;
@@ -230,7 +234,9 @@ cally_text_init (CallyText *cally_text)
   priv->signal_name_insert = NULL;
   priv->position_insert = -1;
   priv->length_insert = -1;
-  priv->insert_idle_handler = 0;
+  priv->notified_cursor_position = -1;
+  priv->caret_moved = FALSE;
+  priv->selection_changed = FALSE;
 
   priv->signal_name_delete = NULL;
   priv->position_delete = -1;
@@ -247,8 +253,6 @@ cally_text_finalize   (GObject *obj)
 /*   g_object_unref (cally_text->priv->textutil); */
 /*   cally_text->priv->textutil = NULL; */
 
-  g_clear_handle_id (&cally_text->priv->insert_idle_handler, g_source_remove);
-
   G_OBJECT_CLASS (cally_text_parent_class)->finalize (obj);
 }
 
@@ -297,6 +301,7 @@ cally_text_real_initialize(AtkObject *obj,
 
   cally_text->priv->cursor_position = clutter_text_get_cursor_position (clutter_text);
   cally_text->priv->selection_bound = clutter_text_get_selection_bound (clutter_text);
+  cally_text->priv->notified_cursor_position = cally_text->priv->cursor_position;
 
   g_signal_connect (clutter_text, "insert-text",
                     G_CALLBACK (_cally_text_insert_text_cb),
@@ -1558,6 +1563,11 @@ _cally_text_delete_text_cb (ClutterText *clutter_text,
 
   cally_text = CALLY_TEXT (data);
 
+  /* The deleted text can only be retrieved while the signal is being
+   * emitted, so deletions are not delayed; the notifications queued
+   * before have to be emitted first */
+  _cally_actor_flush_notifications (CALLY_ACTOR (cally_text));
+
   if (!cally_text->priv->signal_name_delete)
     {
       cally_text->priv->signal_name_delete = "text_changed::delete";
@@ -1581,20 +1591,23 @@ _cally_text_insert_text_cb (ClutterText *clutter_text,
 
   cally_text = CALLY_TEXT (data);
 
-  if (!cally_text->priv->signal_name_insert)
+  /* Typing produces an insertion right after the previous one, which
+   * can be notified as a single one */
+  if (cally_text->priv->signal_name_insert &&
+      cally_text->priv->position_insert + cally_text->priv->length_insert == *position)
     {
-      cally_text->priv->signal_name_insert = "text_changed::insert";
-      cally_text->priv->position_insert = *position;
-      cally_text->priv->length_insert = g_utf8_strlen (new_text, new_text_length);
+      cally_text->priv->length_insert += g_utf8_strlen (new_text, new_text_length);
+      return;
     }
 
-  /*
-   * The signal will be emitted when the cursor position is updated,
-   * or in an idle handler if it not updated.
-   */
-  if (cally_text->priv->insert_idle_handler == 0)
-    cally_text->priv->insert_idle_handler = clutter_threads_add_idle (_idle_notify_insert,
-                                                                      cally_text);
+  _cally_actor_flush_notifications (CALLY_ACTOR (cally_text));
+
+  cally_text->priv->signal_name_insert = "text_changed::insert";
+  cally_text->priv->position_insert = *position;
+  cally_text->priv->length_insert = g_utf8_strlen (new_text, new_text_length);
+
+  /* The signal will be emitted with the next batch of notifications */
+  _cally_actor_queue_notify (CALLY_ACTOR (cally_text), _notify_text_changes);
 }
 
 /***** atkeditabletext.h ******/
@@ -1693,20 +1706,26 @@ cally_text_notify_clutter (GObject    *obj,
     {
       /* the selection can change also for the cursor position */
       if (_check_for_selection_change (cally_text, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        cally_text->priv->selection_changed = TRUE;
 
-      g_signal_emit_by_name (atk_obj, "text_caret_moved",
-                             clutter_text_get_cursor_position (clutter_text));
+      cally_text->priv->caret_moved = TRUE;
+      _cally_actor_queue_notify (CALLY_ACTOR (cally_text),
+                                 _notify_text_changes);
     }
   else if (g_strcmp0 (pspec->name, "selection-bound") == 0)
     {
       if (_check_for_selection_change (cally_text, clutter_text))
-        g_signal_emit_by_name (atk_obj, "text_selection_changed");
+        {
+          cally_text->priv->selection_changed = TRUE;
+          _cally_actor_queue_notify (CALLY_ACTOR (cally_text),
+                                     _notify_text_changes);
+        }
     }
   else if (g_strcmp0 (pspec->name, "editable") == 0)
     {
-      atk_object_notify_state_change (atk_obj, ATK_STATE_EDITABLE,
-                                      clutter_text_get_editable (clutter_text));
+      _cally_actor_queue_state_change (CALLY_ACTOR (cally_text),
+                                       ATK_STATE_EDITABLE,
+                                       clutter_text_get_editable (clutter_text));
     }
   else if (g_strcmp0 (pspec->name, "activatable") == 0)
     {
@@ -1761,17 +1780,34 @@ _check_for_selection_change (CallyText *cally_text,
   return ret_val;
 }
 
-static gboolean
-_idle_notify_insert (gpointer data)
+/* Emits the notifications queued since the last batch: the pending
+ * insertion, and a single selection change and caret move, no matter
+ * how many times they happened */
+static void
+_notify_text_changes (CallyActor *cally_actor)
 {
-  CallyText *cally_text = NULL;
-
-  cally_text = CALLY_TEXT (data);
-  cally_text->priv->insert_idle_handler = 0;
+  CallyText *cally_text = CALLY_TEXT (cally_actor);
+  CallyTextPrivate *priv = cally_text->priv;
 
   _notify_insert (cally_text);
 
-  return FALSE;
+  if (priv->selection_changed)
+    {
+      priv->selection_changed = FALSE;
+      g_signal_emit_by_name (cally_text, "text_selection_changed");
+    }
+
+  if (priv->caret_moved)
+    {
+      priv->caret_moved = FALSE;
+
+      if (priv->cursor_position != priv->notified_cursor_position)
+        {
+          priv->notified_cursor_position = priv->cursor_position;
+          g_signal_emit_by_name (cally_text, "text_caret_moved",
+                                 priv->cursor_position);
+        }
+    }
 }
 
 static void
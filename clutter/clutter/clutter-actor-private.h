@@ -294,6 +294,10 @@ gboolean                        _clutter_actor_set_default_paint_volume
 
 const gchar *                   _clutter_actor_get_debug_name                           (ClutterActor *self);
 
+gboolean                        _clutter_actor_is_effect_nested                         (ClutterActor  *self,
+                                                                                         ClutterEffect *effect,
+                                                                                         GType          outer_type);
+
 void                            _clutter_actor_push_clone_paint                         (void);
 void                            _clutter_actor_pop_clone_paint                          (void);
 
@@ -323,6 +327,8 @@ ClutterPaintNode *              clutter_actor_create_texture_paint_node
 void clutter_actor_update_stage_views (ClutterActor *self,
                                        int           phase);
 
+void clutter_actor_reset_stage_views_update_stats (void);
+
 void clutter_actor_queue_immediate_relayout (ClutterActor *self);
 
 G_END_DECLS
@@ -678,21 +678,32 @@ typedef enum
 } MapStateChange;
 
 /* 3 entries should be a good compromise, few layout managers
- * will ask for 3 different preferred size in each allocation cycle */
+ * will ask for 3 different preferred size in each allocation cycle;
+ * actors inside the layouts that do ask for more (e.g. flow and grid
+ * layouts with many children) grow their cache on demand, up to
+ * CLUTTER_MAX_CACHED_SIZE_REQUESTS entries */
 #define N_CACHED_SIZE_REQUESTS 3
 
+typedef struct _SizeRequestCache
+{
+  /* points to preallocated until the cache grows */
+  SizeRequest *requests;
+  guint n_requests;
+
+  /* An age of 0 means the entry is not set */
+  guint age;
+
+  SizeRequest preallocated[N_CACHED_SIZE_REQUESTS];
+} SizeRequestCache;
+
 struct _ClutterActorPrivate
 {
   /* request mode */
   ClutterRequestMode request_mode;
 
   /* our cached size requests for different width / height */
-  SizeRequest width_requests[N_CACHED_SIZE_REQUESTS];
-  SizeRequest height_requests[N_CACHED_SIZE_REQUESTS];
-
-  /* An age of 0 means the entry is not set */
-  guint cached_height_age;
-  guint cached_width_age;
+  SizeRequestCache width_requests;
+  SizeRequestCache height_requests;
 
   /* the bounding box of the actor, relative to the parent's
    * allocation
@@ -856,6 +867,8 @@ struct _ClutterActorPrivate
   guint had_effects_on_last_paint_volume_update : 1;
   guint absolute_origin_changed     : 1;
   guint needs_update_stage_views    : 1;
+  guint needs_update_stage_views_subtree : 1;
+  guint children_need_update_stage_views : 1;
   guint clear_stage_views_needs_stage_views_changed : 1;
 };
 
@@ -1141,6 +1154,57 @@ static GQuark quark_proximity = 0;
 static GQuark quark_pad = 0;
 static GQuark quark_im = 0;
 
+static guint64 size_request_cache_hits = 0;
+static guint64 size_request_cache_misses = 0;
+
+static void
+size_request_cache_init (SizeRequestCache *cache)
+{
+  cache->requests = cache->preallocated;
+  cache->n_requests = N_CACHED_SIZE_REQUESTS;
+  cache->age = 1;
+}
+
+static void
+size_request_cache_reset (SizeRequestCache *cache)
+{
+  /* the capacity is kept, since the same layout is likely to ask
+   * for the same amount of sizes in the next allocation cycle */
+  memset (cache->requests, 0, cache->n_requests * sizeof (SizeRequest));
+}
+
+static void
+size_request_cache_resize (SizeRequestCache *cache,
+                           guint             n_requests)
+{
+  g_assert (n_requests > cache->n_requests);
+
+  if (cache->requests == cache->preallocated)
+    {
+      cache->requests = g_new0 (SizeRequest, n_requests);
+      memcpy (cache->requests, cache->preallocated,
+              cache->n_requests * sizeof (SizeRequest));
+    }
+  else
+    {
+      cache->requests = g_renew (SizeRequest, cache->requests, n_requests);
+      memset (cache->requests + cache->n_requests, 0,
+              (n_requests - cache->n_requests) * sizeof (SizeRequest));
+    }
+
+  cache->n_requests = n_requests;
+}
+
+static void
+size_request_cache_clear (SizeRequestCache *cache)
+{
+  if (cache->requests != cache->preallocated)
+    g_free (cache->requests);
+
+  cache->requests = cache->preallocated;
+  cache->n_requests = N_CACHED_SIZE_REQUESTS;
+}
+
 G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          clutter_actor,
                          G_TYPE_INITIALLY_UNOWNED,
@@ -1638,20 +1702,60 @@ clutter_actor_update_map_state (ClutterActor  *self,
 #endif
 }
 
+/* counters for the last update of the stage-views of the actors */
+static guint stage_views_n_visited = 0;
+static guint stage_views_n_updated = 0;
+
+static void
+queue_update_stage_views_path (ClutterActor *actor)
+{
+  ClutterActor *parent = actor->priv->parent;
+
+  /* The stage-views of the actors up the hierarchy don't need to be
+   * updated, they only get marked so that we can avoid traversing the
+   * whole scenegraph when looking for actors which need an update in
+   * clutter_actor_update_stage_views().
+   */
+  while (parent && !parent->priv->children_need_update_stage_views)
+    {
+      parent->priv->children_need_update_stage_views = TRUE;
+      parent = parent->priv->parent;
+    }
+}
+
 static void
 queue_update_stage_views (ClutterActor *actor)
 {
-  while (actor && !actor->priv->needs_update_stage_views)
-  {
-    actor->priv->needs_update_stage_views = TRUE;
+  actor->priv->needs_update_stage_views = TRUE;
+  queue_update_stage_views_path (actor);
+}
+
+/* The absolute geometry of @actor and of all its descendants changed;
+ * the descendants only get marked while updating the stage-views, so
+ * that moving a large subtree doesn't need a traversal of its own */
+static void
+queue_update_stage_views_subtree (ClutterActor *actor)
+{
+  actor->priv->needs_update_stage_views_subtree = TRUE;
+  queue_update_stage_views_path (actor);
+}
 
-    /* We don't really need to update the stage-views of the actors up the
-     * hierarchy, we set the flag anyway though so we can avoid traversing
-     * the whole scenegraph when looking for actors which need an update
-     * in clutter_actor_update_stage_views().
-     */
-    actor = actor->priv->parent;
-  }
+static gboolean
+stage_views_need_update (ClutterActor *actor)
+{
+  ClutterActorPrivate *priv = actor->priv;
+
+  return priv->needs_update_stage_views ||
+         priv->needs_update_stage_views_subtree ||
+         priv->children_need_update_stage_views;
+}
+
+static void
+transform_changed (ClutterActor *actor)
+{
+  actor->priv->transform_valid = FALSE;
+
+  queue_update_stage_views_subtree (actor);
 }
 
 static void
@@ -1670,15 +1774,10 @@ clutter_actor_real_map (ClutterActor *self)
 
   /* We skip unmapped actors when updating the stage-views list, so if
    * an actors list got invalidated while it was unmapped make sure to
-   * set priv->needs_update_stage_views to TRUE for all actors up the
-   * hierarchy now.
+   * mark all the actors up the hierarchy now.
    */
-  if (self->priv->needs_update_stage_views)
-    {
-      /* Avoid the early return in queue_update_stage_views() */
-      self->priv->needs_update_stage_views = FALSE;
-      queue_update_stage_views (self);
-    }
+  if (stage_views_need_update (self))
+    queue_update_stage_views_path (self);
 
   /* notify on parent mapped before potentially mapping
    * children, so apps see a top-down notification.
@@ -2617,16 +2716,6 @@ absolute_allocation_changed (ClutterActor *actor)
   queue_update_stage_views (actor);
 }
 
-static ClutterActorTraverseVisitFlags
-absolute_allocation_changed_cb (ClutterActor *actor,
-                                int           depth,
-                                gpointer      user_data)
-{
-  absolute_allocation_changed (actor);
-
-  return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
-}
-
 /*< private >
  * clutter_actor_set_allocation_internal:
  * @self: a #ClutterActor
@@ -2859,10 +2948,8 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   priv->needs_paint_volume_update = TRUE;
 
   /* reset the cached size requests */
-  memset (priv->width_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
-  memset (priv->height_requests, 0,
-          N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
+  size_request_cache_reset (&priv->width_requests);
+  size_request_cache_reset (&priv->height_requests);
 
   /* We may need to go all the way up the hierarchy */
   if (priv->parent != NULL)
@@ -4206,6 +4293,40 @@ clutter_actor_continue_paint (ClutterActor        *self,
     }
 }
 
+/*< private >
+ * _clutter_actor_is_effect_nested:
+ * @self: a #ClutterActor
+ * @effect: an effect of @self
+ * @outer_type: the type of the outer effects to look for
+ *
+ * Checks whether @effect is painted inside another enabled effect of
+ * @self, of type @outer_type.
+ *
+ * Return value: %TRUE if @effect is nested inside an effect of @outer_type
+ */
+gboolean
+_clutter_actor_is_effect_nested (ClutterActor  *self,
+                                 ClutterEffect *effect,
+                                 GType          outer_type)
+{
+  ClutterActorPrivate *priv = self->priv;
+  const GList *l;
+
+  if (priv->effects == NULL)
+    return FALSE;
+
+  for (l = _clutter_meta_group_peek_metas (priv->effects);
+       l != NULL && l->data != effect;
+       l = l->next)
+    {
+      if (clutter_actor_meta_get_enabled (l->data) &&
+          G_TYPE_CHECK_INSTANCE_TYPE (l->data, outer_type))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 /**
  * clutter_actor_pick:
  * @actor: A #ClutterActor
@@ -4694,7 +4815,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor           *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot = *pivot;
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
@@ -4710,7 +4831,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot_z = pivot_z;
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
@@ -4744,7 +4865,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -4876,7 +4997,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -5032,7 +5153,7 @@ clutter_actor_set_rotation_center_internal (ClutterActor             *self,
       break;
     }
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   g_object_thaw_notify (obj);
 
@@ -5058,7 +5179,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -5140,7 +5261,7 @@ clutter_actor_set_scale_center (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -5162,7 +5283,7 @@ clutter_actor_set_scale_gravity (ClutterActor   *self,
   else
     clutter_anchor_coord_set_gravity (&info->scale_center, gravity);
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_X]);
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_Y]);
@@ -5215,7 +5336,7 @@ clutter_actor_set_anchor_coord (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -6240,6 +6361,9 @@ clutter_actor_finalize (GObject *object)
 
   g_free (priv->name);
 
+  size_request_cache_clear (&priv->width_requests);
+  size_request_cache_clear (&priv->height_requests);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   g_free (priv->debug_name);
 #endif
@@ -8837,8 +8961,8 @@ clutter_actor_init (ClutterActor *self)
   priv->needs_paint_volume_update = TRUE;
   priv->needs_update_stage_views = TRUE;
 
-  priv->cached_width_age = 1;
-  priv->cached_height_age = 1;
+  size_request_cache_init (&priv->width_requests);
+  size_request_cache_init (&priv->height_requests);
 
   priv->opacity_override = -1;
   priv->enable_model_view_transform = TRUE;
@@ -9669,26 +9793,31 @@ clutter_actor_adjust_height (ClutterActor *self,
 }
 
 /* looks for a cached size request for this for_size. If not
- * found, returns the oldest entry so it can be overwritten */
+ * found, returns the oldest entry so it can be overwritten; if
+ * every entry is in use the cache grows instead, so that layouts
+ * asking for many different sizes in each allocation cycle don't
+ * keep evicting each other's requests */
 static gboolean
-_clutter_actor_get_cached_size_request (gfloat         for_size,
-                                        SizeRequest   *cached_size_requests,
-                                        SizeRequest  **result)
+_clutter_actor_get_cached_size_request (gfloat             for_size,
+                                        SizeRequestCache  *cache,
+                                        SizeRequest      **result)
 {
+  guint max_requests;
   guint i;
 
-  *result = &cached_size_requests[0];
+  *result = &cache->requests[0];
 
-  for (i = 0; i < N_CACHED_SIZE_REQUESTS; i++)
+  for (i = 0; i < cache->n_requests; i++)
     {
       SizeRequest *sr;
 
-      sr = &cached_size_requests[i];
+      sr = &cache->requests[i];
 
       if (sr->age > 0 &&
           sr->for_size == for_size)
         {
           CLUTTER_NOTE (LAYOUT, "Size cache hit for size: %.2f", for_size);
+          size_request_cache_hits += 1;
           *result = sr;
           return TRUE;
         }
@@ -9699,6 +9828,18 @@ _clutter_actor_get_cached_size_request (gfloat         for_size,
     }
 
   CLUTTER_NOTE (LAYOUT, "Size cache miss for size: %.2f", for_size);
+  size_request_cache_misses += 1;
+
+  max_requests = _clutter_context_get_max_cached_size_requests ();
+  if ((*result)->age > 0 && cache->n_requests < max_requests)
+    {
+      guint n_requests = MIN (cache->n_requests * 2, max_requests);
+
+      CLUTTER_NOTE (LAYOUT, "Growing size cache to %u entries", n_requests);
+
+      size_request_cache_resize (cache, n_requests);
+      *result = &cache->requests[i];
+    }
 
   return FALSE;
 }
@@ -9828,14 +9969,15 @@ clutter_actor_get_preferred_width (ClutterActor *self,
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_height,
-                                                priv->width_requests,
+                                                &priv->width_requests,
                                                 &cached_size_request);
     }
   else
     {
       /* if the actor needs a width request we use the first slot */
       found_in_cache = FALSE;
-      cached_size_request = &priv->width_requests[0];
+      cached_size_request = &priv->width_requests.requests[0];
+      size_request_cache_misses += 1;
     }
 
   if (!found_in_cache)
@@ -9880,9 +10022,9 @@ clutter_actor_get_preferred_width (ClutterActor *self,
       cached_size_request->min_size = minimum_width;
       cached_size_request->natural_size = natural_width;
       cached_size_request->for_size = for_height;
-      cached_size_request->age = priv->cached_width_age;
+      cached_size_request->age = priv->width_requests.age;
 
-      priv->cached_width_age += 1;
+      priv->width_requests.age += 1;
       priv->needs_width_request = FALSE;
     }
 
@@ -9993,13 +10135,14 @@ clutter_actor_get_preferred_height (ClutterActor *self,
     {
       found_in_cache =
         _clutter_actor_get_cached_size_request (for_width,
-                                                priv->height_requests,
+                                                &priv->height_requests,
                                                 &cached_size_request);
     }
   else
     {
       found_in_cache = FALSE;
-      cached_size_request = &priv->height_requests[0];
+      cached_size_request = &priv->height_requests.requests[0];
+      size_request_cache_misses += 1;
     }
 
   if (!found_in_cache)
@@ -10044,9 +10187,9 @@ clutter_actor_get_preferred_height (ClutterActor *self,
       cached_size_request->min_size = minimum_height;
       cached_size_request->natural_size = natural_height;
       cached_size_request->for_size = for_width;
-      cached_size_request->age = priv->cached_height_age;
+      cached_size_request->age = priv->height_requests.age;
 
-      priv->cached_height_age += 1;
+      priv->height_requests.age += 1;
       priv->needs_height_request = FALSE;
     }
 
@@ -10358,11 +10501,7 @@ clutter_actor_allocate (ClutterActor          *self,
     {
       if (priv->absolute_origin_changed)
         {
-          _clutter_actor_traverse (self,
-                                   CLUTTER_ACTOR_TRAVERSE_DEPTH_FIRST,
-                                   absolute_allocation_changed_cb,
-                                   NULL,
-                                   NULL);
+          queue_update_stage_views_subtree (self);
         }
       goto out;
     }
@@ -10415,11 +10554,7 @@ clutter_actor_allocate (ClutterActor          *self,
     {
       if (priv->absolute_origin_changed)
         {
-          _clutter_actor_traverse (self,
-                                   CLUTTER_ACTOR_TRAVERSE_DEPTH_FIRST,
-                                   absolute_allocation_changed_cb,
-                                   NULL,
-                                   NULL);
+          queue_update_stage_views_subtree (self);
         }
 
       CLUTTER_NOTE (LAYOUT, "No allocation needed");
@@ -12138,7 +12273,7 @@ clutter_actor_set_depth_internal (ClutterActor *self,
       /* Sets Z value - XXX 2.0: should we invert? */
       info->z_position = depth;
 
-      self->priv->transform_valid = FALSE;
+      transform_changed (self);
 
       /* FIXME - remove this crap; sadly, there are still containers
        * in Clutter that depend on this utter brain damage
@@ -12163,7 +12298,7 @@ clutter_actor_set_z_position_internal (ClutterActor *self,
     {
       info->z_position = z_position;
 
-      self->priv->transform_valid = FALSE;
+      transform_changed (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -14070,7 +14205,7 @@ clutter_actor_set_anchor_point (ClutterActor *self,
 
   if (changed)
     {
-      priv->transform_valid = FALSE;
+      transform_changed (self);
       clutter_actor_queue_redraw (self);
     }
 
@@ -14240,7 +14375,7 @@ clutter_actor_set_anchor_point_from_gravity (ClutterActor   *self,
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_X]);
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_Y]);
 
-      self->priv->transform_valid = FALSE;
+      transform_changed (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -15818,6 +15953,21 @@ clutter_actor_get_pango_context (ClutterActor *self)
  */
 PangoContext *
 clutter_actor_create_pango_context (ClutterActor *self)
+{
+  return _clutter_create_pango_context ();
+}
+
+/*< private >
+ * _clutter_create_pango_context:
+ *
+ * Creates a #PangoContext configured like the ones returned by
+ * clutter_actor_create_pango_context(), for users that are not tied to
+ * a specific actor.
+ *
+ * Return value: (transfer full): the newly created #PangoContext
+ */
+PangoContext *
+_clutter_create_pango_context (void)
 {
   CoglPangoFontMap *font_map;
   PangoContext *context;
@@ -16337,7 +16487,7 @@ clutter_actor_set_transform_internal (ClutterActor        *self,
   info->transform = *transform;
   info->transform_set = !cogl_matrix_is_identity (&info->transform);
 
-  self->priv->transform_valid = FALSE;
+  transform_changed (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -17883,21 +18033,76 @@ clutter_actor_update_stage_views (ClutterActor *self,
 {
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *child;
+  gboolean subtree_changed;
 
   if (!CLUTTER_ACTOR_IS_MAPPED (self) ||
       CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
 
-  if (!priv->needs_update_stage_views)
+  if (!stage_views_need_update (self))
     return;
 
-  update_stage_views (self);
-  update_resource_scale (self, use_max_scale);
+  stage_views_n_visited += 1;
+
+  subtree_changed = priv->needs_update_stage_views_subtree;
+
+  /* Actors which only lead to an invalidated descendant keep their
+   * stage-views */
+  if (priv->needs_update_stage_views || subtree_changed)
+    {
+      update_stage_views (self);
+      update_resource_scale (self, use_max_scale);
+
+      stage_views_n_updated += 1;
+    }
 
   priv->needs_update_stage_views = FALSE;
+  priv->needs_update_stage_views_subtree = FALSE;
+  priv->children_need_update_stage_views = FALSE;
 
   for (child = priv->first_child; child; child = child->priv->next_sibling)
-    clutter_actor_update_stage_views (child, use_max_scale);
+    {
+      /* Unmapped children keep the flag until they get mapped */
+      if (subtree_changed)
+        child->priv->needs_update_stage_views_subtree = TRUE;
+
+      clutter_actor_update_stage_views (child, use_max_scale);
+    }
+}
+
+/*< private >
+ * clutter_actor_reset_stage_views_update_stats:
+ *
+ * Resets the counters returned by
+ * clutter_actor_get_stage_views_update_stats(); called by the stage
+ * before updating the stage-views of its actors for a new frame.
+ */
+void
+clutter_actor_reset_stage_views_update_stats (void)
+{
+  stage_views_n_visited = 0;
+  stage_views_n_updated = 0;
+}
+
+/**
+ * clutter_actor_get_stage_views_update_stats: (skip)
+ * @n_visited: (out) (optional): return location for the number of actors
+ *   visited
+ * @n_updated: (out) (optional): return location for the number of actors
+ *   whose stage-views were recomputed
+ *
+ * Retrieves how many actors were looked at while updating the
+ * stage-views of the actors for the last frame.
+ */
+void
+clutter_actor_get_stage_views_update_stats (guint *n_visited,
+                                            guint *n_updated)
+{
+  if (n_visited != NULL)
+    *n_visited = stage_views_n_visited;
+
+  if (n_updated != NULL)
+    *n_updated = stage_views_n_updated;
 }
 
 /**
@@ -19989,6 +20194,39 @@ clutter_actor_get_transition (ClutterActor *self,
   return clos->transition;
 }
 
+/**
+ * clutter_actor_get_size_request_cache_stats: (skip)
+ * @hits: (out) (optional): return location for the number of cache hits
+ * @misses: (out) (optional): return location for the number of cache misses
+ *
+ * Retrieves the number of preferred size requests, across all actors,
+ * that were answered from the per-actor size cache and the number of
+ * requests that had to be computed.
+ */
+void
+clutter_actor_get_size_request_cache_stats (guint64 *hits,
+                                            guint64 *misses)
+{
+  if (hits != NULL)
+    *hits = size_request_cache_hits;
+
+  if (misses != NULL)
+    *misses = size_request_cache_misses;
+}
+
+/**
+ * clutter_actor_reset_size_request_cache_stats: (skip)
+ *
+ * Resets the counters returned by
+ * clutter_actor_get_size_request_cache_stats().
+ */
+void
+clutter_actor_reset_size_request_cache_stats (void)
+{
+  size_request_cache_hits = 0;
+  size_request_cache_misses = 0;
+}
+
 /**
  * clutter_actor_has_transitions: (skip)
  */
@@ -20899,7 +21137,7 @@ clutter_actor_set_child_transform_internal (ClutterActor        *self,
   /* we need to reset the transform_valid flag on each child */
   clutter_actor_iter_init (&iter, self);
   while (clutter_actor_iter_next (&iter, &child))
-    child->priv->transform_valid = FALSE;
+    transform_changed (child);
 
   clutter_actor_queue_redraw (self);
 
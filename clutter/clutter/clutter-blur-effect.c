@@ -30,6 +30,12 @@
  * #ClutterBlurEffect is a sub-class of #ClutterEffect that allows blurring a
  * actor and its contents.
  *
+ * By default a fixed 3x3 kernel is applied at full resolution. Setting the
+ * #ClutterBlurEffect:radius property switches to a dual-Kawase blur, which
+ * downsamples the contents of the actor through a chain of progressively
+ * smaller render targets and upsamples them back, so that large radii cost
+ * a fraction of a full resolution Gaussian blur.
+ *
  * #ClutterBlurEffect is available since Clutter 1.4
  */
 
@@ -39,6 +45,9 @@
 
 #include "clutter-build-config.h"
 
+#include <math.h>
+#include <string.h>
+
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
 #include "clutter-blur-effect.h"
@@ -51,6 +60,15 @@
 
 #define BLUR_PADDING    2
 
+/* the number of downsampling passes is limited, as every pass halves the
+ * resolution and with too many of them the blur starts looking blocky */
+#define MAX_KAWASE_ITERATIONS   6
+
+/* the range of sample offsets, in texels of the pass' target, for which
+ * the dual-Kawase filter looks smooth */
+#define MIN_KAWASE_OFFSET       0.5f
+#define MAX_KAWASE_OFFSET       4.0f
+
 /* FIXME - lame shader; we should really have a decoupled
  * horizontal/vertical two pass shader for the gaussian blur
  */
@@ -72,6 +90,53 @@ static const gchar *box_blur_glsl_shader =
 "  cogl_texel /= 9.0;\n";
 #undef SAMPLE
 
+/* dual-Kawase filter, see "Bandwidth-Efficient Rendering" by Marius
+ * Bjørge, SIGGRAPH 2015; half_pixel is half a texel of the target of
+ * the pass, in normalized coordinates */
+static const gchar *kawase_glsl_declarations =
+"uniform vec2 half_pixel;\n"
+"uniform float sample_offset;\n";
+#define SAMPLE(offx, offy, weight) \
+  "cogl_texel += texture2D (cogl_sampler, cogl_tex_coord.st + half_pixel * " \
+  "sample_offset * vec2 (" G_STRINGIFY (offx) ", " G_STRINGIFY (offy) ")) * " \
+  G_STRINGIFY (weight) ";\n"
+static const gchar *kawase_down_glsl_shader =
+"  cogl_texel = texture2D (cogl_sampler, cogl_tex_coord.st) * 4.0;\n"
+  SAMPLE (-1.0, -1.0, 1.0)
+  SAMPLE (+1.0, +1.0, 1.0)
+  SAMPLE (+1.0, -1.0, 1.0)
+  SAMPLE (-1.0, +1.0, 1.0)
+"  cogl_texel /= 8.0;\n";
+static const gchar *kawase_up_glsl_shader =
+"  cogl_texel = vec4 (0.0);\n"
+  SAMPLE (-2.0,  0.0, 1.0)
+  SAMPLE (-1.0, +1.0, 2.0)
+  SAMPLE ( 0.0, +2.0, 1.0)
+  SAMPLE (+1.0, +1.0, 2.0)
+  SAMPLE (+2.0,  0.0, 1.0)
+  SAMPLE (+1.0, -1.0, 2.0)
+  SAMPLE ( 0.0, -2.0, 1.0)
+  SAMPLE (-1.0, -1.0, 2.0)
+"  cogl_texel /= 12.0;\n";
+#undef SAMPLE
+
+/* A level of the dual-Kawase mip chain; level 0 is the texture of the
+ * offscreen effect, the following ones are half the size of the previous
+ * one. The down pipeline renders the previous level into this one, the
+ * up pipeline renders the next level back into this one, or, for level 0,
+ * onto the framebuffer being painted */
+typedef struct _BlurLevel
+{
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+
+  int width;
+  int height;
+
+  CoglPipeline *down_pipeline;
+  CoglPipeline *up_pipeline;
+} BlurLevel;
+
 struct _ClutterBlurEffect
 {
   ClutterOffscreenEffect parent_instance;
@@ -85,6 +150,17 @@ struct _ClutterBlurEffect
   gint tex_height;
 
   CoglPipeline *pipeline;
+
+  gfloat radius;
+
+  /* the dual-Kawase passes only need to run again when the contents
+   * of the actor or the radius change */
+  gboolean levels_dirty;
+
+  float kawase_offset;
+
+  int n_levels;
+  BlurLevel levels[MAX_KAWASE_ITERATIONS + 1];
 };
 
 struct _ClutterBlurEffectClass
@@ -92,12 +168,255 @@ struct _ClutterBlurEffectClass
   ClutterOffscreenEffectClass parent_class;
 
   CoglPipeline *base_pipeline;
+
+  CoglPipeline *base_down_pipeline;
+  CoglPipeline *base_up_pipeline;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_RADIUS,
+
+  PROP_LAST
 };
 
+static GParamSpec *obj_props[PROP_LAST];
+
 G_DEFINE_TYPE (ClutterBlurEffect,
                clutter_blur_effect,
                CLUTTER_TYPE_OFFSCREEN_EFFECT);
 
+static void
+clear_levels (ClutterBlurEffect *self)
+{
+  int i;
+
+  for (i = 0; i < self->n_levels; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      /* the texture of level 0 belongs to the offscreen effect */
+      if (i > 0)
+        {
+          g_clear_pointer (&level->offscreen, cogl_object_unref);
+          g_clear_pointer (&level->texture, cogl_object_unref);
+        }
+
+      g_clear_pointer (&level->down_pipeline, cogl_object_unref);
+      g_clear_pointer (&level->up_pipeline, cogl_object_unref);
+    }
+
+  memset (self->levels, 0, sizeof (self->levels));
+  self->n_levels = 0;
+}
+
+static void
+get_kawase_parameters (ClutterBlurEffect *self,
+                       int               *iterations,
+                       float             *offset)
+{
+  float radius;
+  int n = 1;
+
+  radius = self->radius * ceilf (clutter_actor_get_real_resource_scale (self->actor));
+
+  /* every iteration doubles the distance covered by the samples, giving
+   * a blur radius of about offset * 2^(n + 1) texels after n iterations */
+  while (n < MAX_KAWASE_ITERATIONS &&
+         radius > MAX_KAWASE_OFFSET * (1 << (n + 1)) &&
+         (self->tex_width >> (n + 1)) > 0 &&
+         (self->tex_height >> (n + 1)) > 0)
+    n++;
+
+  *iterations = n;
+  *offset = CLAMP (radius / (1 << (n + 1)),
+                   MIN_KAWASE_OFFSET, MAX_KAWASE_OFFSET);
+}
+
+static void
+set_level_pipeline_offset (CoglPipeline *pipeline,
+                           float         offset)
+{
+  int location;
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "sample_offset");
+  cogl_pipeline_set_uniform_1f (pipeline, location, offset);
+}
+
+static CoglPipeline *
+create_level_pipeline (CoglPipeline *base_pipeline,
+                       BlurLevel    *target,
+                       CoglTexture  *source,
+                       float         offset)
+{
+  CoglPipeline *pipeline;
+  float half_pixel[2];
+  int location;
+
+  pipeline = cogl_pipeline_copy (base_pipeline);
+  cogl_pipeline_set_layer_texture (pipeline, 0, source);
+
+  half_pixel[0] = 0.5f / target->width;
+  half_pixel[1] = 0.5f / target->height;
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "half_pixel");
+  cogl_pipeline_set_uniform_float (pipeline, location,
+                                   2, /* n_components */
+                                   1, /* count */
+                                   half_pixel);
+
+  set_level_pipeline_offset (pipeline, offset);
+
+  return pipeline;
+}
+
+static gboolean
+allocate_levels (ClutterBlurEffect *self,
+                 int                iterations,
+                 float              offset)
+{
+  ClutterBlurEffectClass *klass = CLUTTER_BLUR_EFFECT_GET_CLASS (self);
+  int i;
+
+  self->n_levels = iterations + 1;
+
+  self->levels[0].width = self->tex_width;
+  self->levels[0].height = self->tex_height;
+
+  for (i = 1; i < self->n_levels; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      level->width = MAX (self->levels[i - 1].width / 2, 1);
+      level->height = MAX (self->levels[i - 1].height / 2, 1);
+
+      level->texture =
+        cogl_texture_new_with_size (level->width, level->height,
+                                    COGL_TEXTURE_NO_SLICING,
+                                    COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+      if (level->texture == NULL)
+        return FALSE;
+
+      level->offscreen = cogl_offscreen_new_to_texture (level->texture);
+      if (level->offscreen == NULL)
+        return FALSE;
+
+      cogl_framebuffer_orthographic (COGL_FRAMEBUFFER (level->offscreen),
+                                     0, 0,
+                                     level->width, level->height,
+                                     -1, 1);
+    }
+
+  for (i = 0; i < self->n_levels; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      if (i > 0)
+        {
+          level->down_pipeline =
+            create_level_pipeline (klass->base_down_pipeline, level,
+                                   self->levels[i - 1].texture,
+                                   offset);
+        }
+
+      if (i < self->n_levels - 1)
+        {
+          level->up_pipeline =
+            create_level_pipeline (klass->base_up_pipeline, level,
+                                   self->levels[i + 1].texture,
+                                   offset);
+
+          /* the intermediate levels are fully overwritten by every
+           * pass, only level 0 is blended onto the painted framebuffer */
+          if (i > 0)
+            cogl_pipeline_set_blend (level->up_pipeline,
+                                     "RGBA = ADD (SRC_COLOR, 0)",
+                                     NULL);
+        }
+    }
+
+  self->kawase_offset = offset;
+
+  return TRUE;
+}
+
+static gboolean
+ensure_levels (ClutterBlurEffect *self,
+               CoglTexture       *texture)
+{
+  int iterations;
+  float offset;
+  int i;
+
+  get_kawase_parameters (self, &iterations, &offset);
+
+  if (self->n_levels != iterations + 1 ||
+      self->levels[0].width != self->tex_width ||
+      self->levels[0].height != self->tex_height)
+    {
+      clear_levels (self);
+
+      if (!allocate_levels (self, iterations, offset))
+        {
+          g_warning ("Unable to allocate the render targets of a %dx%d blur",
+                     self->tex_width, self->tex_height);
+          clear_levels (self);
+          return FALSE;
+        }
+    }
+  else if (self->kawase_offset != offset)
+    {
+      for (i = 0; i < self->n_levels; i++)
+        {
+          if (self->levels[i].down_pipeline != NULL)
+            set_level_pipeline_offset (self->levels[i].down_pipeline, offset);
+          if (self->levels[i].up_pipeline != NULL)
+            set_level_pipeline_offset (self->levels[i].up_pipeline, offset);
+        }
+
+      self->kawase_offset = offset;
+    }
+
+  /* the offscreen effect might have exchanged its render target for
+   * another one of the same size */
+  if (self->levels[0].texture != texture)
+    {
+      self->levels[0].texture = texture;
+      cogl_pipeline_set_layer_texture (self->levels[1].down_pipeline,
+                                       0, texture);
+    }
+
+  return TRUE;
+}
+
+static void
+run_kawase_passes (ClutterBlurEffect *self)
+{
+  int i;
+
+  for (i = 1; i < self->n_levels; i++)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      cogl_framebuffer_draw_rectangle (COGL_FRAMEBUFFER (level->offscreen),
+                                       level->down_pipeline,
+                                       0, 0,
+                                       level->width, level->height);
+    }
+
+  for (i = self->n_levels - 2; i > 0; i--)
+    {
+      BlurLevel *level = &self->levels[i];
+
+      cogl_framebuffer_draw_rectangle (COGL_FRAMEBUFFER (level->offscreen),
+                                       level->up_pipeline,
+                                       0, 0,
+                                       level->width, level->height);
+    }
+}
+
 static gboolean
 clutter_blur_effect_pre_paint (ClutterEffect       *effect,
                                ClutterPaintContext *paint_context)
@@ -151,6 +470,8 @@ clutter_blur_effect_pre_paint (ClutterEffect       *effect,
 
       cogl_pipeline_set_layer_texture (self->pipeline, 0, texture);
 
+      self->levels_dirty = TRUE;
+
       return TRUE;
     }
   else
@@ -164,18 +485,31 @@ clutter_blur_effect_paint_target (ClutterOffscreenEffect *effect,
   ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   CoglFramebuffer *framebuffer =
     clutter_paint_context_get_framebuffer (paint_context);
+  CoglPipeline *pipeline = self->pipeline;
   guint8 paint_opacity;
 
+  if (self->radius > 0.0f &&
+      ensure_levels (self, clutter_offscreen_effect_get_texture (effect)))
+    {
+      if (self->levels_dirty)
+        {
+          run_kawase_passes (self);
+          self->levels_dirty = FALSE;
+        }
+
+      pipeline = self->levels[0].up_pipeline;
+    }
+
   paint_opacity = clutter_actor_get_paint_opacity (self->actor);
 
-  cogl_pipeline_set_color4ub (self->pipeline,
+  cogl_pipeline_set_color4ub (pipeline,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity,
                               paint_opacity);
 
   cogl_framebuffer_draw_rectangle (framebuffer,
-                                   self->pipeline,
+                                   pipeline,
                                    0, 0,
                                    self->tex_width, self->tex_height);
 }
@@ -184,17 +518,24 @@ static gboolean
 clutter_blur_effect_modify_paint_volume (ClutterEffect      *effect,
                                          ClutterPaintVolume *volume)
 {
+  ClutterBlurEffect *self = CLUTTER_BLUR_EFFECT (effect);
   gfloat cur_width, cur_height;
   graphene_point3d_t origin;
+  gfloat padding;
+
+  if (self->radius > 0.0f)
+    padding = ceilf (self->radius);
+  else
+    padding = BLUR_PADDING;
 
   clutter_paint_volume_get_origin (volume, &origin);
   cur_width = clutter_paint_volume_get_width (volume);
   cur_height = clutter_paint_volume_get_height (volume);
 
-  origin.x -= BLUR_PADDING;
-  origin.y -= BLUR_PADDING;
-  cur_width += 2 * BLUR_PADDING;
-  cur_height += 2 * BLUR_PADDING;
+  origin.x -= padding;
+  origin.y -= padding;
+  cur_width += 2 * padding;
+  cur_height += 2 * padding;
   clutter_paint_volume_set_origin (volume, &origin);
   clutter_paint_volume_set_width (volume, cur_width);
   clutter_paint_volume_set_height (volume, cur_height);
@@ -213,9 +554,51 @@ clutter_blur_effect_dispose (GObject *gobject)
       self->pipeline = NULL;
     }
 
+  clear_levels (self);
+
   G_OBJECT_CLASS (clutter_blur_effect_parent_class)->dispose (gobject);
 }
 
+static void
+clutter_blur_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      clutter_blur_effect_set_radius (effect, g_value_get_float (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_blur_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBlurEffect *effect = CLUTTER_BLUR_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_RADIUS:
+      g_value_set_float (value, effect->radius);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
 {
@@ -224,12 +607,55 @@ clutter_blur_effect_class_init (ClutterBlurEffectClass *klass)
   ClutterOffscreenEffectClass *offscreen_class;
 
   gobject_class->dispose = clutter_blur_effect_dispose;
+  gobject_class->set_property = clutter_blur_effect_set_property;
+  gobject_class->get_property = clutter_blur_effect_get_property;
 
   effect_class->pre_paint = clutter_blur_effect_pre_paint;
   effect_class->modify_paint_volume = clutter_blur_effect_modify_paint_volume;
 
   offscreen_class = CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
   offscreen_class->paint_target = clutter_blur_effect_paint_target;
+
+  /**
+   * ClutterBlurEffect:radius:
+   *
+   * The radius of the blur, in pixels. When set to 0.0, the default,
+   * a fixed 3x3 kernel is applied at full resolution; otherwise the
+   * contents of the actor are blurred by a dual-Kawase filter working
+   * on downsampled copies of them.
+   */
+  obj_props[PROP_RADIUS] =
+    g_param_spec_float ("radius",
+                        P_("Radius"),
+                        P_("The radius of the blur"),
+                        0.0, G_MAXFLOAT,
+                        0.0,
+                        CLUTTER_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
+}
+
+static CoglPipeline *
+create_kawase_pipeline (CoglContext *ctx,
+                        const char  *shader)
+{
+  CoglPipeline *pipeline;
+  CoglSnippet *snippet;
+
+  pipeline = cogl_pipeline_new (ctx);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                              kawase_glsl_declarations,
+                              NULL);
+  cogl_snippet_set_replace (snippet, shader);
+  cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+  cogl_object_unref (snippet);
+
+  cogl_pipeline_set_layer_null_texture (pipeline, 0);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+  return pipeline;
 }
 
 static void
@@ -253,6 +679,15 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
       cogl_object_unref (snippet);
 
       cogl_pipeline_set_layer_null_texture (klass->base_pipeline, 0);
+
+      klass->base_down_pipeline =
+        create_kawase_pipeline (ctx, kawase_down_glsl_shader);
+      cogl_pipeline_set_blend (klass->base_down_pipeline,
+                               "RGBA = ADD (SRC_COLOR, 0)",
+                               NULL);
+
+      klass->base_up_pipeline =
+        create_kawase_pipeline (ctx, kawase_up_glsl_shader);
     }
 
   self->pipeline = cogl_pipeline_copy (klass->base_pipeline);
@@ -276,3 +711,54 @@ clutter_blur_effect_new (void)
 {
   return g_object_new (CLUTTER_TYPE_BLUR_EFFECT, NULL);
 }
+
+/**
+ * clutter_blur_effect_set_radius:
+ * @effect: a #ClutterBlurEffect
+ * @radius: the radius of the blur, in pixels, or 0.0
+ *
+ * Sets the radius of the blur applied by @effect. A radius of 0.0
+ * applies a fixed 3x3 kernel at full resolution.
+ */
+void
+clutter_blur_effect_set_radius (ClutterBlurEffect *effect,
+                                gfloat             radius)
+{
+  ClutterActor *actor;
+
+  g_return_if_fail (CLUTTER_IS_BLUR_EFFECT (effect));
+  g_return_if_fail (radius >= 0.0f);
+
+  if (fabsf (effect->radius - radius) < 0.00001)
+    return;
+
+  effect->radius = radius;
+  effect->levels_dirty = TRUE;
+
+  if (radius == 0.0f)
+    clear_levels (effect);
+
+  /* the padding of the paint volume depends on the radius, so the
+   * contents of the actor need to be painted again */
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+  if (actor != NULL)
+    clutter_actor_queue_redraw (actor);
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_RADIUS]);
+}
+
+/**
+ * clutter_blur_effect_get_radius:
+ * @effect: a #ClutterBlurEffect
+ *
+ * Retrieves the radius of the blur applied by @effect
+ *
+ * Return value: the radius of the blur, in pixels
+ */
+gfloat
+clutter_blur_effect_get_radius (ClutterBlurEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BLUR_EFFECT (effect), 0.0f);
+
+  return effect->radius;
+}
@@ -39,6 +39,12 @@
  * See [canvas.c](https://git.gnome.org/browse/clutter/tree/examples/canvas.c?h=clutter-1.18)
  * for an example of how to use #ClutterCanvas.
  *
+ * Canvases drawing complex contents can be switched to asynchronous
+ * drawing using clutter_canvas_set_async(): the #ClutterCanvas::draw
+ * signal is still emitted when the canvas is invalidated, but the
+ * operations are recorded and then rasterized on a worker thread, while
+ * the previous contents of the canvas keep being painted.
+ *
  * #ClutterCanvas is available since Clutter 1.10.
  */
 
@@ -47,6 +53,7 @@
 #include <math.h>
 #include <cogl/cogl.h>
 #include <cairo-gobject.h>
+#include <gio/gio.h>
 
 #include "clutter-canvas.h"
 
@@ -76,8 +83,33 @@ struct _ClutterCanvasPrivate
   gboolean dirty;
 
   CoglBitmap *buffer;
+
+  gboolean async;
+
+  /* the results of asynchronous draws started before the last time
+   * the canvas was reset are dropped */
+  guint async_serial;
+  gboolean async_draw_in_flight;
+  gboolean async_draw_pending;
+
+  /* in asynchronous mode, the surface whose data backs the bitmap,
+   * and the surface the next draw will be rasterized into */
+  cairo_surface_t *front_surface;
+  cairo_surface_t *back_surface;
 };
 
+typedef struct _AsyncDraw
+{
+  cairo_surface_t *recording;
+  cairo_surface_t *surface;
+
+  int width;
+  int height;
+  float scale_factor;
+
+  guint serial;
+} AsyncDraw;
+
 enum
 {
   PROP_0,
@@ -85,6 +117,7 @@ enum
   PROP_WIDTH,
   PROP_HEIGHT,
   PROP_SCALE_FACTOR,
+  PROP_ASYNC,
 
   LAST_PROP
 };
@@ -141,6 +174,8 @@ clutter_canvas_finalize (GObject *gobject)
     }
 
   g_clear_pointer (&priv->texture, cogl_object_unref);
+  g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
 
   G_OBJECT_CLASS (clutter_canvas_parent_class)->finalize (gobject);
 }
@@ -194,6 +229,11 @@ clutter_canvas_set_property (GObject      *gobject,
       }
       break;
 
+    case PROP_ASYNC:
+      clutter_canvas_set_async (CLUTTER_CANVAS (gobject),
+                                g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -222,6 +262,10 @@ clutter_canvas_get_property (GObject    *gobject,
       g_value_set_float (value, priv->scale_factor);
       break;
 
+    case PROP_ASYNC:
+      g_value_set_boolean (value, priv->async);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -279,6 +323,20 @@ clutter_canvas_class_init (ClutterCanvasClass *klass)
                         G_PARAM_READWRITE |
                         G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterCanvas:async:
+   *
+   * Whether the contents of the canvas are rasterized on a worker
+   * thread. See clutter_canvas_set_async().
+   */
+  obj_props[PROP_ASYNC] =
+    g_param_spec_boolean ("async",
+                          P_("Asynchronous"),
+                          P_("Whether the contents are rasterized on a worker thread"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
   /**
    * ClutterCanvas::draw:
    * @canvas: the #ClutterCanvas that emitted the signal
@@ -359,6 +417,33 @@ clutter_canvas_paint_content (ClutterContent      *content,
   priv->dirty = FALSE;
 }
 
+static void
+clutter_canvas_run_draw (ClutterCanvas   *self,
+                         cairo_surface_t *surface)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  gboolean res;
+  cairo_t *cr;
+
+  priv->cr = cr = cairo_create (surface);
+
+  g_signal_emit (self, canvas_signals[DRAW], 0,
+                 cr, priv->width, priv->height,
+                 &res);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (_clutter_diagnostic_enabled () && cairo_status (cr))
+    {
+      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
+                 self,
+                 cairo_status_to_string (cairo_status (cr)));
+    }
+#endif
+
+  priv->cr = NULL;
+  cairo_destroy (cr);
+}
+
 static void
 clutter_canvas_emit_draw (ClutterCanvas *self)
 {
@@ -368,8 +453,6 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
   gboolean mapped_buffer;
   unsigned char *data;
   CoglBuffer *buffer;
-  gboolean res;
-  cairo_t *cr;
 
   g_assert (priv->height > 0 && priv->width > 0);
 
@@ -426,23 +509,7 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
                                   priv->scale_factor,
                                   priv->scale_factor);
 
-  self->priv->cr = cr = cairo_create (surface);
-
-  g_signal_emit (self, canvas_signals[DRAW], 0,
-                 cr, priv->width, priv->height,
-                 &res);
-
-#ifdef CLUTTER_ENABLE_DEBUG
-  if (_clutter_diagnostic_enabled () && cairo_status (cr))
-    {
-      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
-                 self,
-                 cairo_status_to_string (cairo_status (cr)));
-    }
-#endif
-
-  self->priv->cr = NULL;
-  cairo_destroy (cr);
+  clutter_canvas_run_draw (self, surface);
 
   if (mapped_buffer)
     cogl_buffer_unmap (buffer);
@@ -458,18 +525,168 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
   cairo_surface_destroy (surface);
 }
 
+static void
+async_draw_free (AsyncDraw *draw)
+{
+  g_clear_pointer (&draw->recording, cairo_surface_destroy);
+  g_clear_pointer (&draw->surface, cairo_surface_destroy);
+  g_free (draw);
+}
+
+static void
+async_draw_thread_func (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  AsyncDraw *draw = task_data;
+  cairo_t *cr;
+
+  if (draw->surface == NULL ||
+      cairo_image_surface_get_width (draw->surface) != draw->width ||
+      cairo_image_surface_get_height (draw->surface) != draw->height)
+    {
+      g_clear_pointer (&draw->surface, cairo_surface_destroy);
+      draw->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                                  draw->width,
+                                                  draw->height);
+    }
+
+  cairo_surface_set_device_scale (draw->surface,
+                                  draw->scale_factor,
+                                  draw->scale_factor);
+
+  /* the surface might hold the contents of an older draw, so replace
+   * every pixel of it */
+  cr = cairo_create (draw->surface);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface (cr, draw->recording, 0, 0);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (draw->surface);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void clutter_canvas_queue_async_draw (ClutterCanvas *self);
+
+static void
+on_async_draw_done (GObject      *source_object,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  ClutterCanvas *self = CLUTTER_CANVAS (source_object);
+  ClutterCanvasPrivate *priv = self->priv;
+  AsyncDraw *draw = g_task_get_task_data (G_TASK (result));
+
+  priv->async_draw_in_flight = FALSE;
+
+  if (draw->serial == priv->async_serial)
+    {
+      CoglContext *ctx;
+
+      ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+      /* the bitmap needs to go before the surface holding its data; the
+       * texture created from it, if any, has already been uploaded */
+      g_clear_pointer (&priv->buffer, cogl_object_unref);
+      g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+
+      priv->back_surface = priv->front_surface;
+      priv->front_surface = g_steal_pointer (&draw->surface);
+
+      priv->buffer =
+        cogl_bitmap_new_for_data (ctx,
+                                  draw->width,
+                                  draw->height,
+                                  CLUTTER_CAIRO_FORMAT_ARGB32,
+                                  cairo_image_surface_get_stride (priv->front_surface),
+                                  cairo_image_surface_get_data (priv->front_surface));
+      priv->dirty = TRUE;
+
+      _clutter_content_queue_redraw (CLUTTER_CONTENT (self));
+    }
+
+  if (priv->async && priv->async_draw_pending)
+    clutter_canvas_queue_async_draw (self);
+}
+
+static void
+clutter_canvas_queue_async_draw (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  cairo_rectangle_t extents;
+  AsyncDraw *draw;
+  GTask *task;
+
+  /* a single draw is in flight at any time; invalidations happening in
+   * the meantime are coalesced into the next one */
+  if (priv->async_draw_in_flight)
+    {
+      priv->async_draw_pending = TRUE;
+      return;
+    }
+
+  priv->async_draw_pending = FALSE;
+
+  if (priv->width <= 0 || priv->height <= 0)
+    return;
+
+  extents.x = 0;
+  extents.y = 0;
+  extents.width = priv->width;
+  extents.height = priv->height;
+
+  draw = g_new0 (AsyncDraw, 1);
+  draw->recording = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+                                                    &extents);
+  draw->surface = g_steal_pointer (&priv->back_surface);
+  draw->width = ceilf (priv->width * priv->scale_factor);
+  draw->height = ceilf (priv->height * priv->scale_factor);
+  draw->scale_factor = priv->scale_factor;
+  draw->serial = priv->async_serial;
+
+  CLUTTER_NOTE (MISC, "Recording Cairo surface with size %d x %d",
+                priv->width, priv->height);
+
+  /* the draw handlers run on this thread, only the rasterization of
+   * what they recorded is deferred to the worker */
+  clutter_canvas_run_draw (self, draw->recording);
+
+  task = g_task_new (self, NULL, on_async_draw_done, NULL);
+  g_task_set_task_data (task, draw, (GDestroyNotify) async_draw_free);
+  g_task_run_in_thread (task, async_draw_thread_func);
+  g_object_unref (task);
+
+  priv->async_draw_in_flight = TRUE;
+}
+
 static void
 clutter_canvas_invalidate (ClutterContent *content)
 {
   ClutterCanvas *self = CLUTTER_CANVAS (content);
   ClutterCanvasPrivate *priv = self->priv;
 
+  /* asynchronous draws keep the previous contents until the new ones
+   * are ready */
+  if (priv->async && priv->width > 0 && priv->height > 0)
+    {
+      clutter_canvas_queue_async_draw (self);
+      return;
+    }
+
+  priv->async_serial++;
+
   if (priv->buffer != NULL)
     {
       cogl_object_unref (priv->buffer);
       priv->buffer = NULL;
     }
 
+  g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+
   if (priv->width <= 0 || priv->height <= 0)
     return;
 
@@ -644,3 +861,65 @@ clutter_canvas_get_scale_factor (ClutterCanvas *canvas)
 
   return canvas->priv->scale_factor;
 }
+
+/**
+ * clutter_canvas_set_async:
+ * @canvas: a #ClutterCanvas
+ * @async: whether the contents of @canvas are rasterized on a worker thread
+ *
+ * Sets whether the contents of @canvas are rasterized on a worker thread.
+ *
+ * In asynchronous mode the #ClutterCanvas::draw signal is still emitted
+ * on the main thread when @canvas is invalidated, but the Cairo context
+ * passed to the handlers records the drawing operations instead of
+ * executing them. The recorded operations are then rasterized on a worker
+ * thread, and the result replaces the contents of @canvas at the next
+ * frame; until then, the previous contents keep being painted. Handlers
+ * must therefore not read back from the target surface of the context,
+ * nor modify the surfaces they used as sources once the signal emission
+ * is over.
+ */
+void
+clutter_canvas_set_async (ClutterCanvas *canvas,
+                          gboolean       async)
+{
+  ClutterCanvasPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+
+  priv = canvas->priv;
+
+  async = !!async;
+  if (priv->async == async)
+    return;
+
+  priv->async = async;
+
+  /* drop whatever was drawn in the previous mode */
+  priv->async_serial++;
+  priv->async_draw_pending = FALSE;
+  g_clear_pointer (&priv->buffer, cogl_object_unref);
+  g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+
+  g_object_notify_by_pspec (G_OBJECT (canvas), obj_props[PROP_ASYNC]);
+}
+
+/**
+ * clutter_canvas_get_async:
+ * @canvas: a #ClutterCanvas
+ *
+ * Retrieves whether the contents of @canvas are rasterized on a worker
+ * thread. See clutter_canvas_set_async().
+ *
+ * Return value: %TRUE if @canvas draws asynchronously
+ */
+gboolean
+clutter_canvas_get_async (ClutterCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_CANVAS (canvas), FALSE);
+
+  return canvas->priv->async;
+}
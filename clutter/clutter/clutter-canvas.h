@@ -101,6 +101,12 @@ void                    clutter_canvas_set_scale_factor         (ClutterCanvas *
 CLUTTER_EXPORT
 float                   clutter_canvas_get_scale_factor         (ClutterCanvas *canvas);
 
+CLUTTER_EXPORT
+void                    clutter_canvas_set_async                (ClutterCanvas *canvas,
+                                                                 gboolean       async);
+CLUTTER_EXPORT
+gboolean                clutter_canvas_get_async                (ClutterCanvas *canvas);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_CANVAS_H__ */
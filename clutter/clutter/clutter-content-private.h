@@ -34,6 +34,8 @@ void            _clutter_content_attached               (ClutterContent   *conte
 void            _clutter_content_detached               (ClutterContent   *content,
                                                          ClutterActor     *actor);
 
+void            _clutter_content_queue_redraw           (ClutterContent   *content);
+
 void            _clutter_content_paint_content          (ClutterContent      *content,
                                                          ClutterActor        *actor,
                                                          ClutterPaintNode    *node,
@@ -169,14 +169,30 @@ clutter_content_default_init (ClutterContentInterface *iface)
 void
 clutter_content_invalidate (ClutterContent *content)
 {
-  GHashTable *actors;
-  GHashTableIter iter;
-  gpointer key_p, value_p;
-
   g_return_if_fail (CLUTTER_IS_CONTENT (content));
 
   CLUTTER_CONTENT_GET_IFACE (content)->invalidate (content);
 
+  _clutter_content_queue_redraw (content);
+}
+
+/*< private >
+ * _clutter_content_queue_redraw:
+ * @content: a #ClutterContent
+ *
+ * Queues a redraw of the actors @content is attached to, without
+ * invalidating @content.
+ *
+ * This is meant to be used by #ClutterContent implementations whose
+ * contents become available some time after being invalidated.
+ */
+void
+_clutter_content_queue_redraw (ClutterContent *content)
+{
+  GHashTable *actors;
+  GHashTableIter iter;
+  gpointer key_p, value_p;
+
   actors = g_object_get_qdata (G_OBJECT (content), quark_content_actors);
   if (actors == NULL)
     return;
@@ -38,6 +38,9 @@ CLUTTER_EXPORT
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
+void            _clutter_event_coalesce_history         (ClutterEvent       *event,
+                                                         ClutterEvent       *discarded);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EVENT_PRIVATE_H__ */
@@ -61,6 +61,9 @@ typedef struct _ClutterEventPrivate {
   ClutterModifierType latched_state;
   ClutterModifierType locked_state;
 
+  /* samples coalesced into the event, oldest first */
+  GArray *history;
+
   guint is_pointer_emulated : 1;
 } ClutterEventPrivate;
 
@@ -126,6 +129,136 @@ _clutter_event_set_platform_data (ClutterEvent *event,
   ((ClutterEventPrivate *) event)->platform_data = data;
 }
 
+static void
+clear_history_entry (gpointer data)
+{
+  ClutterEventHistoryEntry *entry = data;
+
+  g_clear_pointer (&entry->axes, g_free);
+}
+
+static GArray *
+create_history (guint reserved_size)
+{
+  GArray *history;
+
+  history = g_array_sized_new (FALSE, FALSE,
+                               sizeof (ClutterEventHistoryEntry),
+                               reserved_size);
+  g_array_set_clear_func (history, clear_history_entry);
+
+  return history;
+}
+
+static GArray *
+copy_history (GArray *history,
+              guint   n_axes)
+{
+  GArray *copy;
+  guint i;
+
+  copy = create_history (history->len);
+
+  for (i = 0; i < history->len; i++)
+    {
+      ClutterEventHistoryEntry entry;
+
+      entry = g_array_index (history, ClutterEventHistoryEntry, i);
+      if (entry.axes != NULL)
+        entry.axes = g_memdup2 (entry.axes, sizeof (double) * n_axes);
+
+      g_array_append_val (copy, entry);
+    }
+
+  return copy;
+}
+
+/*< private >
+ * _clutter_event_coalesce_history:
+ * @event: a #ClutterEvent
+ * @discarded: an event of the same device preceding @event, which is
+ *   not going to be delivered
+ *
+ * Moves the sample of @discarded, along with the samples that were
+ * previously coalesced into it, to the history of @event.
+ */
+void
+_clutter_event_coalesce_history (ClutterEvent *event,
+                                 ClutterEvent *discarded)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+  ClutterEventPrivate *real_discarded = (ClutterEventPrivate *) discarded;
+  ClutterEventHistoryEntry entry = { 0, };
+  GArray *history;
+  gdouble *axes;
+  guint n_axes;
+
+  /* The samples of the discarded event are older than the ones which
+   * might already be coalesced into @event */
+  history = g_steal_pointer (&real_discarded->history);
+  if (history == NULL)
+    history = create_history (1);
+
+  entry.time = clutter_event_get_time (discarded);
+  clutter_event_get_coords (discarded, &entry.x, &entry.y);
+
+  axes = clutter_event_get_axes (discarded, &n_axes);
+  if (axes != NULL && n_axes > 0)
+    entry.axes = g_memdup2 (axes, sizeof (double) * n_axes);
+
+  g_array_append_val (history, entry);
+
+  if (real_event->history != NULL)
+    {
+      g_array_append_vals (history,
+                           real_event->history->data,
+                           real_event->history->len);
+
+      /* the axes are owned by the new history now */
+      g_array_set_clear_func (real_event->history, NULL);
+      g_array_free (real_event->history, TRUE);
+    }
+
+  real_event->history = history;
+}
+
+/**
+ * clutter_event_get_history:
+ * @event: a #ClutterEvent
+ * @n_entries: (out): return location for the number of entries
+ *
+ * Retrieves the samples of the same device that were coalesced into
+ * @event instead of being delivered as events of their own, because
+ * they happened within the same frame; see
+ * clutter_stage_set_throttle_motion_events().
+ *
+ * The entries are sorted from the oldest to the most recent, and do not
+ * include the sample of @event itself. The axes of each entry match the
+ * axes of the device of @event.
+ *
+ * Return value: (transfer none) (array length=n_entries) (nullable): the
+ *   history of @event, or %NULL if no samples were coalesced into it
+ */
+const ClutterEventHistoryEntry *
+clutter_event_get_history (const ClutterEvent *event,
+                           guint              *n_entries)
+{
+  ClutterEventPrivate *real_event = (ClutterEventPrivate *) event;
+
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (n_entries != NULL, NULL);
+
+  if (real_event->history == NULL || real_event->history->len == 0)
+    {
+      *n_entries = 0;
+      return NULL;
+    }
+
+  *n_entries = real_event->history->len;
+
+  return (const ClutterEventHistoryEntry *) real_event->history->data;
+}
+
 void
 _clutter_event_set_pointer_emulated (ClutterEvent *event,
                                      gboolean      is_emulated)
@@ -1367,6 +1500,9 @@ clutter_event_copy (const ClutterEvent *event)
   if (device != NULL)
     n_axes = clutter_input_device_get_n_axes (device);
 
+  if (real_event->history != NULL)
+    new_real_event->history = copy_history (real_event->history, n_axes);
+
   switch (event->type)
     {
     case CLUTTER_BUTTON_PRESS:
@@ -1447,6 +1583,7 @@ clutter_event_free (ClutterEvent *event)
 
       g_clear_object (&real_event->device);
       g_clear_object (&real_event->source_device);
+      g_clear_pointer (&real_event->history, g_array_unref);
 
       switch (event->type)
         {
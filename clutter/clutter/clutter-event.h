@@ -124,6 +124,7 @@ typedef struct _ClutterPadStripEvent    ClutterPadStripEvent;
 typedef struct _ClutterPadRingEvent     ClutterPadRingEvent;
 typedef struct _ClutterIMEvent          ClutterIMEvent;
 typedef struct _ClutterDeviceEvent      ClutterDeviceEvent;
+typedef struct _ClutterEventHistoryEntry ClutterEventHistoryEntry;
 
 /**
  * ClutterAnyEvent:
@@ -643,6 +644,25 @@ union _ClutterEvent
   ClutterDeviceEvent device;
 };
 
+/**
+ * ClutterEventHistoryEntry:
+ * @time: the time of the sample, in milliseconds
+ * @x: the X coordinate of the sample, in stage coordinates
+ * @y: the Y coordinate of the sample, in stage coordinates
+ * @axes: (nullable): the axes values of the sample, one for each axis
+ *   of the device of the event, or %NULL
+ *
+ * A sample of a motion or touch update event which was coalesced into
+ * a later event instead of being delivered on its own.
+ */
+struct _ClutterEventHistoryEntry
+{
+  guint32 time;
+  gfloat x;
+  gfloat y;
+  gdouble *axes;
+};
+
 /**
  * ClutterEventFilterFunc:
  * @event: the event that is going to be emitted
@@ -862,6 +882,10 @@ gboolean                 clutter_event_get_pad_event_details         (const Clut
                                                                       guint                  *mode,
                                                                       gdouble                *value);
 
+CLUTTER_EXPORT
+const ClutterEventHistoryEntry * clutter_event_get_history           (const ClutterEvent     *event,
+                                                                      guint                  *n_entries);
+
 
 G_END_DECLS
 
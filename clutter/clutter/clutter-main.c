@@ -98,6 +98,7 @@ static gboolean clutter_enable_accessibility = TRUE;
 static gboolean clutter_sync_to_vblank       = TRUE;
 
 static guint clutter_default_fps             = 60;
+static guint clutter_max_cached_size_requests = 16;
 
 static ClutterTextDirection clutter_text_direction = CLUTTER_TEXT_DIRECTION_LTR;
 
@@ -362,6 +363,12 @@ _clutter_context_get_show_fps (void)
   return context->show_fps;
 }
 
+guint
+_clutter_context_get_max_cached_size_requests (void)
+{
+  return clutter_max_cached_size_requests;
+}
+
 /**
  * clutter_get_accessibility_enabled:
  *
@@ -1070,6 +1077,14 @@ pre_parse_hook (GOptionContext  *context,
       clutter_default_fps = CLAMP (default_fps, 1, 1000);
     }
 
+  env_string = g_getenv ("CLUTTER_MAX_CACHED_SIZE_REQUESTS");
+  if (env_string)
+    {
+      gint max_requests = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_max_cached_size_requests = CLAMP (max_requests, 3, 256);
+    }
+
   env_string = g_getenv ("CLUTTER_DISABLE_MIPMAPPED_TEXT");
   if (env_string)
     clutter_disable_mipmap_text = TRUE;
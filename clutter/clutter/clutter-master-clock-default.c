@@ -54,6 +54,10 @@
 #define clutter_warn_if_over_budget(master_clock,start_time,section)
 #endif
 
+/* Predictions are never more than a few frames away from the dispatch,
+ * even at the lowest refresh rates */
+#define MAX_PRESENTATION_TIME_DISTANCE_US (G_USEC_PER_SEC / 8)
+
 typedef struct _ClutterClockSource              ClutterClockSource;
 
 struct _ClutterMasterClockDefault
@@ -478,6 +482,8 @@ clutter_clock_dispatch (GSource     *source,
   ClutterClockSource *clock_source = (ClutterClockSource *) source;
   ClutterMasterClockDefault *master_clock = clock_source->master_clock;
   GSList *stages;
+  gint64 next_tick;
+  gint64 now;
 
   CLUTTER_NOTE (SCHEDULER, "Master clock [tick]");
 
@@ -485,12 +491,22 @@ clutter_clock_dispatch (GSource     *source,
 
   COGL_TRACE_BEGIN (ClutterMasterClockTick, "Master Clock (tick)");
 
-  /* Get the time to use for this frame */
-  master_clock->cur_tick = master_clock_get_next_presentation_time (master_clock);
-
-  /* On the first frame the backend might not have an answer */
-  if (master_clock->cur_tick <= 0)
-    master_clock->cur_tick = g_source_get_time (source);
+  /* Get the time to use for this frame: animations are sampled at the
+   * time the frame is predicted to be presented at, rather than at the
+   * time of the dispatch, which is subject to jitter */
+  now = g_source_get_time (source);
+  next_tick = master_clock_get_next_presentation_time (master_clock);
+
+  /* On the first frame the backend might not have an answer; a
+   * prediction far from now, e.g. from a mode change or a stalled flip,
+   * is bogus and would hold animations back until it is reached */
+  if (next_tick <= 0 ||
+      ABS (next_tick - now) > MAX_PRESENTATION_TIME_DISTANCE_US)
+    next_tick = now;
+
+  /* Never go back in time, which could happen when moving between
+   * the predictions of views presented at different rates */
+  master_clock->cur_tick = MAX (master_clock->cur_tick, next_tick);
 
 #ifdef CLUTTER_ENABLE_DEBUG
   master_clock->remaining_budget = master_clock->frame_budget;
@@ -26,6 +26,7 @@
 #define __CLUTTER_H_INSIDE__
 
 #include "clutter-backend.h"
+#include "clutter-damage-history.h"
 #include "clutter-event-private.h"
 #include "clutter-input-device-private.h"
 #include "clutter-input-pointer-a11y-private.h"
@@ -34,6 +35,7 @@
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 #include "clutter-stage-view.h"
+#include "clutter-stage-view-private.h"
 #include "cogl/clutter-stage-cogl.h"
 #include "clutter/x11/clutter-backend-x11.h"
 
@@ -47,7 +49,8 @@ CLUTTER_EXPORT
 void clutter_stage_capture_into (ClutterStage          *stage,
                                  gboolean               paint,
                                  cairo_rectangle_int_t *rect,
-                                 uint8_t               *data);
+                                 uint8_t               *data,
+                                 int                    stride);
 
 CLUTTER_EXPORT
 void clutter_stage_paint_to_framebuffer (ClutterStage                *stage,
@@ -91,6 +94,23 @@ void clutter_stage_get_device_coords (ClutterStage         *stage,
 CLUTTER_EXPORT
 gboolean clutter_actor_has_transitions (ClutterActor *actor);
 
+CLUTTER_EXPORT
+void clutter_actor_get_size_request_cache_stats (guint64 *hits,
+                                                 guint64 *misses);
+
+CLUTTER_EXPORT
+void clutter_actor_reset_size_request_cache_stats (void);
+
+CLUTTER_EXPORT
+void clutter_actor_get_stage_views_update_stats (guint *n_visited,
+                                                 guint *n_updated);
+
+CLUTTER_EXPORT
+void clutter_text_get_layout_cache_stats (guint64 *hits,
+                                          guint64 *misses,
+                                          guint   *n_layouts,
+                                          gsize   *size);
+
 #undef __CLUTTER_H_INSIDE__
 
 #endif /* __CLUTTER_MUFFIN_H__ */
@@ -72,6 +72,9 @@
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-deform-effect.h"
+#include "clutter-flatten-effect.h"
+#include "clutter-offscreen-pool.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 #include "clutter-paint-context-private.h"
@@ -99,6 +102,10 @@ struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  /* whether offscreen and texture come from the shared offscreen
+   * pool, and must be given back to it */
+  gboolean pooled;
+
   gint old_opacity_override;
 };
 
@@ -106,6 +113,36 @@ G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ClutterOffscreenEffect,
                                      clutter_offscreen_effect,
                                      CLUTTER_TYPE_EFFECT)
 
+static CoglHandle clutter_offscreen_effect_real_create_texture (ClutterOffscreenEffect *effect,
+                                                               gfloat                  width,
+                                                               gfloat                  height);
+
+static void
+clutter_offscreen_effect_release_fbo (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  /* don't keep the texture alive through the pipeline */
+  if (priv->target != NULL && priv->texture != NULL)
+    cogl_pipeline_set_layer_null_texture (priv->target, 0);
+
+  if (priv->pooled && priv->offscreen != NULL)
+    {
+      clutter_offscreen_pool_release (priv->texture, priv->offscreen);
+      priv->texture = NULL;
+      priv->offscreen = NULL;
+    }
+  else
+    {
+      g_clear_pointer (&priv->texture, cogl_object_unref);
+      g_clear_pointer (&priv->offscreen, cogl_object_unref);
+    }
+
+  priv->pooled = FALSE;
+  priv->target_width = 0;
+  priv->target_height = 0;
+}
+
 static void
 clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
                                     ClutterActor     *actor)
@@ -118,7 +155,7 @@ clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
   meta_class->set_actor (meta, actor);
 
   /* clear out the previous state */
-  g_clear_pointer (&priv->offscreen, cogl_object_unref);
+  clutter_offscreen_effect_release_fbo (self);
 
   /* we keep a back pointer here, to avoid going through the ActorMeta */
   priv->actor = clutter_actor_meta_get_actor (meta);
@@ -194,33 +231,71 @@ update_fbo (ClutterEffect *effect,
       ensure_pipeline_filter_for_scale (self, resource_scale);
     }
 
-  g_clear_pointer (&priv->texture, cogl_object_unref);
-  g_clear_pointer (&priv->offscreen, cogl_object_unref);
-
-  priv->texture =
-    clutter_offscreen_effect_create_texture (self, target_width, target_height);
-  if (priv->texture == NULL)
-    return FALSE;
+  /* Effects using the default textures share their render targets
+   * through the offscreen pool; the pooled textures can be larger than
+   * the requested size, so only their target_width x target_height
+   * corner is painted. Deform effects map their geometry on the whole
+   * texture, so they need an exact size. */
+  if (CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (self)->create_texture ==
+      clutter_offscreen_effect_real_create_texture &&
+      !CLUTTER_IS_DEFORM_EFFECT (self))
+    {
+      CoglTexture *texture;
+      CoglOffscreen *offscreen;
+
+      if (priv->pooled && priv->offscreen != NULL &&
+          clutter_offscreen_pool_is_suitable (priv->texture,
+                                              target_width,
+                                              target_height))
+        {
+          /* the current render target is still in the right bucket */
+          priv->target_width = target_width;
+          priv->target_height = target_height;
+
+          ensure_pipeline_filter_for_scale (self, resource_scale);
+          return TRUE;
+        }
+
+      clutter_offscreen_effect_release_fbo (self);
+
+      if (!clutter_offscreen_pool_acquire (target_width, target_height,
+                                           &texture, &offscreen))
+        {
+          g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+
+          g_clear_pointer (&priv->target, cogl_object_unref);
+          return FALSE;
+        }
+
+      priv->texture = texture;
+      priv->offscreen = offscreen;
+      priv->pooled = TRUE;
+    }
+  else
+    {
+      clutter_offscreen_effect_release_fbo (self);
+
+      priv->texture =
+        clutter_offscreen_effect_create_texture (self, target_width, target_height);
+      if (priv->texture == NULL)
+        return FALSE;
+
+      priv->offscreen = cogl_offscreen_new_to_texture (priv->texture);
+      if (priv->offscreen == NULL)
+        {
+          g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+
+          g_clear_pointer (&priv->texture, cogl_object_unref);
+          g_clear_pointer (&priv->target, cogl_object_unref);
+          return FALSE;
+        }
+    }
 
   cogl_pipeline_set_layer_texture (priv->target, 0, priv->texture);
 
   priv->target_width = target_width;
   priv->target_height = target_height;
 
-  priv->offscreen = cogl_offscreen_new_to_texture (priv->texture);
-  if (priv->offscreen == NULL)
-    {
-      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
-
-      cogl_object_unref (priv->target);
-      priv->target = NULL;
-
-      priv->target_width = 0;
-      priv->target_height = 0;
-
-      return FALSE;
-    }
-
   return TRUE;
 }
 
@@ -382,6 +457,7 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect,
   CoglFramebuffer *framebuffer =
     clutter_paint_context_get_framebuffer (paint_context);
   guint8 paint_opacity;
+  float s_2, t_2;
 
   paint_opacity = clutter_actor_get_paint_opacity (priv->actor);
 
@@ -394,15 +470,19 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect,
   /* At this point we are in stage coordinates translated so if
    * we draw our texture using a textured quad the size of the paint
    * box then we will overlay where the actor would have drawn if it
-   * hadn't been redirected offscreen.
+   * hadn't been redirected offscreen. Pooled textures can be larger
+   * than the target, so only sample the part that was painted to.
    */
+  s_2 = (float) priv->target_width / cogl_texture_get_width (priv->texture);
+  t_2 = (float) priv->target_height / cogl_texture_get_height (priv->texture);
+
   cogl_framebuffer_draw_textured_rectangle (framebuffer,
                                             priv->target,
                                             0, 0,
-                                            cogl_texture_get_width (priv->texture),
-                                            cogl_texture_get_height (priv->texture),
+                                            priv->target_width,
+                                            priv->target_height,
                                             0.0, 0.0,
-                                            1.0, 1.0);
+                                            s_2, t_2);
 }
 
 static void
@@ -478,7 +558,7 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
   if (flags & CLUTTER_EFFECT_PAINT_BYPASS_EFFECT)
     {
       clutter_actor_continue_paint (priv->actor, paint_context);
-      cogl_clear_object (&priv->offscreen);
+      clutter_offscreen_effect_release_fbo (self);
       return;
     }
 
@@ -497,7 +577,20 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
       if (pre_paint_succeeded)
         effect_class->post_paint (effect, paint_context);
       else
-        g_clear_pointer (&priv->offscreen, cogl_object_unref);
+        clutter_offscreen_effect_release_fbo (self);
+
+      /* When painting inside another offscreen effect of the same actor
+       * our result is now part of the outer effect's image, which is the
+       * one reused as long as the actor is not dirty; so give the render
+       * target back to the pool right away, letting the next effects of
+       * the chain, or of other actors, reuse it in this same frame. The
+       * flatten effect is excluded, as caching its image is its purpose.
+       */
+      if (priv->pooled &&
+          !CLUTTER_IS_FLATTEN_EFFECT (effect) &&
+          _clutter_actor_is_effect_nested (priv->actor, effect,
+                                           CLUTTER_TYPE_OFFSCREEN_EFFECT))
+        clutter_offscreen_effect_release_fbo (self);
     }
   else
     clutter_offscreen_effect_paint_texture (self, paint_context);
@@ -508,10 +601,9 @@ clutter_offscreen_effect_notify (GObject    *gobject,
                                  GParamSpec *pspec)
 {
   ClutterOffscreenEffect *offscreen_effect = CLUTTER_OFFSCREEN_EFFECT (gobject);
-  ClutterOffscreenEffectPrivate *priv = offscreen_effect->priv;
 
   if (strcmp (pspec->name, "enabled") == 0)
-    g_clear_pointer (&priv->offscreen, cogl_object_unref);
+    clutter_offscreen_effect_release_fbo (offscreen_effect);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->notify (gobject, pspec);
 }
@@ -522,8 +614,7 @@ clutter_offscreen_effect_finalize (GObject *gobject)
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (gobject);
   ClutterOffscreenEffectPrivate *priv = self->priv;
 
-  g_clear_pointer (&priv->offscreen, cogl_object_unref);
-  g_clear_pointer (&priv->texture, cogl_object_unref);
+  clutter_offscreen_effect_release_fbo (self);
   g_clear_pointer (&priv->target, cogl_object_unref);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
@@ -714,10 +805,10 @@ clutter_offscreen_effect_get_target_size (ClutterOffscreenEffect *effect,
     return FALSE;
 
   if (width)
-    *width = cogl_texture_get_width (priv->texture);
+    *width = priv->target_width;
 
   if (height)
-    *height = cogl_texture_get_height (priv->texture);
+    *height = priv->target_height;
 
   return TRUE;
 }
@@ -756,8 +847,8 @@ clutter_offscreen_effect_get_target_rect (ClutterOffscreenEffect *effect,
   graphene_rect_init (rect,
                       priv->position.x,
                       priv->position.y,
-                      cogl_texture_get_width (priv->texture),
-                      cogl_texture_get_height (priv->texture));
+                      priv->target_width,
+                      priv->target_height);
 
   return TRUE;
 }
@@ -0,0 +1,264 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The offscreen pool hands out render targets (a texture and an
+ * offscreen framebuffer drawing to it) to #ClutterOffscreenEffect
+ * instances.
+ *
+ * Sizes are rounded up to a multiple of POOL_BUCKET_SIZE, so that an
+ * effect applied to an actor whose size is being animated keeps using
+ * the same target for most frames, and targets released by one effect
+ * can be picked up by another one needing a similar size.
+ *
+ * Targets that are not in use are kept around for a few seconds, as
+ * long as the memory used by all the targets allocated through the
+ * pool stays within POOL_BUDGET.
+ */
+
+#include "clutter-build-config.h"
+
+#include "clutter-offscreen-pool.h"
+
+#include "clutter-backend.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#define POOL_BUCKET_SIZE        64
+
+/* estimated video memory that render targets allocated through the
+ * pool can use before unused ones are freed instead of being kept */
+#define POOL_BUDGET             (128 * 1024 * 1024)
+
+/* how long unused render targets are kept */
+#define POOL_IDLE_TIMEOUT_S     5
+
+#define BYTES_PER_PIXEL         4
+
+typedef struct _PoolEntry
+{
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+
+  int64_t release_time_us;
+} PoolEntry;
+
+typedef struct _ClutterOffscreenPool
+{
+  /* unused render targets, most recently released first */
+  GList *free_entries;
+
+  /* the memory used by all the render targets created by the pool,
+   * both in use and unused */
+  size_t allocated_size;
+
+  guint trim_id;
+} ClutterOffscreenPool;
+
+static ClutterOffscreenPool pool = { NULL, };
+
+static int
+bucket_size (int size)
+{
+  size = MAX (size, 1);
+
+  return ((size + POOL_BUCKET_SIZE - 1) / POOL_BUCKET_SIZE) * POOL_BUCKET_SIZE;
+}
+
+static size_t
+texture_size (CoglTexture *texture)
+{
+  return (size_t) cogl_texture_get_width (texture) *
+         cogl_texture_get_height (texture) *
+         BYTES_PER_PIXEL;
+}
+
+static void
+pool_entry_free (PoolEntry *entry)
+{
+  pool.allocated_size -= texture_size (entry->texture);
+
+  cogl_object_unref (entry->offscreen);
+  cogl_object_unref (entry->texture);
+  g_free (entry);
+}
+
+static void
+trim_free_entries (size_t  target_size,
+                   int64_t min_release_time_us)
+{
+  GList *l;
+
+  l = g_list_last (pool.free_entries);
+  while (l != NULL)
+    {
+      GList *prev = l->prev;
+      PoolEntry *entry = l->data;
+
+      if (pool.allocated_size <= target_size &&
+          entry->release_time_us >= min_release_time_us)
+        break;
+
+      pool_entry_free (entry);
+      pool.free_entries = g_list_delete_link (pool.free_entries, l);
+
+      l = prev;
+    }
+}
+
+static gboolean
+trim_idle_entries (gpointer user_data)
+{
+  int64_t now_us = g_get_monotonic_time ();
+
+  trim_free_entries (POOL_BUDGET,
+                     now_us - POOL_IDLE_TIMEOUT_S * G_USEC_PER_SEC);
+
+  if (pool.free_entries != NULL)
+    return G_SOURCE_CONTINUE;
+
+  pool.trim_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * clutter_offscreen_pool_acquire:
+ * @width: the minimum width of the render target
+ * @height: the minimum height of the render target
+ * @texture: (out) (transfer full): return location for the texture
+ * @offscreen: (out) (transfer full): return location for the offscreen
+ *   framebuffer drawing to @texture
+ *
+ * Retrieves an unused render target of at least the given size from
+ * the pool, or creates a new one. The contents of the render target are
+ * undefined.
+ *
+ * Return value: %TRUE if a render target was returned
+ */
+gboolean
+clutter_offscreen_pool_acquire (int             width,
+                                int             height,
+                                CoglTexture   **texture,
+                                CoglOffscreen **offscreen)
+{
+  size_t size;
+  GList *l;
+
+  width = bucket_size (width);
+  height = bucket_size (height);
+
+  for (l = pool.free_entries; l != NULL; l = l->next)
+    {
+      PoolEntry *entry = l->data;
+
+      if (cogl_texture_get_width (entry->texture) == width &&
+          cogl_texture_get_height (entry->texture) == height)
+        {
+          *texture = entry->texture;
+          *offscreen = entry->offscreen;
+
+          pool.free_entries = g_list_delete_link (pool.free_entries, l);
+          g_free (entry);
+
+          return TRUE;
+        }
+    }
+
+  /* make room for the new target; if the targets in use are already
+   * over budget there is nothing else we can do, as effects still need
+   * to be painted */
+  size = (size_t) width * height * BYTES_PER_PIXEL;
+  if (size < POOL_BUDGET)
+    trim_free_entries (POOL_BUDGET - size, 0);
+  else
+    trim_free_entries (0, 0);
+
+  CLUTTER_NOTE (MISC, "Allocating a %dx%d offscreen render target", width, height);
+
+  *texture = cogl_texture_new_with_size (width, height,
+                                         COGL_TEXTURE_NO_SLICING,
+                                         COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (*texture == NULL)
+    return FALSE;
+
+  *offscreen = cogl_offscreen_new_to_texture (*texture);
+  if (*offscreen == NULL)
+    {
+      g_clear_pointer (texture, cogl_object_unref);
+      return FALSE;
+    }
+
+  pool.allocated_size += size;
+
+  return TRUE;
+}
+
+/*
+ * clutter_offscreen_pool_is_suitable:
+ * @texture: a texture returned by clutter_offscreen_pool_acquire()
+ * @width: the minimum width of the render target
+ * @height: the minimum height of the render target
+ *
+ * Checks whether @texture is the texture clutter_offscreen_pool_acquire()
+ * would return for the given size, so that a render target already in
+ * use can be kept instead of being exchanged for an equivalent one.
+ *
+ * Return value: %TRUE if @texture can be used for the given size
+ */
+gboolean
+clutter_offscreen_pool_is_suitable (CoglTexture *texture,
+                                    int          width,
+                                    int          height)
+{
+  return cogl_texture_get_width (texture) == bucket_size (width) &&
+         cogl_texture_get_height (texture) == bucket_size (height);
+}
+
+/*
+ * clutter_offscreen_pool_release:
+ * @texture: (transfer full): a texture returned by
+ *   clutter_offscreen_pool_acquire()
+ * @offscreen: (transfer full): the offscreen framebuffer returned with
+ *   @texture
+ *
+ * Gives a render target back to the pool, so that it can be reused.
+ */
+void
+clutter_offscreen_pool_release (CoglTexture   *texture,
+                                CoglOffscreen *offscreen)
+{
+  PoolEntry *entry;
+
+  entry = g_new0 (PoolEntry, 1);
+  entry->texture = texture;
+  entry->offscreen = offscreen;
+  entry->release_time_us = g_get_monotonic_time ();
+
+  pool.free_entries = g_list_prepend (pool.free_entries, entry);
+
+  trim_free_entries (POOL_BUDGET, 0);
+
+  if (pool.free_entries != NULL && pool.trim_id == 0)
+    {
+      pool.trim_id = g_timeout_add_seconds (POOL_IDLE_TIMEOUT_S,
+                                            trim_idle_entries,
+                                            NULL);
+      g_source_set_name_by_id (pool.trim_id, "[clutter] trim_idle_entries");
+    }
+}
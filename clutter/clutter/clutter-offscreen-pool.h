@@ -0,0 +1,39 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUTTER_OFFSCREEN_POOL_H
+#define CLUTTER_OFFSCREEN_POOL_H
+
+#include <glib.h>
+
+#include "cogl/cogl.h"
+
+gboolean clutter_offscreen_pool_acquire (int             width,
+                                         int             height,
+                                         CoglTexture   **texture,
+                                         CoglOffscreen **offscreen);
+
+gboolean clutter_offscreen_pool_is_suitable (CoglTexture *texture,
+                                             int          width,
+                                             int          height);
+
+void clutter_offscreen_pool_release (CoglTexture   *texture,
+                                     CoglOffscreen *offscreen);
+
+#endif /* CLUTTER_OFFSCREEN_POOL_H */
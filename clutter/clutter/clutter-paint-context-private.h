@@ -31,6 +31,10 @@ ClutterPaintContext * clutter_paint_context_new_for_view (ClutterStageView     *
                                                           const cairo_region_t *redraw_clip,
                                                           ClutterPaintFlag      paint_flags);
 
+ClutterPaintContext * clutter_paint_context_new_for_framebuffer_full (CoglFramebuffer      *framebuffer,
+                                                                      const cairo_region_t *redraw_clip,
+                                                                      ClutterPaintFlag      paint_flags);
+
 gboolean clutter_paint_context_is_drawing_off_stage (ClutterPaintContext *paint_context);
 
 CoglFramebuffer * clutter_paint_context_get_base_framebuffer (ClutterPaintContext *paint_context);
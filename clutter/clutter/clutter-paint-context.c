@@ -56,24 +56,35 @@ clutter_paint_context_new_for_view (ClutterStageView     *view,
   return paint_context;
 }
 
-/**
- * clutter_paint_context_new_for_framebuffer: (skip)
- */
 ClutterPaintContext *
-clutter_paint_context_new_for_framebuffer (CoglFramebuffer *framebuffer)
+clutter_paint_context_new_for_framebuffer_full (CoglFramebuffer      *framebuffer,
+                                                const cairo_region_t *redraw_clip,
+                                                ClutterPaintFlag      paint_flags)
 {
   ClutterPaintContext *paint_context;
 
   paint_context = g_new0 (ClutterPaintContext, 1);
   g_ref_count_init (&paint_context->ref_count);
-  paint_context->paint_flags = (CLUTTER_PAINT_FLAG_NO_CURSORS |
-                                CLUTTER_PAINT_FLAG_NO_PAINT_SIGNAL);
+  if (redraw_clip)
+    paint_context->redraw_clip = cairo_region_copy (redraw_clip);
+  paint_context->paint_flags = paint_flags;
 
   clutter_paint_context_push_framebuffer (paint_context, framebuffer);
 
   return paint_context;
 }
 
+/**
+ * clutter_paint_context_new_for_framebuffer: (skip)
+ */
+ClutterPaintContext *
+clutter_paint_context_new_for_framebuffer (CoglFramebuffer *framebuffer)
+{
+  return clutter_paint_context_new_for_framebuffer_full (framebuffer, NULL,
+                                                         (CLUTTER_PAINT_FLAG_NO_CURSORS |
+                                                          CLUTTER_PAINT_FLAG_NO_PAINT_SIGNAL));
+}
+
 ClutterPaintContext *
 clutter_paint_context_ref (ClutterPaintContext *paint_context)
 {
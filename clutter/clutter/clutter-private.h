@@ -193,6 +193,7 @@ void                    _clutter_context_unlock                         (void);
 gboolean                _clutter_context_is_initialized                 (void);
 ClutterPickMode         _clutter_context_get_pick_mode                  (void);
 gboolean                _clutter_context_get_show_fps                   (void);
+guint                   _clutter_context_get_max_cached_size_requests   (void);
 
 gboolean      _clutter_feature_init (GError **error);
 
@@ -292,6 +293,8 @@ gboolean        _clutter_util_matrix_decompose  (const ClutterMatrix *src,
                                                  graphene_point3d_t  *translate_p,
                                                  ClutterVertex4      *perspective_p);
 
+PangoContext * _clutter_create_pango_context     (void);
+
 CLUTTER_EXPORT
 PangoDirection _clutter_pango_unichar_direction (gunichar ch);
 
@@ -38,6 +38,7 @@ enum
   PROP_OFFSCREEN,
   PROP_USE_SHADOWFB,
   PROP_SCALE,
+  PROP_REFRESH_RATE,
 
   PROP_LAST
 };
@@ -50,6 +51,7 @@ typedef struct _ClutterStageViewPrivate
 
   cairo_rectangle_int_t layout;
   float scale;
+  float refresh_rate;
   CoglFramebuffer *framebuffer;
 
   CoglOffscreen *offscreen;
@@ -699,6 +701,24 @@ clutter_stage_view_get_scale (ClutterStageView *view)
   return priv->scale;
 }
 
+/**
+ * clutter_stage_view_get_refresh_rate:
+ * @view: a #ClutterStageView
+ *
+ * Retrieves the refresh rate of the mode of the monitor @view is
+ * presented on, as configured when @view was created.
+ *
+ * Returns: the refresh rate of @view, or 0.0 if it is unknown
+ */
+float
+clutter_stage_view_get_refresh_rate (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  return priv->refresh_rate;
+}
+
 typedef void (*FrontBufferCallback) (CoglFramebuffer *framebuffer,
                                      gconstpointer    user_data);
 
@@ -976,6 +996,9 @@ clutter_stage_view_get_property (GObject    *object,
     case PROP_SCALE:
       g_value_set_float (value, priv->scale);
       break;
+    case PROP_REFRESH_RATE:
+      g_value_set_float (value, priv->refresh_rate);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -1027,6 +1050,9 @@ clutter_stage_view_set_property (GObject      *object,
     case PROP_SCALE:
       priv->scale = g_value_get_float (value);
       break;
+    case PROP_REFRESH_RATE:
+      priv->refresh_rate = g_value_get_float (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -1150,5 +1176,14 @@ clutter_stage_view_class_init (ClutterStageViewClass *klass)
                         G_PARAM_CONSTRUCT |
                         G_PARAM_STATIC_STRINGS);
 
+  obj_props[PROP_REFRESH_RATE] =
+    g_param_spec_float ("refresh-rate",
+                        "Refresh rate",
+                        "The refresh rate of the view",
+                        0.0, G_MAXFLOAT, 0.0,
+                        G_PARAM_READWRITE |
+                        G_PARAM_CONSTRUCT_ONLY |
+                        G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (object_class, PROP_LAST, obj_props);
 }
@@ -65,6 +65,9 @@ void             clutter_stage_view_invalidate_offscreen_blit_pipeline (ClutterS
 CLUTTER_EXPORT
 float clutter_stage_view_get_scale (ClutterStageView *view);
 
+CLUTTER_EXPORT
+float clutter_stage_view_get_refresh_rate (ClutterStageView *view);
+
 CLUTTER_EXPORT
 void clutter_stage_view_get_offscreen_transformation_matrix (ClutterStageView *view,
                                                              CoglMatrix       *matrix);
@@ -87,7 +87,9 @@ void              _clutter_stage_window_get_geometry            (ClutterStageWin
                                                                  cairo_rectangle_int_t *geometry);
 void              _clutter_stage_window_schedule_update         (ClutterStageWindow *window,
                                                                  int                 sync_delay);
+CLUTTER_EXPORT
 gint64            _clutter_stage_window_get_update_time         (ClutterStageWindow *window);
+CLUTTER_EXPORT
 void              _clutter_stage_window_clear_update_time       (ClutterStageWindow *window);
 
 void              _clutter_stage_window_set_accept_focus        (ClutterStageWindow *window,
@@ -103,6 +105,7 @@ void              _clutter_stage_window_finish_frame            (ClutterStageWin
 
 int64_t           _clutter_stage_window_get_frame_counter       (ClutterStageWindow *window);
 
+CLUTTER_EXPORT
 int64_t           _clutter_stage_window_get_next_presentation_time (ClutterStageWindow *window);
 
 G_END_DECLS
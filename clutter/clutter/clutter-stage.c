@@ -1292,6 +1292,7 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                   ClutterSeat *seat = clutter_input_device_get_seat (device);
 
                   clutter_seat_compress_motion (seat, next_event, event);
+                  _clutter_event_coalesce_history (next_event, event);
                 }
 
               goto next_event;
@@ -1305,6 +1306,8 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                             "Omitting touch update event at %d, %d",
                             (int) event->touch.x,
                             (int) event->touch.y);
+
+              _clutter_event_coalesce_history (next_event, event);
               goto next_event;
             }
         }
@@ -1533,6 +1536,8 @@ update_actor_stage_views (ClutterStage *stage)
    * allocation of an actor probably moved the actor onto another stage
    * view, so if an actor sees phase == 1, it can choose a "final" scale.
    */
+  clutter_actor_reset_stage_views_update_stats ();
+
   for (phase = 0; phase < 2; phase++)
     {
       clutter_actor_update_stage_views (actor, phase);
@@ -1547,6 +1552,20 @@ update_actor_stage_views (ClutterStage *stage)
   g_warn_if_fail (!priv->actor_needs_immediate_relayout);
 }
 
+static gboolean
+stage_has_pending_view_redraws (ClutterStage *stage)
+{
+  GList *l;
+
+  for (l = _clutter_stage_window_get_views (stage->priv->impl); l; l = l->next)
+    {
+      if (clutter_stage_view_has_redraw_clip (l->data))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 /**
  * _clutter_stage_do_update:
  * @stage: A #ClutterStage
@@ -1608,8 +1627,10 @@ _clutter_stage_do_update (ClutterStage *stage)
 
   COGL_TRACE_END (ClutterStagePaint);
 
-  /* reset the guard, so that new redraws are possible */
-  priv->redraw_pending = FALSE;
+  /* reset the guard, so that new redraws are possible; views driven by a
+   * slower frame clock might not have been painted by this update, and
+   * still need one of their own */
+  priv->redraw_pending = stage_has_pending_view_redraws (stage);
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (priv->redraw_count > 0)
@@ -4606,7 +4627,11 @@ clutter_stage_paint_to_framebuffer (ClutterStage                *stage,
   cairo_region_t *redraw_clip;
 
   redraw_clip = cairo_region_create_rectangle (rect);
-  paint_context = clutter_paint_context_new_for_framebuffer (framebuffer);
+  paint_context =
+    clutter_paint_context_new_for_framebuffer_full (framebuffer,
+                                                    redraw_clip,
+                                                    paint_flags |
+                                                    CLUTTER_PAINT_FLAG_NO_PAINT_SIGNAL);
   cairo_region_destroy (redraw_clip);
 
   cogl_framebuffer_push_matrix (framebuffer);
@@ -4710,14 +4735,12 @@ void
 clutter_stage_capture_into (ClutterStage          *stage,
                             gboolean               paint,
                             cairo_rectangle_int_t *rect,
-                            uint8_t               *data)
+                            uint8_t               *data,
+                            int                    stride)
 {
   ClutterStagePrivate *priv = stage->priv;
   GList *l;
   int bpp = 4;
-  int stride;
-
-  stride = rect->width * 4;
 
   for (l = _clutter_stage_window_get_views (priv->impl); l; l = l->next)
     {
@@ -4734,6 +4757,9 @@ clutter_stage_capture_into (ClutterStage          *stage,
       cairo_region_get_extents (region, &capture_rect);
       cairo_region_destroy (region);
 
+      if (capture_rect.width == 0 || capture_rect.height == 0)
+        continue;
+
       x_offset = capture_rect.x - rect->x;
       y_offset = capture_rect.y - rect->y;
 
@@ -0,0 +1,401 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The text layout cache is a process-wide, least-recently-used cache
+ * of PangoLayouts shared between non-editable ClutterText actors.
+ *
+ * The same strings tend to be displayed by many actors at once (window
+ * titles in a window list, an alt-tab switcher and an overview, for
+ * instance), and actors displaying them are frequently destroyed and
+ * recreated. Each ClutterText still keeps its own small per-size cache
+ * of layouts, but on a miss it asks this cache first, so that a layout
+ * (together with the glyph cache and the cogl-pango display list
+ * attached to it) is only computed once for a given content.
+ *
+ * Layouts handed out by the cache are shared and must not be modified.
+ * They are created on PangoContexts owned by the cache, so that the base
+ * direction set on an actor's own context does not invalidate them.
+ */
+
+#include "clutter-build-config.h"
+
+#include <string.h>
+
+#include "clutter-text-layout-cache.h"
+
+#include "clutter-backend.h"
+#include "clutter-debug.h"
+#include "clutter-muffin.h"
+#include "clutter-private.h"
+#include "clutter-settings.h"
+
+/* upper bound for the estimated memory used by cached layouts */
+#define MAX_CACHE_SIZE          (4 * 1024 * 1024)
+
+/* rough per-character and per-line costs of a laid out PangoLayout,
+ * including its glyph strings and the cogl-pango display list */
+#define BYTES_PER_CHAR          48
+#define BYTES_PER_LINE          256
+
+typedef struct _CacheEntry
+{
+  char *text;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  ClutterTextLayoutKey key;
+
+  PangoLayout *layout;
+  gsize size;
+
+  GList link;
+} CacheEntry;
+
+typedef struct _ClutterTextLayoutCache
+{
+  GHashTable *entries;
+
+  /* most recently used first */
+  GQueue lru;
+  gsize size;
+
+  PangoContext *contexts[PANGO_DIRECTION_NEUTRAL + 1];
+
+  guint64 hits;
+  guint64 misses;
+} ClutterTextLayoutCache;
+
+static ClutterTextLayoutCache *layout_cache = NULL;
+
+static gboolean
+attr_lists_equal (PangoAttrList *a,
+                  PangoAttrList *b)
+{
+  PangoAttrIterator *iter_a, *iter_b;
+  gboolean equal = TRUE;
+
+  if (a == b)
+    return TRUE;
+
+  if (a == NULL || b == NULL)
+    return FALSE;
+
+  iter_a = pango_attr_list_get_iterator (a);
+  iter_b = pango_attr_list_get_iterator (b);
+
+  do
+    {
+      GSList *attrs_a, *attrs_b, *l_a, *l_b;
+      int start_a, end_a, start_b, end_b;
+
+      pango_attr_iterator_range (iter_a, &start_a, &end_a);
+      pango_attr_iterator_range (iter_b, &start_b, &end_b);
+
+      if (start_a != start_b || end_a != end_b)
+        {
+          equal = FALSE;
+          break;
+        }
+
+      attrs_a = pango_attr_iterator_get_attrs (iter_a);
+      attrs_b = pango_attr_iterator_get_attrs (iter_b);
+
+      for (l_a = attrs_a, l_b = attrs_b;
+           l_a != NULL && l_b != NULL;
+           l_a = l_a->next, l_b = l_b->next)
+        {
+          if (!pango_attribute_equal (l_a->data, l_b->data))
+            break;
+        }
+
+      if (l_a != NULL || l_b != NULL)
+        equal = FALSE;
+
+      g_slist_free_full (attrs_a, (GDestroyNotify) pango_attribute_destroy);
+      g_slist_free_full (attrs_b, (GDestroyNotify) pango_attribute_destroy);
+
+      if (!equal)
+        break;
+
+      if (pango_attr_iterator_next (iter_a) != pango_attr_iterator_next (iter_b))
+        {
+          equal = FALSE;
+          break;
+        }
+    }
+  while (TRUE);
+
+  pango_attr_iterator_destroy (iter_a);
+  pango_attr_iterator_destroy (iter_b);
+
+  return equal;
+}
+
+static guint
+layout_key_hash (gconstpointer data)
+{
+  const ClutterTextLayoutKey *key = data;
+  guint hash;
+
+  hash = g_str_hash (key->text);
+  hash ^= pango_font_description_hash (key->font_desc);
+  hash = hash * 31 + key->width;
+  hash = hash * 31 + key->height;
+  hash = hash * 31 + key->ellipsize;
+  hash = hash * 31 + key->direction;
+
+  return hash;
+}
+
+static gboolean
+layout_key_equal (gconstpointer data_a,
+                  gconstpointer data_b)
+{
+  const ClutterTextLayoutKey *a = data_a;
+  const ClutterTextLayoutKey *b = data_b;
+
+  return a->width == b->width &&
+         a->height == b->height &&
+         a->ellipsize == b->ellipsize &&
+         a->direction == b->direction &&
+         a->alignment == b->alignment &&
+         a->wrap_mode == b->wrap_mode &&
+         !a->single_line_mode == !b->single_line_mode &&
+         !a->justify == !b->justify &&
+         strcmp (a->text, b->text) == 0 &&
+         pango_font_description_equal (a->font_desc, b->font_desc) &&
+         attr_lists_equal (a->attrs, b->attrs);
+}
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+  g_object_unref (entry->layout);
+  g_clear_pointer (&entry->attrs, pango_attr_list_unref);
+  pango_font_description_free (entry->font_desc);
+  g_free (entry->text);
+  g_free (entry);
+}
+
+static void
+clutter_text_layout_cache_evict (ClutterTextLayoutCache *cache,
+                                 CacheEntry             *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->size -= entry->size;
+
+  /* the hash table owns the entry */
+  g_hash_table_remove (cache->entries, &entry->key);
+}
+
+static void
+clutter_text_layout_cache_invalidate (ClutterTextLayoutCache *cache)
+{
+  int i;
+
+  g_queue_init (&cache->lru);
+  g_hash_table_remove_all (cache->entries);
+  cache->size = 0;
+
+  /* the font options or the resolution changed, so the contexts need
+   * to be configured again */
+  for (i = 0; i < G_N_ELEMENTS (cache->contexts); i++)
+    g_clear_object (&cache->contexts[i]);
+}
+
+static ClutterTextLayoutCache *
+clutter_text_layout_cache_get_default (void)
+{
+  ClutterBackend *backend;
+  ClutterSettings *settings;
+
+  if (G_LIKELY (layout_cache != NULL))
+    return layout_cache;
+
+  layout_cache = g_new0 (ClutterTextLayoutCache, 1);
+  layout_cache->entries =
+    g_hash_table_new_full (layout_key_hash, layout_key_equal,
+                           NULL, (GDestroyNotify) cache_entry_free);
+  g_queue_init (&layout_cache->lru);
+
+  backend = clutter_get_default_backend ();
+  g_signal_connect_swapped (backend, "resolution-changed",
+                            G_CALLBACK (clutter_text_layout_cache_invalidate),
+                            layout_cache);
+  g_signal_connect_swapped (backend, "font-changed",
+                            G_CALLBACK (clutter_text_layout_cache_invalidate),
+                            layout_cache);
+
+  settings = clutter_settings_get_default ();
+  g_signal_connect_swapped (settings, "notify::font-name",
+                            G_CALLBACK (clutter_text_layout_cache_invalidate),
+                            layout_cache);
+
+  return layout_cache;
+}
+
+static PangoContext *
+clutter_text_layout_cache_get_context (ClutterTextLayoutCache *cache,
+                                       PangoDirection          direction)
+{
+  g_assert (direction < G_N_ELEMENTS (cache->contexts));
+
+  if (cache->contexts[direction] == NULL)
+    {
+      PangoContext *context;
+
+      context = _clutter_create_pango_context ();
+      pango_context_set_base_dir (context, direction);
+
+      cache->contexts[direction] = context;
+    }
+
+  return cache->contexts[direction];
+}
+
+static gsize
+estimate_layout_size (PangoLayout *layout)
+{
+  return sizeof (CacheEntry) +
+         pango_layout_get_character_count (layout) * BYTES_PER_CHAR +
+         pango_layout_get_line_count (layout) * BYTES_PER_LINE;
+}
+
+static PangoLayout *
+create_layout (ClutterTextLayoutCache     *cache,
+               const ClutterTextLayoutKey *key)
+{
+  PangoLayout *layout;
+
+  layout = pango_layout_new (clutter_text_layout_cache_get_context (cache,
+                                                                    key->direction));
+
+  pango_layout_set_font_description (layout, key->font_desc);
+  pango_layout_set_text (layout, key->text, -1);
+
+  if (key->attrs != NULL)
+    pango_layout_set_attributes (layout, key->attrs);
+
+  pango_layout_set_alignment (layout, key->alignment);
+  pango_layout_set_single_paragraph_mode (layout, key->single_line_mode);
+  pango_layout_set_justify (layout, key->justify);
+  pango_layout_set_wrap (layout, key->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, key->ellipsize);
+  pango_layout_set_width (layout, key->width);
+  pango_layout_set_height (layout, key->height);
+
+  cogl_pango_ensure_glyph_cache_for_layout (layout);
+
+  return layout;
+}
+
+/*
+ * clutter_text_layout_cache_get_layout:
+ * @key: the contents of the layout
+ *
+ * Retrieves a shared #PangoLayout for @key, creating it if needed.
+ *
+ * Return value: (transfer full): a #PangoLayout that must not be
+ *   modified
+ */
+PangoLayout *
+clutter_text_layout_cache_get_layout (const ClutterTextLayoutKey *key)
+{
+  ClutterTextLayoutCache *cache = clutter_text_layout_cache_get_default ();
+  CacheEntry *entry;
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry != NULL)
+    {
+      CLUTTER_NOTE (PANGO, "Shared layout cache hit for '%s'", key->text);
+
+      cache->hits += 1;
+
+      g_queue_unlink (&cache->lru, &entry->link);
+      g_queue_push_head_link (&cache->lru, &entry->link);
+
+      return g_object_ref (entry->layout);
+    }
+
+  CLUTTER_NOTE (PANGO, "Shared layout cache miss for '%s'", key->text);
+
+  cache->misses += 1;
+
+  entry = g_new0 (CacheEntry, 1);
+  entry->text = g_strdup (key->text);
+  entry->font_desc = pango_font_description_copy (key->font_desc);
+  /* the attributes list is copied so that changes to the actor's own
+   * list cannot alter the key of a cached entry */
+  if (key->attrs != NULL)
+    entry->attrs = pango_attr_list_copy (key->attrs);
+
+  entry->key = *key;
+  entry->key.text = entry->text;
+  entry->key.font_desc = entry->font_desc;
+  entry->key.attrs = entry->attrs;
+
+  entry->layout = create_layout (cache, &entry->key);
+  entry->size = estimate_layout_size (entry->layout);
+  entry->link.data = entry;
+
+  g_hash_table_insert (cache->entries, &entry->key, entry);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->size += entry->size;
+
+  /* the layout we just added is never evicted, even if on its own it
+   * is larger than the whole cache */
+  while (cache->size > MAX_CACHE_SIZE && cache->lru.length > 1)
+    clutter_text_layout_cache_evict (cache, cache->lru.tail->data);
+
+  return g_object_ref (entry->layout);
+}
+
+/**
+ * clutter_text_get_layout_cache_stats: (skip)
+ * @hits: (out) (optional): return location for the number of cache hits
+ * @misses: (out) (optional): return location for the number of cache misses
+ * @n_layouts: (out) (optional): return location for the number of cached
+ *   layouts
+ * @size: (out) (optional): return location for the estimated memory
+ *   used by the cached layouts, in bytes
+ *
+ * Retrieves statistics about the layout cache shared between
+ * #ClutterText actors.
+ */
+void
+clutter_text_get_layout_cache_stats (guint64 *hits,
+                                     guint64 *misses,
+                                     guint   *n_layouts,
+                                     gsize   *size)
+{
+  ClutterTextLayoutCache *cache = layout_cache;
+
+  if (hits != NULL)
+    *hits = cache != NULL ? cache->hits : 0;
+
+  if (misses != NULL)
+    *misses = cache != NULL ? cache->misses : 0;
+
+  if (n_layouts != NULL)
+    *n_layouts = cache != NULL ? g_hash_table_size (cache->entries) : 0;
+
+  if (size != NULL)
+    *size = cache != NULL ? cache->size : 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CLUTTER_TEXT_LAYOUT_CACHE_H
+#define CLUTTER_TEXT_LAYOUT_CACHE_H
+
+#include <glib.h>
+#include <pango/pango.h>
+
+typedef struct _ClutterTextLayoutKey ClutterTextLayoutKey;
+
+/* Everything a non-editable ClutterText layout depends on; two actors
+ * producing the same key can share the same PangoLayout */
+struct _ClutterTextLayoutKey
+{
+  const char *text;
+  const PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+
+  PangoDirection direction;
+  PangoAlignment alignment;
+  PangoWrapMode wrap_mode;
+  PangoEllipsizeMode ellipsize;
+
+  int width;
+  int height;
+
+  gboolean single_line_mode;
+  gboolean justify;
+};
+
+PangoLayout * clutter_text_layout_cache_get_layout (const ClutterTextLayoutKey *key);
+
+#endif /* CLUTTER_TEXT_LAYOUT_CACHE_H */
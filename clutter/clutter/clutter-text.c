@@ -58,6 +58,7 @@
 #include "clutter-private.h"    /* includes <cogl-pango/cogl-pango.h> */
 #include "clutter-property-transition.h"
 #include "clutter-text-buffer.h"
+#include "clutter-text-layout-cache.h"
 #include "clutter-units.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-scriptable.h"
@@ -726,6 +727,47 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static PangoDirection
+clutter_text_get_base_direction (ClutterText *text,
+                                 const gchar *contents,
+                                 gsize        contents_len)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoDirection pango_dir;
+
+  if (priv->password_char != 0)
+    pango_dir = PANGO_DIRECTION_NEUTRAL;
+  else
+    pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
+
+  if (pango_dir == PANGO_DIRECTION_NEUTRAL)
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+      ClutterTextDirection text_dir;
+
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterSeat *seat;
+          ClutterKeymap *keymap;
+
+          seat = clutter_backend_get_default_seat (backend);
+          keymap = clutter_seat_get_keymap (seat);
+          pango_dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+
+          if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
+            pango_dir = PANGO_DIRECTION_RTL;
+          else
+            pango_dir = PANGO_DIRECTION_LTR;
+       }
+    }
+
+  return pango_dir;
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -783,35 +825,7 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
     {
       PangoDirection pango_dir;
 
-      if (priv->password_char != 0)
-        pango_dir = PANGO_DIRECTION_NEUTRAL;
-      else
-        pango_dir = _clutter_pango_find_base_dir (contents, contents_len);
-
-      if (pango_dir == PANGO_DIRECTION_NEUTRAL)
-        {
-          ClutterBackend *backend = clutter_get_default_backend ();
-          ClutterTextDirection text_dir;
-
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterSeat *seat;
-              ClutterKeymap *keymap;
-
-              seat = clutter_backend_get_default_seat (backend);
-              keymap = clutter_seat_get_keymap (seat);
-              pango_dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              text_dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
-
-              if (text_dir == CLUTTER_TEXT_DIRECTION_RTL)
-                pango_dir = PANGO_DIRECTION_RTL;
-              else
-                pango_dir = PANGO_DIRECTION_LTR;
-           }
-        }
+      pango_dir = clutter_text_get_base_direction (text, contents, contents_len);
 
       pango_context_set_base_dir (clutter_actor_get_pango_context (CLUTTER_ACTOR (text)), pango_dir);
 
@@ -844,6 +858,53 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   return layout;
 }
 
+/*
+ * clutter_text_create_shared_layout:
+ *
+ * Like clutter_text_create_layout_no_cache(), but looks up the layout in
+ * the cache shared by all non-editable #ClutterText actors first. The
+ * returned layout must not be modified.
+ */
+static PangoLayout *
+clutter_text_create_shared_layout (ClutterText       *text,
+                                   gint               width,
+                                   gint               height,
+                                   PangoEllipsizeMode ellipsize)
+{
+  ClutterTextPrivate *priv = text->priv;
+  ClutterTextLayoutKey key;
+  PangoLayout *layout;
+  gchar *contents;
+  gsize contents_len;
+
+  g_assert (!priv->editable);
+
+  contents = clutter_text_get_display_text (text);
+  contents_len = strlen (contents);
+
+  clutter_text_ensure_effective_attributes (text);
+
+  key.text = contents;
+  key.font_desc = priv->font_desc;
+  key.attrs = priv->effective_attrs;
+  key.direction = clutter_text_get_base_direction (text, contents, contents_len);
+  key.alignment = priv->alignment;
+  key.wrap_mode = priv->wrap_mode;
+  key.ellipsize = ellipsize;
+  key.width = width;
+  key.height = height;
+  key.single_line_mode = priv->single_line_mode;
+  key.justify = priv->justify;
+
+  priv->resolved_direction = key.direction;
+
+  layout = clutter_text_layout_cache_get_layout (&key);
+
+  g_free (contents);
+
+  return layout;
+}
+
 static void
 clutter_text_dirty_cache (ClutterText *text)
 {
@@ -1121,10 +1182,20 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  /* Editable layouts depend on the preedit string and the cursor, so
+   * they are never shared with other actors */
+  if (!priv->editable)
+    {
+      oldest_cache->layout =
+        clutter_text_create_shared_layout (text, width, height, ellipsize);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
 
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+      cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+    }
 
   /* Mark the 'time' this cache was created and advance the time */
   oldest_cache->age = priv->cache_age++;
@@ -5000,6 +5071,9 @@ clutter_text_set_editable (ClutterText *self,
     {
       priv->editable = editable;
 
+      /* editable and non-editable actors don't share layouts */
+      clutter_text_dirty_cache (self);
+
       if (method)
         {
           if (!priv->editable && clutter_input_focus_is_focused (priv->input_focus))
@@ -5782,7 +5856,8 @@ clutter_text_set_markup (ClutterText *self,
  * Retrieves the current #PangoLayout used by a #ClutterText actor.
  *
  * Return value: (transfer none): a #PangoLayout. The returned object is owned by
- *   the #ClutterText actor and should not be modified or freed
+ *   the #ClutterText actor and should not be modified or freed; layouts of
+ *   non-editable actors may be shared with other #ClutterText actors
  *
  * Since: 1.0
  */
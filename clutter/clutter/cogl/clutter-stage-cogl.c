@@ -50,11 +50,18 @@
 
 #define MAX_STACK_RECTS 256
 
+/* Added to the longest of the recent render times when predicting the
+ * time the next update is going to take, to absorb the variations that
+ * the history doesn't account for */
+#define RENDER_TIME_MARGIN_US 1500
+
 typedef struct _ClutterStageViewCoglPrivate
 {
   /* Damage history, in stage view render target framebuffer coordinate space.
    */
   ClutterDamageHistory *damage_history;
+
+  ClutterStageCoglFrameClock frame_clock;
 } ClutterStageViewCoglPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterStageViewCogl, clutter_stage_view_cogl,
@@ -77,22 +84,362 @@ enum
   PROP_LAST
 };
 
-static void
-clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
-                                    gint                sync_delay);
-
 static void
 clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
 {
   CLUTTER_NOTE (BACKEND, "Unrealizing Cogl stage [%p]", stage_window);
 }
 
-void
-_clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
-                               CoglFrameEvent    frame_event,
-                               ClutterFrameInfo *frame_info)
+static void
+frame_clock_init (ClutterStageCoglFrameClock *frame_clock)
+{
+  frame_clock->refresh_rate = 0.0;
+  frame_clock->pending_swaps = 0;
+
+  frame_clock->last_presentation_time = 0;
+  frame_clock->update_time = -1;
+  frame_clock->last_update_time = 0;
+  frame_clock->next_presentation_time = -1;
+
+  frame_clock->sample_time = 0;
+  frame_clock->last_sample_time = 0;
+
+  frame_clock->dispatch_time = 0;
+  frame_clock->target_presentation_time = 0;
+  frame_clock->cpu_time_before_swap = 0;
+  frame_clock->gpu_time_before_swap_ns = 0;
+  frame_clock->timestamp_query = NULL;
+
+  frame_clock->render_time_index = 0;
+  frame_clock->n_render_times = 0;
+
+  frame_clock->n_presented_frames = 0;
+  frame_clock->n_missed_deadlines = 0;
+  frame_clock->last_latency = 0;
+  frame_clock->total_latency = 0;
+}
+
+static void
+frame_clock_clear_timestamp_query (ClutterStageCoglFrameClock *frame_clock)
+{
+  CoglContext *context;
+
+  if (!frame_clock->timestamp_query)
+    return;
+
+  context = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  cogl_context_free_timestamp_query (context,
+                                     g_steal_pointer (&frame_clock->timestamp_query));
+}
+
+static void
+frame_clock_clear (ClutterStageCoglFrameClock *frame_clock)
+{
+  frame_clock_clear_timestamp_query (frame_clock);
+}
+
+static ClutterStageCoglFrameClock *
+get_frame_clock (ClutterStageCogl *stage_cogl,
+                 ClutterStageView *view)
+{
+  ClutterStageViewCoglPrivate *view_priv;
+
+  if (!CLUTTER_IS_STAGE_VIEW_COGL (view))
+    return &stage_cogl->frame_clock;
+
+  view_priv =
+    clutter_stage_view_cogl_get_instance_private (CLUTTER_STAGE_VIEW_COGL (view));
+
+  return &view_priv->frame_clock;
+}
+
+static gint64
+get_frame_clock_time (ClutterStageCogl *stage_cogl)
+{
+  if (G_UNLIKELY (stage_cogl->frame_clock_time != 0))
+    return stage_cogl->frame_clock_time;
+
+  return g_get_monotonic_time ();
+}
+
+static float
+get_view_refresh_rate (ClutterStageView *view)
+{
+  if (!view)
+    return 0.0;
+
+  return clutter_stage_view_get_refresh_rate (view);
+}
+
+static gint64
+frame_clock_get_refresh_interval (ClutterStageCoglFrameClock *frame_clock,
+                                  float                       view_refresh_rate,
+                                  float                      *out_refresh_rate)
+{
+  float refresh_rate;
+
+  /* Prefer the rate of the mode the view was created for, as views
+   * presented through a shared onscreen all get the presentation
+   * feedback of that onscreen */
+  refresh_rate = view_refresh_rate;
+  if (refresh_rate <= 0.0)
+    refresh_rate = frame_clock->refresh_rate;
+  if (refresh_rate <= 0.0)
+    refresh_rate = clutter_get_default_frame_rate ();
+
+  if (out_refresh_rate)
+    *out_refresh_rate = refresh_rate;
+
+  return (gint64) (0.5 + G_USEC_PER_SEC / refresh_rate);
+}
+
+static void
+frame_clock_record_render_time (ClutterStageCoglFrameClock *frame_clock,
+                                int64_t                     render_time)
+{
+  frame_clock->render_times[frame_clock->render_time_index] = render_time;
+  frame_clock->render_time_index =
+    (frame_clock->render_time_index + 1) % CLUTTER_STAGE_COGL_RENDER_TIME_HISTORY;
+  frame_clock->n_render_times =
+    MIN (frame_clock->n_render_times + 1, CLUTTER_STAGE_COGL_RENDER_TIME_HISTORY);
+}
+
+/* The time the next update is expected to take, from its dispatch to
+ * the completion of its rendering by the GPU, or 0 if unknown */
+static int64_t
+frame_clock_get_predicted_render_time (ClutterStageCoglFrameClock *frame_clock)
+{
+  int64_t max_render_time = 0;
+  int i;
+
+  if (frame_clock->n_render_times == 0)
+    return 0;
+
+  for (i = 0; i < frame_clock->n_render_times; i++)
+    max_render_time = MAX (max_render_time, frame_clock->render_times[i]);
+
+  return max_render_time + RENDER_TIME_MARGIN_US;
+}
+
+static void
+frame_clock_schedule_update (ClutterStageCoglFrameClock *frame_clock,
+                             gint                        sync_delay,
+                             float                       view_refresh_rate,
+                             gint64                      now)
+{
+  float refresh_rate;
+  gint64 refresh_interval;
+  int64_t min_render_time_allowed;
+  int64_t max_render_time_allowed;
+  int64_t predicted_render_time;
+  int64_t next_presentation_time;
+
+  if (frame_clock->update_time != -1)
+    return;
+
+  if (sync_delay < 0)
+    {
+      frame_clock->update_time = now;
+      return;
+    }
+
+  refresh_interval = frame_clock_get_refresh_interval (frame_clock,
+                                                       view_refresh_rate,
+                                                       &refresh_rate);
+  if (refresh_interval == 0)
+    {
+      frame_clock->update_time = now;
+      return;
+    }
+
+  min_render_time_allowed = refresh_interval / 2;
+  max_render_time_allowed = refresh_interval - 1000 * sync_delay;
+
+  /* Be robust in the case of incredibly bogus refresh rate */
+  if (max_render_time_allowed <= 0)
+    {
+      g_warning ("Unsupported monitor refresh rate detected. "
+                 "(Refresh rate: %.3f, refresh interval: %" G_GINT64_FORMAT ")",
+                 refresh_rate,
+                 refresh_interval);
+      frame_clock->update_time = now;
+      return;
+    }
+
+  /* Once the time updates take is known, start them only as early as
+   * needed to make it to the vblank, so that the frame is built from
+   * the most recent input and client content */
+  predicted_render_time = frame_clock_get_predicted_render_time (frame_clock);
+  if (predicted_render_time > 0)
+    max_render_time_allowed = MIN (max_render_time_allowed,
+                                   predicted_render_time);
+
+  if (min_render_time_allowed > max_render_time_allowed)
+    min_render_time_allowed = max_render_time_allowed;
+
+  next_presentation_time = frame_clock->last_presentation_time + refresh_interval;
+
+  /* Get next_presentation_time closer to its final value, to reduce
+   * the number of while iterations below.
+   */
+  if (next_presentation_time < now)
+    {
+      int64_t last_virtual_presentation_time = now - now % refresh_interval;
+      int64_t hardware_clock_phase =
+        frame_clock->last_presentation_time % refresh_interval;
+
+      next_presentation_time =
+        last_virtual_presentation_time + hardware_clock_phase;
+    }
+
+  while (next_presentation_time < now + min_render_time_allowed)
+    next_presentation_time += refresh_interval;
+
+  frame_clock->update_time = next_presentation_time - max_render_time_allowed;
+
+  if (frame_clock->update_time == frame_clock->last_update_time)
+    {
+      frame_clock->update_time += refresh_interval;
+      next_presentation_time += refresh_interval;
+    }
+
+  frame_clock->next_presentation_time = next_presentation_time;
+}
+
+static void
+frame_clock_clear_update_time (ClutterStageCoglFrameClock *frame_clock)
+{
+  frame_clock->last_update_time = frame_clock->update_time;
+  frame_clock->update_time = -1;
+  frame_clock->next_presentation_time = -1;
+
+  if (frame_clock->sample_time > 0)
+    frame_clock->last_sample_time = frame_clock->sample_time;
+  frame_clock->sample_time = 0;
+}
+
+/* Whether the view driven by @frame_clock should be painted by an
+ * update happening at @now */
+static gboolean
+frame_clock_is_due (ClutterStageCoglFrameClock *frame_clock,
+                    gint64                      now)
 {
+  return frame_clock->pending_swaps == 0 &&
+         frame_clock->update_time != -1 &&
+         frame_clock->update_time <= now;
+}
 
+static void
+frame_clock_before_swap (ClutterStageCoglFrameClock *frame_clock,
+                         CoglFramebuffer            *framebuffer,
+                         gint64                      now)
+{
+  CoglContext *context;
+
+  frame_clock->cpu_time_before_swap = now;
+
+  frame_clock_clear_timestamp_query (frame_clock);
+  frame_clock->gpu_time_before_swap_ns = 0;
+
+  if (!framebuffer)
+    return;
+
+  context = cogl_framebuffer_get_context (framebuffer);
+  if (!cogl_has_feature (context, COGL_FEATURE_ID_TIMESTAMP_QUERY))
+    return;
+
+  /* The query is answered with the time the GPU is done with the frame,
+   * which can be compared with the time the GPU is at now that all the
+   * rendering of the frame has been submitted */
+  frame_clock->timestamp_query =
+    cogl_framebuffer_create_timestamp_query (framebuffer);
+  frame_clock->gpu_time_before_swap_ns = cogl_context_get_gpu_time_ns (context);
+}
+
+static void
+frame_clock_record_frame (ClutterStageCoglFrameClock *frame_clock,
+                          ClutterStageCogl           *stage_cogl,
+                          ClutterStageView           *view,
+                          gboolean                    has_presentation_time)
+{
+  int64_t render_time;
+
+  /* Views sharing an onscreen also get the feedback of frames they
+   * weren't painted in */
+  if (frame_clock->dispatch_time == 0 ||
+      frame_clock->cpu_time_before_swap == 0)
+    return;
+
+  render_time = frame_clock->cpu_time_before_swap - frame_clock->dispatch_time;
+
+  if (frame_clock->timestamp_query)
+    {
+      CoglContext *context =
+        clutter_backend_get_cogl_context (stage_cogl->backend);
+      int64_t rendering_done_ns;
+      int64_t swap_to_rendering_done;
+
+      rendering_done_ns =
+        cogl_context_timestamp_query_get_time_ns (context,
+                                                  frame_clock->timestamp_query);
+      swap_to_rendering_done =
+        (rendering_done_ns - frame_clock->gpu_time_before_swap_ns) / 1000;
+
+      /* The GPU clock can jump, e.g. when it is power managed */
+      if (swap_to_rendering_done > 0 &&
+          swap_to_rendering_done < G_USEC_PER_SEC)
+        render_time += swap_to_rendering_done;
+
+      frame_clock_clear_timestamp_query (frame_clock);
+    }
+
+  if (render_time >= 0)
+    frame_clock_record_render_time (frame_clock, render_time);
+
+  if (has_presentation_time)
+    {
+      int64_t latency;
+      int64_t refresh_interval;
+
+      latency = frame_clock->last_presentation_time - frame_clock->dispatch_time;
+
+      frame_clock->n_presented_frames++;
+      frame_clock->last_latency = latency;
+      frame_clock->total_latency += latency;
+
+      refresh_interval =
+        frame_clock_get_refresh_interval (frame_clock,
+                                          get_view_refresh_rate (view),
+                                          NULL);
+
+      if (frame_clock->target_presentation_time > 0 &&
+          frame_clock->last_presentation_time >
+          frame_clock->target_presentation_time + refresh_interval / 2)
+        {
+          frame_clock->n_missed_deadlines++;
+
+          CLUTTER_NOTE (BACKEND,
+                        "Frame presented %" G_GINT64_FORMAT "us late "
+                        "(render time: %" G_GINT64_FORMAT "us, "
+                        "latency: %" G_GINT64_FORMAT "us)",
+                        frame_clock->last_presentation_time -
+                        frame_clock->target_presentation_time,
+                        render_time, latency);
+        }
+    }
+
+  frame_clock->dispatch_time = 0;
+  frame_clock->target_presentation_time = 0;
+  frame_clock->cpu_time_before_swap = 0;
+}
+
+static void
+frame_clock_presented (ClutterStageCoglFrameClock *frame_clock,
+                       ClutterStageCogl           *stage_cogl,
+                       ClutterStageView           *view,
+                       CoglFrameEvent              frame_event,
+                       ClutterFrameInfo           *frame_info)
+{
   if (frame_event == COGL_FRAME_EVENT_SYNC)
     {
       /* Early versions of the swap_event implementation in Mesa
@@ -104,8 +451,8 @@ _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
        * FIXME: This issue can be hidden inside Cogl so we shouldn't
        * need to care about this bug here.
        */
-      if (stage_cogl->pending_swaps > 0)
-        stage_cogl->pending_swaps--;
+      if (frame_clock->pending_swaps > 0)
+        frame_clock->pending_swaps--;
     }
   else if (frame_event == COGL_FRAME_EVENT_COMPLETE)
     {
@@ -116,28 +463,140 @@ _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
           ClutterBackend *backend = stage_cogl->backend;
           CoglContext *context = clutter_backend_get_cogl_context (backend);
           gint64 current_time_cogl = cogl_get_clock_time (context);
-          gint64 now = g_get_monotonic_time ();
+          gint64 now = get_frame_clock_time (stage_cogl);
 
-          stage_cogl->last_presentation_time =
+          frame_clock->last_presentation_time =
             now + (presentation_time_cogl - current_time_cogl) / 1000;
         }
 
-      stage_cogl->refresh_rate = frame_info->refresh_rate;
+      frame_clock->refresh_rate = frame_info->refresh_rate;
+
+      frame_clock_record_frame (frame_clock, stage_cogl, view,
+                                presentation_time_cogl != 0);
     }
+}
 
-  _clutter_stage_presented (stage_cogl->wrapper, frame_event, frame_info);
+static void
+frame_clock_reschedule (ClutterStageCoglFrameClock *frame_clock,
+                        ClutterStageCogl           *stage_cogl,
+                        ClutterStageView           *view)
+{
+  if (frame_clock->update_time == -1)
+    return;
+
+  frame_clock->update_time = -1;
+  frame_clock_schedule_update (frame_clock,
+                               stage_cogl->last_sync_delay,
+                               get_view_refresh_rate (view),
+                               get_frame_clock_time (stage_cogl));
+}
+
+/*
+ * _clutter_stage_cogl_view_presented:
+ * @stage_cogl: a #ClutterStageCogl
+ * @view: (nullable): the #ClutterStageView that was presented, or %NULL
+ *   if the backend can't tell, in which case all views are affected
+ * @frame_event: the presentation event
+ * @frame_info: the presentation details
+ *
+ * Updates the frame clock of @view with the presentation feedback of its
+ * last frame. Must be called before _clutter_stage_cogl_presented().
+ */
+void
+_clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                    ClutterStageView *view,
+                                    CoglFrameEvent    frame_event,
+                                    ClutterFrameInfo *frame_info)
+{
+  ClutterStageWindow *stage_window = CLUTTER_STAGE_WINDOW (stage_cogl);
+  GList *views;
+  GList *l;
+
+  views = _clutter_stage_window_get_views (stage_window);
 
-  if (frame_event == COGL_FRAME_EVENT_COMPLETE &&
-      stage_cogl->update_time != -1)
+  if (view)
     {
-      ClutterStageWindow *stage_window = CLUTTER_STAGE_WINDOW (stage_cogl);
+      ClutterStageCoglFrameClock *frame_clock =
+        get_frame_clock (stage_cogl, view);
 
-      stage_cogl->update_time = -1;
-      clutter_stage_cogl_schedule_update (stage_window,
-                                          stage_cogl->last_sync_delay);
+      frame_clock_presented (frame_clock, stage_cogl, view,
+                             frame_event, frame_info);
+      if (frame_event == COGL_FRAME_EVENT_COMPLETE)
+        frame_clock_reschedule (frame_clock, stage_cogl, view);
+    }
+  else if (!views)
+    {
+      frame_clock_presented (&stage_cogl->frame_clock, stage_cogl, NULL,
+                             frame_event, frame_info);
+      if (frame_event == COGL_FRAME_EVENT_COMPLETE)
+        frame_clock_reschedule (&stage_cogl->frame_clock, stage_cogl, NULL);
+    }
+  else
+    {
+      for (l = views; l; l = l->next)
+        {
+          ClutterStageView *stage_view = l->data;
+          ClutterStageCoglFrameClock *frame_clock =
+            get_frame_clock (stage_cogl, stage_view);
+
+          frame_clock_presented (frame_clock, stage_cogl, stage_view,
+                                 frame_event, frame_info);
+          if (frame_event == COGL_FRAME_EVENT_COMPLETE)
+            frame_clock_reschedule (frame_clock, stage_cogl, stage_view);
+        }
     }
 }
 
+/*
+ * _clutter_stage_cogl_view_presented_at:
+ * @stage_cogl: a #ClutterStageCogl
+ * @view: the #ClutterStageView that was presented
+ * @presentation_time_us: the time the frame was presented at, in the
+ *   time base of the frame clocks
+ *
+ * Completes the frame of @view as if its presentation feedback had
+ * arrived, so that tests can drive frame clocks with known timestamps.
+ */
+void
+_clutter_stage_cogl_view_presented_at (ClutterStageCogl *stage_cogl,
+                                       ClutterStageView *view,
+                                       int64_t           presentation_time_us)
+{
+  ClutterStageCoglFrameClock *frame_clock = get_frame_clock (stage_cogl, view);
+
+  if (frame_clock->pending_swaps > 0)
+    frame_clock->pending_swaps--;
+
+  frame_clock->last_presentation_time = presentation_time_us;
+  frame_clock->refresh_rate = get_view_refresh_rate (view);
+
+  frame_clock_record_frame (frame_clock, stage_cogl, view, TRUE);
+  frame_clock_reschedule (frame_clock, stage_cogl, view);
+}
+
+/*
+ * _clutter_stage_cogl_set_frame_clock_time:
+ * @stage_cogl: a #ClutterStageCogl
+ * @time_us: the time, or 0 to go back to the monotonic clock
+ *
+ * Makes the frame clocks of @stage_cogl take @time_us as the current
+ * time when scheduling, dispatching and completing frames, for tests.
+ */
+void
+_clutter_stage_cogl_set_frame_clock_time (ClutterStageCogl *stage_cogl,
+                                          int64_t           time_us)
+{
+  stage_cogl->frame_clock_time = time_us;
+}
+
+void
+_clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
+                               CoglFrameEvent    frame_event,
+                               ClutterFrameInfo *frame_info)
+{
+  _clutter_stage_presented (stage_cogl->wrapper, frame_event, frame_info);
+}
+
 static gboolean
 clutter_stage_cogl_realize (ClutterStageWindow *stage_window)
 {
@@ -163,124 +622,239 @@ clutter_stage_cogl_schedule_update (ClutterStageWindow *stage_window,
                                     gint                sync_delay)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-  gint64 now;
-  float refresh_rate;
-  gint64 refresh_interval;
-  int64_t min_render_time_allowed;
-  int64_t max_render_time_allowed;
-  int64_t next_presentation_time;
-
-  if (stage_cogl->update_time != -1)
-    return;
+  gint64 now = get_frame_clock_time (stage_cogl);
+  GList *views;
+  GList *l;
 
   stage_cogl->last_sync_delay = sync_delay;
 
-  now = g_get_monotonic_time ();
-
-  if (sync_delay < 0)
+  views = _clutter_stage_window_get_views (stage_window);
+  if (!views)
     {
-      stage_cogl->update_time = now;
+      frame_clock_schedule_update (&stage_cogl->frame_clock, sync_delay, 0.0,
+                                   now);
       return;
     }
 
-  refresh_rate = stage_cogl->refresh_rate;
-  if (refresh_rate <= 0.0)
-    refresh_rate = clutter_get_default_frame_rate ();
+  /* Each view is updated in sync with its own monitor, so that views
+   * with different refresh rates are all painted at their own pace */
+  for (l = views; l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
 
-  refresh_interval = (gint64) (0.5 + G_USEC_PER_SEC / refresh_rate);
-  if (refresh_interval == 0)
+      frame_clock_schedule_update (get_frame_clock (stage_cogl, view),
+                                   sync_delay,
+                                   get_view_refresh_rate (view),
+                                   now);
+    }
+}
+
+static gint64
+clutter_stage_cogl_get_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gint64 update_time = -1;
+  GList *views;
+  GList *l;
+
+  views = _clutter_stage_window_get_views (stage_window);
+  if (!views)
     {
-      stage_cogl->update_time = now;
-      return;
+      if (stage_cogl->frame_clock.pending_swaps)
+        return -1; /* in the future, indefinite */
+
+      return stage_cogl->frame_clock.update_time;
     }
 
-  min_render_time_allowed = refresh_interval / 2;
-  max_render_time_allowed = refresh_interval - 1000 * sync_delay;
+  /* The stage needs to be updated as soon as any of its views does;
+   * views waiting for a swap to complete are not ready in any case */
+  for (l = views; l; l = l->next)
+    {
+      ClutterStageCoglFrameClock *frame_clock =
+        get_frame_clock (stage_cogl, l->data);
 
-  /* Be robust in the case of incredibly bogus refresh rate */
-  if (max_render_time_allowed <= 0)
+      if (frame_clock->pending_swaps || frame_clock->update_time == -1)
+        continue;
+
+      if (update_time == -1 || frame_clock->update_time < update_time)
+        update_time = frame_clock->update_time;
+    }
+
+  return update_time;
+}
+
+static void
+clutter_stage_cogl_clear_update_time (ClutterStageWindow *stage_window)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  gint64 now = get_frame_clock_time (stage_cogl);
+  GList *views;
+  GList *l;
+
+  views = _clutter_stage_window_get_views (stage_window);
+  if (!views)
     {
-      g_warning ("Unsupported monitor refresh rate detected. "
-                 "(Refresh rate: %.3f, refresh interval: %" G_GINT64_FORMAT ")",
-                 refresh_rate,
-                 refresh_interval);
-      stage_cogl->update_time = now;
+      frame_clock_clear_update_time (&stage_cogl->frame_clock);
       return;
     }
 
-  if (min_render_time_allowed > max_render_time_allowed)
-    min_render_time_allowed = max_render_time_allowed;
+  /* Views that weren't due yet keep their update time; so do views
+   * that became due after the redraw but still have something to
+   * paint, so that they are painted right away on the next update */
+  for (l = views; l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      ClutterStageCoglFrameClock *frame_clock =
+        get_frame_clock (stage_cogl, view);
 
-  next_presentation_time = stage_cogl->last_presentation_time + refresh_interval;
+      if (!frame_clock_is_due (frame_clock, now))
+        continue;
 
-  /* Get next_presentation_time closer to its final value, to reduce
-   * the number of while iterations below.
-   */
-  if (next_presentation_time < now)
-    {
-      int64_t last_virtual_presentation_time = now - now % refresh_interval;
-      int64_t hardware_clock_phase =
-        stage_cogl->last_presentation_time % refresh_interval;
+      if (clutter_stage_view_has_redraw_clip (view))
+        continue;
 
-      next_presentation_time =
-        last_virtual_presentation_time + hardware_clock_phase;
+      frame_clock_clear_update_time (frame_clock);
     }
+}
 
-  while (next_presentation_time < now + min_render_time_allowed)
-    next_presentation_time += refresh_interval;
+static void
+frame_clock_skip_missed_frames (ClutterStageCoglFrameClock *frame_clock,
+                                ClutterStageView           *view,
+                                gint64                      now)
+{
+  gint64 refresh_interval;
+  gint64 missed_time;
+
+  if (frame_clock->next_presentation_time <= 0 ||
+      frame_clock->next_presentation_time > now)
+    return;
+
+  missed_time = now - frame_clock->next_presentation_time;
 
-  stage_cogl->update_time = next_presentation_time - max_render_time_allowed;
+  CLUTTER_NOTE (BACKEND,
+                "Missed some frames. Something blocked for over "
+                "%" G_GINT64_FORMAT "ms.",
+                missed_time / 1000);
 
-  if (stage_cogl->update_time == stage_cogl->last_update_time)
+  /* Move on to the next vblank of the view without touching its update
+   * time, so that a view already due is still painted by this update */
+  refresh_interval =
+    frame_clock_get_refresh_interval (frame_clock,
+                                      get_view_refresh_rate (view),
+                                      NULL);
+  if (refresh_interval <= 0)
     {
-      stage_cogl->update_time += refresh_interval;
-      next_presentation_time += refresh_interval;
+      frame_clock->next_presentation_time = now;
+      return;
     }
 
-  stage_cogl->next_presentation_time = next_presentation_time;
+  frame_clock->next_presentation_time +=
+    (missed_time / refresh_interval + 1) * refresh_interval;
 }
 
-static gint64
-clutter_stage_cogl_get_update_time (ClutterStageWindow *stage_window)
+/*
+ * Both the dispatch of updates and the presentation feedback the
+ * prediction is based on are subject to jitter, while frames end up on
+ * the screen on a steady grid of vblanks. Keep the time animations are
+ * sampled at on the grid of the previous samples, so that they advance
+ * in even steps, and only let the prediction slowly pull it back in
+ * phase with the hardware.
+ */
+static int64_t
+frame_clock_update_sample_time (ClutterStageCoglFrameClock *frame_clock,
+                                ClutterStageView           *view)
 {
-  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-
-  if (stage_cogl->pending_swaps)
-    return -1; /* in the future, indefinite */
-
-  return stage_cogl->update_time;
+  int64_t predicted_time = frame_clock->next_presentation_time;
+  int64_t last_sample_time = frame_clock->last_sample_time;
+  int64_t refresh_interval;
+  int64_t n_intervals;
+  int64_t grid_time;
+  int64_t error;
+
+  if (predicted_time <= 0)
+    return predicted_time;
+
+  refresh_interval =
+    frame_clock_get_refresh_interval (frame_clock,
+                                      get_view_refresh_rate (view),
+                                      NULL);
+
+  frame_clock->sample_time = predicted_time;
+
+  if (refresh_interval <= 0 || last_sample_time <= 0 ||
+      predicted_time <= last_sample_time)
+    return frame_clock->sample_time;
+
+  n_intervals = (predicted_time - last_sample_time + refresh_interval / 2) /
+                refresh_interval;
+  grid_time = last_sample_time + n_intervals * refresh_interval;
+  error = predicted_time - grid_time;
+
+  /* A prediction too far off the grid means the phase of the monitor
+   * really changed, e.g. after a mode set; follow it right away */
+  if (n_intervals >= 1 && ABS (error) < refresh_interval / 4)
+    frame_clock->sample_time = grid_time + error / 8;
+
+  return frame_clock->sample_time;
 }
 
 static void
-clutter_stage_cogl_clear_update_time (ClutterStageWindow *stage_window)
+frame_clock_dispatch (ClutterStageCoglFrameClock *frame_clock,
+                      gint64                      now)
 {
-  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-
-  stage_cogl->last_update_time = stage_cogl->update_time;
-  stage_cogl->update_time = -1;
-  stage_cogl->next_presentation_time = -1;
+  frame_clock->dispatch_time = now;
+  frame_clock->target_presentation_time = frame_clock->next_presentation_time;
 }
 
 static int64_t
 clutter_stage_cogl_get_next_presentation_time (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
-  int64_t now = g_get_monotonic_time ();
+  int64_t now = get_frame_clock_time (stage_cogl);
+  int64_t earliest_due = -1;
+  int64_t earliest = -1;
+  GList *views;
+  GList *l;
+
+  views = _clutter_stage_window_get_views (stage_window);
+  if (!views)
+    {
+      frame_clock_skip_missed_frames (&stage_cogl->frame_clock, NULL, now);
+      if (frame_clock_is_due (&stage_cogl->frame_clock, now))
+        frame_clock_dispatch (&stage_cogl->frame_clock, now);
+
+      return frame_clock_update_sample_time (&stage_cogl->frame_clock, NULL);
+    }
 
-  if (stage_cogl->next_presentation_time > 0 &&
-      stage_cogl->next_presentation_time <= now)
+  /* Prefer the presentation time of the views this update is going to
+   * paint; other views are only painted by later updates */
+  for (l = views; l; l = l->next)
     {
-      CLUTTER_NOTE (BACKEND,
-                    "Missed some frames. Something blocked for over "
-                    "%" G_GINT64_FORMAT "ms.",
-                    (now - stage_cogl->next_presentation_time) / 1000);
+      ClutterStageView *view = l->data;
+      ClutterStageCoglFrameClock *frame_clock =
+        get_frame_clock (stage_cogl, view);
+      int64_t next_presentation_time;
+
+      frame_clock_skip_missed_frames (frame_clock, view, now);
+
+      next_presentation_time =
+        frame_clock_update_sample_time (frame_clock, view);
+      if (next_presentation_time <= 0)
+        continue;
 
-      stage_cogl->update_time = -1;
-      clutter_stage_cogl_schedule_update (stage_window,
-                                          stage_cogl->last_sync_delay);
+      if (earliest == -1 || next_presentation_time < earliest)
+        earliest = next_presentation_time;
+
+      if (!frame_clock_is_due (frame_clock, now))
+        continue;
+
+      frame_clock_dispatch (frame_clock, now);
+
+      if (earliest_due == -1 || next_presentation_time < earliest_due)
+        earliest_due = next_presentation_time;
     }
 
-  return stage_cogl->next_presentation_time;
+  return earliest_due != -1 ? earliest_due : earliest;
 }
 
 static ClutterActor *
@@ -389,6 +963,7 @@ swap_framebuffer (ClutterStageWindow *stage_window,
                   cairo_region_t     *swap_region,
                   gboolean            swap_with_damage)
 {
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
   CoglFramebuffer *framebuffer = clutter_stage_view_get_onscreen (view);
   clutter_stage_view_before_swap_buffer (view, swap_region);
 
@@ -397,6 +972,10 @@ swap_framebuffer (ClutterStageWindow *stage_window,
       CoglOnscreen *onscreen = COGL_ONSCREEN (framebuffer);
       int *damage, n_rects, i;
 
+      frame_clock_before_swap (get_frame_clock (stage_cogl, view),
+                               framebuffer,
+                               get_frame_clock_time (stage_cogl));
+
       n_rects = cairo_region_num_rectangles (swap_region);
       damage = g_newa (int, n_rects * 4);
       for (i = 0; i < n_rects; i++)
@@ -812,11 +1391,15 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 {
   ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (stage_window);
   gboolean has_redraw_clip = FALSE;
-  gboolean swap_event = FALSE;
+  gboolean has_swap_events;
+  gint64 now;
   GList *l;
 
   COGL_TRACE_BEGIN (ClutterStageCoglRedraw, "Paint (Cogl Redraw)");
 
+  has_swap_events = clutter_feature_available (CLUTTER_FEATURE_SWAP_EVENTS);
+  now = get_frame_clock_time (stage_cogl);
+
   for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
     {
       ClutterStageView *view = l->data;
@@ -824,6 +1407,9 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
       if (!clutter_stage_view_has_redraw_clip (view))
         continue;
 
+      if (!frame_clock_is_due (get_frame_clock (stage_cogl, view), now))
+        continue;
+
       has_redraw_clip = TRUE;
       break;
     }
@@ -834,14 +1420,28 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   for (l = _clutter_stage_window_get_views (stage_window); l; l = l->next)
     {
       ClutterStageView *view = l->data;
+      ClutterStageCoglFrameClock *frame_clock =
+        get_frame_clock (stage_cogl, view);
       g_autoptr (CoglScanout) scanout = NULL;
+      gboolean swap_event;
 
       if (!clutter_stage_view_has_redraw_clip (view))
         continue;
 
+      /* Views whose monitor isn't ready for a new frame yet keep their
+       * redraw clip until their own frame clock is due */
+      if (!frame_clock_is_due (frame_clock, now))
+        continue;
+
       scanout = clutter_stage_view_take_scanout (view);
       if (scanout)
         {
+          cairo_region_t *redraw_clip;
+
+          redraw_clip = clutter_stage_view_take_redraw_clip (view);
+          g_clear_pointer (&redraw_clip, cairo_region_destroy);
+
+          frame_clock_before_swap (frame_clock, NULL, now);
           clutter_stage_cogl_scanout_view (stage_cogl,
                                            view,
                                            scanout);
@@ -849,8 +1449,14 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
         }
       else
         {
-          swap_event |= clutter_stage_cogl_redraw_view (stage_window, view);
+          swap_event = clutter_stage_cogl_redraw_view (stage_window, view);
         }
+
+      /* If we have swap buffer events then cogl_onscreen_swap_buffers
+       * will return immediately and we need to track that there is a
+       * swap in progress... */
+      if (swap_event && has_swap_events)
+        frame_clock->pending_swaps++;
     }
 
   if (has_redraw_clip)
@@ -858,15 +1464,6 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   _clutter_stage_window_finish_frame (stage_window);
 
-  if (swap_event)
-    {
-      /* If we have swap buffer events then cogl_onscreen_swap_buffers
-       * will return immediately and we need to track that there is a
-       * swap in progress... */
-      if (clutter_feature_available (CLUTTER_FEATURE_SWAP_EVENTS))
-        stage_cogl->pending_swaps++;
-    }
-
   stage_cogl->frame_count++;
 
   COGL_TRACE_END (ClutterStageCoglRedraw);
@@ -912,12 +1509,23 @@ clutter_stage_cogl_set_property (GObject      *gobject,
     }
 }
 
+static void
+clutter_stage_cogl_finalize (GObject *gobject)
+{
+  ClutterStageCogl *stage_cogl = CLUTTER_STAGE_COGL (gobject);
+
+  frame_clock_clear (&stage_cogl->frame_clock);
+
+  G_OBJECT_CLASS (_clutter_stage_cogl_parent_class)->finalize (gobject);
+}
+
 static void
 _clutter_stage_cogl_class_init (ClutterStageCoglClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 
   gobject_class->set_property = clutter_stage_cogl_set_property;
+  gobject_class->finalize = clutter_stage_cogl_finalize;
 
   g_object_class_override_property (gobject_class, PROP_WRAPPER, "wrapper");
   g_object_class_override_property (gobject_class, PROP_BACKEND, "backend");
@@ -926,11 +1534,7 @@ _clutter_stage_cogl_class_init (ClutterStageCoglClass *klass)
 static void
 _clutter_stage_cogl_init (ClutterStageCogl *stage)
 {
-  stage->last_presentation_time = 0;
-  stage->refresh_rate = 0.0;
-
-  stage->update_time = -1;
-  stage->next_presentation_time = -1;
+  frame_clock_init (&stage->frame_clock);
 }
 
 static void
@@ -941,6 +1545,7 @@ clutter_stage_view_cogl_finalize (GObject *object)
   clutter_stage_view_cogl_get_instance_private (view_cogl);
 
   clutter_damage_history_free (view_priv->damage_history);
+  frame_clock_clear (&view_priv->frame_clock);
 
   G_OBJECT_CLASS (clutter_stage_view_cogl_parent_class)->finalize (object);
 }
@@ -952,6 +1557,7 @@ clutter_stage_view_cogl_init (ClutterStageViewCogl *view_cogl)
   clutter_stage_view_cogl_get_instance_private (view_cogl);
 
   view_priv->damage_history = clutter_damage_history_new ();
+  frame_clock_init (&view_priv->frame_clock);
 }
 
 static void
@@ -961,3 +1567,51 @@ clutter_stage_view_cogl_class_init (ClutterStageViewCoglClass *klass)
 
   object_class->finalize = clutter_stage_view_cogl_finalize;
 }
+
+/*
+ * clutter_stage_view_cogl_get_next_presentation_time:
+ * @view_cogl: a #ClutterStageViewCogl
+ *
+ * Returns: the time the next frame of @view_cogl is expected to be
+ *   presented at, in microseconds, or -1 if no frame is scheduled
+ */
+int64_t
+clutter_stage_view_cogl_get_next_presentation_time (ClutterStageViewCogl *view_cogl)
+{
+  ClutterStageViewCoglPrivate *view_priv;
+
+  g_return_val_if_fail (CLUTTER_IS_STAGE_VIEW_COGL (view_cogl), -1);
+
+  view_priv = clutter_stage_view_cogl_get_instance_private (view_cogl);
+
+  return view_priv->frame_clock.next_presentation_time;
+}
+
+/**
+ * clutter_stage_view_cogl_get_frame_stats:
+ * @view_cogl: a #ClutterStageViewCogl
+ * @stats: (out caller-allocates): return location for the statistics
+ *
+ * Retrieves statistics about the latency of the frames of @view_cogl
+ * and the deadlines they missed, for monitoring purposes.
+ */
+void
+clutter_stage_view_cogl_get_frame_stats (ClutterStageViewCogl           *view_cogl,
+                                         ClutterStageViewCoglFrameStats *stats)
+{
+  ClutterStageViewCoglPrivate *view_priv;
+  ClutterStageCoglFrameClock *frame_clock;
+
+  g_return_if_fail (CLUTTER_IS_STAGE_VIEW_COGL (view_cogl));
+
+  view_priv = clutter_stage_view_cogl_get_instance_private (view_cogl);
+  frame_clock = &view_priv->frame_clock;
+
+  stats->n_presented_frames = frame_clock->n_presented_frames;
+  stats->n_missed_deadlines = frame_clock->n_missed_deadlines;
+  stats->last_latency_us = frame_clock->last_latency;
+  stats->mean_latency_us = frame_clock->n_presented_frames > 0 ?
+    frame_clock->total_latency / (int64_t) frame_clock->n_presented_frames : 0;
+  stats->predicted_render_time_us =
+    frame_clock_get_predicted_render_time (frame_clock);
+}
@@ -32,6 +32,71 @@ struct _ClutterStageViewCoglClass
   ClutterStageViewClass parent_class;
 };
 
+/*
+ * ClutterStageCoglFrameClock:
+ *
+ * The presentation timing of a stage view, used to schedule its
+ * redraws independently of the other views of the stage, which might
+ * be presented at a different refresh rate.
+ */
+#define CLUTTER_STAGE_COGL_RENDER_TIME_HISTORY 16
+
+typedef struct _ClutterStageCoglFrameClock
+{
+  float refresh_rate;
+  int pending_swaps;
+
+  gint64 last_presentation_time;
+  gint64 update_time;
+  int64_t last_update_time;
+  int64_t next_presentation_time;
+
+  /* the time animations are sampled at for the frame being built, and
+   * for the last frame that was painted */
+  int64_t sample_time;
+  int64_t last_sample_time;
+
+  /* the timings of the frame waiting to be presented, from the dispatch
+   * of the update painting it to the completion of its rendering */
+  int64_t dispatch_time;
+  int64_t target_presentation_time;
+  int64_t cpu_time_before_swap;
+  int64_t gpu_time_before_swap_ns;
+  CoglTimestampQuery *timestamp_query;
+
+  /* the time it took to render the most recent frames, in a ring */
+  int64_t render_times[CLUTTER_STAGE_COGL_RENDER_TIME_HISTORY];
+  int render_time_index;
+  int n_render_times;
+
+  uint64_t n_presented_frames;
+  uint64_t n_missed_deadlines;
+  int64_t last_latency;
+  int64_t total_latency;
+} ClutterStageCoglFrameClock;
+
+/**
+ * ClutterStageViewCoglFrameStats:
+ * @n_presented_frames: the number of frames presented with a timestamp
+ * @n_missed_deadlines: the number of those frames that were presented
+ *   after the vblank they were painted for
+ * @last_latency_us: the time from the start of the update painting the
+ *   last frame to its presentation, in microseconds
+ * @mean_latency_us: the mean of that time over all presented frames
+ * @predicted_render_time_us: the time updates are currently expected to
+ *   take, including a safety margin, or 0 if it isn't known yet
+ *
+ * Statistics about the presentation of the frames of a stage view.
+ */
+typedef struct _ClutterStageViewCoglFrameStats
+{
+  uint64_t n_presented_frames;
+  uint64_t n_missed_deadlines;
+  int64_t last_latency_us;
+  int64_t mean_latency_us;
+  int64_t predicted_render_time_us;
+} ClutterStageViewCoglFrameStats;
+
 struct _ClutterStageCogl
 {
   GObject parent_instance;
@@ -42,13 +107,8 @@ struct _ClutterStageCogl
   /* back pointer to the backend */
   ClutterBackend *backend;
 
-  float refresh_rate;
-  int pending_swaps;
-
-  gint64 last_presentation_time;
-  gint64 update_time;
-  int64_t last_update_time;
-  int64_t next_presentation_time;
+  /* used when the stage has no views */
+  ClutterStageCoglFrameClock frame_clock;
 
   /* We only enable clipped redraws after 2 frames, since we've seen
    * a lot of drivers can struggle to get going and may output some
@@ -56,6 +116,9 @@ struct _ClutterStageCogl
   unsigned int frame_count;
 
   gint last_sync_delay;
+
+  /* the time frame clocks run on instead of the monotonic clock, if not 0 */
+  int64_t frame_clock_time;
 };
 
 struct _ClutterStageCoglClass
@@ -71,6 +134,28 @@ void _clutter_stage_cogl_presented (ClutterStageCogl *stage_cogl,
                                     CoglFrameEvent    frame_event,
                                     ClutterFrameInfo *frame_info);
 
+CLUTTER_EXPORT
+void _clutter_stage_cogl_view_presented (ClutterStageCogl *stage_cogl,
+                                         ClutterStageView *view,
+                                         CoglFrameEvent    frame_event,
+                                         ClutterFrameInfo *frame_info);
+
+CLUTTER_EXPORT
+void _clutter_stage_cogl_view_presented_at (ClutterStageCogl *stage_cogl,
+                                            ClutterStageView *view,
+                                            int64_t           presentation_time_us);
+
+CLUTTER_EXPORT
+void _clutter_stage_cogl_set_frame_clock_time (ClutterStageCogl *stage_cogl,
+                                               int64_t           time_us);
+
+CLUTTER_EXPORT
+int64_t clutter_stage_view_cogl_get_next_presentation_time (ClutterStageViewCogl *view_cogl);
+
+CLUTTER_EXPORT
+void clutter_stage_view_cogl_get_frame_stats (ClutterStageViewCogl           *view_cogl,
+                                              ClutterStageViewCoglFrameStats *stats);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_STAGE_COGL_H__ */
@@ -63,6 +63,11 @@ typedef struct
   GLubyte c[4];
 } CoglTextureGLVertex;
 
+struct _CoglTimestampQuery
+{
+  unsigned int id;
+};
+
 struct _CoglContext
 {
   CoglObject _parent;
@@ -593,6 +593,36 @@ cogl_get_clock_time (CoglContext *context)
     return 0;
 }
 
+int64_t
+cogl_context_get_gpu_time_ns (CoglContext *context)
+{
+  const CoglDriverVtable *driver = context->driver_vtable;
+
+  g_return_val_if_fail (cogl_has_feature (context,
+                                          COGL_FEATURE_ID_TIMESTAMP_QUERY),
+                        0);
+
+  return driver->get_gpu_time_ns (context);
+}
+
+int64_t
+cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
+                                          CoglTimestampQuery *query)
+{
+  const CoglDriverVtable *driver = context->driver_vtable;
+
+  return driver->timestamp_query_get_time_ns (context, query);
+}
+
+void
+cogl_context_free_timestamp_query (CoglContext        *context,
+                                   CoglTimestampQuery *query)
+{
+  const CoglDriverVtable *driver = context->driver_vtable;
+
+  driver->free_timestamp_query (context, query);
+}
+
 CoglGraphicsResetStatus
 cogl_get_graphics_reset_status (CoglContext *context)
 {
@@ -195,6 +195,9 @@ cogl_is_context (void *object);
  *    time stamps will be recorded in #CoglFrameInfo objects.
  * @COGL_FEATURE_ID_BLIT_FRAMEBUFFER: Whether blitting using
  *    cogl_blit_framebuffer() is supported.
+ * @COGL_FEATURE_ID_TIMESTAMP_QUERY: Whether GPU timestamps can be
+ *    queried using cogl_framebuffer_create_timestamp_query() and
+ *    cogl_context_get_gpu_time_ns().
  *
  * All the capabilities that can vary between different GPUs supported
  * by Cogl. Applications that depend on any of these features should explicitly
@@ -214,6 +217,7 @@ typedef enum _CoglFeatureID
   COGL_FEATURE_ID_BUFFER_AGE,
   COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL,
   COGL_FEATURE_ID_BLIT_FRAMEBUFFER,
+  COGL_FEATURE_ID_TIMESTAMP_QUERY,
 
   /*< private >*/
   _COGL_N_FEATURE_IDS   /*< skip >*/
@@ -357,6 +361,47 @@ typedef enum _CoglGraphicsResetStatus
 COGL_EXPORT CoglGraphicsResetStatus
 cogl_get_graphics_reset_status (CoglContext *context);
 
+/**
+ * cogl_context_get_gpu_time_ns:
+ * @context: a #CoglContext pointer
+ *
+ * Queries the current time of the GPU clock, without waiting for the
+ * rendering that was already submitted to complete. Only supported if
+ * the %COGL_FEATURE_ID_TIMESTAMP_QUERY feature is available.
+ *
+ * Return value: the GPU time, in nanoseconds
+ */
+COGL_EXPORT int64_t
+cogl_context_get_gpu_time_ns (CoglContext *context);
+
+/**
+ * cogl_context_timestamp_query_get_time_ns:
+ * @context: a #CoglContext pointer
+ * @query: a #CoglTimestampQuery
+ *
+ * Retrieves the GPU time at which the rendering submitted before
+ * @query was created completed. This blocks until that rendering is
+ * done, so it is meant to be called once the frame @query was created
+ * for has been presented.
+ *
+ * Return value: the GPU time, in nanoseconds, comparable to the values
+ *   returned by cogl_context_get_gpu_time_ns()
+ */
+COGL_EXPORT int64_t
+cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
+                                          CoglTimestampQuery *query);
+
+/**
+ * cogl_context_free_timestamp_query:
+ * @context: a #CoglContext pointer
+ * @query: (transfer full): a #CoglTimestampQuery
+ *
+ * Frees a query created with cogl_framebuffer_create_timestamp_query().
+ */
+COGL_EXPORT void
+cogl_context_free_timestamp_query (CoglContext        *context,
+                                   CoglTimestampQuery *query);
+
 G_END_DECLS
 
 #endif /* __COGL_CONTEXT_H__ */
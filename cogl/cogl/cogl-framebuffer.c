@@ -1407,6 +1407,22 @@ cogl_framebuffer_flush (CoglFramebuffer *framebuffer)
   ctx->driver_vtable->framebuffer_flush (framebuffer);
 }
 
+CoglTimestampQuery *
+cogl_framebuffer_create_timestamp_query (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = framebuffer->context;
+
+  g_return_val_if_fail (cogl_has_feature (ctx,
+                                          COGL_FEATURE_ID_TIMESTAMP_QUERY),
+                        NULL);
+
+  /* The query has to follow the rendering batched in the journal in
+   * the command stream for it to measure its completion */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  return ctx->driver_vtable->create_timestamp_query (ctx);
+}
+
 void
 cogl_framebuffer_push_matrix (CoglFramebuffer *framebuffer)
 {
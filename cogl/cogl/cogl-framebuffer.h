@@ -1568,6 +1568,21 @@ cogl_blit_framebuffer (CoglFramebuffer *src,
 void
 cogl_framebuffer_flush (CoglFramebuffer *framebuffer);
 
+/**
+ * cogl_framebuffer_create_timestamp_query:
+ * @framebuffer: A #CoglFramebuffer pointer
+ *
+ * Submits the batched rendering of @framebuffer to the GPU and creates
+ * a query for the GPU time at which that rendering completes, see
+ * cogl_context_timestamp_query_get_time_ns(). Only supported if the
+ * %COGL_FEATURE_ID_TIMESTAMP_QUERY feature is available.
+ *
+ * Return value: (transfer full): a new #CoglTimestampQuery, to be freed
+ *   with cogl_context_free_timestamp_query()
+ */
+COGL_EXPORT CoglTimestampQuery *
+cogl_framebuffer_create_timestamp_query (CoglFramebuffer *framebuffer);
+
 G_END_DECLS
 
 #endif /* __COGL_FRAMEBUFFER_H */
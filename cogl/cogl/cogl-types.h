@@ -113,6 +113,15 @@ typedef struct _CoglTextureVertex       CoglTextureVertex;
  */
 typedef struct _CoglDmaBufHandle CoglDmaBufHandle;
 
+/**
+ * CoglTimestampQuery: (skip)
+ *
+ * An opaque type for a pending query of the time at which the GPU
+ * completed some rendering. Release with
+ * cogl_context_free_timestamp_query().
+ */
+typedef struct _CoglTimestampQuery CoglTimestampQuery;
+
 /* Enum declarations */
 
 #define COGL_A_BIT              (1 << 4)
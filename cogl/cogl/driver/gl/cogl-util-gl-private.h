@@ -82,6 +82,20 @@ _cogl_driver_gl_context_init (CoglContext *context);
 void
 _cogl_driver_gl_context_deinit (CoglContext *context);
 
+CoglTimestampQuery *
+_cogl_driver_gl_create_timestamp_query (CoglContext *context);
+
+void
+_cogl_driver_gl_free_timestamp_query (CoglContext        *context,
+                                      CoglTimestampQuery *query);
+
+int64_t
+_cogl_driver_gl_timestamp_query_get_time_ns (CoglContext        *context,
+                                             CoglTimestampQuery *query);
+
+int64_t
+_cogl_driver_gl_get_gpu_time_ns (CoglContext *context);
+
 GLenum
 _cogl_gl_util_get_error (CoglContext *ctx);
 
@@ -37,6 +37,15 @@
 #include "driver/gl/cogl-pipeline-opengl-private.h"
 #include "driver/gl/cogl-util-gl-private.h"
 
+/* These aren't defined in the GLES headers */
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+
 #ifdef COGL_GL_DEBUG
 /* GL error to string conversion */
 static const struct {
@@ -95,6 +104,50 @@ _cogl_driver_gl_context_deinit (CoglContext *context)
   _cogl_destroy_texture_units (context);
 }
 
+CoglTimestampQuery *
+_cogl_driver_gl_create_timestamp_query (CoglContext *context)
+{
+  CoglTimestampQuery *query;
+
+  query = g_new0 (CoglTimestampQuery, 1);
+
+  GE (context, glGenQueries (1, &query->id));
+  GE (context, glQueryCounter (query->id, GL_TIMESTAMP));
+
+  return query;
+}
+
+void
+_cogl_driver_gl_free_timestamp_query (CoglContext        *context,
+                                      CoglTimestampQuery *query)
+{
+  GE (context, glDeleteQueries (1, &query->id));
+  g_free (query);
+}
+
+int64_t
+_cogl_driver_gl_timestamp_query_get_time_ns (CoglContext        *context,
+                                             CoglTimestampQuery *query)
+{
+  uint64_t query_time_ns = 0;
+
+  GE (context, glGetQueryObjectui64v (query->id,
+                                      GL_QUERY_RESULT,
+                                      &query_time_ns));
+
+  return (int64_t) query_time_ns;
+}
+
+int64_t
+_cogl_driver_gl_get_gpu_time_ns (CoglContext *context)
+{
+  int64_t gpu_time_ns = 0;
+
+  GE (context, glGetInteger64v (GL_TIMESTAMP, &gpu_time_ns));
+
+  return gpu_time_ns;
+}
+
 GLenum
 _cogl_gl_util_get_error (CoglContext *ctx)
 {
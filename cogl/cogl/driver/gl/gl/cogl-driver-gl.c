@@ -523,6 +523,9 @@ _cogl_driver_update_features (CoglContext *ctx,
   if (ctx->glFenceSync)
     COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_FENCE, TRUE);
 
+  if (ctx->glQueryCounter)
+    COGL_FLAGS_SET (ctx->features, COGL_FEATURE_ID_TIMESTAMP_QUERY, TRUE);
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 0) ||
       _cogl_check_extension ("GL_ARB_texture_rg", gl_extensions))
     COGL_FLAGS_SET (ctx->features,
@@ -593,4 +596,8 @@ _cogl_driver_gl =
     _cogl_buffer_gl_map_range,
     _cogl_buffer_gl_unmap,
     _cogl_buffer_gl_set_data,
+    _cogl_driver_gl_create_timestamp_query,
+    _cogl_driver_gl_free_timestamp_query,
+    _cogl_driver_gl_timestamp_query_get_time_ns,
+    _cogl_driver_gl_get_gpu_time_ns,
   };
@@ -426,6 +426,9 @@ _cogl_driver_update_features (CoglContext *context,
     COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_FENCE, TRUE);
 #endif
 
+  if (context->glQueryCounter)
+    COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_TIMESTAMP_QUERY, TRUE);
+
   if (_cogl_check_extension ("GL_EXT_texture_rg", gl_extensions))
     COGL_FLAGS_SET (context->features,
                     COGL_FEATURE_ID_TEXTURE_RG,
@@ -482,4 +485,8 @@ _cogl_driver_gles =
     _cogl_buffer_gl_map_range,
     _cogl_buffer_gl_unmap,
     _cogl_buffer_gl_set_data,
+    _cogl_driver_gl_create_timestamp_query,
+    _cogl_driver_gl_free_timestamp_query,
+    _cogl_driver_gl_timestamp_query_get_time_ns,
+    _cogl_driver_gl_get_gpu_time_ns,
   };
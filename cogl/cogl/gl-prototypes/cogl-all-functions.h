@@ -224,6 +224,22 @@ COGL_EXT_FUNCTION (void, glDeleteSync,
 COGL_EXT_END ()
 #endif
 
+COGL_EXT_BEGIN (timer_query, 3, 3,
+                0,
+                "ARB:\0EXT\0",
+                "timer_query\0disjoint_timer_query\0")
+COGL_EXT_FUNCTION (void, glGenQueries,
+                   (GLsizei n, GLuint *ids))
+COGL_EXT_FUNCTION (void, glDeleteQueries,
+                   (GLsizei n, const GLuint *ids))
+COGL_EXT_FUNCTION (void, glQueryCounter,
+                   (GLuint id, GLenum target))
+COGL_EXT_FUNCTION (void, glGetQueryObjectui64v,
+                   (GLuint id, GLenum pname, uint64_t *params))
+COGL_EXT_FUNCTION (void, glGetInteger64v,
+                   (GLenum pname, int64_t *data))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (draw_buffers, 2, 0,
                 COGL_EXT_IN_GLES3,
                 "ARB\0EXT\0",
@@ -35,6 +35,7 @@ struct _MetaCursorSpriteXcursor
 
   int current_frame;
   XcursorImages *xcursor_images;
+  unsigned int images_serial;
 
   int theme_scale;
   gboolean theme_dirty;
@@ -400,6 +401,22 @@ meta_cursor_sprite_xcursor_get_current_image (MetaCursorSpriteXcursor *sprite_xc
   return sprite_xcursor->xcursor_images->images[sprite_xcursor->current_frame];
 }
 
+int
+meta_cursor_sprite_xcursor_get_current_frame (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->current_frame;
+}
+
+/*
+ * Changes every time the images are reloaded from the theme, so that
+ * together with the current frame, it identifies the current image.
+ */
+unsigned int
+meta_cursor_sprite_xcursor_get_images_serial (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->images_serial;
+}
+
 static void
 meta_cursor_sprite_xcursor_tick_frame (MetaCursorSprite *sprite)
 {
@@ -449,6 +466,7 @@ load_cursor_from_theme (MetaCursorSprite *sprite)
   sprite_xcursor->xcursor_images =
     load_cursor_on_client (sprite_xcursor->cursor,
                            sprite_xcursor->theme_scale);
+  sprite_xcursor->images_serial++;
 
   load_from_current_xcursor_image (sprite_xcursor);
 }
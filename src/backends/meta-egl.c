@@ -704,6 +704,23 @@ meta_egl_swap_buffers (MetaEgl   *egl,
   return TRUE;
 }
 
+gboolean
+meta_egl_query_surface (MetaEgl    *egl,
+                        EGLDisplay  display,
+                        EGLSurface  surface,
+                        EGLint      attribute,
+                        EGLint     *value,
+                        GError    **error)
+{
+  if (!eglQuerySurface (display, surface, attribute, value))
+    {
+      set_egl_error (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 meta_egl_query_wayland_buffer (MetaEgl            *egl,
                                EGLDisplay          display,
@@ -27,6 +27,7 @@
 #include <graphene.h>
 #include <libcinnamon-desktop/gnome-pnp-ids.h>
 
+#include "backends/edid.h"
 #include "backends/meta-backend-private.h"
 #include "backends/meta-cursor.h"
 #include "backends/meta-display-config-shared.h"
@@ -318,6 +319,8 @@ void                meta_monitor_manager_confirm_configuration (MetaMonitorManag
 
 void               meta_output_parse_edid (MetaOutput *output,
                                            GBytes     *edid);
+void               meta_output_set_edid_info (MetaOutput        *output,
+                                              const MonitorInfo *edid_info);
 gboolean           meta_output_is_laptop  (MetaOutput *output);
 
 gboolean           meta_monitor_manager_has_hotplug_mode_update (MetaMonitorManager *manager);
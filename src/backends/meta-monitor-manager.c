@@ -3322,43 +3322,32 @@ meta_monitor_manager_rebuild_derived (MetaMonitorManager *manager,
 }
 
 void
-meta_output_parse_edid (MetaOutput *output,
-                        GBytes     *edid)
+meta_output_set_edid_info (MetaOutput        *output,
+                           const MonitorInfo *edid_info)
 {
-  MonitorInfo *parsed_edid;
-  gsize len;
-
-  if (!edid)
-    goto out;
-
-  parsed_edid = decode_edid (g_bytes_get_data (edid, &len));
-
-  if (parsed_edid)
+  if (edid_info)
     {
-      output->vendor = g_strndup (parsed_edid->manufacturer_code, 4);
+      output->vendor = g_strndup (edid_info->manufacturer_code, 4);
       if (!g_utf8_validate (output->vendor, -1, NULL))
         g_clear_pointer (&output->vendor, g_free);
 
-      output->product = g_strndup (parsed_edid->dsc_product_name, 14);
+      output->product = g_strndup (edid_info->dsc_product_name, 14);
       if (!g_utf8_validate (output->product, -1, NULL) ||
           output->product[0] == '\0')
         {
           g_clear_pointer (&output->product, g_free);
-          output->product = g_strdup_printf ("0x%04x", (unsigned) parsed_edid->product_code);
+          output->product = g_strdup_printf ("0x%04x", (unsigned) edid_info->product_code);
         }
 
-      output->serial = g_strndup (parsed_edid->dsc_serial_number, 14);
+      output->serial = g_strndup (edid_info->dsc_serial_number, 14);
       if (!g_utf8_validate (output->serial, -1, NULL) ||
           output->serial[0] == '\0')
         {
           g_clear_pointer (&output->serial, g_free);
-          output->serial = g_strdup_printf ("0x%08x", parsed_edid->serial_number);
+          output->serial = g_strdup_printf ("0x%08x", edid_info->serial_number);
         }
-
-      g_free (parsed_edid);
     }
 
- out:
   if (!output->vendor)
     output->vendor = g_strdup ("unknown");
   if (!output->product)
@@ -3367,6 +3356,21 @@ meta_output_parse_edid (MetaOutput *output,
     output->serial = g_strdup ("unknown");
 }
 
+void
+meta_output_parse_edid (MetaOutput *output,
+                        GBytes     *edid)
+{
+  MonitorInfo *parsed_edid = NULL;
+  gsize len;
+
+  if (edid)
+    parsed_edid = decode_edid (g_bytes_get_data (edid, &len));
+
+  meta_output_set_edid_info (output, parsed_edid);
+
+  g_free (parsed_edid);
+}
+
 gboolean
 meta_output_is_laptop (MetaOutput *output)
 {
@@ -59,6 +59,7 @@ typedef struct _MetaMonitorPrivate
 
   GList *outputs;
   GList *modes;
+  GList *modes_tail;
   GHashTable *mode_ids;
 
   MetaMonitorMode *preferred_mode;
@@ -548,9 +549,22 @@ meta_monitor_add_mode (MetaMonitor     *monitor,
     return FALSE;
 
   if (existing_mode)
-    priv->modes = g_list_remove (priv->modes, existing_mode);
+    {
+      if (priv->modes_tail->data == existing_mode)
+        priv->modes_tail = priv->modes_tail->prev;
+      priv->modes = g_list_remove (priv->modes, existing_mode);
+    }
 
-  priv->modes = g_list_append (priv->modes, monitor_mode);
+  /* Tiled monitors can have hundreds of modes; append at the tail link. */
+  if (priv->modes_tail)
+    {
+      priv->modes_tail = g_list_append (priv->modes_tail, monitor_mode)->next;
+    }
+  else
+    {
+      priv->modes = g_list_append (NULL, monitor_mode);
+      priv->modes_tail = priv->modes;
+    }
   g_hash_table_replace (priv->mode_ids, monitor_mode->id, monitor_mode);
 
   return TRUE;
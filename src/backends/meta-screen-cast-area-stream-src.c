@@ -0,0 +1,653 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Linux Mint
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-area-stream-src.h"
+
+#include <spa/buffer/meta.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-cursor-tracker-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-monitor.h"
+#include "backends/meta-screen-cast-area-stream.h"
+#include "backends/meta-screen-cast-session.h"
+#include "backends/meta-stage-private.h"
+#include "clutter/clutter.h"
+#include "clutter/clutter-muffin.h"
+#include "compositor/region-utils.h"
+#include "core/boxes-private.h"
+
+#define DEFAULT_FRAME_RATE 60.0
+
+struct _MetaScreenCastAreaStreamSrc
+{
+  MetaScreenCastStreamSrc parent;
+
+  gboolean cursor_bitmap_invalid;
+  gboolean hw_cursor_inhibited;
+
+  GList *watches;
+
+  gulong monitors_changed_handler_id;
+  gulong cursor_moved_handler_id;
+  gulong cursor_changed_handler_id;
+};
+
+static void
+hw_cursor_inhibitor_iface_init (MetaHwCursorInhibitorInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MetaScreenCastAreaStreamSrc,
+                         meta_screen_cast_area_stream_src,
+                         META_TYPE_SCREEN_CAST_STREAM_SRC,
+                         G_IMPLEMENT_INTERFACE (META_TYPE_HW_CURSOR_INHIBITOR,
+                                                hw_cursor_inhibitor_iface_init))
+
+static MetaScreenCastAreaStream *
+get_area_stream (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+
+  return META_SCREEN_CAST_AREA_STREAM (meta_screen_cast_stream_src_get_stream (src));
+}
+
+static ClutterStage *
+get_stage (MetaScreenCastAreaStreamSrc *area_src)
+{
+  return meta_screen_cast_area_stream_get_stage (get_area_stream (area_src));
+}
+
+static MetaRectangle *
+get_area (MetaScreenCastAreaStreamSrc *area_src)
+{
+  return meta_screen_cast_area_stream_get_area (get_area_stream (area_src));
+}
+
+static float
+get_scale (MetaScreenCastAreaStreamSrc *area_src)
+{
+  return meta_screen_cast_area_stream_get_scale (get_area_stream (area_src));
+}
+
+static MetaBackend *
+get_backend (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
+
+  return meta_screen_cast_get_backend (screen_cast);
+}
+
+static ClutterPaintFlag
+get_paint_flags (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+
+  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+    {
+    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
+    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
+      return CLUTTER_PAINT_FLAG_NO_CURSORS;
+    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
+      return CLUTTER_PAINT_FLAG_NONE;
+    }
+
+  g_assert_not_reached ();
+  return CLUTTER_PAINT_FLAG_NONE;
+}
+
+static void
+meta_screen_cast_area_stream_src_get_specs (MetaScreenCastStreamSrc *src,
+                                            int                     *width,
+                                            int                     *height,
+                                            float                   *frame_rate)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  MetaBackend *backend = get_backend (area_src);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaRectangle *area = get_area (area_src);
+  float scale = get_scale (area_src);
+  float max_refresh_rate = 0.0;
+  GList *l;
+
+  *width = (int) roundf (area->width * scale);
+  *height = (int) roundf (area->height * scale);
+
+  /* Run at the rate of the fastest monitor the area is shown on */
+  for (l = meta_monitor_manager_get_monitors (monitor_manager); l; l = l->next)
+    {
+      MetaMonitor *monitor = l->data;
+      MetaLogicalMonitor *logical_monitor;
+      MetaMonitorMode *mode;
+
+      logical_monitor = meta_monitor_get_logical_monitor (monitor);
+      mode = meta_monitor_get_current_mode (monitor);
+      if (!logical_monitor || !mode ||
+          !meta_rectangle_overlap (&logical_monitor->rect, area))
+        continue;
+
+      max_refresh_rate = MAX (max_refresh_rate,
+                              meta_monitor_mode_get_refresh_rate (mode));
+    }
+
+  *frame_rate = max_refresh_rate > 0.0 ? max_refresh_rate : DEFAULT_FRAME_RATE;
+}
+
+static void
+stage_painted (MetaStage           *stage,
+               ClutterStageView    *view,
+               ClutterPaintContext *paint_context,
+               gpointer             user_data)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (user_data);
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (user_data);
+  MetaRectangle *area = get_area (area_src);
+  const cairo_region_t *redraw_clip;
+  MetaScreenCastRecordFlag flags;
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+  if (redraw_clip)
+    {
+      cairo_region_t *damage;
+      float scale;
+
+      damage = cairo_region_copy (redraw_clip);
+      cairo_region_intersect_rectangle (damage, area);
+      if (cairo_region_is_empty (damage))
+        {
+          cairo_region_destroy (damage);
+          return;
+        }
+
+      cairo_region_translate (damage, -area->x, -area->y);
+
+      scale = get_scale (area_src);
+      if (scale != 1.0)
+        {
+          cairo_region_t *scaled_damage;
+
+          scaled_damage = meta_region_scale_double (damage, scale,
+                                                    META_ROUNDING_STRATEGY_GROW);
+          cairo_region_destroy (damage);
+          damage = scaled_damage;
+        }
+
+      meta_screen_cast_stream_src_add_damage (src, damage);
+      cairo_region_destroy (damage);
+    }
+  else
+    {
+      meta_screen_cast_stream_src_damage_all (src);
+    }
+
+  flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
+  meta_screen_cast_stream_src_maybe_record_frame (src, flags);
+}
+
+static gboolean
+is_cursor_in_stream (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaBackend *backend = get_backend (area_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  graphene_rect_t area_rect;
+  MetaCursorSprite *cursor_sprite;
+
+  area_rect = meta_rectangle_to_graphene_rect (get_area (area_src));
+
+  cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
+  if (cursor_sprite)
+    {
+      graphene_rect_t cursor_rect;
+
+      cursor_rect = meta_cursor_renderer_calculate_rect (cursor_renderer,
+                                                         cursor_sprite);
+      return graphene_rect_intersection (&cursor_rect, &area_rect, NULL);
+    }
+  else
+    {
+      graphene_point_t cursor_position;
+
+      cursor_position = meta_cursor_renderer_get_position (cursor_renderer);
+      return graphene_rect_contains_point (&area_rect, &cursor_position);
+    }
+}
+
+static void
+sync_cursor_state (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  ClutterStage *stage = get_stage (area_src);
+  MetaScreenCastRecordFlag flags;
+
+  if (clutter_stage_is_redraw_queued (stage))
+    return;
+
+  if (meta_screen_cast_stream_src_pending_follow_up_frame (src))
+    return;
+
+  flags = META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY;
+  meta_screen_cast_stream_src_maybe_record_frame (src, flags);
+}
+
+static void
+cursor_moved (MetaCursorTracker           *cursor_tracker,
+              float                        x,
+              float                        y,
+              MetaScreenCastAreaStreamSrc *area_src)
+{
+  sync_cursor_state (area_src);
+}
+
+static void
+cursor_changed (MetaCursorTracker           *cursor_tracker,
+                MetaScreenCastAreaStreamSrc *area_src)
+{
+  area_src->cursor_bitmap_invalid = TRUE;
+  sync_cursor_state (area_src);
+}
+
+static void
+inhibit_hw_cursor (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaBackend *backend = get_backend (area_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  MetaHwCursorInhibitor *inhibitor;
+
+  g_return_if_fail (!area_src->hw_cursor_inhibited);
+
+  inhibitor = META_HW_CURSOR_INHIBITOR (area_src);
+  meta_cursor_renderer_add_hw_cursor_inhibitor (cursor_renderer, inhibitor);
+
+  area_src->hw_cursor_inhibited = TRUE;
+}
+
+static void
+uninhibit_hw_cursor (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaBackend *backend = get_backend (area_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  MetaHwCursorInhibitor *inhibitor;
+
+  g_return_if_fail (area_src->hw_cursor_inhibited);
+
+  inhibitor = META_HW_CURSOR_INHIBITOR (area_src);
+  meta_cursor_renderer_remove_hw_cursor_inhibitor (cursor_renderer, inhibitor);
+
+  area_src->hw_cursor_inhibited = FALSE;
+}
+
+static MetaStageWatchPhase
+get_watch_phase (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+
+  if (meta_screen_cast_stream_get_cursor_mode (stream) ==
+      META_SCREEN_CAST_CURSOR_MODE_EMBEDDED)
+    return META_STAGE_WATCH_AFTER_PAINT;
+  else
+    return META_STAGE_WATCH_AFTER_ACTOR_PAINT;
+}
+
+/* Only the views showing part of the area can carry damage for it */
+static void
+add_view_painted_watches (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaBackend *backend = get_backend (area_src);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaStage *meta_stage = META_STAGE (get_stage (area_src));
+  MetaRectangle *area = get_area (area_src);
+  MetaStageWatchPhase watch_phase = get_watch_phase (area_src);
+  GList *l;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaRendererView *view = l->data;
+      MetaRectangle view_layout;
+      MetaStageWatch *watch;
+
+      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+      if (!meta_rectangle_overlap (area, &view_layout))
+        continue;
+
+      watch = meta_stage_watch_view (meta_stage,
+                                     CLUTTER_STAGE_VIEW (view),
+                                     watch_phase,
+                                     stage_painted,
+                                     area_src);
+
+      area_src->watches = g_list_prepend (area_src->watches, watch);
+    }
+}
+
+static void
+remove_view_painted_watches (MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaStage *meta_stage = META_STAGE (get_stage (area_src));
+  GList *l;
+
+  for (l = area_src->watches; l; l = l->next)
+    {
+      MetaStageWatch *watch = l->data;
+
+      meta_stage_remove_watch (meta_stage, watch);
+    }
+  g_clear_pointer (&area_src->watches, g_list_free);
+}
+
+static void
+on_monitors_changed (MetaMonitorManager          *monitor_manager,
+                     MetaScreenCastAreaStreamSrc *area_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (area_src);
+
+  remove_view_painted_watches (area_src);
+  add_view_painted_watches (area_src);
+
+  meta_screen_cast_stream_src_damage_all (src);
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (get_stage (area_src)));
+}
+
+static void
+meta_screen_cast_area_stream_src_enable (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  MetaBackend *backend = get_backend (area_src);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaCursorTracker *cursor_tracker = meta_backend_get_cursor_tracker (backend);
+  MetaScreenCastStream *stream;
+
+  stream = meta_screen_cast_stream_src_get_stream (src);
+
+  switch (meta_screen_cast_stream_get_cursor_mode (stream))
+    {
+    case META_SCREEN_CAST_CURSOR_MODE_METADATA:
+      area_src->cursor_moved_handler_id =
+        g_signal_connect_after (cursor_tracker, "cursor-moved",
+                                G_CALLBACK (cursor_moved),
+                                area_src);
+      area_src->cursor_changed_handler_id =
+        g_signal_connect_after (cursor_tracker, "cursor-changed",
+                                G_CALLBACK (cursor_changed),
+                                area_src);
+      break;
+    case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
+      break;
+    case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
+      inhibit_hw_cursor (area_src);
+      break;
+    }
+
+  add_view_painted_watches (area_src);
+
+  area_src->monitors_changed_handler_id =
+    g_signal_connect (monitor_manager, "monitors-changed-internal",
+                      G_CALLBACK (on_monitors_changed),
+                      area_src);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (get_stage (area_src)));
+}
+
+static void
+meta_screen_cast_area_stream_src_disable (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  MetaBackend *backend = get_backend (area_src);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaCursorTracker *cursor_tracker = meta_backend_get_cursor_tracker (backend);
+
+  remove_view_painted_watches (area_src);
+
+  if (area_src->hw_cursor_inhibited)
+    uninhibit_hw_cursor (area_src);
+
+  g_clear_signal_handler (&area_src->monitors_changed_handler_id,
+                          monitor_manager);
+  g_clear_signal_handler (&area_src->cursor_moved_handler_id,
+                          cursor_tracker);
+  g_clear_signal_handler (&area_src->cursor_changed_handler_id,
+                          cursor_tracker);
+}
+
+static gboolean
+meta_screen_cast_area_stream_src_record_to_buffer (MetaScreenCastStreamSrc  *src,
+                                                   uint8_t                  *data,
+                                                   const cairo_region_t     *copy_region,
+                                                   GError                  **error)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  ClutterStage *stage = get_stage (area_src);
+  MetaRectangle *area = get_area (area_src);
+  float scale = get_scale (area_src);
+  ClutterPaintFlag paint_flags = get_paint_flags (area_src);
+  cairo_rectangle_int_t rects[META_SCREEN_CAST_MAX_COPY_RECTS];
+  int stride;
+  int n_rects, i;
+
+  stride = (int) roundf (area->width * scale) * 4;
+
+  /*
+   * Partial paints map stream pixels 1:1 to stage pixels, so scaled
+   * areas are always painted as a whole.
+   */
+  if (!copy_region || scale != 1.0)
+    {
+      return clutter_stage_paint_to_buffer (stage, area, scale,
+                                            data, stride,
+                                            CLUTTER_CAIRO_FORMAT_ARGB32,
+                                            paint_flags,
+                                            error);
+    }
+
+  n_rects = meta_screen_cast_stream_src_get_copy_rects (copy_region, rects);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t *rect = &rects[i];
+      cairo_rectangle_int_t stage_rect;
+
+      stage_rect = (cairo_rectangle_int_t) {
+        .x = area->x + rect->x,
+        .y = area->y + rect->y,
+        .width = rect->width,
+        .height = rect->height,
+      };
+      if (!clutter_stage_paint_to_buffer (stage, &stage_rect, 1.0,
+                                          data + rect->y * stride + rect->x * 4,
+                                          stride,
+                                          CLUTTER_CAIRO_FORMAT_ARGB32,
+                                          paint_flags,
+                                          error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+meta_screen_cast_area_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc  *src,
+                                                        CoglFramebuffer          *framebuffer,
+                                                        GError                  **error)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+
+  clutter_stage_paint_to_framebuffer (get_stage (area_src),
+                                      framebuffer,
+                                      get_area (area_src),
+                                      get_scale (area_src),
+                                      get_paint_flags (area_src));
+
+  cogl_framebuffer_finish (framebuffer);
+
+  return TRUE;
+}
+
+static void
+meta_screen_cast_area_stream_src_record_follow_up (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  MetaRectangle *area = get_area (area_src);
+  MetaRectangle damage;
+
+  damage = (cairo_rectangle_int_t) {
+    .x = area->x,
+    .y = area->y,
+    .width = 1,
+    .height = 1,
+  };
+  clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (get_stage (area_src)),
+                                        &damage);
+}
+
+static void
+meta_screen_cast_area_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc *src,
+                                                      struct spa_meta_cursor  *spa_meta_cursor)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (src);
+  MetaBackend *backend = get_backend (area_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  MetaCursorSprite *cursor_sprite;
+  MetaRectangle *area;
+  float scale;
+  graphene_point_t cursor_position;
+  int x, y;
+
+  cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
+
+  if (!is_cursor_in_stream (area_src))
+    {
+      meta_screen_cast_stream_src_unset_cursor_metadata (src,
+                                                         spa_meta_cursor);
+      return;
+    }
+
+  area = get_area (area_src);
+  scale = get_scale (area_src);
+
+  cursor_position = meta_cursor_renderer_get_position (cursor_renderer);
+  cursor_position.x -= area->x;
+  cursor_position.y -= area->y;
+  cursor_position.x *= scale;
+  cursor_position.y *= scale;
+
+  x = (int) roundf (cursor_position.x);
+  y = (int) roundf (cursor_position.y);
+
+  if (area_src->cursor_bitmap_invalid)
+    {
+      if (cursor_sprite)
+        {
+          float cursor_scale;
+
+          cursor_scale = meta_cursor_sprite_get_texture_scale (cursor_sprite);
+          meta_screen_cast_stream_src_set_cursor_sprite_metadata (src,
+                                                                  spa_meta_cursor,
+                                                                  cursor_sprite,
+                                                                  x, y,
+                                                                  scale * cursor_scale);
+        }
+      else
+        {
+          meta_screen_cast_stream_src_set_empty_cursor_sprite_metadata (src,
+                                                                        spa_meta_cursor,
+                                                                        x, y);
+        }
+
+      area_src->cursor_bitmap_invalid = FALSE;
+    }
+  else
+    {
+      meta_screen_cast_stream_src_set_cursor_position_metadata (src,
+                                                                spa_meta_cursor,
+                                                                x, y);
+    }
+}
+
+static gboolean
+meta_screen_cast_area_stream_src_is_cursor_sprite_inhibited (MetaHwCursorInhibitor *inhibitor,
+                                                             MetaCursorSprite      *cursor_sprite)
+{
+  MetaScreenCastAreaStreamSrc *area_src =
+    META_SCREEN_CAST_AREA_STREAM_SRC (inhibitor);
+
+  return is_cursor_in_stream (area_src);
+}
+
+static void
+hw_cursor_inhibitor_iface_init (MetaHwCursorInhibitorInterface *iface)
+{
+  iface->is_cursor_sprite_inhibited =
+    meta_screen_cast_area_stream_src_is_cursor_sprite_inhibited;
+}
+
+MetaScreenCastAreaStreamSrc *
+meta_screen_cast_area_stream_src_new (MetaScreenCastAreaStream  *area_stream,
+                                      GError                   **error)
+{
+  return g_initable_new (META_TYPE_SCREEN_CAST_AREA_STREAM_SRC, NULL, error,
+                         "stream", area_stream,
+                         NULL);
+}
+
+static void
+meta_screen_cast_area_stream_src_init (MetaScreenCastAreaStreamSrc *area_src)
+{
+  area_src->cursor_bitmap_invalid = TRUE;
+}
+
+static void
+meta_screen_cast_area_stream_src_class_init (MetaScreenCastAreaStreamSrcClass *klass)
+{
+  MetaScreenCastStreamSrcClass *src_class =
+    META_SCREEN_CAST_STREAM_SRC_CLASS (klass);
+
+  src_class->get_specs = meta_screen_cast_area_stream_src_get_specs;
+  src_class->enable = meta_screen_cast_area_stream_src_enable;
+  src_class->disable = meta_screen_cast_area_stream_src_disable;
+  src_class->record_to_buffer =
+    meta_screen_cast_area_stream_src_record_to_buffer;
+  src_class->record_to_framebuffer =
+    meta_screen_cast_area_stream_src_record_to_framebuffer;
+  src_class->record_follow_up =
+    meta_screen_cast_area_stream_src_record_follow_up;
+  src_class->set_cursor_metadata =
+    meta_screen_cast_area_stream_src_set_cursor_metadata;
+}
@@ -0,0 +1,254 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Linux Mint
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-area-stream.h"
+
+#include <math.h>
+
+#include "backends/meta-screen-cast-area-stream-src.h"
+
+/* twice the largest monitor scale */
+#define MAX_AREA_SCALE 8.0
+
+/* the streamed frames are 32 bits per pixel */
+#define AREA_BYTES_PER_PIXEL 4
+
+enum
+{
+  PROP_0,
+
+  PROP_AREA,
+  PROP_SCALE,
+};
+
+struct _MetaScreenCastAreaStream
+{
+  MetaScreenCastStream parent;
+
+  ClutterStage *stage;
+
+  MetaRectangle area;
+  float scale;
+};
+
+G_DEFINE_TYPE (MetaScreenCastAreaStream,
+               meta_screen_cast_area_stream,
+               META_TYPE_SCREEN_CAST_STREAM)
+
+ClutterStage *
+meta_screen_cast_area_stream_get_stage (MetaScreenCastAreaStream *area_stream)
+{
+  return area_stream->stage;
+}
+
+MetaRectangle *
+meta_screen_cast_area_stream_get_area (MetaScreenCastAreaStream *area_stream)
+{
+  return &area_stream->area;
+}
+
+float
+meta_screen_cast_area_stream_get_scale (MetaScreenCastAreaStream *area_stream)
+{
+  return area_stream->scale;
+}
+
+MetaScreenCastAreaStream *
+meta_screen_cast_area_stream_new (MetaScreenCastSession     *session,
+                                  GDBusConnection           *connection,
+                                  MetaRectangle             *area,
+                                  float                      scale,
+                                  ClutterStage              *stage,
+                                  MetaScreenCastCursorMode   cursor_mode,
+                                  GError                   **error)
+{
+  MetaScreenCastAreaStream *area_stream;
+  double stream_width, stream_height;
+
+  if (area->width <= 0 || area->height <= 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Invalid area size");
+      return NULL;
+    }
+
+  if (!isfinite (scale) || scale <= 0.0 || scale > MAX_AREA_SCALE)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Invalid scale");
+      return NULL;
+    }
+
+  /* the frame size and stride are computed as int */
+  stream_width = round (area->width * scale);
+  stream_height = round (area->height * scale);
+  if (stream_width * stream_height * AREA_BYTES_PER_PIXEL > G_MAXINT)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Area too large");
+      return NULL;
+    }
+
+  area_stream = g_initable_new (META_TYPE_SCREEN_CAST_AREA_STREAM,
+                                NULL,
+                                error,
+                                "session", session,
+                                "connection", connection,
+                                "cursor-mode", cursor_mode,
+                                "area", area,
+                                "scale", scale,
+                                NULL);
+  if (!area_stream)
+    return NULL;
+
+  area_stream->stage = stage;
+
+  return area_stream;
+}
+
+static MetaScreenCastStreamSrc *
+meta_screen_cast_area_stream_create_src (MetaScreenCastStream  *stream,
+                                         GError               **error)
+{
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+  MetaScreenCastAreaStreamSrc *area_stream_src;
+
+  area_stream_src = meta_screen_cast_area_stream_src_new (area_stream, error);
+  if (!area_stream_src)
+    return NULL;
+
+  return META_SCREEN_CAST_STREAM_SRC (area_stream_src);
+}
+
+static void
+meta_screen_cast_area_stream_set_parameters (MetaScreenCastStream *stream,
+                                             GVariantBuilder      *parameters_builder)
+{
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+
+  g_variant_builder_add (parameters_builder, "{sv}",
+                         "position",
+                         g_variant_new ("(ii)",
+                                        area_stream->area.x,
+                                        area_stream->area.y));
+  g_variant_builder_add (parameters_builder, "{sv}",
+                         "size",
+                         g_variant_new ("(ii)",
+                                        area_stream->area.width,
+                                        area_stream->area.height));
+}
+
+static void
+meta_screen_cast_area_stream_transform_position (MetaScreenCastStream *stream,
+                                                 double                stream_x,
+                                                 double                stream_y,
+                                                 double               *x,
+                                                 double               *y)
+{
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (stream);
+
+  *x = area_stream->area.x + stream_x / area_stream->scale;
+  *y = area_stream->area.y + stream_y / area_stream->scale;
+}
+
+static void
+meta_screen_cast_area_stream_set_property (GObject      *object,
+                                           guint         prop_id,
+                                           const GValue *value,
+                                           GParamSpec   *pspec)
+{
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (object);
+
+  switch (prop_id)
+    {
+    case PROP_AREA:
+      area_stream->area = *(MetaRectangle *) g_value_get_boxed (value);
+      break;
+    case PROP_SCALE:
+      area_stream->scale = g_value_get_float (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+meta_screen_cast_area_stream_get_property (GObject    *object,
+                                           guint       prop_id,
+                                           GValue     *value,
+                                           GParamSpec *pspec)
+{
+  MetaScreenCastAreaStream *area_stream = META_SCREEN_CAST_AREA_STREAM (object);
+
+  switch (prop_id)
+    {
+    case PROP_AREA:
+      g_value_set_boxed (value, &area_stream->area);
+      break;
+    case PROP_SCALE:
+      g_value_set_float (value, area_stream->scale);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+meta_screen_cast_area_stream_init (MetaScreenCastAreaStream *area_stream)
+{
+}
+
+static void
+meta_screen_cast_area_stream_class_init (MetaScreenCastAreaStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaScreenCastStreamClass *stream_class =
+    META_SCREEN_CAST_STREAM_CLASS (klass);
+
+  object_class->set_property = meta_screen_cast_area_stream_set_property;
+  object_class->get_property = meta_screen_cast_area_stream_get_property;
+
+  stream_class->create_src = meta_screen_cast_area_stream_create_src;
+  stream_class->set_parameters = meta_screen_cast_area_stream_set_parameters;
+  stream_class->transform_position = meta_screen_cast_area_stream_transform_position;
+
+  g_object_class_install_property (object_class,
+                                   PROP_AREA,
+                                   g_param_spec_boxed ("area",
+                                                       "area",
+                                                       "Stage area to record",
+                                                       META_TYPE_RECTANGLE,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (object_class,
+                                   PROP_SCALE,
+                                   g_param_spec_float ("scale",
+                                                       "scale",
+                                                       "Scale the area is recorded at",
+                                                       0.0, G_MAXFLOAT, 1.0,
+                                                       G_PARAM_READWRITE |
+                                                       G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
+}
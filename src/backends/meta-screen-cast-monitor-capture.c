@@ -0,0 +1,452 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Linux Mint
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+/*
+ * A monitor capture watches the stage views of a monitor on behalf of
+ * every stream source casting that monitor in the same cursor mode. Each
+ * painted frame is fanned out to all of them, and frames recorded into
+ * shared memory are read back from the stage once into a staging copy
+ * that the sources then copy their buffers from.
+ */
+
+#include "config.h"
+
+#include "backends/meta-screen-cast-monitor-capture.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "backends/meta-backend-private.h"
+#include "backends/meta-logical-monitor.h"
+#include "backends/meta-monitor.h"
+#include "backends/meta-screen-cast-stream-src.h"
+#include "clutter/clutter-muffin.h"
+#include "compositor/region-utils.h"
+#include "core/boxes-private.h"
+
+struct _MetaScreenCastMonitorCapture
+{
+  GObject parent;
+
+  MetaBackend *backend;
+  MetaMonitor *monitor;
+  MetaStageWatchPhase watch_phase;
+
+  GList *srcs;
+  GList *watches;
+
+  /* Last read back frame, only kept while the capture is shared */
+  uint8_t *staging_data;
+  /* Parts of the staging copy that are out of date, in stream coordinates */
+  cairo_region_t *staging_dirty;
+};
+
+G_DEFINE_TYPE (MetaScreenCastMonitorCapture,
+               meta_screen_cast_monitor_capture,
+               G_TYPE_OBJECT)
+
+static ClutterStage *
+get_stage (MetaScreenCastMonitorCapture *capture)
+{
+  return CLUTTER_STAGE (meta_backend_get_stage (capture->backend));
+}
+
+static float
+get_stream_scale (MetaScreenCastMonitorCapture *capture)
+{
+  MetaLogicalMonitor *logical_monitor;
+
+  if (!meta_is_stage_views_scaled ())
+    return 1.0;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  return meta_logical_monitor_get_scale (logical_monitor);
+}
+
+static void
+get_stream_size (MetaScreenCastMonitorCapture *capture,
+                 int                          *width,
+                 int                          *height)
+{
+  MetaLogicalMonitor *logical_monitor;
+  float scale;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  scale = get_stream_scale (capture);
+
+  *width = (int) roundf (logical_monitor->rect.width * scale);
+  *height = (int) roundf (logical_monitor->rect.height * scale);
+}
+
+static int
+get_stride (MetaScreenCastMonitorCapture *capture)
+{
+  MetaLogicalMonitor *logical_monitor;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  return logical_monitor->rect.width * 4;
+}
+
+static void
+damage_staging_all (MetaScreenCastMonitorCapture *capture)
+{
+  cairo_rectangle_int_t rect = { 0 };
+
+  get_stream_size (capture, &rect.width, &rect.height);
+  cairo_region_union_rectangle (capture->staging_dirty, &rect);
+}
+
+static cairo_region_t *
+get_stage_damage (MetaScreenCastMonitorCapture *capture,
+                  const cairo_region_t         *redraw_clip)
+{
+  MetaLogicalMonitor *logical_monitor;
+  MetaRectangle logical_monitor_layout;
+  cairo_region_t *damage;
+  float scale;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  damage = cairo_region_copy (redraw_clip);
+  cairo_region_intersect_rectangle (damage, &logical_monitor_layout);
+  cairo_region_translate (damage,
+                          -logical_monitor_layout.x,
+                          -logical_monitor_layout.y);
+
+  scale = get_stream_scale (capture);
+  if (scale != 1.0)
+    {
+      cairo_region_t *scaled_damage;
+
+      scaled_damage = meta_region_scale_double (damage, scale,
+                                                META_ROUNDING_STRATEGY_GROW);
+      cairo_region_destroy (damage);
+      damage = scaled_damage;
+    }
+
+  return damage;
+}
+
+static void
+stage_painted (MetaStage           *stage,
+               ClutterStageView    *view,
+               ClutterPaintContext *paint_context,
+               gpointer             user_data)
+{
+  MetaScreenCastMonitorCapture *capture = user_data;
+  const cairo_region_t *redraw_clip;
+  cairo_region_t *damage = NULL;
+  GList *l;
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+  if (redraw_clip)
+    damage = get_stage_damage (capture, redraw_clip);
+
+  if (capture->staging_data)
+    {
+      if (damage)
+        cairo_region_union (capture->staging_dirty, damage);
+      else
+        damage_staging_all (capture);
+    }
+
+  for (l = capture->srcs; l; l = l->next)
+    {
+      MetaScreenCastStreamSrc *src = l->data;
+
+      if (damage)
+        meta_screen_cast_stream_src_add_damage (src, damage);
+      else
+        meta_screen_cast_stream_src_damage_all (src);
+
+      meta_screen_cast_stream_src_maybe_record_frame (src,
+                                                      META_SCREEN_CAST_RECORD_FLAG_NONE);
+    }
+
+  g_clear_pointer (&damage, cairo_region_destroy);
+}
+
+static void
+add_view_painted_watches (MetaScreenCastMonitorCapture *capture)
+{
+  MetaRenderer *renderer = meta_backend_get_renderer (capture->backend);
+  MetaStage *meta_stage = META_STAGE (get_stage (capture));
+  MetaLogicalMonitor *logical_monitor;
+  MetaRectangle logical_monitor_layout;
+  GList *l;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaRendererView *view = l->data;
+      MetaRectangle view_layout;
+
+      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+      if (meta_rectangle_overlap (&logical_monitor_layout, &view_layout))
+        {
+          MetaStageWatch *watch;
+
+          watch = meta_stage_watch_view (meta_stage,
+                                         CLUTTER_STAGE_VIEW (view),
+                                         capture->watch_phase,
+                                         stage_painted,
+                                         capture);
+
+          capture->watches = g_list_prepend (capture->watches, watch);
+        }
+    }
+}
+
+static void
+remove_view_painted_watches (MetaScreenCastMonitorCapture *capture)
+{
+  MetaStage *meta_stage = META_STAGE (get_stage (capture));
+  GList *l;
+
+  for (l = capture->watches; l; l = l->next)
+    {
+      MetaStageWatch *watch = l->data;
+
+      meta_stage_remove_watch (meta_stage, watch);
+    }
+  g_clear_pointer (&capture->watches, g_list_free);
+}
+
+static void
+clear_staging (MetaScreenCastMonitorCapture *capture)
+{
+  g_clear_pointer (&capture->staging_data, g_free);
+  cairo_region_destroy (capture->staging_dirty);
+  capture->staging_dirty = cairo_region_create ();
+}
+
+MetaMonitor *
+meta_screen_cast_monitor_capture_get_monitor (MetaScreenCastMonitorCapture *capture)
+{
+  return capture->monitor;
+}
+
+MetaStageWatchPhase
+meta_screen_cast_monitor_capture_get_watch_phase (MetaScreenCastMonitorCapture *capture)
+{
+  return capture->watch_phase;
+}
+
+void
+meta_screen_cast_monitor_capture_add_src (MetaScreenCastMonitorCapture *capture,
+                                          MetaScreenCastStreamSrc      *src)
+{
+  g_return_if_fail (!g_list_find (capture->srcs, src));
+
+  if (!capture->srcs)
+    add_view_painted_watches (capture);
+
+  capture->srcs = g_list_prepend (capture->srcs, src);
+}
+
+void
+meta_screen_cast_monitor_capture_remove_src (MetaScreenCastMonitorCapture *capture,
+                                             MetaScreenCastStreamSrc      *src)
+{
+  g_return_if_fail (g_list_find (capture->srcs, src));
+
+  capture->srcs = g_list_remove (capture->srcs, src);
+
+  if (!capture->srcs)
+    remove_view_painted_watches (capture);
+
+  if (!capture->srcs || !capture->srcs->next)
+    clear_staging (capture);
+}
+
+static void
+capture_region_into (MetaScreenCastMonitorCapture *capture,
+                     const cairo_region_t         *region,
+                     uint8_t                      *data)
+{
+  ClutterStage *stage = get_stage (capture);
+  MetaLogicalMonitor *logical_monitor;
+  cairo_rectangle_int_t rects[META_SCREEN_CAST_MAX_COPY_RECTS];
+  int stride;
+  int n_rects, i;
+
+  logical_monitor = meta_monitor_get_logical_monitor (capture->monitor);
+  stride = get_stride (capture);
+
+  /*
+   * Partial captures map stream pixels 1:1 to stage pixels, so scaled
+   * monitors are always captured as a whole.
+   */
+  if (!region || get_stream_scale (capture) != 1.0)
+    {
+      clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect,
+                                  data, stride);
+      return;
+    }
+
+  n_rects = meta_screen_cast_stream_src_get_copy_rects (region, rects);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t *rect = &rects[i];
+      cairo_rectangle_int_t stage_rect;
+
+      stage_rect = (cairo_rectangle_int_t) {
+        .x = logical_monitor->rect.x + rect->x,
+        .y = logical_monitor->rect.y + rect->y,
+        .width = rect->width,
+        .height = rect->height,
+      };
+      clutter_stage_capture_into (stage, FALSE, &stage_rect,
+                                  data + rect->y * stride + rect->x * 4,
+                                  stride);
+    }
+}
+
+static void
+copy_rect (uint8_t                     *dst,
+           const uint8_t               *src,
+           int                          stride,
+           const cairo_rectangle_int_t *rect)
+{
+  int offset = rect->y * stride + rect->x * 4;
+  int y;
+
+  for (y = 0; y < rect->height; y++)
+    {
+      memcpy (dst + offset, src + offset, rect->width * 4);
+      offset += stride;
+    }
+}
+
+static void
+update_staging (MetaScreenCastMonitorCapture *capture)
+{
+  if (!capture->staging_data)
+    {
+      int width, height;
+
+      get_stream_size (capture, &width, &height);
+      capture->staging_data = g_malloc0 (width * 4 * height);
+      damage_staging_all (capture);
+    }
+
+  if (cairo_region_is_empty (capture->staging_dirty))
+    return;
+
+  capture_region_into (capture, capture->staging_dirty,
+                       capture->staging_data);
+
+  cairo_region_destroy (capture->staging_dirty);
+  capture->staging_dirty = cairo_region_create ();
+}
+
+/*
+ * Reads the current content of the monitor into @data, laid out like the
+ * frames of the stream; only @copy_region is written if it is not NULL.
+ * With a single source the stage is read directly into @data, otherwise
+ * the read back is shared through the staging copy.
+ */
+void
+meta_screen_cast_monitor_capture_read (MetaScreenCastMonitorCapture *capture,
+                                       const cairo_region_t         *copy_region,
+                                       uint8_t                      *data)
+{
+  int stride;
+  int n_rects, i;
+
+  if (!capture->srcs || !capture->srcs->next)
+    {
+      capture_region_into (capture, copy_region, data);
+      return;
+    }
+
+  update_staging (capture);
+
+  stride = get_stride (capture);
+
+  if (!copy_region)
+    {
+      int width, height;
+
+      get_stream_size (capture, &width, &height);
+      memcpy (data, capture->staging_data, width * 4 * height);
+      return;
+    }
+
+  n_rects = cairo_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
+      copy_rect (data, capture->staging_data, stride, &rect);
+    }
+}
+
+MetaScreenCastMonitorCapture *
+meta_screen_cast_monitor_capture_new (MetaBackend         *backend,
+                                      MetaMonitor         *monitor,
+                                      MetaStageWatchPhase  watch_phase)
+{
+  MetaScreenCastMonitorCapture *capture;
+
+  capture = g_object_new (META_TYPE_SCREEN_CAST_MONITOR_CAPTURE, NULL);
+  capture->backend = backend;
+  capture->monitor = g_object_ref (monitor);
+  capture->watch_phase = watch_phase;
+
+  return capture;
+}
+
+static void
+meta_screen_cast_monitor_capture_finalize (GObject *object)
+{
+  MetaScreenCastMonitorCapture *capture =
+    META_SCREEN_CAST_MONITOR_CAPTURE (object);
+
+  g_warn_if_fail (!capture->srcs);
+
+  remove_view_painted_watches (capture);
+  g_clear_pointer (&capture->srcs, g_list_free);
+  g_clear_pointer (&capture->staging_data, g_free);
+  g_clear_pointer (&capture->staging_dirty, cairo_region_destroy);
+  g_clear_object (&capture->monitor);
+
+  G_OBJECT_CLASS (meta_screen_cast_monitor_capture_parent_class)->finalize (object);
+}
+
+static void
+meta_screen_cast_monitor_capture_init (MetaScreenCastMonitorCapture *capture)
+{
+  capture->staging_dirty = cairo_region_create ();
+}
+
+static void
+meta_screen_cast_monitor_capture_class_init (MetaScreenCastMonitorCaptureClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_screen_cast_monitor_capture_finalize;
+}
@@ -0,0 +1,59 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+/*
+ * Copyright (C) 2026 Linux Mint
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ *
+ */
+
+#ifndef META_SCREEN_CAST_MONITOR_CAPTURE_H
+#define META_SCREEN_CAST_MONITOR_CAPTURE_H
+
+#include <cairo.h>
+#include <glib-object.h>
+#include <stdint.h>
+
+#include "backends/meta-backend-types.h"
+#include "backends/meta-stage-private.h"
+
+typedef struct _MetaScreenCastStreamSrc MetaScreenCastStreamSrc;
+
+#define META_TYPE_SCREEN_CAST_MONITOR_CAPTURE (meta_screen_cast_monitor_capture_get_type ())
+G_DECLARE_FINAL_TYPE (MetaScreenCastMonitorCapture,
+                      meta_screen_cast_monitor_capture,
+                      META, SCREEN_CAST_MONITOR_CAPTURE,
+                      GObject)
+
+MetaScreenCastMonitorCapture * meta_screen_cast_monitor_capture_new (MetaBackend         *backend,
+                                                                     MetaMonitor         *monitor,
+                                                                     MetaStageWatchPhase  watch_phase);
+
+MetaMonitor * meta_screen_cast_monitor_capture_get_monitor (MetaScreenCastMonitorCapture *capture);
+
+MetaStageWatchPhase meta_screen_cast_monitor_capture_get_watch_phase (MetaScreenCastMonitorCapture *capture);
+
+void meta_screen_cast_monitor_capture_add_src (MetaScreenCastMonitorCapture *capture,
+                                               MetaScreenCastStreamSrc      *src);
+
+void meta_screen_cast_monitor_capture_remove_src (MetaScreenCastMonitorCapture *capture,
+                                                  MetaScreenCastStreamSrc      *src);
+
+void meta_screen_cast_monitor_capture_read (MetaScreenCastMonitorCapture *capture,
+                                            const cairo_region_t         *copy_region,
+                                            uint8_t                      *data);
+
+#endif /* META_SCREEN_CAST_MONITOR_CAPTURE_H */
@@ -44,7 +44,7 @@ struct _MetaScreenCastMonitorStreamSrc
   gboolean cursor_bitmap_invalid;
   gboolean hw_cursor_inhibited;
 
-  GList *watches;
+  MetaScreenCastMonitorCapture *capture;
 
   gulong cursor_moved_handler_id;
   gulong cursor_changed_handler_id;
@@ -114,19 +114,6 @@ meta_screen_cast_monitor_stream_src_get_specs (MetaScreenCastStreamSrc *src,
   *frame_rate = meta_monitor_mode_get_refresh_rate (mode);
 }
 
-static void
-stage_painted (MetaStage           *stage,
-               ClutterStageView    *view,
-               ClutterPaintContext *paint_context,
-               gpointer             user_data)
-{
-  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (user_data);
-  MetaScreenCastRecordFlag flags;
-
-  flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
-  meta_screen_cast_stream_src_maybe_record_frame (src, flags);
-}
-
 static MetaBackend *
 get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
@@ -255,44 +242,27 @@ uninhibit_hw_cursor (MetaScreenCastMonitorStreamSrc *monitor_src)
   monitor_src->hw_cursor_inhibited = FALSE;
 }
 
-static void
-add_view_painted_watches (MetaScreenCastMonitorStreamSrc *monitor_src,
-                          MetaStageWatchPhase             watch_phase)
+static MetaScreenCast *
+get_screen_cast (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
-  MetaBackend *backend = get_backend (monitor_src);
-  MetaRenderer *renderer = meta_backend_get_renderer (backend);
-  ClutterStage *stage;
-  MetaStage *meta_stage;
-  MetaMonitor *monitor;
-  MetaLogicalMonitor *logical_monitor;
-  MetaRectangle logical_monitor_layout;
-  GList *l;
-
-  stage = get_stage (monitor_src);
-  meta_stage = META_STAGE (stage);
-  monitor = get_monitor (monitor_src);
-  logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
-
-  for (l = meta_renderer_get_views (renderer); l; l = l->next)
-    {
-      MetaRendererView *view = l->data;
-      MetaRectangle view_layout;
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
 
-      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
-      if (meta_rectangle_overlap (&logical_monitor_layout, &view_layout))
-        {
-          MetaStageWatch *watch;
+  return meta_screen_cast_session_get_screen_cast (session);
+}
 
-          watch = meta_stage_watch_view (meta_stage,
-                                         CLUTTER_STAGE_VIEW (view),
-                                         watch_phase,
-                                         stage_painted,
-                                         monitor_src);
+static void
+attach_capture (MetaScreenCastMonitorStreamSrc *monitor_src,
+                MetaStageWatchPhase             watch_phase)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
 
-          monitor_src->watches = g_list_prepend (monitor_src->watches, watch);
-        }
-    }
+  monitor_src->capture =
+    meta_screen_cast_get_monitor_capture (get_screen_cast (monitor_src),
+                                          get_monitor (monitor_src),
+                                          watch_phase);
+  meta_screen_cast_monitor_capture_add_src (monitor_src->capture, src);
 }
 
 static void
@@ -321,13 +291,11 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
                                 monitor_src);
       G_GNUC_FALLTHROUGH;
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
-      add_view_painted_watches (monitor_src,
-                                META_STAGE_WATCH_AFTER_ACTOR_PAINT);
+      attach_capture (monitor_src, META_STAGE_WATCH_AFTER_ACTOR_PAINT);
       break;
     case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
       inhibit_hw_cursor (monitor_src);
-      add_view_painted_watches (monitor_src,
-                                META_STAGE_WATCH_AFTER_PAINT);
+      attach_capture (monitor_src, META_STAGE_WATCH_AFTER_PAINT);
       break;
     }
 
@@ -341,20 +309,12 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
   MetaBackend *backend = get_backend (monitor_src);
   MetaCursorTracker *cursor_tracker = meta_backend_get_cursor_tracker (backend);
-  ClutterStage *stage;
-  MetaStage *meta_stage;
-  GList *l;
-
-  stage = get_stage (monitor_src);
-  meta_stage = META_STAGE (stage);
 
-  for (l = monitor_src->watches; l; l = l->next)
+  if (monitor_src->capture)
     {
-      MetaStageWatch *watch = l->data;
-
-      meta_stage_remove_watch (meta_stage, watch);
+      meta_screen_cast_monitor_capture_remove_src (monitor_src->capture, src);
+      g_clear_object (&monitor_src->capture);
     }
-  g_clear_pointer (&monitor_src->watches, g_list_free);
 
   if (monitor_src->hw_cursor_inhibited)
     uninhibit_hw_cursor (monitor_src);
@@ -368,18 +328,15 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
 static gboolean
 meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc  *src,
                                                       uint8_t                  *data,
+                                                      const cairo_region_t     *copy_region,
                                                       GError                  **error)
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
-  ClutterStage *stage;
-  MetaMonitor *monitor;
-  MetaLogicalMonitor *logical_monitor;
 
-  stage = get_stage (monitor_src);
-  monitor = get_monitor (monitor_src);
-  logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  clutter_stage_capture_into (stage, FALSE, &logical_monitor->rect, data);
+  meta_screen_cast_monitor_capture_read (monitor_src->capture,
+                                         copy_region,
+                                         data);
 
   return TRUE;
 }
@@ -47,6 +47,19 @@
   (sizeof (struct spa_meta_cursor) + \
    sizeof (struct spa_meta_bitmap) + width * height * 4)
 
+#define MAX_DAMAGE_RECTS 16
+
+/* Frames are recorded at least this often, so that encoders get a
+ * refresh of the whole frame even while nothing changes */
+#define REFRESH_INTERVAL_US (G_USEC_PER_SEC)
+
+/* Bounds of the interval frames are held back to while the consumer
+ * does not give buffers back */
+#define MIN_THROTTLE_INTERVAL_US (G_USEC_PER_SEC / 60)
+#define MAX_THROTTLE_INTERVAL_US (G_USEC_PER_SEC / 2)
+
+#define MAX_PLANES 3
+
 enum
 {
   PROP_0,
@@ -72,6 +85,35 @@ typedef struct _MetaPipeWireSource
   struct pw_loop *pipewire_loop;
 } MetaPipeWireSource;
 
+typedef struct _MetaScreenCastBuffer
+{
+  /* The frame last recorded into the buffer, 0 if its content is unknown */
+  uint64_t frame_seq;
+} MetaScreenCastBuffer;
+
+typedef struct _MetaScreenCastPlane
+{
+  int offset;
+  int stride;
+  int height;
+
+  /* For YUV formats, the plane as rendered by the conversion pass, with
+   * four 8 bit samples packed into each RGBA texel */
+  CoglFramebuffer *framebuffer;
+  CoglPipeline *pipeline;
+} MetaScreenCastPlane;
+
+typedef struct _MetaScreenCastPlaneConversion
+{
+  /* Size of the square of source pixels a sample is averaged over */
+  int block_size;
+  /* Number of interleaved components making up a sample */
+  int components_per_sample;
+  /* RGB weights and offset of the even and odd components of a sample */
+  const float *coeffs_even;
+  const float *coeffs_odd;
+} MetaScreenCastPlaneConversion;
+
 typedef struct _MetaScreenCastStreamSrcPrivate
 {
   MetaScreenCastStream *stream;
@@ -91,13 +133,33 @@ typedef struct _MetaScreenCastStreamSrcPrivate
   struct spa_video_info_raw video_format;
   int video_stride;
 
+  MetaScreenCastPlane planes[MAX_PLANES];
+  int n_planes;
+  int frame_size;
+
+  /* The RGB frame the YUV planes are converted from */
+  CoglFramebuffer *yuv_source_framebuffer;
+
   int64_t last_frame_timestamp_us;
   guint follow_up_frame_source_id;
 
+  int64_t last_recorded_frame_timestamp_us;
+  guint refresh_frame_source_id;
+
+  /* Raised when no buffer can be dequeued, 0 when not throttled */
+  int64_t throttle_interval_us;
+  int64_t last_throttle_timestamp_us;
+
   GHashTable *dmabuf_handles;
 
   int stream_width;
   int stream_height;
+
+  /* Damage since the last recorded frame, in stream coordinates */
+  cairo_region_t *damage;
+  /* Damage of the recorded frames, to bring older buffers up to date */
+  ClutterDamageHistory *damage_history;
+  uint64_t frame_seq;
 } MetaScreenCastStreamSrcPrivate;
 
 static void
@@ -144,12 +206,13 @@ meta_screen_cast_stream_src_get_videocrop (MetaScreenCastStreamSrc *src,
 static gboolean
 meta_screen_cast_stream_src_record_to_buffer (MetaScreenCastStreamSrc  *src,
                                               uint8_t                  *data,
+                                              const cairo_region_t     *copy_region,
                                               GError                  **error)
 {
   MetaScreenCastStreamSrcClass *klass =
     META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src);
 
-  return klass->record_to_buffer (src, data, error);
+  return klass->record_to_buffer (src, data, copy_region, error);
 }
 
 static gboolean
@@ -407,6 +470,54 @@ add_cursor_metadata (MetaScreenCastStreamSrc *src,
     meta_screen_cast_stream_src_set_cursor_metadata (src, spa_meta_cursor);
 }
 
+static void
+add_damage_metadata (MetaScreenCastStreamSrc *src,
+                     struct spa_buffer       *spa_buffer,
+                     const cairo_region_t    *damage)
+{
+  struct spa_meta *spa_meta_video_damage;
+  struct spa_meta_region *spa_meta_regions;
+  int max_regions;
+  int n_rects;
+  int i;
+
+  spa_meta_video_damage = spa_buffer_find_meta (spa_buffer,
+                                                SPA_META_VideoDamage);
+  if (!spa_meta_video_damage)
+    return;
+
+  spa_meta_regions = spa_meta_video_damage->data;
+  max_regions = spa_meta_video_damage->size / sizeof (struct spa_meta_region);
+  if (max_regions == 0)
+    return;
+
+  n_rects = cairo_region_num_rectangles (damage);
+  if (n_rects > max_regions)
+    {
+      cairo_rectangle_int_t extents;
+
+      cairo_region_get_extents (damage, &extents);
+      spa_meta_regions[0].region = SPA_REGION (extents.x, extents.y,
+                                               extents.width, extents.height);
+      n_rects = 1;
+    }
+  else
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (damage, i, &rect);
+          spa_meta_regions[i].region = SPA_REGION (rect.x, rect.y,
+                                                   rect.width, rect.height);
+        }
+    }
+
+  /* A region with no size terminates the list */
+  if (n_rects < max_regions)
+    spa_meta_regions[n_rects].region = SPA_REGION (0, 0, 0, 0);
+}
+
 static void
 maybe_record_cursor (MetaScreenCastStreamSrc *src,
                      struct spa_buffer       *spa_buffer)
@@ -426,19 +537,478 @@ maybe_record_cursor (MetaScreenCastStreamSrc *src,
   g_assert_not_reached ();
 }
 
+void
+meta_screen_cast_stream_src_add_damage (MetaScreenCastStreamSrc *src,
+                                        const cairo_region_t    *damage)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  cairo_region_union (priv->damage, damage);
+}
+
+void
+meta_screen_cast_stream_src_damage_all (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_rectangle_int_t stream_rect;
+
+  stream_rect = (cairo_rectangle_int_t) {
+    .width = priv->stream_width,
+    .height = priv->stream_height,
+  };
+  cairo_region_union_rectangle (priv->damage, &stream_rect);
+}
+
+/*
+ * Moves the accumulated damage into the damage history as the damage of a
+ * new frame, and returns it.
+ */
+static cairo_region_t *
+take_frame_damage (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  cairo_region_t *damage;
+  cairo_rectangle_int_t stream_rect;
+
+  damage = g_steal_pointer (&priv->damage);
+  priv->damage = cairo_region_create ();
+
+  stream_rect = (cairo_rectangle_int_t) {
+    .width = priv->stream_width,
+    .height = priv->stream_height,
+  };
+  cairo_region_intersect_rectangle (damage, &stream_rect);
+
+  clutter_damage_history_step (priv->damage_history);
+  clutter_damage_history_record (priv->damage_history, damage);
+  priv->frame_seq++;
+
+  return damage;
+}
+
+/*
+ * Returns the part of a buffer that is out of date for the current frame,
+ * or NULL if all of it is.
+ */
+static cairo_region_t *
+get_buffer_copy_region (MetaScreenCastStreamSrc *src,
+                        MetaScreenCastBuffer    *buffer)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  ClutterDamageHistory *damage_history = priv->damage_history;
+  cairo_region_t *region;
+  uint64_t age;
+  int i;
+
+  if (!buffer || buffer->frame_seq == 0)
+    return NULL;
+
+  age = priv->frame_seq - buffer->frame_seq;
+  if (age < 1 || age > G_MAXINT ||
+      (age > 1 &&
+       !clutter_damage_history_is_age_valid (damage_history, (int) age - 1)))
+    return NULL;
+
+  region = cairo_region_copy (clutter_damage_history_lookup (damage_history, 0));
+  for (i = 1; i < age; i++)
+    cairo_region_union (region,
+                        clutter_damage_history_lookup (damage_history, i));
+
+  return region;
+}
+
+/**
+ * meta_screen_cast_stream_src_get_copy_rects:
+ * @copy_region: the region of a buffer to copy
+ * @rects: (out caller-allocates): room for %META_SCREEN_CAST_MAX_COPY_RECTS
+ *   rectangles
+ *
+ * Each rectangle copied separately costs a paint and a read-back, so a
+ * fragmented @copy_region is copied as its extents instead.
+ *
+ * Returns: the number of rectangles stored in @rects
+ */
+int
+meta_screen_cast_stream_src_get_copy_rects (const cairo_region_t  *copy_region,
+                                            cairo_rectangle_int_t *rects)
+{
+  int n_rects;
+  int i;
+
+  n_rects = cairo_region_num_rectangles (copy_region);
+  if (n_rects > META_SCREEN_CAST_MAX_COPY_RECTS)
+    {
+      cairo_region_get_extents (copy_region, &rects[0]);
+      return 1;
+    }
+
+  for (i = 0; i < n_rects; i++)
+    cairo_region_get_rectangle (copy_region, i, &rects[i]);
+
+  return n_rects;
+}
+
+/* BT.601 limited range, as vec4 (r, g, b, offset) */
+static const float y_coeffs[] = { 0.256788f, 0.504129f, 0.097906f, 0.062745f };
+static const float u_coeffs[] = { -0.148223f, -0.290993f, 0.439216f, 0.501961f };
+static const float v_coeffs[] = { 0.439216f, -0.367788f, -0.071427f, 0.501961f };
+
+static const MetaScreenCastPlaneConversion nv12_conversion[] = {
+  { 1, 1, y_coeffs, y_coeffs },
+  { 2, 2, u_coeffs, v_coeffs },
+};
+
+static const MetaScreenCastPlaneConversion i420_conversion[] = {
+  { 1, 1, y_coeffs, y_coeffs },
+  { 2, 1, u_coeffs, u_coeffs },
+  { 2, 1, v_coeffs, v_coeffs },
+};
+
+static const char yuv_plane_glsl_declarations[] =
+"uniform vec2 source_size;\n"
+"uniform vec2 plane_size;\n"
+"uniform float block_size;\n"
+"uniform float components_per_sample;\n"
+"uniform vec4 coeffs_even;\n"
+"uniform vec4 coeffs_odd;\n";
+
+/* Each output texel packs four consecutive bytes of the plane; component
+ * k belongs to sample k / components_per_sample of the texel, which is
+ * the average of a block_size square of source pixels */
+#define CONVERT_COMPONENT(k, channel, coeffs) \
+"  sample_pos = vec2 (first_sample + floor (" #k ".0 / components_per_sample),\n" \
+"                     plane_pos.y);\n" \
+"  rgb = texture2D (cogl_sampler,\n" \
+"                   (sample_pos + 0.5) * block_size / source_size).rgb;\n" \
+"  cogl_texel." #channel " = dot (rgb, " #coeffs ".rgb) + " #coeffs ".a;\n"
+
+static const char yuv_plane_glsl[] =
+"  vec2 plane_pos = floor (cogl_tex_coord.st * plane_size);\n"
+"  float first_sample = plane_pos.x * 4.0 / components_per_sample;\n"
+"  vec2 sample_pos;\n"
+"  vec3 rgb;\n"
+"\n"
+CONVERT_COMPONENT (0, r, coeffs_even)
+CONVERT_COMPONENT (1, g, coeffs_odd)
+CONVERT_COMPONENT (2, b, coeffs_even)
+CONVERT_COMPONENT (3, a, coeffs_odd);
+#undef CONVERT_COMPONENT
+
+static gboolean
+is_yuv_format (uint32_t format)
+{
+  return (format == SPA_VIDEO_FORMAT_NV12 ||
+          format == SPA_VIDEO_FORMAT_I420);
+}
+
+static const MetaScreenCastPlaneConversion *
+get_plane_conversions (uint32_t format)
+{
+  switch (format)
+    {
+    case SPA_VIDEO_FORMAT_NV12:
+      return nv12_conversion;
+    case SPA_VIDEO_FORMAT_I420:
+      return i420_conversion;
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
+
+static void
+update_plane_layout (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  MetaScreenCastPlane *planes = priv->planes;
+  int width = priv->video_format.size.width;
+  int height = priv->video_format.size.height;
+  int chroma_height = SPA_ROUND_UP_N (height, 2) / 2;
+  const int bpp = 4;
+
+  memset (planes, 0, sizeof (priv->planes));
+
+  switch (priv->video_format.format)
+    {
+    case SPA_VIDEO_FORMAT_NV12:
+      planes[0].stride = SPA_ROUND_UP_N (width, 4);
+      planes[0].height = height;
+
+      planes[1].offset = planes[0].stride * SPA_ROUND_UP_N (height, 2);
+      planes[1].stride = planes[0].stride;
+      planes[1].height = chroma_height;
+
+      priv->n_planes = 2;
+      break;
+    case SPA_VIDEO_FORMAT_I420:
+      planes[0].stride = SPA_ROUND_UP_N (width, 4);
+      planes[0].height = height;
+
+      planes[1].offset = planes[0].stride * SPA_ROUND_UP_N (height, 2);
+      planes[1].stride = SPA_ROUND_UP_N (SPA_ROUND_UP_N (width, 2) / 2, 4);
+      planes[1].height = chroma_height;
+
+      planes[2].offset = planes[1].offset + planes[1].stride * chroma_height;
+      planes[2].stride = planes[1].stride;
+      planes[2].height = chroma_height;
+
+      priv->n_planes = 3;
+      break;
+    default:
+      planes[0].stride = SPA_ROUND_UP_N (width * bpp, 4);
+      planes[0].height = height;
+
+      priv->n_planes = 1;
+      break;
+    }
+
+  priv->frame_size = (planes[priv->n_planes - 1].offset +
+                      planes[priv->n_planes - 1].stride *
+                      planes[priv->n_planes - 1].height);
+  priv->video_stride = planes[0].stride;
+}
+
+static void
+clear_yuv_conversion (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int i;
+
+  for (i = 0; i < MAX_PLANES; i++)
+    {
+      g_clear_pointer (&priv->planes[i].pipeline, cogl_object_unref);
+      g_clear_pointer (&priv->planes[i].framebuffer, cogl_object_unref);
+    }
+
+  g_clear_pointer (&priv->yuv_source_framebuffer, cogl_object_unref);
+}
+
+static CoglFramebuffer *
+create_offscreen (CoglContext  *cogl_context,
+                  int           width,
+                  int           height,
+                  gboolean      premultiplied,
+                  GError      **error)
+{
+  CoglTexture2D *texture;
+  CoglOffscreen *offscreen;
+  CoglFramebuffer *framebuffer;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  cogl_primitive_texture_set_auto_mipmap (COGL_PRIMITIVE_TEXTURE (texture),
+                                          FALSE);
+  cogl_texture_set_premultiplied (COGL_TEXTURE (texture), premultiplied);
+
+  offscreen = cogl_offscreen_new_with_texture (COGL_TEXTURE (texture));
+  framebuffer = COGL_FRAMEBUFFER (offscreen);
+  cogl_object_unref (texture);
+
+  if (!cogl_framebuffer_allocate (framebuffer, error))
+    {
+      cogl_object_unref (framebuffer);
+      return NULL;
+    }
+
+  return framebuffer;
+}
+
+static CoglPipeline *
+create_plane_pipeline (CoglContext                         *cogl_context,
+                       CoglTexture                         *source_texture,
+                       const MetaScreenCastPlane           *plane,
+                       const MetaScreenCastPlaneConversion *conversion)
+{
+  CoglPipeline *pipeline;
+  CoglSnippet *snippet;
+  float source_size[2];
+  float plane_size[2];
+  int location;
+
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_layer_texture (pipeline, 0, source_texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                     COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                              yuv_plane_glsl_declarations,
+                              NULL);
+  cogl_snippet_set_replace (snippet, yuv_plane_glsl);
+  cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+  cogl_object_unref (snippet);
+
+  source_size[0] = cogl_texture_get_width (source_texture);
+  source_size[1] = cogl_texture_get_height (source_texture);
+  location = cogl_pipeline_get_uniform_location (pipeline, "source_size");
+  cogl_pipeline_set_uniform_float (pipeline, location, 2, 1, source_size);
+
+  plane_size[0] = plane->stride / 4;
+  plane_size[1] = plane->height;
+  location = cogl_pipeline_get_uniform_location (pipeline, "plane_size");
+  cogl_pipeline_set_uniform_float (pipeline, location, 2, 1, plane_size);
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "block_size");
+  cogl_pipeline_set_uniform_1f (pipeline, location, conversion->block_size);
+
+  location = cogl_pipeline_get_uniform_location (pipeline,
+                                                 "components_per_sample");
+  cogl_pipeline_set_uniform_1f (pipeline, location,
+                                conversion->components_per_sample);
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "coeffs_even");
+  cogl_pipeline_set_uniform_float (pipeline, location, 4, 1,
+                                   conversion->coeffs_even);
+
+  location = cogl_pipeline_get_uniform_location (pipeline, "coeffs_odd");
+  cogl_pipeline_set_uniform_float (pipeline, location, 4, 1,
+                                   conversion->coeffs_odd);
+
+  return pipeline;
+}
+
+static gboolean
+ensure_yuv_conversion (MetaScreenCastStreamSrc  *src,
+                       GError                  **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  const MetaScreenCastPlaneConversion *conversions;
+  CoglTexture *source_texture;
+  int i;
+
+  if (priv->yuv_source_framebuffer)
+    return TRUE;
+
+  priv->yuv_source_framebuffer =
+    create_offscreen (cogl_context,
+                      priv->video_format.size.width,
+                      priv->video_format.size.height,
+                      TRUE,
+                      error);
+  if (!priv->yuv_source_framebuffer)
+    return FALSE;
+
+  source_texture =
+    cogl_offscreen_get_texture (COGL_OFFSCREEN (priv->yuv_source_framebuffer));
+  conversions = get_plane_conversions (priv->video_format.format);
+
+  for (i = 0; i < priv->n_planes; i++)
+    {
+      MetaScreenCastPlane *plane = &priv->planes[i];
+
+      plane->framebuffer = create_offscreen (cogl_context,
+                                             plane->stride / 4,
+                                             plane->height,
+                                             FALSE,
+                                             error);
+      if (!plane->framebuffer)
+        {
+          clear_yuv_conversion (src);
+          return FALSE;
+        }
+
+      plane->pipeline = create_plane_pipeline (cogl_context,
+                                               source_texture,
+                                               plane,
+                                               &conversions[i]);
+    }
+
+  return TRUE;
+}
+
+/* Renders the frame in RGB, converts it to YUV on the GPU, one pass per
+ * plane, and reads the planes back into @data */
+static gboolean
+record_yuv_to_buffer (MetaScreenCastStreamSrc  *src,
+                      uint8_t                  *data,
+                      GError                  **error)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int i;
+
+  if (!ensure_yuv_conversion (src, error))
+    return FALSE;
+
+  if (!meta_screen_cast_stream_src_record_to_framebuffer (src,
+                                                          priv->yuv_source_framebuffer,
+                                                          error))
+    return FALSE;
+
+  for (i = 0; i < priv->n_planes; i++)
+    {
+      MetaScreenCastPlane *plane = &priv->planes[i];
+
+      cogl_framebuffer_draw_rectangle (plane->framebuffer, plane->pipeline,
+                                       -1, 1, 1, -1);
+    }
+
+  for (i = 0; i < priv->n_planes; i++)
+    {
+      MetaScreenCastPlane *plane = &priv->planes[i];
+
+      if (!cogl_framebuffer_read_pixels (plane->framebuffer,
+                                         0, 0,
+                                         plane->stride / 4, plane->height,
+                                         COGL_PIXEL_FORMAT_RGBA_8888,
+                                         data + plane->offset))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Failed to read back plane %d", i);
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 static gboolean
 do_record_frame (MetaScreenCastStreamSrc  *src,
-                 struct spa_buffer        *spa_buffer,
+                 struct pw_buffer         *buffer,
                  uint8_t                  *data,
                  GError                  **error)
 {
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
+  struct spa_buffer *spa_buffer = buffer->buffer;
 
-  if (spa_buffer->datas[0].data ||
+  if (is_yuv_format (priv->video_format.format))
+    {
+      if (!data)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "YUV frames need a mappable buffer");
+          return FALSE;
+        }
+
+      /* The planes are converted as a whole, so the frame damage is only
+       * passed on as metadata */
+      return record_yuv_to_buffer (src, data, error);
+    }
+  else if (spa_buffer->datas[0].data ||
       spa_buffer->datas[0].type == SPA_DATA_MemFd)
     {
-      return meta_screen_cast_stream_src_record_to_buffer (src, data, error);
+      cairo_region_t *copy_region;
+      gboolean ret;
+
+      copy_region = get_buffer_copy_region (src, buffer->user_data);
+      ret = meta_screen_cast_stream_src_record_to_buffer (src, data,
+                                                          copy_region,
+                                                          error);
+      g_clear_pointer (&copy_region, cairo_region_destroy);
+
+      return ret;
     }
   else if (spa_buffer->datas[0].type == SPA_DATA_DmaBuf)
     {
@@ -495,6 +1065,117 @@ maybe_schedule_follow_up_frame (MetaScreenCastStreamSrc *src,
                                                    src);
 }
 
+static int64_t
+get_max_framerate_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->video_format.max_framerate.num <= 0)
+    return 0;
+
+  return ((G_USEC_PER_SEC * priv->video_format.max_framerate.denom) /
+          priv->video_format.max_framerate.num);
+}
+
+static int64_t
+get_min_frame_interval_us (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  return MAX (get_max_framerate_interval_us (src),
+              priv->throttle_interval_us);
+}
+
+/*
+ * The consumer holds on to all buffers; back off by doubling the frame
+ * interval, and relax it gradually again once buffers come back. Every
+ * frame attempted within the current interval hits the same shortage, so
+ * the interval is raised at most once per interval.
+ */
+static void
+throttle_frame_rate (MetaScreenCastStreamSrc *src,
+                     int64_t                  now_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t interval_us;
+
+  interval_us = MAX (get_min_frame_interval_us (src), MIN_THROTTLE_INTERVAL_US);
+  if (priv->throttle_interval_us &&
+      now_us - priv->last_throttle_timestamp_us < interval_us)
+    return;
+
+  priv->throttle_interval_us = MIN (interval_us * 2, MAX_THROTTLE_INTERVAL_US);
+  priv->last_throttle_timestamp_us = now_us;
+}
+
+static void
+relax_frame_rate_throttle (MetaScreenCastStreamSrc *src)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (!priv->throttle_interval_us)
+    return;
+
+  priv->throttle_interval_us -= priv->throttle_interval_us / 4;
+  if (priv->throttle_interval_us <= get_max_framerate_interval_us (src) ||
+      priv->throttle_interval_us < MIN_THROTTLE_INTERVAL_US)
+    priv->throttle_interval_us = 0;
+}
+
+static void maybe_schedule_refresh_frame (MetaScreenCastStreamSrc *src,
+                                          int64_t                  timeout_us);
+
+static gboolean
+refresh_frame_cb (gpointer user_data)
+{
+  MetaScreenCastStreamSrc *src = user_data;
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+  int64_t time_since_last_frame_us;
+
+  priv->refresh_frame_source_id = 0;
+
+  time_since_last_frame_us =
+    g_get_monotonic_time () - priv->last_recorded_frame_timestamp_us;
+  if (time_since_last_frame_us < REFRESH_INTERVAL_US)
+    {
+      maybe_schedule_refresh_frame (src,
+                                    REFRESH_INTERVAL_US -
+                                    time_since_last_frame_us);
+      return G_SOURCE_REMOVE;
+    }
+
+  meta_screen_cast_stream_src_damage_all (src);
+  meta_screen_cast_stream_src_record_follow_up (src);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+maybe_schedule_refresh_frame (MetaScreenCastStreamSrc *src,
+                              int64_t                  timeout_us)
+{
+  MetaScreenCastStreamSrcPrivate *priv =
+    meta_screen_cast_stream_src_get_instance_private (src);
+
+  if (priv->refresh_frame_source_id)
+    return;
+
+  priv->refresh_frame_source_id = g_timeout_add (us2ms (timeout_us),
+                                                 refresh_frame_cb,
+                                                 src);
+}
+
+/*
+ * Frames are only recorded when something was damaged since the last
+ * one, at most at the negotiated max framerate, or slower while the
+ * consumer is short of buffers. Without damage, a frame is still
+ * recorded every REFRESH_INTERVAL_US.
+ */
 void
 meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc  *src,
                                                 MetaScreenCastRecordFlag  flags)
@@ -506,19 +1187,20 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc  *src,
   struct spa_buffer *spa_buffer;
   uint8_t *data = NULL;
   uint64_t now_us;
+  int64_t min_interval_us;
   g_autoptr (GError) error = NULL;
 
+  if (!(flags & META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY) &&
+      cairo_region_is_empty (priv->damage))
+    return;
+
   now_us = g_get_monotonic_time ();
-  if (priv->video_format.max_framerate.num > 0 &&
+  min_interval_us = get_min_frame_interval_us (src);
+  if (min_interval_us > 0 &&
       priv->last_frame_timestamp_us != 0)
     {
-      int64_t min_interval_us;
       int64_t time_since_last_frame_us;
 
-      min_interval_us =
-        ((G_USEC_PER_SEC * priv->video_format.max_framerate.denom) /
-         priv->video_format.max_framerate.num);
-
       time_since_last_frame_us = now_us - priv->last_frame_timestamp_us;
       if (time_since_last_frame_us < min_interval_us)
         {
@@ -535,7 +1217,16 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc  *src,
 
   buffer = pw_stream_dequeue_buffer (priv->pipewire_stream);
   if (!buffer)
-    return;
+    {
+      throttle_frame_rate (src, now_us);
+
+      /* The damage is kept, record it once a buffer is available again */
+      if (!(flags & META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY))
+        maybe_schedule_follow_up_frame (src, get_min_frame_interval_us (src));
+      return;
+    }
+
+  relax_frame_rate_throttle (src);
 
   spa_buffer = buffer->buffer;
   data = spa_buffer->datas[0].data;
@@ -548,11 +1239,23 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc  *src,
 
   if (!(flags & META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY))
     {
+      MetaScreenCastBuffer *screen_cast_buffer = buffer->user_data;
+      cairo_region_t *damage;
+
       g_clear_handle_id (&priv->follow_up_frame_source_id, g_source_remove);
-      if (do_record_frame (src, spa_buffer, data, &error))
+
+      damage = take_frame_damage (src);
+      if (do_record_frame (src, buffer, data, &error))
         {
           struct spa_meta_region *spa_meta_video_crop;
 
+          if (screen_cast_buffer)
+            screen_cast_buffer->frame_seq = priv->frame_seq;
+          add_damage_metadata (src, spa_buffer, damage);
+
+          priv->last_recorded_frame_timestamp_us = now_us;
+          maybe_schedule_refresh_frame (src, REFRESH_INTERVAL_US);
+
           spa_buffer->datas[0].chunk->size = spa_buffer->datas[0].maxsize;
           spa_buffer->datas[0].chunk->stride = priv->video_stride;
 
@@ -582,11 +1285,23 @@ meta_screen_cast_stream_src_maybe_record_frame (MetaScreenCastStreamSrc  *src,
         {
           g_warning ("Failed to record screen cast frame: %s", error->message);
           spa_buffer->datas[0].chunk->size = 0;
+
+          if (screen_cast_buffer)
+            screen_cast_buffer->frame_seq = 0;
+
+          /* Nothing was delivered, report the damage with the next frame */
+          meta_screen_cast_stream_src_add_damage (src, damage);
         }
+
+      cairo_region_destroy (damage);
     }
   else
     {
+      cairo_region_t *no_damage = cairo_region_create ();
+
       spa_buffer->datas[0].chunk->size = 0;
+      add_damage_metadata (src, spa_buffer, no_damage);
+      cairo_region_destroy (no_damage);
     }
 
   maybe_record_cursor (src, spa_buffer);
@@ -611,6 +1326,12 @@ meta_screen_cast_stream_src_enable (MetaScreenCastStreamSrc *src)
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
 
+  /*
+   * Sources may record their first frame from enable(), which is dropped
+   * unless there is damage to record.
+   */
+  meta_screen_cast_stream_src_damage_all (src);
+
   META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src)->enable (src);
 
   priv->is_enabled = TRUE;
@@ -625,7 +1346,10 @@ meta_screen_cast_stream_src_disable (MetaScreenCastStreamSrc *src)
   META_SCREEN_CAST_STREAM_SRC_GET_CLASS (src)->disable (src);
 
   g_clear_handle_id (&priv->follow_up_frame_source_id, g_source_remove);
+  g_clear_handle_id (&priv->refresh_frame_source_id, g_source_remove);
 
+  priv->throttle_interval_us = 0;
+  priv->last_throttle_timestamp_us = 0;
   priv->is_enabled = FALSE;
 }
 
@@ -675,10 +1399,8 @@ on_stream_param_changed (void                 *data,
   MetaScreenCastStreamSrcPrivate *priv =
     meta_screen_cast_stream_src_get_instance_private (src);
   uint8_t params_buffer[1024];
-  int32_t width, height, stride, size;
   struct spa_pod_builder pod_builder;
-  const struct spa_pod *params[3];
-  const int bpp = 4;
+  const struct spa_pod *params[4];
 
   if (!format || id != SPA_PARAM_Format)
     return;
@@ -686,12 +1408,10 @@ on_stream_param_changed (void                 *data,
   spa_format_video_raw_parse (format,
                               &priv->video_format);
 
-  width = priv->video_format.size.width;
-  height = priv->video_format.size.height;
-  stride = SPA_ROUND_UP_N (width * bpp, 4);
-  size = height * stride;
+  clear_yuv_conversion (src);
+  update_plane_layout (src);
 
-  priv->video_stride = stride;
+  meta_screen_cast_stream_src_damage_all (src);
 
   pod_builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
 
@@ -700,8 +1420,8 @@ on_stream_param_changed (void                 *data,
     SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
     SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (16, 2, 16),
     SPA_PARAM_BUFFERS_blocks, SPA_POD_Int (1),
-    SPA_PARAM_BUFFERS_size, SPA_POD_Int (size),
-    SPA_PARAM_BUFFERS_stride, SPA_POD_Int (stride),
+    SPA_PARAM_BUFFERS_size, SPA_POD_Int (priv->frame_size),
+    SPA_PARAM_BUFFERS_stride, SPA_POD_Int (priv->video_stride),
     SPA_PARAM_BUFFERS_align, SPA_POD_Int (16));
 
   params[1] = spa_pod_builder_add_object (
@@ -716,6 +1436,15 @@ on_stream_param_changed (void                 *data,
     SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Cursor),
     SPA_PARAM_META_size, SPA_POD_Int (CURSOR_META_SIZE (64, 64)));
 
+  params[3] = spa_pod_builder_add_object (
+    &pod_builder,
+    SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+    SPA_PARAM_META_type, SPA_POD_Id (SPA_META_VideoDamage),
+    SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int (
+      sizeof (struct spa_meta_region) * MAX_DAMAGE_RECTS,
+      sizeof (struct spa_meta_region) * 1,
+      sizeof (struct spa_meta_region) * MAX_DAMAGE_RECTS));
+
   pw_stream_update_params (priv->pipewire_stream, params, G_N_ELEMENTS (params));
 }
 
@@ -730,24 +1459,27 @@ on_stream_add_buffer (void             *data,
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
   CoglRenderer *renderer = cogl_context_get_renderer (context);
   g_autoptr (GError) error = NULL;
-  CoglDmaBufHandle *dmabuf_handle;
+  CoglDmaBufHandle *dmabuf_handle = NULL;
   struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = spa_buffer->datas;
-  const int bpp = 4;
-  int stride;
 
-  stride = SPA_ROUND_UP_N (priv->video_format.size.width * bpp, 4);
+  buffer->user_data = g_new0 (MetaScreenCastBuffer, 1);
 
   spa_data[0].mapoffset = 0;
-  spa_data[0].maxsize = stride * priv->video_format.size.height;
+  spa_data[0].maxsize = priv->frame_size;
 
-  dmabuf_handle = cogl_renderer_create_dma_buf (renderer,
-                                                priv->stream_width,
-                                                priv->stream_height,
-                                                &error);
+  /* Exported DMA buffers are single plane XRGB, YUV frames are read back
+   * from the GPU into shared memory instead */
+  if (!is_yuv_format (priv->video_format.format))
+    {
+      dmabuf_handle = cogl_renderer_create_dma_buf (renderer,
+                                                    priv->stream_width,
+                                                    priv->stream_height,
+                                                    &error);
 
-  if (error)
-    g_debug ("Error exporting DMA buffer handle: %s", error->message);
+      if (error)
+        g_debug ("Error exporting DMA buffer handle: %s", error->message);
+    }
 
   if (dmabuf_handle)
     {
@@ -775,7 +1507,7 @@ on_stream_add_buffer (void             *data,
           return;
         }
       spa_data[0].mapoffset = 0;
-      spa_data[0].maxsize = stride * priv->video_format.size.height;
+      spa_data[0].maxsize = priv->frame_size;
 
       if (ftruncate (spa_data[0].fd, spa_data[0].maxsize) < 0)
         {
@@ -811,6 +1543,8 @@ on_stream_remove_buffer (void             *data,
   struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = spa_buffer->datas;
 
+  g_clear_pointer (&buffer->user_data, g_free);
+
   if (spa_data[0].type == SPA_DATA_DmaBuf)
     {
       if (!g_hash_table_remove (priv->dmabuf_handles, GINT_TO_POINTER (spa_data[0].fd)))
@@ -876,7 +1610,11 @@ create_pipewire_stream (MetaScreenCastStreamSrc  *src,
     SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat,
     SPA_FORMAT_mediaType, SPA_POD_Id (SPA_MEDIA_TYPE_video),
     SPA_FORMAT_mediaSubtype, SPA_POD_Id (SPA_MEDIA_SUBTYPE_raw),
-    SPA_FORMAT_VIDEO_format, SPA_POD_Id (SPA_VIDEO_FORMAT_BGRx),
+    SPA_FORMAT_VIDEO_format, SPA_POD_CHOICE_ENUM_Id (4,
+                                                     SPA_VIDEO_FORMAT_BGRx,
+                                                     SPA_VIDEO_FORMAT_BGRx,
+                                                     SPA_VIDEO_FORMAT_NV12,
+                                                     SPA_VIDEO_FORMAT_I420),
     SPA_FORMAT_VIDEO_size, SPA_POD_Rectangle (&SPA_RECTANGLE (priv->stream_width,
                                                               priv->stream_height)),
     SPA_FORMAT_VIDEO_framerate, SPA_POD_Fraction (&SPA_FRACTION (0, 1)),
@@ -1074,8 +1812,12 @@ meta_screen_cast_stream_src_finalize (GObject *object)
   if (meta_screen_cast_stream_src_is_enabled (src))
     meta_screen_cast_stream_src_disable (src);
 
+  g_clear_handle_id (&priv->refresh_frame_source_id, g_source_remove);
   g_clear_pointer (&priv->pipewire_stream, pw_stream_destroy);
   g_clear_pointer (&priv->dmabuf_handles, g_hash_table_destroy);
+  clear_yuv_conversion (src);
+  g_clear_pointer (&priv->damage, cairo_region_destroy);
+  g_clear_pointer (&priv->damage_history, clutter_damage_history_free);
   g_clear_pointer (&priv->pipewire_core, pw_core_disconnect);
   g_clear_pointer (&priv->pipewire_context, pw_context_destroy);
   g_source_destroy (&priv->pipewire_source->base);
@@ -1133,6 +1875,8 @@ meta_screen_cast_stream_src_init (MetaScreenCastStreamSrc *src)
   priv->dmabuf_handles =
     g_hash_table_new_full (NULL, NULL, NULL,
                            (GDestroyNotify) cogl_dma_buf_handle_free);
+  priv->damage = cairo_region_create ();
+  priv->damage_history = clutter_damage_history_new ();
 }
 
 static void
@@ -37,6 +37,9 @@
 
 typedef struct _MetaScreenCastStream MetaScreenCastStream;
 
+/* see meta_screen_cast_stream_src_get_copy_rects() */
+#define META_SCREEN_CAST_MAX_COPY_RECTS 4
+
 typedef enum _MetaScreenCastRecordFlag
 {
   META_SCREEN_CAST_RECORD_FLAG_NONE = 0,
@@ -59,8 +62,10 @@ struct _MetaScreenCastStreamSrcClass
                       float                   *frame_rate);
   void (* enable) (MetaScreenCastStreamSrc *src);
   void (* disable) (MetaScreenCastStreamSrc *src);
+  /* copy_region is the part of data that is out of date, NULL if all of it */
   gboolean (* record_to_buffer) (MetaScreenCastStreamSrc  *src,
                                  uint8_t                  *data,
+                                 const cairo_region_t     *copy_region,
                                  GError                  **error);
   gboolean (* record_to_framebuffer) (MetaScreenCastStreamSrc  *src,
                                       CoglFramebuffer          *framebuffer,
@@ -80,6 +85,14 @@ gboolean meta_screen_cast_stream_src_pending_follow_up_frame (MetaScreenCastStre
 
 MetaScreenCastStream * meta_screen_cast_stream_src_get_stream (MetaScreenCastStreamSrc *src);
 
+void meta_screen_cast_stream_src_add_damage (MetaScreenCastStreamSrc *src,
+                                             const cairo_region_t    *damage);
+
+void meta_screen_cast_stream_src_damage_all (MetaScreenCastStreamSrc *src);
+
+int meta_screen_cast_stream_src_get_copy_rects (const cairo_region_t  *copy_region,
+                                                cairo_rectangle_int_t *rects);
+
 gboolean meta_screen_cast_stream_src_draw_cursor_into (MetaScreenCastStreamSrc  *src,
                                                        CoglTexture              *cursor_texture,
                                                        float                     scale,
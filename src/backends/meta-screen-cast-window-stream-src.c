@@ -40,6 +40,8 @@ struct _MetaScreenCastWindowStreamSrc
   unsigned long cursor_changed_handler_id;
 
   gboolean cursor_bitmap_invalid;
+
+  MetaRectangle last_buffer_bounds;
 };
 
 G_DEFINE_TYPE (MetaScreenCastWindowStreamSrc,
@@ -239,19 +241,40 @@ maybe_blit_cursor_sprite (MetaScreenCastWindowStreamSrc *window_src,
 
 static gboolean
 capture_into (MetaScreenCastWindowStreamSrc *window_src,
-              uint8_t                       *data)
+              uint8_t                       *data,
+              const cairo_region_t          *copy_region)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
   MetaRectangle stream_rect;
   MetaScreenCastStream *stream;
+  int stride;
 
   stream_rect.x = 0;
   stream_rect.y = 0;
   stream_rect.width = get_stream_width (window_src);
   stream_rect.height = get_stream_height (window_src);
+  stride = stream_rect.width * 4;
+
+  if (copy_region)
+    {
+      MetaRectangle copy_rect;
 
-  meta_screen_cast_window_capture_into (window_src->screen_cast_window,
-                                        &stream_rect, data);
+      cairo_region_get_extents (copy_region, &copy_rect);
+      if (meta_rectangle_intersect (&copy_rect, &stream_rect, &copy_rect))
+        {
+          meta_screen_cast_window_capture_into (window_src->screen_cast_window,
+                                                &copy_rect,
+                                                data +
+                                                copy_rect.y * stride +
+                                                copy_rect.x * 4,
+                                                stride);
+        }
+    }
+  else
+    {
+      meta_screen_cast_window_capture_into (window_src->screen_cast_window,
+                                            &stream_rect, data, stride);
+    }
 
   stream = meta_screen_cast_stream_src_get_stream (src);
   switch (meta_screen_cast_stream_get_cursor_mode (stream))
@@ -327,9 +350,32 @@ screen_cast_window_damaged (MetaWindowActor               *actor,
                             MetaScreenCastWindowStreamSrc *window_src)
 {
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (window_src);
+  MetaScreenCastWindow *screen_cast_window = window_src->screen_cast_window;
+  MetaScreenCastStream *stream;
+  const cairo_region_t *damage;
+  MetaRectangle buffer_bounds;
   MetaScreenCastRecordFlag flags;
 
-  flags = META_SCREEN_CAST_RECORD_FLAG_CURSOR_ONLY;
+  stream = meta_screen_cast_stream_src_get_stream (src);
+  damage = meta_screen_cast_window_get_damage (screen_cast_window);
+  meta_screen_cast_window_get_buffer_bounds (screen_cast_window,
+                                             &buffer_bounds);
+
+  /*
+   * An embedded cursor may have moved anywhere since the last frame, and a
+   * resized window moves everything around.
+   */
+  if (!damage ||
+      meta_screen_cast_stream_get_cursor_mode (stream) ==
+      META_SCREEN_CAST_CURSOR_MODE_EMBEDDED ||
+      !meta_rectangle_equal (&buffer_bounds, &window_src->last_buffer_bounds))
+    meta_screen_cast_stream_src_damage_all (src);
+  else
+    meta_screen_cast_stream_src_add_damage (src, damage);
+
+  window_src->last_buffer_bounds = buffer_bounds;
+
+  flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
   meta_screen_cast_stream_src_maybe_record_frame (src, flags);
 }
 
@@ -387,6 +433,8 @@ meta_screen_cast_window_stream_src_enable (MetaScreenCastStreamSrc *src)
     return;
 
   window_src->screen_cast_window = META_SCREEN_CAST_WINDOW (window_actor);
+  meta_screen_cast_window_get_buffer_bounds (window_src->screen_cast_window,
+                                             &window_src->last_buffer_bounds);
 
   window_src->screen_cast_window_damaged_handler_id =
     g_signal_connect (window_src->screen_cast_window,
@@ -434,12 +482,13 @@ meta_screen_cast_window_stream_src_disable (MetaScreenCastStreamSrc *src)
 static gboolean
 meta_screen_cast_window_stream_src_record_to_buffer (MetaScreenCastStreamSrc  *src,
                                                      uint8_t                  *data,
+                                                     const cairo_region_t     *copy_region,
                                                      GError                  **error)
 {
   MetaScreenCastWindowStreamSrc *window_src =
     META_SCREEN_CAST_WINDOW_STREAM_SRC (src);
 
-  capture_into (window_src, data);
+  capture_into (window_src, data, copy_region);
 
   return TRUE;
 }
@@ -71,11 +71,13 @@ meta_screen_cast_window_transform_cursor_position (MetaScreenCastWindow *screen_
 void
 meta_screen_cast_window_capture_into (MetaScreenCastWindow *screen_cast_window,
                                       MetaRectangle        *bounds,
-                                      uint8_t              *data)
+                                      uint8_t              *data,
+                                      int                   stride)
 {
   META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window)->capture_into (screen_cast_window,
                                                                         bounds,
-                                                                        data);
+                                                                        data,
+                                                                        stride);
 }
 
 gboolean
@@ -97,3 +99,19 @@ meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window)
 
   return iface->has_damage (screen_cast_window);
 }
+
+/*
+ * The damage reported with the current "damaged" emission, in buffer
+ * coordinates, or NULL if it is unknown.
+ */
+const cairo_region_t *
+meta_screen_cast_window_get_damage (MetaScreenCastWindow *screen_cast_window)
+{
+  MetaScreenCastWindowInterface *iface =
+    META_SCREEN_CAST_WINDOW_GET_IFACE (screen_cast_window);
+
+  if (!iface->get_damage)
+    return NULL;
+
+  return iface->get_damage (screen_cast_window);
+}
@@ -22,6 +22,7 @@
 #define META_SCREEN_CAST_WINDOW_H
 
 #include <stdint.h>
+#include <cairo.h>
 #include <glib-object.h>
 
 #include "backends/meta-cursor.h"
@@ -54,13 +55,16 @@ struct _MetaScreenCastWindowInterface
 
   void (*capture_into) (MetaScreenCastWindow *screen_cast_window,
                         MetaRectangle        *bounds,
-                        uint8_t              *data);
+                        uint8_t              *data,
+                        int                   stride);
 
   gboolean (*blit_to_framebuffer) (MetaScreenCastWindow *screen_cast_window,
                                    MetaRectangle        *bounds,
                                    CoglFramebuffer      *framebuffer);
 
   gboolean (*has_damage) (MetaScreenCastWindow *screen_cast_window);
+
+  const cairo_region_t * (*get_damage) (MetaScreenCastWindow *screen_cast_window);
 };
 
 void meta_screen_cast_window_get_buffer_bounds (MetaScreenCastWindow *screen_cast_window,
@@ -80,7 +84,8 @@ gboolean meta_screen_cast_window_transform_cursor_position (MetaScreenCastWindow
 
 void meta_screen_cast_window_capture_into (MetaScreenCastWindow *screen_cast_window,
                                            MetaRectangle        *bounds,
-                                           uint8_t              *data);
+                                           uint8_t              *data,
+                                           int                   stride);
 
 gboolean meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                                       MetaRectangle        *bounds,
@@ -88,6 +93,8 @@ gboolean meta_screen_cast_window_blit_to_framebuffer (MetaScreenCastWindow *scre
 
 gboolean meta_screen_cast_window_has_damage (MetaScreenCastWindow *screen_cast_window);
 
+const cairo_region_t * meta_screen_cast_window_get_damage (MetaScreenCastWindow *screen_cast_window);
+
 G_END_DECLS
 
 #endif /* META_SCREEN_CAST_WINDOW_H */
@@ -32,7 +32,7 @@
 
 #define META_SCREEN_CAST_DBUS_SERVICE "org.cinnamon.Muffin.ScreenCast"
 #define META_SCREEN_CAST_DBUS_PATH "/org/cinnamon/Muffin/ScreenCast"
-#define META_SCREEN_CAST_API_VERSION 3
+#define META_SCREEN_CAST_API_VERSION 4
 
 struct _MetaScreenCast
 {
@@ -42,6 +42,9 @@ struct _MetaScreenCast
 
   GList *sessions;
 
+  /* Monitor captures shared between the streams of all sessions */
+  GList *monitor_captures;
+
   MetaDbusSessionWatcher *session_watcher;
   MetaBackend *backend;
 };
@@ -69,6 +72,49 @@ meta_screen_cast_get_backend (MetaScreenCast *screen_cast)
   return screen_cast->backend;
 }
 
+static void
+on_monitor_capture_finalized (gpointer  user_data,
+                              GObject  *where_the_object_was)
+{
+  MetaScreenCast *screen_cast = user_data;
+
+  screen_cast->monitor_captures =
+    g_list_remove (screen_cast->monitor_captures, where_the_object_was);
+}
+
+/*
+ * Returns a new reference to the capture of @monitor painted in
+ * @watch_phase, creating it if no other stream is casting it already.
+ */
+MetaScreenCastMonitorCapture *
+meta_screen_cast_get_monitor_capture (MetaScreenCast      *screen_cast,
+                                      MetaMonitor         *monitor,
+                                      MetaStageWatchPhase  watch_phase)
+{
+  MetaScreenCastMonitorCapture *capture;
+  GList *l;
+
+  for (l = screen_cast->monitor_captures; l; l = l->next)
+    {
+      capture = l->data;
+
+      if (meta_screen_cast_monitor_capture_get_monitor (capture) == monitor &&
+          meta_screen_cast_monitor_capture_get_watch_phase (capture) == watch_phase)
+        return g_object_ref (capture);
+    }
+
+  capture = meta_screen_cast_monitor_capture_new (screen_cast->backend,
+                                                  monitor,
+                                                  watch_phase);
+  g_object_weak_ref (G_OBJECT (capture),
+                     on_monitor_capture_finalized,
+                     screen_cast);
+  screen_cast->monitor_captures =
+    g_list_prepend (screen_cast->monitor_captures, capture);
+
+  return capture;
+}
+
 static gboolean
 register_remote_desktop_screen_cast_session (MetaScreenCastSession  *session,
                                              const char             *remote_desktop_session_id,
@@ -257,6 +303,16 @@ meta_screen_cast_finalize (GObject *object)
       meta_screen_cast_session_close (session);
     }
 
+  while (screen_cast->monitor_captures)
+    {
+      GObject *capture = screen_cast->monitor_captures->data;
+
+      g_object_weak_unref (capture, on_monitor_capture_finalized, screen_cast);
+      screen_cast->monitor_captures =
+        g_list_delete_link (screen_cast->monitor_captures,
+                            screen_cast->monitor_captures);
+    }
+
   G_OBJECT_CLASS (meta_screen_cast_parent_class)->finalize (object);
 }
 
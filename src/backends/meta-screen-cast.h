@@ -27,6 +27,7 @@
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-dbus-session-watcher.h"
+#include "backends/meta-screen-cast-monitor-capture.h"
 
 #include "meta-dbus-screen-cast.h"
 
@@ -46,6 +47,10 @@ GDBusConnection * meta_screen_cast_get_connection (MetaScreenCast *screen_cast);
 
 MetaBackend * meta_screen_cast_get_backend (MetaScreenCast *screen_cast);
 
+MetaScreenCastMonitorCapture * meta_screen_cast_get_monitor_capture (MetaScreenCast      *screen_cast,
+                                                                     MetaMonitor         *monitor,
+                                                                     MetaStageWatchPhase  watch_phase);
+
 MetaScreenCast * meta_screen_cast_new (MetaBackend            *backend,
                                        MetaDbusSessionWatcher *session_watcher);
 
@@ -54,6 +54,9 @@ void              meta_stage_update_cursor_overlay   (MetaStage       *stage,
                                                       CoglTexture     *texture,
                                                       graphene_rect_t *rect);
 
+gboolean meta_stage_has_overlays_in_rect (MetaStage             *stage,
+                                          const graphene_rect_t *rect);
+
 void meta_stage_set_active (MetaStage *stage,
                             gboolean   is_active);
 
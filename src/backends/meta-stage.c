@@ -387,6 +387,30 @@ meta_stage_update_cursor_overlay (MetaStage       *stage,
   queue_redraw_for_overlay (stage, overlay);
 }
 
+/*
+ * Checks whether any overlay, e.g. the cursor when it isn't shown on a
+ * hardware plane, is painted over @rect.
+ */
+gboolean
+meta_stage_has_overlays_in_rect (MetaStage             *stage,
+                                 const graphene_rect_t *rect)
+{
+  GList *l;
+
+  for (l = stage->overlays; l; l = l->next)
+    {
+      MetaOverlay *overlay = l->data;
+
+      if (!overlay->enabled)
+        continue;
+
+      if (graphene_rect_intersection (&overlay->current_rect, rect, NULL))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 meta_stage_set_active (MetaStage *stage,
                        gboolean   is_active)
@@ -337,6 +337,19 @@ meta_backend_native_create_clutter_backend (MetaBackend *backend)
   return g_object_new (META_TYPE_CLUTTER_BACKEND_NATIVE, NULL);
 }
 
+static void
+on_pointer_predicted (float    x,
+                      float    y,
+                      gpointer user_data)
+{
+  MetaBackend *backend = user_data;
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+
+  meta_cursor_renderer_native_predict_position (META_CURSOR_RENDERER_NATIVE (cursor_renderer),
+                                                x, y);
+}
+
 static void
 meta_backend_native_post_init (MetaBackend *backend)
 {
@@ -353,6 +366,10 @@ meta_backend_native_post_init (MetaBackend *backend)
 
   META_BACKEND_CLASS (meta_backend_native_parent_class)->post_init (backend);
 
+  meta_seat_native_set_pointer_prediction_callback (META_SEAT_NATIVE (seat),
+                                                    on_pointer_predicted,
+                                                    backend);
+
   if (meta_settings_is_experimental_feature_enabled (settings,
                                                      META_EXPERIMENTAL_FEATURE_RT_SCHEDULER))
     {
@@ -30,6 +30,7 @@
 #include <string.h>
 #include <gbm.h>
 #include <xf86drm.h>
+#include <xf86drmMode.h>
 #include <errno.h>
 
 #include "backends/meta-backend-private.h"
@@ -87,6 +88,10 @@
 #define HW_CURSOR_SLOW_UPDATE_US 25000
 #define HW_CURSOR_MAX_SLOW_UPDATES 5
 
+/* Number of scaled and transformed cursor images kept ready for scanout per
+ * GPU, enough for the frames of common animated cursors. */
+#define HW_CURSOR_CACHE_SIZE 64
+
 static GQuark quark_cursor_sprite = 0;
 
 struct _MetaCursorRendererNative
@@ -94,6 +99,31 @@ struct _MetaCursorRendererNative
   MetaCursorRenderer parent;
 };
 
+/*
+ * Where the hardware cursor is shown on a CRTC, so that it can be moved
+ * from the input thread. See meta_cursor_renderer_native_predict_position().
+ */
+typedef struct _CrtcCursorPrediction
+{
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsPlane *cursor_plane;
+  uint32_t fb_id;
+  uint32_t bo_handle;
+  int cursor_width;
+  int cursor_height;
+
+  /* the CRTC in stage coordinates */
+  graphene_rect_t crtc_rect;
+  float scale;
+  MetaMonitorTransform inverted_transform;
+  int crtc_mode_width;
+  int crtc_mode_height;
+  int cursor_rect_width;
+  int cursor_rect_height;
+
+  gboolean visible;
+} CrtcCursorPrediction;
+
 struct _MetaCursorRendererNativePrivate
 {
   MetaBackend *backend;
@@ -103,9 +133,43 @@ struct _MetaCursorRendererNativePrivate
 
   MetaCursorSprite *last_cursor;
   guint animation_timeout_id;
+
+  /* protects the fields below, used from the input thread */
+  GMutex prediction_mutex;
+  GArray *crtc_predictions;
+  graphene_point_t prediction_offset;
+  graphene_size_t prediction_size;
 };
 typedef struct _MetaCursorRendererNativePrivate MetaCursorRendererNativePrivate;
 
+typedef struct _MetaCursorBo
+{
+  grefcount ref_count;
+  struct gbm_bo *bo;
+  int width;
+  int height;
+
+  /* for cursor planes driven through atomic KMS, 0 if none could be added */
+  int fd;
+  uint32_t fb_id;
+} MetaCursorBo;
+
+typedef struct _MetaCursorBoCacheKey
+{
+  MetaCursorSprite *cursor_sprite;
+  unsigned int content_serial;
+  int frame;
+  float scale;
+  MetaMonitorTransform transform;
+} MetaCursorBoCacheKey;
+
+typedef struct _MetaCursorBoCacheEntry
+{
+  MetaCursorBoCacheKey key;
+  MetaCursorBo *cursor_bo;
+  GList link;
+} MetaCursorBoCacheEntry;
+
 typedef struct _MetaCursorRendererNativeGpuData
 {
   gboolean hw_cursor_broken;
@@ -115,6 +179,11 @@ typedef struct _MetaCursorRendererNativeGpuData
 
   gboolean uploaded_in_update;
   int consecutive_slow_updates;
+
+  /* Cursor images uploaded for the sprites, scales and transforms seen
+   * lately, most recently used first in bo_cache_lru */
+  GHashTable *bo_cache;
+  GQueue bo_cache_lru;
 } MetaCursorRendererNativeGpuData;
 
 typedef enum _MetaCursorGbmBoState
@@ -129,15 +198,17 @@ typedef struct _MetaCursorNativeGpuState
   MetaGpu *gpu;
   guint active_bo;
   MetaCursorGbmBoState pending_bo_state;
-  struct gbm_bo *bos[HW_CURSOR_BUFFER_COUNT];
-  int widths[HW_CURSOR_BUFFER_COUNT];
-  int heights[HW_CURSOR_BUFFER_COUNT];
+  MetaCursorBo *bos[HW_CURSOR_BUFFER_COUNT];
 } MetaCursorNativeGpuState;
 
 typedef struct _MetaCursorNativePrivate
 {
+  MetaCursorSprite *cursor_sprite;
   GHashTable *gpu_states;
 
+  /* bumped when the contents of a sprite without frames change */
+  unsigned int content_serial;
+
   struct {
     gboolean can_preprocess;
     float current_relative_scale;
@@ -178,16 +249,182 @@ meta_cursor_renderer_native_gpu_data_from_gpu (MetaGpuKms *gpu_kms)
                              quark_cursor_renderer_native_gpu_data);
 }
 
+static MetaCursorBo *
+meta_cursor_bo_new_take (MetaGpuKms    *gpu_kms,
+                         struct gbm_bo *bo,
+                         int            width,
+                         int            height)
+{
+  MetaCursorBo *cursor_bo;
+  uint32_t handles[4] = { 0 };
+  uint32_t strides[4] = { 0 };
+  uint32_t offsets[4] = { 0 };
+
+  cursor_bo = g_new0 (MetaCursorBo, 1);
+  g_ref_count_init (&cursor_bo->ref_count);
+  cursor_bo->bo = bo;
+  cursor_bo->width = width;
+  cursor_bo->height = height;
+  cursor_bo->fd = meta_gpu_kms_get_fd (gpu_kms);
+
+  handles[0] = gbm_bo_get_handle (bo).u32;
+  strides[0] = gbm_bo_get_stride (bo);
+
+  if (drmModeAddFB2 (cursor_bo->fd,
+                     gbm_bo_get_width (bo),
+                     gbm_bo_get_height (bo),
+                     gbm_bo_get_format (bo),
+                     handles,
+                     strides,
+                     offsets,
+                     &cursor_bo->fb_id,
+                     0) != 0)
+    cursor_bo->fb_id = 0;
+
+  return cursor_bo;
+}
+
+static MetaCursorBo *
+meta_cursor_bo_ref (MetaCursorBo *cursor_bo)
+{
+  g_ref_count_inc (&cursor_bo->ref_count);
+  return cursor_bo;
+}
+
+static void
+meta_cursor_bo_unref (MetaCursorBo *cursor_bo)
+{
+  if (g_ref_count_dec (&cursor_bo->ref_count))
+    {
+      if (cursor_bo->fb_id)
+        drmModeRmFB (cursor_bo->fd, cursor_bo->fb_id);
+      gbm_bo_destroy (cursor_bo->bo);
+      g_free (cursor_bo);
+    }
+}
+
+static guint
+cursor_bo_cache_key_hash (gconstpointer data)
+{
+  const MetaCursorBoCacheKey *key = data;
+
+  return (g_direct_hash (key->cursor_sprite) ^
+          (key->content_serial * 31) ^
+          (key->frame << 8) ^
+          ((guint) (key->scale * 1000) << 16) ^
+          key->transform);
+}
+
+static gboolean
+cursor_bo_cache_key_equal (gconstpointer a,
+                           gconstpointer b)
+{
+  const MetaCursorBoCacheKey *key_a = a;
+  const MetaCursorBoCacheKey *key_b = b;
+
+  return (key_a->cursor_sprite == key_b->cursor_sprite &&
+          key_a->content_serial == key_b->content_serial &&
+          key_a->frame == key_b->frame &&
+          key_a->scale == key_b->scale &&
+          key_a->transform == key_b->transform);
+}
+
+static void
+cursor_bo_cache_entry_free (MetaCursorBoCacheEntry *entry)
+{
+  meta_cursor_bo_unref (entry->cursor_bo);
+  g_free (entry);
+}
+
+static void
+cursor_bo_cache_remove_entry (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                              MetaCursorBoCacheEntry          *entry)
+{
+  g_queue_unlink (&cursor_renderer_gpu_data->bo_cache_lru, &entry->link);
+  g_hash_table_remove (cursor_renderer_gpu_data->bo_cache, &entry->key);
+}
+
+static MetaCursorBo *
+cursor_bo_cache_lookup (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                        const MetaCursorBoCacheKey      *key)
+{
+  MetaCursorBoCacheEntry *entry;
+
+  entry = g_hash_table_lookup (cursor_renderer_gpu_data->bo_cache, key);
+  if (!entry)
+    return NULL;
+
+  g_queue_unlink (&cursor_renderer_gpu_data->bo_cache_lru, &entry->link);
+  g_queue_push_head_link (&cursor_renderer_gpu_data->bo_cache_lru,
+                          &entry->link);
+
+  return entry->cursor_bo;
+}
+
+static void
+cursor_bo_cache_insert (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                        const MetaCursorBoCacheKey      *key,
+                        MetaCursorBo                    *cursor_bo)
+{
+  MetaCursorBoCacheEntry *entry;
+
+  while (cursor_renderer_gpu_data->bo_cache_lru.length >= HW_CURSOR_CACHE_SIZE)
+    {
+      GList *oldest = g_queue_peek_tail_link (&cursor_renderer_gpu_data->bo_cache_lru);
+
+      cursor_bo_cache_remove_entry (cursor_renderer_gpu_data, oldest->data);
+    }
+
+  entry = g_new0 (MetaCursorBoCacheEntry, 1);
+  entry->key = *key;
+  entry->cursor_bo = meta_cursor_bo_ref (cursor_bo);
+  entry->link.data = entry;
+
+  g_hash_table_insert (cursor_renderer_gpu_data->bo_cache, &entry->key, entry);
+  g_queue_push_head_link (&cursor_renderer_gpu_data->bo_cache_lru,
+                          &entry->link);
+}
+
+static void
+cursor_bo_cache_remove_sprite (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                               MetaCursorSprite                *cursor_sprite)
+{
+  GList *l;
+
+  l = cursor_renderer_gpu_data->bo_cache_lru.head;
+  while (l)
+    {
+      MetaCursorBoCacheEntry *entry = l->data;
+
+      l = l->next;
+      if (entry->key.cursor_sprite == cursor_sprite)
+        cursor_bo_cache_remove_entry (cursor_renderer_gpu_data, entry);
+    }
+}
+
+static void
+meta_cursor_renderer_native_gpu_data_free (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  g_hash_table_destroy (cursor_renderer_gpu_data->bo_cache);
+  g_free (cursor_renderer_gpu_data);
+}
+
 static MetaCursorRendererNativeGpuData *
 meta_create_cursor_renderer_native_gpu_data (MetaGpuKms *gpu_kms)
 {
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
 
   cursor_renderer_gpu_data = g_new0 (MetaCursorRendererNativeGpuData, 1);
+  cursor_renderer_gpu_data->bo_cache =
+    g_hash_table_new_full (cursor_bo_cache_key_hash,
+                           cursor_bo_cache_key_equal,
+                           NULL,
+                           (GDestroyNotify) cursor_bo_cache_entry_free);
+  g_queue_init (&cursor_renderer_gpu_data->bo_cache_lru);
   g_object_set_qdata_full (G_OBJECT (gpu_kms),
                            quark_cursor_renderer_native_gpu_data,
                            cursor_renderer_gpu_data,
-                           g_free);
+                           (GDestroyNotify) meta_cursor_renderer_native_gpu_data_free);
 
   return cursor_renderer_gpu_data;
 }
@@ -201,6 +438,9 @@ meta_cursor_renderer_native_finalize (GObject *object)
 
   g_clear_handle_id (&priv->animation_timeout_id, g_source_remove);
 
+  g_clear_pointer (&priv->crtc_predictions, g_array_unref);
+  g_mutex_clear (&priv->prediction_mutex);
+
   G_OBJECT_CLASS (meta_cursor_renderer_native_parent_class)->finalize (object);
 }
 
@@ -210,7 +450,7 @@ get_pending_cursor_sprite_gbm_bo_index (MetaCursorNativeGpuState *cursor_gpu_sta
   return (cursor_gpu_state->active_bo + 1) % HW_CURSOR_BUFFER_COUNT;
 }
 
-static struct gbm_bo *
+static MetaCursorBo *
 get_pending_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state)
 {
   guint pending_bo;
@@ -219,7 +459,7 @@ get_pending_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state)
   return cursor_gpu_state->bos[pending_bo];
 }
 
-static struct gbm_bo *
+static MetaCursorBo *
 get_active_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state)
 {
   return cursor_gpu_state->bos[cursor_gpu_state->active_bo];
@@ -228,9 +468,7 @@ get_active_cursor_sprite_gbm_bo (MetaCursorNativeGpuState *cursor_gpu_state)
 static void
 set_pending_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
                                   MetaGpuKms       *gpu_kms,
-                                  struct gbm_bo    *bo,
-                                  int               width,
-                                  int               height)
+                                  MetaCursorBo     *cursor_bo)
 {
   MetaCursorNativePrivate *cursor_priv;
   MetaCursorNativeGpuState *cursor_gpu_state;
@@ -240,9 +478,8 @@ set_pending_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
   cursor_gpu_state = ensure_cursor_gpu_state (cursor_priv, gpu_kms);
 
   pending_bo = get_pending_cursor_sprite_gbm_bo_index (cursor_gpu_state);
-  cursor_gpu_state->bos[pending_bo] = bo;
-  cursor_gpu_state->widths[pending_bo] = width;
-  cursor_gpu_state->heights[pending_bo] = height;
+  g_clear_pointer (&cursor_gpu_state->bos[pending_bo], meta_cursor_bo_unref);
+  cursor_gpu_state->bos[pending_bo] = cursor_bo;
   cursor_gpu_state->pending_bo_state = META_CURSOR_GBM_BO_STATE_SET;
 }
 
@@ -277,7 +514,8 @@ set_crtc_cursor (MetaCursorRendererNative *native,
                  MetaCrtc                 *crtc,
                  int                       x,
                  int                       y,
-                 MetaCursorSprite         *cursor_sprite)
+                 MetaCursorSprite         *cursor_sprite,
+                 CrtcCursorPrediction     *prediction)
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
@@ -288,7 +526,7 @@ set_crtc_cursor (MetaCursorRendererNative *native,
   MetaKmsCrtc *kms_crtc;
   MetaKmsDevice *kms_device;
   MetaKmsPlane *cursor_plane;
-  struct gbm_bo *bo;
+  MetaCursorBo *cursor_bo;
   union gbm_bo_handle handle;
   int cursor_width, cursor_height;
   MetaFixed16Rectangle src_rect;
@@ -299,27 +537,19 @@ set_crtc_cursor (MetaCursorRendererNative *native,
   MetaKmsPlaneAssignment *plane_assignment;
 
   if (cursor_gpu_state->pending_bo_state == META_CURSOR_GBM_BO_STATE_SET)
-    {
-      guint pending_bo;
-
-      pending_bo = get_pending_cursor_sprite_gbm_bo_index (cursor_gpu_state);
-      bo = get_pending_cursor_sprite_gbm_bo (cursor_gpu_state);
-      cursor_width = cursor_gpu_state->widths[pending_bo];
-      cursor_height = cursor_gpu_state->heights[pending_bo];
-    }
+    cursor_bo = get_pending_cursor_sprite_gbm_bo (cursor_gpu_state);
   else
-    {
-      bo = get_active_cursor_sprite_gbm_bo (cursor_gpu_state);
-      cursor_width = cursor_gpu_state->widths[cursor_gpu_state->active_bo];
-      cursor_height = cursor_gpu_state->heights[cursor_gpu_state->active_bo];
-    }
+    cursor_bo = get_active_cursor_sprite_gbm_bo (cursor_gpu_state);
+
+  cursor_width = cursor_bo->width;
+  cursor_height = cursor_bo->height;
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc);
   kms_device = meta_kms_crtc_get_device (kms_crtc);
   cursor_plane = meta_kms_device_get_cursor_plane_for (kms_device, kms_crtc);
   g_return_if_fail (cursor_plane);
 
-  handle = gbm_bo_get_handle (bo);
+  handle = gbm_bo_get_handle (cursor_bo->bo);
 
   src_rect = (MetaFixed16Rectangle) {
     .x = meta_fixed_16_from_int (0),
@@ -335,7 +565,8 @@ set_crtc_cursor (MetaCursorRendererNative *native,
   };
 
   flags = META_KMS_ASSIGN_PLANE_FLAG_NONE;
-  if (!priv->hw_state_invalidated && bo == crtc->cursor_renderer_private)
+  if (!priv->hw_state_invalidated &&
+      cursor_bo == crtc->cursor_renderer_private)
     flags |= META_KMS_ASSIGN_PLANE_FLAG_FB_UNCHANGED;
 
   if (!(flags & META_KMS_ASSIGN_PLANE_FLAG_FB_UNCHANGED))
@@ -351,7 +582,7 @@ set_crtc_cursor (MetaCursorRendererNative *native,
   plane_assignment = meta_kms_update_assign_plane (kms_update,
                                                    kms_crtc,
                                                    cursor_plane,
-                                                   handle.u32,
+                                                   cursor_bo->fb_id,
                                                    src_rect,
                                                    dst_rect,
                                                    flags);
@@ -362,10 +593,20 @@ set_crtc_cursor (MetaCursorRendererNative *native,
   meta_kms_plane_assignment_set_cursor_hotspot (plane_assignment,
                                                 cursor_hotspot_x,
                                                 cursor_hotspot_y);
+  meta_kms_plane_assignment_set_cursor_bo_handle (plane_assignment,
+                                                  handle.u32);
 
-  crtc->cursor_renderer_private = bo;
+  crtc->cursor_renderer_private = cursor_bo;
   crtc->cursor_renderer_active = TRUE;
 
+  prediction->kms_crtc = kms_crtc;
+  prediction->cursor_plane = cursor_plane;
+  prediction->fb_id = cursor_bo->fb_id;
+  prediction->bo_handle = handle.u32;
+  prediction->cursor_width = cursor_width;
+  prediction->cursor_height = cursor_height;
+  prediction->visible = TRUE;
+
   if (cursor_gpu_state->pending_bo_state == META_CURSOR_GBM_BO_STATE_SET)
     {
       cursor_gpu_state->active_bo =
@@ -423,6 +664,7 @@ typedef struct
   MetaKmsUpdate *in_kms_update;
 
   gboolean out_painted;
+  GArray *out_predictions;
 } UpdateCrtcCursorData;
 
 static gboolean
@@ -440,6 +682,7 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
   MetaCrtc *crtc;
   MetaMonitorTransform transform;
   graphene_rect_t scaled_crtc_rect;
+  CrtcCursorPrediction prediction;
   float scale;
   int crtc_x, crtc_y;
   int crtc_width, crtc_height;
@@ -481,6 +724,20 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
 
   crtc = meta_output_get_assigned_crtc (monitor_crtc_mode->output);
 
+  prediction = (CrtcCursorPrediction) {
+    .crtc_rect = (graphene_rect_t) {
+      .origin = {
+        .x = data->in_logical_monitor->rect.x + scaled_crtc_rect.origin.x,
+        .y = data->in_logical_monitor->rect.y + scaled_crtc_rect.origin.y
+      },
+      .size = scaled_crtc_rect.size
+    },
+    .scale = scale,
+    .inverted_transform = meta_monitor_transform_invert (transform),
+    .crtc_mode_width = monitor_crtc_mode->crtc_mode->width,
+    .crtc_mode_height = monitor_crtc_mode->crtc_mode->height,
+  };
+
   if (priv->has_hw_cursor &&
       graphene_rect_intersection (&scaled_crtc_rect,
                                   &data->in_local_cursor_rect,
@@ -512,6 +769,8 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
         .width = roundf (tex_width * cursor_crtc_scale),
         .height = roundf (tex_height * cursor_crtc_scale)
       };
+      prediction.cursor_rect_width = cursor_rect.width;
+      prediction.cursor_rect_height = cursor_rect.height;
 
       inverted_transform = meta_monitor_transform_invert (transform);
       meta_rectangle_transform (&cursor_rect,
@@ -525,7 +784,8 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
                        crtc,
                        cursor_rect.x,
                        cursor_rect.y,
-                       data->in_cursor_sprite);
+                       data->in_cursor_sprite,
+                       &prediction);
 
       data->out_painted = data->out_painted || TRUE;
     }
@@ -536,6 +796,8 @@ update_monitor_crtc_cursor (MetaMonitor         *monitor,
                          crtc);
     }
 
+  g_array_append_val (data->out_predictions, prediction);
+
   return TRUE;
 }
 
@@ -619,6 +881,15 @@ update_hw_cursor (MetaCursorRendererNative *native,
   gboolean painted = FALSE;
   int64_t post_start_us;
   g_autoptr (MetaKmsFeedback) feedback = NULL;
+  g_autoptr (GArray) predictions = NULL;
+
+  /* Wait for any move from the input thread to be done, so that it doesn't
+   * land after this update */
+  g_mutex_lock (&priv->prediction_mutex);
+  g_clear_pointer (&priv->crtc_predictions, g_array_unref);
+  g_mutex_unlock (&priv->prediction_mutex);
+
+  predictions = g_array_new (FALSE, FALSE, sizeof (CrtcCursorPrediction));
 
   kms_update = meta_kms_ensure_pending_update (kms);
 
@@ -648,6 +919,7 @@ update_hw_cursor (MetaCursorRendererNative *native,
         },
         .in_cursor_sprite = cursor_sprite,
         .in_kms_update = kms_update,
+        .out_predictions = predictions,
       };
 
       monitors = meta_logical_monitor_get_monitors (logical_monitor);
@@ -692,10 +964,148 @@ update_hw_cursor (MetaCursorRendererNative *native,
 
   priv->hw_state_invalidated = FALSE;
 
+  if (painted && priv->has_hw_cursor)
+    {
+      graphene_point_t position = meta_cursor_renderer_get_position (renderer);
+
+      g_mutex_lock (&priv->prediction_mutex);
+      priv->crtc_predictions = g_steal_pointer (&predictions);
+      priv->prediction_offset = (graphene_point_t) {
+        .x = rect.origin.x - position.x,
+        .y = rect.origin.y - position.y
+      };
+      priv->prediction_size = rect.size;
+      g_mutex_unlock (&priv->prediction_mutex);
+    }
+
   if (painted)
     meta_cursor_renderer_emit_painted (renderer, cursor_sprite);
 }
 
+static gboolean
+assign_predicted_cursor (CrtcCursorPrediction  *prediction,
+                         const graphene_rect_t *cursor_rect,
+                         MetaKmsUpdate         *kms_update)
+{
+  MetaRectangle crtc_cursor_rect;
+  MetaFixed16Rectangle src_rect;
+  MetaFixed16Rectangle dst_rect;
+  MetaKmsPlaneAssignment *plane_assignment;
+  gboolean visible;
+
+  visible = graphene_rect_intersection (&prediction->crtc_rect,
+                                        cursor_rect,
+                                        NULL);
+
+  /* Showing or hiding the cursor on a CRTC is left to the main thread */
+  if (visible != prediction->visible)
+    return FALSE;
+
+  if (!visible)
+    return TRUE;
+
+  crtc_cursor_rect = (MetaRectangle) {
+    .x = floorf ((cursor_rect->origin.x - prediction->crtc_rect.origin.x) *
+                 prediction->scale),
+    .y = floorf ((cursor_rect->origin.y - prediction->crtc_rect.origin.y) *
+                 prediction->scale),
+    .width = prediction->cursor_rect_width,
+    .height = prediction->cursor_rect_height
+  };
+  meta_rectangle_transform (&crtc_cursor_rect,
+                            prediction->inverted_transform,
+                            prediction->crtc_mode_width,
+                            prediction->crtc_mode_height,
+                            &crtc_cursor_rect);
+
+  src_rect = (MetaFixed16Rectangle) {
+    .x = meta_fixed_16_from_int (0),
+    .y = meta_fixed_16_from_int (0),
+    .width = meta_fixed_16_from_int (prediction->cursor_width),
+    .height = meta_fixed_16_from_int (prediction->cursor_height),
+  };
+  dst_rect = (MetaFixed16Rectangle) {
+    .x = meta_fixed_16_from_int (crtc_cursor_rect.x),
+    .y = meta_fixed_16_from_int (crtc_cursor_rect.y),
+    .width = meta_fixed_16_from_int (prediction->cursor_width),
+    .height = meta_fixed_16_from_int (prediction->cursor_height),
+  };
+
+  plane_assignment =
+    meta_kms_update_assign_plane (kms_update,
+                                  prediction->kms_crtc,
+                                  prediction->cursor_plane,
+                                  prediction->fb_id,
+                                  src_rect,
+                                  dst_rect,
+                                  META_KMS_ASSIGN_PLANE_FLAG_FB_UNCHANGED);
+  meta_kms_plane_assignment_set_cursor_bo_handle (plane_assignment,
+                                                  prediction->bo_handle);
+
+  return TRUE;
+}
+
+/**
+ * meta_cursor_renderer_native_predict_position:
+ * @native: a #MetaCursorRendererNative
+ * @x: the predicted pointer X coordinate
+ * @y: the predicted pointer Y coordinate
+ *
+ * Moves the hardware cursor to where the pointer is predicted to be, ahead
+ * of the main thread processing the motion. Called from the input thread;
+ * it does nothing unless the KMS impl context runs in its own thread, the
+ * hardware cursor is in use, and the move doesn't make the cursor enter or
+ * leave a CRTC. The main thread updates the cursor as usual once it has
+ * processed the motion.
+ */
+void
+meta_cursor_renderer_native_predict_position (MetaCursorRendererNative *native,
+                                              float                     x,
+                                              float                     y)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  g_autoptr (MetaKmsUpdate) kms_update = NULL;
+  g_autoptr (MetaKmsFeedback) feedback = NULL;
+  graphene_rect_t cursor_rect;
+  unsigned int i;
+
+  if (!meta_kms_has_impl_thread (kms))
+    return;
+
+  g_mutex_lock (&priv->prediction_mutex);
+
+  if (!priv->crtc_predictions)
+    goto out;
+
+  cursor_rect = (graphene_rect_t) {
+    .origin = {
+      .x = x + priv->prediction_offset.x,
+      .y = y + priv->prediction_offset.y
+    },
+    .size = priv->prediction_size
+  };
+
+  kms_update = meta_kms_update_new ();
+  for (i = 0; i < priv->crtc_predictions->len; i++)
+    {
+      CrtcCursorPrediction *prediction =
+        &g_array_index (priv->crtc_predictions, CrtcCursorPrediction, i);
+
+      if (!assign_predicted_cursor (prediction, &cursor_rect, kms_update))
+        goto out;
+    }
+
+  feedback = meta_kms_post_update_sync (kms, g_steal_pointer (&kms_update));
+  if (meta_kms_feedback_get_result (feedback) != META_KMS_FEEDBACK_PASSED)
+    g_clear_pointer (&priv->crtc_predictions, g_array_unref);
+
+out:
+  g_mutex_unlock (&priv->prediction_mutex);
+}
+
 static gboolean
 has_valid_cursor_sprite_gbm_bo (MetaCursorSprite *cursor_sprite,
                                 MetaGpuKms       *gpu_kms)
@@ -1136,8 +1546,8 @@ meta_cursor_renderer_native_update_cursor (MetaCursorRenderer *renderer,
 }
 
 static void
-unset_crtc_cursor_renderer_privates (MetaGpu       *gpu,
-                                     struct gbm_bo *bo)
+unset_crtc_cursor_renderer_privates (MetaGpu      *gpu,
+                                     MetaCursorBo *cursor_bo)
 {
   GList *l;
 
@@ -1145,7 +1555,7 @@ unset_crtc_cursor_renderer_privates (MetaGpu       *gpu,
     {
       MetaCrtc *crtc = l->data;
 
-      if (bo == crtc->cursor_renderer_private)
+      if (cursor_bo == crtc->cursor_renderer_private)
         crtc->cursor_renderer_private = NULL;
     }
 }
@@ -1154,14 +1564,14 @@ static void
 cursor_gpu_state_free (MetaCursorNativeGpuState *cursor_gpu_state)
 {
   int i;
-  struct gbm_bo *active_bo;
+  MetaCursorBo *active_bo;
 
   active_bo = get_active_cursor_sprite_gbm_bo (cursor_gpu_state);
   if (active_bo)
     unset_crtc_cursor_renderer_privates (cursor_gpu_state->gpu, active_bo);
 
   for (i = 0; i < HW_CURSOR_BUFFER_COUNT; i++)
-    g_clear_pointer (&cursor_gpu_state->bos[i], gbm_bo_destroy);
+    g_clear_pointer (&cursor_gpu_state->bos[i], meta_cursor_bo_unref);
   g_free (cursor_gpu_state);
 }
 
@@ -1202,9 +1612,7 @@ invalidate_cursor_gpu_state (MetaCursorSprite *cursor_sprite)
       guint pending_bo;
       pending_bo = get_pending_cursor_sprite_gbm_bo_index (cursor_gpu_state);
       g_clear_pointer (&cursor_gpu_state->bos[pending_bo],
-                       gbm_bo_destroy);
-      cursor_gpu_state->widths[pending_bo] = 0;
-      cursor_gpu_state->heights[pending_bo] = 0;
+                       meta_cursor_bo_unref);
       cursor_gpu_state->pending_bo_state = META_CURSOR_GBM_BO_STATE_INVALIDATED;
     }
 }
@@ -1212,12 +1620,36 @@ invalidate_cursor_gpu_state (MetaCursorSprite *cursor_sprite)
 static void
 on_cursor_sprite_texture_changed (MetaCursorSprite *cursor_sprite)
 {
+  /* The images of Xcursor sprites are told apart by their frame and
+   * images serial instead */
+  if (!META_IS_CURSOR_SPRITE_XCURSOR (cursor_sprite))
+    {
+      MetaCursorNativePrivate *cursor_priv = get_cursor_priv (cursor_sprite);
+
+      cursor_priv->content_serial++;
+    }
+
   invalidate_cursor_gpu_state (cursor_sprite);
 }
 
 static void
 cursor_priv_free (MetaCursorNativePrivate *cursor_priv)
 {
+  GHashTableIter iter;
+  MetaGpuKms *gpu_kms;
+
+  g_hash_table_iter_init (&iter, cursor_priv->gpu_states);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &gpu_kms, NULL))
+    {
+      MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+
+      cursor_renderer_gpu_data =
+        meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+      if (cursor_renderer_gpu_data)
+        cursor_bo_cache_remove_sprite (cursor_renderer_gpu_data,
+                                       cursor_priv->cursor_sprite);
+    }
+
   g_hash_table_destroy (cursor_priv->gpu_states);
   g_free (cursor_priv);
 }
@@ -1238,6 +1670,7 @@ ensure_cursor_priv (MetaCursorSprite *cursor_sprite)
     return cursor_priv;
 
   cursor_priv = g_new0 (MetaCursorNativePrivate, 1);
+  cursor_priv->cursor_sprite = cursor_sprite;
   cursor_priv->gpu_states =
     g_hash_table_new_full (g_direct_hash,
                            g_direct_equal,
@@ -1301,10 +1734,9 @@ get_cursor_bo_size (MetaGpuKms *gpu_kms,
   *out_height = *out_width;
 }
 
-static void
+static MetaCursorBo *
 load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
                                        MetaGpuKms               *gpu_kms,
-                                       MetaCursorSprite         *cursor_sprite,
                                        uint8_t                  *pixels,
                                        uint                      width,
                                        uint                      height,
@@ -1319,7 +1751,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
   if (!cursor_renderer_gpu_data)
-    return;
+    return NULL;
 
   cursor_width = (uint64_t) cursor_renderer_gpu_data->cursor_width;
   cursor_height = (uint64_t) cursor_renderer_gpu_data->cursor_height;
@@ -1328,7 +1760,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
     {
       meta_warning ("Invalid theme cursor size (must be at most %ux%u)\n",
                     (unsigned int)cursor_width, (unsigned int)cursor_height);
-      return;
+      return NULL;
     }
 
   get_cursor_bo_size (gpu_kms, width, height,
@@ -1348,7 +1780,7 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
       if (!bo)
         {
           meta_warning ("Failed to allocate HW cursor buffer\n");
-          return;
+          return NULL;
         }
 
       memset (buf, 0, sizeof(buf));
@@ -1359,15 +1791,15 @@ load_cursor_sprite_gbm_buffer_for_gpu (MetaCursorRendererNative *native,
           meta_warning ("Failed to write cursors buffer data: %s",
                         g_strerror (errno));
           gbm_bo_destroy (bo);
-          return;
+          return NULL;
         }
 
-      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo,
-                                        bo_width, bo_height);
+      return meta_cursor_bo_new_take (gpu_kms, bo, bo_width, bo_height);
     }
   else
     {
       meta_warning ("HW cursor for format %d not supported\n", gbm_format);
+      return NULL;
     }
 }
 
@@ -1504,6 +1936,42 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                            int                       rowstride,
                                            uint32_t                  gbm_format)
 {
+  MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+  MetaCursorNativePrivate *cursor_priv;
+  MetaCursorBoCacheKey key;
+  MetaCursorBo *cursor_bo;
+
+  cursor_renderer_gpu_data =
+    meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+  if (!cursor_renderer_gpu_data)
+    return;
+
+  cursor_priv = get_cursor_priv (cursor_sprite);
+
+  key = (MetaCursorBoCacheKey) {
+    .cursor_sprite = cursor_sprite,
+    .content_serial = cursor_priv->content_serial,
+    .scale = relative_scale,
+    .transform = relative_transform,
+  };
+  if (META_IS_CURSOR_SPRITE_XCURSOR (cursor_sprite))
+    {
+      MetaCursorSpriteXcursor *sprite_xcursor =
+        META_CURSOR_SPRITE_XCURSOR (cursor_sprite);
+
+      key.content_serial =
+        meta_cursor_sprite_xcursor_get_images_serial (sprite_xcursor);
+      key.frame = meta_cursor_sprite_xcursor_get_current_frame (sprite_xcursor);
+    }
+
+  cursor_bo = cursor_bo_cache_lookup (cursor_renderer_gpu_data, &key);
+  if (cursor_bo)
+    {
+      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms,
+                                        meta_cursor_bo_ref (cursor_bo));
+      return;
+    }
+
   if (!G_APPROX_VALUE (relative_scale, 1.f, FLT_EPSILON) ||
       relative_transform != META_MONITOR_TRANSFORM_NORMAL)
     {
@@ -1516,28 +1984,33 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                                        relative_scale,
                                                        relative_transform);
 
-      load_cursor_sprite_gbm_buffer_for_gpu (native,
-                                             gpu_kms,
-                                             cursor_sprite,
-                                             cairo_image_surface_get_data (surface),
-                                             cairo_image_surface_get_width (surface),
-                                             cairo_image_surface_get_height (surface),
-                                             cairo_image_surface_get_stride (surface),
-                                             gbm_format);
+      cursor_bo =
+        load_cursor_sprite_gbm_buffer_for_gpu (native,
+                                               gpu_kms,
+                                               cairo_image_surface_get_data (surface),
+                                               cairo_image_surface_get_width (surface),
+                                               cairo_image_surface_get_height (surface),
+                                               cairo_image_surface_get_stride (surface),
+                                               gbm_format);
 
       cairo_surface_destroy (surface);
     }
   else
     {
-      load_cursor_sprite_gbm_buffer_for_gpu (native,
-                                             gpu_kms,
-                                             cursor_sprite,
-                                             data,
-                                             width,
-                                             height,
-                                             rowstride,
-                                             gbm_format);
+      cursor_bo = load_cursor_sprite_gbm_buffer_for_gpu (native,
+                                                         gpu_kms,
+                                                         data,
+                                                         width,
+                                                         height,
+                                                         rowstride,
+                                                         gbm_format);
     }
+
+  if (!cursor_bo)
+    return;
+
+  cursor_bo_cache_insert (cursor_renderer_gpu_data, &key, cursor_bo);
+  set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, cursor_bo);
 }
 
 #ifdef HAVE_WAYLAND
@@ -1673,8 +2146,11 @@ realize_cursor_sprite_from_wl_buffer_for_gpu (MetaCursorRenderer      *renderer,
 
       unset_can_preprocess (cursor_sprite);
 
-      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms, bo,
-                                        width, height);
+      set_pending_cursor_sprite_gbm_bo (cursor_sprite, gpu_kms,
+                                        meta_cursor_bo_new_take (gpu_kms,
+                                                                 bo,
+                                                                 width,
+                                                                 height));
     }
 }
 #endif
@@ -1889,4 +2365,8 @@ meta_cursor_renderer_native_new (MetaBackend *backend)
 static void
 meta_cursor_renderer_native_init (MetaCursorRendererNative *native)
 {
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+
+  g_mutex_init (&priv->prediction_mutex);
 }
@@ -35,4 +35,8 @@ G_DECLARE_FINAL_TYPE (MetaCursorRendererNative, meta_cursor_renderer_native,
 
 MetaCursorRendererNative * meta_cursor_renderer_native_new (MetaBackend *backend);
 
+void meta_cursor_renderer_native_predict_position (MetaCursorRendererNative *native,
+                                                   float                     x,
+                                                   float                     y);
+
 #endif /* META_CURSOR_RENDERER_NATIVE_H */
@@ -42,6 +42,9 @@ struct _MetaDrmBufferGbm
 
   struct gbm_bo *bo;
   uint32_t fb_id;
+
+  /* the buffer owning bo and fb_id, if shared */
+  MetaDrmBufferGbm *owner;
 };
 
 static void
@@ -158,6 +161,34 @@ meta_drm_buffer_gbm_new_take (MetaGpuKms     *gpu_kms,
   return buffer_gbm;
 }
 
+/**
+ * meta_drm_buffer_gbm_new_shared:
+ * @owner: the buffer to share
+ *
+ * Creates a buffer showing the same gbm_bo and framebuffer as @owner,
+ * keeping @owner alive. This lets an imported buffer be scanned out
+ * repeatedly, while whoever tracks the scanout learns when each use
+ * ended by the shared buffer being finalized.
+ *
+ * Returns: (transfer full): a new #MetaDrmBufferGbm
+ */
+MetaDrmBufferGbm *
+meta_drm_buffer_gbm_new_shared (MetaDrmBufferGbm *owner)
+{
+  MetaDrmBufferGbm *buffer_gbm;
+
+  if (owner->owner)
+    owner = owner->owner;
+
+  buffer_gbm = g_object_new (META_TYPE_DRM_BUFFER_GBM, NULL);
+  buffer_gbm->gpu_kms = owner->gpu_kms;
+  buffer_gbm->bo = owner->bo;
+  buffer_gbm->fb_id = owner->fb_id;
+  buffer_gbm->owner = g_object_ref (owner);
+
+  return buffer_gbm;
+}
+
 
 static uint32_t
 meta_drm_buffer_gbm_get_fb_id (MetaDrmBuffer *buffer)
@@ -175,6 +206,13 @@ meta_drm_buffer_gbm_finalize (GObject *object)
 {
   MetaDrmBufferGbm *buffer_gbm = META_DRM_BUFFER_GBM (object);
 
+  if (buffer_gbm->owner)
+    {
+      g_object_unref (buffer_gbm->owner);
+      G_OBJECT_CLASS (meta_drm_buffer_gbm_parent_class)->finalize (object);
+      return;
+    }
+
   if (buffer_gbm->fb_id != INVALID_FB_ID)
     {
       int kms_fd;
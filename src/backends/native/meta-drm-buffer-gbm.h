@@ -44,6 +44,8 @@ MetaDrmBufferGbm * meta_drm_buffer_gbm_new_take (MetaGpuKms     *gpu_kms,
                                                  gboolean        use_modifiers,
                                                  GError        **error);
 
+MetaDrmBufferGbm * meta_drm_buffer_gbm_new_shared (MetaDrmBufferGbm *owner);
+
 struct gbm_bo * meta_drm_buffer_gbm_get_bo (MetaDrmBufferGbm *buffer_gbm);
 
 #endif /* META_DRM_BUFFER_GBM_H */
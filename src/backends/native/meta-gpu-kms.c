@@ -59,6 +59,10 @@ struct _MetaGpuKms
 
   clockid_t clock_id;
 
+  /* drmModeModeInfo -> MetaCrtcMode, for the modes currently owned by the
+   * MetaGpu; rebuilt together with the mode list in init_modes(). */
+  GHashTable *modes_by_drm_mode;
+
   gboolean resources_init_failed_before;
 };
 
@@ -352,19 +356,12 @@ MetaCrtcMode *
 meta_gpu_kms_get_mode_from_drm_mode (MetaGpuKms            *gpu_kms,
                                      const drmModeModeInfo *drm_mode)
 {
-  MetaGpu *gpu = META_GPU (gpu_kms);
-  GList *l;
+  MetaCrtcMode *mode;
 
-  for (l = meta_gpu_get_modes (gpu); l; l = l->next)
-    {
-      MetaCrtcMode *mode = l->data;
+  mode = g_hash_table_lookup (gpu_kms->modes_by_drm_mode, drm_mode);
+  g_assert (mode);
 
-      if (meta_drm_mode_equal (drm_mode, mode->driver_private))
-        return mode;
-    }
-
-  g_assert_not_reached ();
-  return NULL;
+  return mode;
 }
 
 static MetaCrtcMode *
@@ -471,7 +468,7 @@ init_modes (MetaGpuKms *gpu_kms)
       MetaCrtcMode *mode;
 
       mode = create_mode (drm_mode, (long) mode_id);
-      modes = g_list_append (modes, mode);
+      modes = g_list_prepend (modes, mode);
 
       mode_id++;
     }
@@ -483,7 +480,7 @@ init_modes (MetaGpuKms *gpu_kms)
       MetaCrtcMode *mode;
 
       mode = create_mode (&meta_default_landscape_drm_mode_infos[i], mode_id);
-      modes = g_list_append (modes, mode);
+      modes = g_list_prepend (modes, mode);
 
       mode_id++;
     }
@@ -493,11 +490,32 @@ init_modes (MetaGpuKms *gpu_kms)
       MetaCrtcMode *mode;
 
       mode = create_mode (&meta_default_portrait_drm_mode_infos[i], mode_id);
-      modes = g_list_append (modes, mode);
+      modes = g_list_prepend (modes, mode);
 
       mode_id++;
     }
 
+  modes = g_list_reverse (modes);
+
+  /*
+   * Output and CRTC creation looks up the MetaCrtcMode of every connector and
+   * CRTC mode, so keep a table around instead of scanning the mode list for
+   * each of them. Connector modes come first, so they take precedence over
+   * identical default modes, same as a first-match list scan would.
+   */
+  g_clear_pointer (&gpu_kms->modes_by_drm_mode, g_hash_table_destroy);
+  gpu_kms->modes_by_drm_mode =
+    g_hash_table_new (drm_mode_hash, (GEqualFunc) meta_drm_mode_equal);
+  for (l = modes; l; l = l->next)
+    {
+      MetaCrtcMode *mode = l->data;
+
+      if (!g_hash_table_contains (gpu_kms->modes_by_drm_mode,
+                                  mode->driver_private))
+        g_hash_table_insert (gpu_kms->modes_by_drm_mode,
+                             mode->driver_private, mode);
+    }
+
   meta_gpu_take_modes (gpu, modes);
 }
 
@@ -643,6 +661,16 @@ meta_gpu_kms_new (MetaBackendNative  *backend_native,
   return gpu_kms;
 }
 
+static void
+meta_gpu_kms_finalize (GObject *object)
+{
+  MetaGpuKms *gpu_kms = META_GPU_KMS (object);
+
+  g_clear_pointer (&gpu_kms->modes_by_drm_mode, g_hash_table_destroy);
+
+  G_OBJECT_CLASS (meta_gpu_kms_parent_class)->finalize (object);
+}
+
 static void
 meta_gpu_kms_init (MetaGpuKms *gpu_kms)
 {
@@ -655,7 +683,10 @@ meta_gpu_kms_init (MetaGpuKms *gpu_kms)
 static void
 meta_gpu_kms_class_init (MetaGpuKmsClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   MetaGpuClass *gpu_class = META_GPU_CLASS (klass);
 
+  object_class->finalize = meta_gpu_kms_finalize;
+
   gpu_class->read_current = meta_gpu_kms_read_current;
 }
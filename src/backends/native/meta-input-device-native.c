@@ -65,7 +65,11 @@ meta_input_device_native_finalize (GObject *object)
   ClutterSeat *seat;
 
   if (device_evdev->libinput_device)
-    libinput_device_unref (device_evdev->libinput_device);
+    {
+      meta_seat_native_lock_libinput (device_evdev->seat);
+      libinput_device_unref (device_evdev->libinput_device);
+      meta_seat_native_unlock_libinput (device_evdev->seat);
+    }
 
   meta_input_device_native_release_touch_slots (device_evdev,
                                                 g_get_monotonic_time ());
@@ -1433,7 +1437,9 @@ meta_input_device_native_update_leds (MetaInputDeviceNative *device,
   if (!device->libinput_device)
     return;
 
+  meta_seat_native_lock_libinput (device->seat);
   libinput_device_led_update (device->libinput_device, leds);
+  meta_seat_native_unlock_libinput (device->seat);
 }
 
 ClutterInputDeviceType
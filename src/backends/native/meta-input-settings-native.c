@@ -34,6 +34,25 @@
 
 G_DEFINE_TYPE (MetaInputSettingsNative, meta_input_settings_native, META_TYPE_INPUT_SETTINGS)
 
+/* libinput may be reading events from the input thread meanwhile */
+static void
+lock_libinput (void)
+{
+  ClutterSeat *seat;
+
+  seat = clutter_backend_get_default_seat (clutter_get_default_backend ());
+  meta_seat_native_lock_libinput (META_SEAT_NATIVE (seat));
+}
+
+static void
+unlock_libinput (void)
+{
+  ClutterSeat *seat;
+
+  seat = clutter_backend_get_default_seat (clutter_get_default_backend ());
+  meta_seat_native_unlock_libinput (META_SEAT_NATIVE (seat));
+}
+
 static void
 meta_input_settings_native_set_send_events (MetaInputSettings        *settings,
                                             ClutterInputDevice       *device,
@@ -60,7 +79,10 @@ meta_input_settings_native_set_send_events (MetaInputSettings        *settings,
   libinput_device = meta_input_device_native_get_libinput_device (device);
   if (!libinput_device)
     return;
+
+  lock_libinput ();
   libinput_device_config_send_events_set_mode (libinput_device, libinput_mode);
+  unlock_libinput ();
 }
 
 static void
@@ -85,8 +107,11 @@ meta_input_settings_native_set_speed (MetaInputSettings  *settings,
   libinput_device = meta_input_device_native_get_libinput_device (device);
   if (!libinput_device)
     return;
+
+  lock_libinput ();
   libinput_device_config_accel_set_speed (libinput_device,
                                           CLAMP (speed, -1, 1));
+  unlock_libinput ();
 }
 
 static void
@@ -100,8 +125,10 @@ meta_input_settings_native_set_left_handed (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_left_handed_is_available (libinput_device))
     libinput_device_config_left_handed_set (libinput_device, enabled);
+  unlock_libinput ();
 }
 
 static void
@@ -115,11 +142,13 @@ meta_input_settings_native_set_tap_enabled (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_tap_get_finger_count (libinput_device) > 0)
     libinput_device_config_tap_set_enabled (libinput_device,
                                             enabled ?
                                             LIBINPUT_CONFIG_TAP_ENABLED :
                                             LIBINPUT_CONFIG_TAP_DISABLED);
+  unlock_libinput ();
 }
 
 static void
@@ -133,11 +162,13 @@ meta_input_settings_native_set_tap_and_drag_enabled (MetaInputSettings  *setting
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_tap_get_finger_count (libinput_device) > 0)
     libinput_device_config_tap_set_drag_enabled (libinput_device,
                                                  enabled ?
                                                  LIBINPUT_CONFIG_DRAG_ENABLED :
                                                  LIBINPUT_CONFIG_DRAG_DISABLED);
+  unlock_libinput ();
 }
 
 static void
@@ -152,11 +183,13 @@ meta_input_settings_native_set_disable_while_typing (MetaInputSettings  *setting
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_dwt_is_available (libinput_device))
     libinput_device_config_dwt_set_enabled (libinput_device,
                                             enabled ?
                                             LIBINPUT_CONFIG_DWT_ENABLED :
                                             LIBINPUT_CONFIG_DWT_DISABLED);
+  unlock_libinput ();
 }
 
 static void
@@ -170,9 +203,11 @@ meta_input_settings_native_set_invert_scroll (MetaInputSettings  *settings,
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_scroll_has_natural_scroll (libinput_device))
     libinput_device_config_scroll_set_natural_scroll_enabled (libinput_device,
                                                               inverted);
+  unlock_libinput ();
 }
 
 static gboolean
@@ -204,10 +239,13 @@ meta_input_settings_native_set_edge_scroll (MetaInputSettings            *settin
   libinput_device = meta_input_device_native_get_libinput_device (device);
 
   method = edge_scrolling_enabled ? LIBINPUT_CONFIG_SCROLL_EDGE : LIBINPUT_CONFIG_SCROLL_NO_SCROLL;
+
+  lock_libinput ();
   current = libinput_device_config_scroll_get_method (libinput_device);
   current &= ~LIBINPUT_CONFIG_SCROLL_EDGE;
 
   device_set_scroll_method (libinput_device, current | method);
+  unlock_libinput ();
 }
 
 static void
@@ -221,10 +259,13 @@ meta_input_settings_native_set_two_finger_scroll (MetaInputSettings            *
   libinput_device = meta_input_device_native_get_libinput_device (device);
 
   method = two_finger_scroll_enabled ? LIBINPUT_CONFIG_SCROLL_2FG : LIBINPUT_CONFIG_SCROLL_NO_SCROLL;
+
+  lock_libinput ();
   current = libinput_device_config_scroll_get_method (libinput_device);
   current &= ~LIBINPUT_CONFIG_SCROLL_2FG;
 
   device_set_scroll_method (libinput_device, current | method);
+  unlock_libinput ();
 }
 
 static gboolean
@@ -232,12 +273,17 @@ meta_input_settings_native_has_two_finger_scroll (MetaInputSettings  *settings,
                                                   ClutterInputDevice *device)
 {
   struct libinput_device *libinput_device;
+  uint32_t methods;
 
   libinput_device = meta_input_device_native_get_libinput_device (device);
   if (!libinput_device)
     return FALSE;
 
-  return libinput_device_config_scroll_get_methods (libinput_device) & LIBINPUT_CONFIG_SCROLL_2FG;
+  lock_libinput ();
+  methods = libinput_device_config_scroll_get_methods (libinput_device);
+  unlock_libinput ();
+
+  return methods & LIBINPUT_CONFIG_SCROLL_2FG;
 }
 
 static void
@@ -269,10 +315,10 @@ meta_input_settings_native_set_scroll_button (MetaInputSettings  *settings,
       method = LIBINPUT_CONFIG_SCROLL_ON_BUTTON_DOWN;
     }
 
-  if (!device_set_scroll_method (libinput_device, method))
-    return;
-
-  libinput_device_config_scroll_set_button (libinput_device, evcode);
+  lock_libinput ();
+  if (device_set_scroll_method (libinput_device, method))
+    libinput_device_config_scroll_set_button (libinput_device, evcode);
+  unlock_libinput ();
 }
 
 static void
@@ -290,7 +336,9 @@ meta_input_settings_native_set_click_method (MetaInputSettings           *settin
   switch (mode)
     {
     case C_DESKTOP_TOUCHPAD_CLICK_METHOD_DEFAULT:
+      lock_libinput ();
       click_method = libinput_device_config_click_get_default_method (libinput_device);
+      unlock_libinput ();
       break;
     case C_DESKTOP_TOUCHPAD_CLICK_METHOD_NONE:
       click_method = LIBINPUT_CONFIG_CLICK_METHOD_NONE;
@@ -306,7 +354,9 @@ meta_input_settings_native_set_click_method (MetaInputSettings           *settin
       return;
   }
 
+  lock_libinput ();
   device_set_click_method (libinput_device, click_method);
+  unlock_libinput ();
 }
 
 static void
@@ -332,6 +382,8 @@ set_device_accel_profile (ClutterInputDevice         *device,
 
   libinput_device = meta_input_device_native_get_libinput_device (device);
 
+  lock_libinput ();
+
   switch (profile)
     {
     case C_DESKTOP_POINTER_ACCEL_PROFILE_FLAT:
@@ -356,6 +408,8 @@ set_device_accel_profile (ClutterInputDevice         *device,
 
   libinput_device_config_accel_set_profile (libinput_device,
                                             libinput_profile);
+
+  unlock_libinput ();
 }
 
 static gboolean
@@ -370,7 +424,9 @@ has_udev_property (ClutterInputDevice *device,
   if (!libinput_device)
     return FALSE;
 
+  lock_libinput ();
   udev_device = libinput_device_get_udev_device (libinput_device);
+  unlock_libinput ();
 
   if (!udev_device)
     return FALSE;
@@ -511,11 +567,13 @@ meta_input_settings_native_set_tablet_area (MetaInputSettings  *settings,
                        0., scale_y, offset_y };
 
   libinput_device = meta_input_device_native_get_libinput_device (device);
-  if (!libinput_device ||
-      !libinput_device_config_calibration_has_matrix (libinput_device))
+  if (!libinput_device)
     return;
 
-  libinput_device_config_calibration_set_matrix (libinput_device, matrix);
+  lock_libinput ();
+  if (libinput_device_config_calibration_has_matrix (libinput_device))
+    libinput_device_config_calibration_set_matrix (libinput_device, matrix);
+  unlock_libinput ();
 }
 
 static void
@@ -585,8 +643,10 @@ meta_input_settings_native_set_mouse_middle_click_emulation (MetaInputSettings
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_middle_emulation_is_available (libinput_device))
     libinput_device_config_middle_emulation_set_enabled (libinput_device, enabled);
+  unlock_libinput ();
 }
 
 static void
@@ -603,8 +663,10 @@ meta_input_settings_native_set_touchpad_middle_click_emulation (MetaInputSetting
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_middle_emulation_is_available (libinput_device))
     libinput_device_config_middle_emulation_set_enabled (libinput_device, enabled);
+  unlock_libinput ();
 }
 
 static void
@@ -621,8 +683,10 @@ meta_input_settings_native_set_trackball_middle_click_emulation (MetaInputSettin
   if (!libinput_device)
     return;
 
+  lock_libinput ();
   if (libinput_device_config_middle_emulation_is_available (libinput_device))
     libinput_device_config_middle_emulation_set_enabled (libinput_device, enabled);
+  unlock_libinput ();
 }
 
 static void
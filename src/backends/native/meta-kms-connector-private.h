@@ -22,8 +22,9 @@
 
 #include "backends/native/meta-kms-types.h"
 
-void meta_kms_connector_update_state (MetaKmsConnector *connector,
-                                      drmModeRes       *drm_resources);
+gboolean meta_kms_connector_update_state (MetaKmsConnector *connector,
+                                          drmModeConnector *drm_connector,
+                                          drmModeRes       *drm_resources);
 
 void meta_kms_connector_predict_state (MetaKmsConnector *connector,
                                        MetaKmsUpdate    *update);
@@ -24,6 +24,7 @@
 
 #include <errno.h>
 
+#include "backends/native/meta-gpu-kms.h"
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-device-private.h"
 #include "backends/native/meta-kms-impl-device.h"
@@ -449,22 +450,105 @@ static void
 meta_kms_connector_state_free (MetaKmsConnectorState *state)
 {
   g_clear_pointer (&state->edid_data, g_bytes_unref);
+  g_free (state->edid_info);
   g_free (state->modes);
   g_free (state);
 }
 
+static gboolean
+meta_kms_connector_state_modes_equal (MetaKmsConnectorState *state,
+                                      MetaKmsConnectorState *other_state)
+{
+  int i;
+
+  if (state->n_modes != other_state->n_modes)
+    return FALSE;
+
+  for (i = 0; i < state->n_modes; i++)
+    {
+      if (!meta_drm_mode_equal (&state->modes[i], &other_state->modes[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Whether the connector looks the same to the monitor configuration. The
+ * CRTC the connector is driven by is left out, as that is only changed by
+ * us.
+ */
+static gboolean
+meta_kms_connector_state_equal (MetaKmsConnectorState *state,
+                                MetaKmsConnectorState *other_state)
+{
+  if (!state || !other_state)
+    return state == other_state;
+
+  if (state->edid_data || other_state->edid_data)
+    {
+      if (!state->edid_data || !other_state->edid_data)
+        return FALSE;
+
+      if (!g_bytes_equal (state->edid_data, other_state->edid_data))
+        return FALSE;
+    }
+
+  return (state->common_possible_crtcs == other_state->common_possible_crtcs &&
+          state->common_possible_clones == other_state->common_possible_clones &&
+          state->encoder_device_idxs == other_state->encoder_device_idxs &&
+          state->width_mm == other_state->width_mm &&
+          state->height_mm == other_state->height_mm &&
+          memcmp (&state->tile_info, &other_state->tile_info,
+                  sizeof (state->tile_info)) == 0 &&
+          state->has_scaling == other_state->has_scaling &&
+          state->subpixel_order == other_state->subpixel_order &&
+          state->suggested_x == other_state->suggested_x &&
+          state->suggested_y == other_state->suggested_y &&
+          state->hotplug_mode_update == other_state->hotplug_mode_update &&
+          state->panel_orientation_transform ==
+          other_state->panel_orientation_transform &&
+          meta_kms_connector_state_modes_equal (state, other_state));
+}
+
 static void
+state_set_edid_info (MetaKmsConnectorState *state,
+                     MetaKmsConnectorState *old_state)
+{
+  if (!state->edid_data)
+    return;
+
+  /*
+   * Decoding happens here rather than when creating the MetaOutput so that
+   * it is done in the KMS impl context; if the EDID didn't change since the
+   * last read, keep the already decoded copy.
+   */
+  if (old_state && old_state->edid_info && old_state->edid_data &&
+      g_bytes_equal (old_state->edid_data, state->edid_data))
+    {
+      state->edid_info = g_steal_pointer (&old_state->edid_info);
+      return;
+    }
+
+  state->edid_info = decode_edid (g_bytes_get_data (state->edid_data, NULL));
+}
+
+static gboolean
 meta_kms_connector_read_state (MetaKmsConnector  *connector,
                                MetaKmsImplDevice *impl_device,
                                drmModeConnector  *drm_connector,
                                drmModeRes        *drm_resources)
 {
   MetaKmsConnectorState *state;
-
-  g_clear_pointer (&connector->current_state, meta_kms_connector_state_free);
+  gboolean changed;
 
   if (!drm_connector || drm_connector->connection != DRM_MODE_CONNECTED)
-    return;
+    {
+      changed = connector->current_state != NULL;
+      g_clear_pointer (&connector->current_state,
+                       meta_kms_connector_state_free);
+      return changed;
+    }
 
   state = meta_kms_connector_state_new ();
 
@@ -481,24 +565,32 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 
   state_set_crtc_state (state, drm_connector, impl_device, drm_resources);
 
+  changed = !meta_kms_connector_state_equal (connector->current_state, state);
+
+  state_set_edid_info (state, connector->current_state);
+
+  g_clear_pointer (&connector->current_state, meta_kms_connector_state_free);
   connector->current_state = state;
+
+  return changed;
 }
 
-void
+/*
+ * Returns whether the state changed in a way the monitor configuration
+ * needs to be updated for.
+ */
+gboolean
 meta_kms_connector_update_state (MetaKmsConnector *connector,
+                                 drmModeConnector *drm_connector,
                                  drmModeRes       *drm_resources)
 {
   MetaKmsImplDevice *impl_device;
-  drmModeConnector *drm_connector;
 
   impl_device = meta_kms_device_get_impl_device (connector->device);
-  drm_connector = drmModeGetConnector (meta_kms_impl_device_get_fd (impl_device),
-                                       connector->id);
-  meta_kms_connector_read_state (connector, impl_device,
-                                 drm_connector,
-                                 drm_resources);
-  if (drm_connector)
-    drmModeFreeConnector (drm_connector);
+
+  return meta_kms_connector_read_state (connector, impl_device,
+                                        drm_connector,
+                                        drm_resources);
 }
 
 void
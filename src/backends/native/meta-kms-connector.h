@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <xf86drmMode.h>
 
+#include "backends/edid.h"
 #include "backends/meta-output.h"
 #include "backends/native/meta-kms-types.h"
 
@@ -47,6 +48,8 @@ typedef struct _MetaKmsConnectorState
 
   MetaTileInfo tile_info;
   GBytes *edid_data;
+  /* edid_data decoded when the state was read, NULL if it couldn't be */
+  MonitorInfo *edid_info;
 
   gboolean has_scaling;
 
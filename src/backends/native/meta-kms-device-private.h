@@ -24,7 +24,9 @@
 
 MetaKmsImplDevice * meta_kms_device_get_impl_device (MetaKmsDevice *device);
 
-void meta_kms_device_update_states_in_impl (MetaKmsDevice *device);
+gboolean meta_kms_device_update_states_in_impl (MetaKmsDevice *device,
+                                                uint32_t       connector_id,
+                                                uint32_t       property_id);
 
 void meta_kms_device_predict_states_in_impl (MetaKmsDevice *device,
                                              MetaKmsUpdate *update);
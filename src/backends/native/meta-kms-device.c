@@ -173,15 +173,31 @@ meta_kms_device_get_optimal_cursor_size (MetaKmsDevice *device,
   return FALSE;
 }
 
-void
-meta_kms_device_update_states_in_impl (MetaKmsDevice *device)
+/*
+ * A non-zero @connector_id limits the update to that connector, and a
+ * non-zero @property_id tells it was only a property of it that changed.
+ */
+gboolean
+meta_kms_device_update_states_in_impl (MetaKmsDevice *device,
+                                       uint32_t       connector_id,
+                                       uint32_t       property_id)
 {
   MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
+  gboolean changed;
 
   meta_assert_in_kms_impl (device->kms);
   meta_assert_is_waiting_for_kms_impl_task (device->kms);
 
-  meta_kms_impl_device_update_states (impl_device);
+  if (connector_id)
+    {
+      changed = meta_kms_impl_device_update_connector_state (impl_device,
+                                                             connector_id,
+                                                             property_id == 0);
+    }
+  else
+    {
+      changed = meta_kms_impl_device_update_states (impl_device);
+    }
 
   g_list_free (device->crtcs);
   device->crtcs = meta_kms_impl_device_copy_crtcs (impl_device);
@@ -191,6 +207,8 @@ meta_kms_device_update_states_in_impl (MetaKmsDevice *device)
 
   g_list_free (device->planes);
   device->planes = meta_kms_impl_device_copy_planes (impl_device);
+
+  return changed;
 }
 
 void
@@ -0,0 +1,1346 @@
+/*
+ * Copyright (C) 2026 Linux Mint
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include "config.h"
+
+#include "backends/native/meta-kms-impl-atomic.h"
+
+#include <errno.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+#include "backends/native/meta-kms-connector.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device-private.h"
+#include "backends/native/meta-kms-impl-simple.h"
+#include "backends/native/meta-kms-page-flip-private.h"
+#include "backends/native/meta-kms-plane.h"
+#include "backends/native/meta-kms-private.h"
+#include "backends/native/meta-kms-update-private.h"
+
+/*
+ * State kept for each device the atomic API could be enabled on.
+ *
+ * All the commits on a device use the same event token as their user
+ * data, and the kernel sends one event per CRTC for each of them; the
+ * CRTC identifies which of the pending page flips completed.
+ */
+typedef struct _AtomicDevice
+{
+  MetaKmsImplDevice *impl_device;
+
+  MetaKmsPageFlipData *event_token;
+
+  /* object id -> (property name -> property id) */
+  GHashTable *object_props;
+
+  /* MetaKmsCrtc -> MetaKmsPageFlipData */
+  GHashTable *pending_page_flips;
+
+  /* MetaKmsCrtc -> blob id of the current MODE_ID and GAMMA_LUT */
+  GHashTable *mode_blobs;
+  GHashTable *gamma_blobs;
+} AtomicDevice;
+
+/*
+ * A commit being built for one device. The request is rebuilt when it
+ * fails to validate with the cursor and overlay planes, so it can be
+ * tested again without them.
+ */
+typedef struct _AtomicCommit
+{
+  AtomicDevice *atomic_device;
+  MetaKmsDevice *device;
+
+  drmModeAtomicReq *req;
+  uint32_t flags;
+
+  gboolean skip_optional_planes;
+  GList *optional_plane_assignments;
+
+  GList *page_flips;
+
+  /* MetaKmsCrtc -> blob id, replacing the current ones once committed */
+  GHashTable *new_mode_blobs;
+  GHashTable *new_gamma_blobs;
+
+  /* MetaKmsCrtcGamma without GAMMA_LUT support, set after committing */
+  GList *legacy_gammas;
+} AtomicCommit;
+
+struct _MetaKmsImplAtomic
+{
+  MetaKmsImpl parent;
+
+  /* handles the updates of the devices without atomic support */
+  MetaKmsImplSimple *fallback;
+
+  /* MetaKmsDevice -> AtomicDevice */
+  GHashTable *atomic_devices;
+};
+
+G_DEFINE_TYPE (MetaKmsImplAtomic, meta_kms_impl_atomic,
+               META_TYPE_KMS_IMPL)
+
+MetaKmsImplAtomic *
+meta_kms_impl_atomic_new (MetaKms  *kms,
+                          GError  **error)
+{
+  MetaKmsImplAtomic *impl_atomic;
+
+  impl_atomic = g_object_new (META_TYPE_KMS_IMPL_ATOMIC,
+                              "kms", kms,
+                              NULL);
+
+  impl_atomic->fallback = meta_kms_impl_simple_new (kms, error);
+  if (!impl_atomic->fallback)
+    {
+      g_object_unref (impl_atomic);
+      return NULL;
+    }
+
+  return impl_atomic;
+}
+
+static int
+get_fd (AtomicDevice *atomic_device)
+{
+  return meta_kms_impl_device_get_fd (atomic_device->impl_device);
+}
+
+static void
+destroy_blobs (AtomicDevice *atomic_device,
+               GHashTable   *blobs)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, blobs);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    drmModeDestroyPropertyBlob (get_fd (atomic_device), GPOINTER_TO_UINT (value));
+
+  g_hash_table_remove_all (blobs);
+}
+
+static void
+atomic_device_free (AtomicDevice *atomic_device)
+{
+  meta_kms_page_flip_data_unref (atomic_device->event_token);
+  g_hash_table_destroy (atomic_device->object_props);
+  g_hash_table_destroy (atomic_device->pending_page_flips);
+  g_hash_table_destroy (atomic_device->mode_blobs);
+  g_hash_table_destroy (atomic_device->gamma_blobs);
+  g_free (atomic_device);
+}
+
+static AtomicDevice *
+atomic_device_new (MetaKmsImplAtomic *impl_atomic,
+                   MetaKmsImplDevice *impl_device)
+{
+  AtomicDevice *atomic_device;
+
+  atomic_device = g_new0 (AtomicDevice, 1);
+  *atomic_device = (AtomicDevice) {
+    .impl_device = impl_device,
+    .event_token = meta_kms_page_flip_data_new (META_KMS_IMPL (impl_atomic),
+                                                NULL, NULL, NULL),
+    .object_props =
+      g_hash_table_new_full (NULL, NULL,
+                             NULL, (GDestroyNotify) g_hash_table_destroy),
+    .pending_page_flips =
+      g_hash_table_new_full (NULL, NULL,
+                             NULL, (GDestroyNotify) meta_kms_page_flip_data_unref),
+    .mode_blobs = g_hash_table_new (NULL, NULL),
+    .gamma_blobs = g_hash_table_new (NULL, NULL),
+  };
+
+  return atomic_device;
+}
+
+static AtomicDevice *
+get_atomic_device (MetaKmsImplAtomic *impl_atomic,
+                   MetaKmsDevice     *device)
+{
+  return g_hash_table_lookup (impl_atomic->atomic_devices, device);
+}
+
+static GHashTable *
+ensure_object_props (AtomicDevice *atomic_device,
+                     uint32_t      object_id,
+                     uint32_t      object_type)
+{
+  GHashTable *props;
+  drmModeObjectProperties *drm_props;
+  unsigned int i;
+
+  props = g_hash_table_lookup (atomic_device->object_props,
+                               GUINT_TO_POINTER (object_id));
+  if (props)
+    return props;
+
+  props = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  drm_props = drmModeObjectGetProperties (get_fd (atomic_device),
+                                          object_id, object_type);
+  for (i = 0; drm_props && i < drm_props->count_props; i++)
+    {
+      drmModePropertyPtr prop;
+
+      prop = drmModeGetProperty (get_fd (atomic_device), drm_props->props[i]);
+      if (!prop)
+        continue;
+
+      g_hash_table_insert (props,
+                           g_strdup (prop->name),
+                           GUINT_TO_POINTER (prop->prop_id));
+      drmModeFreeProperty (prop);
+    }
+  g_clear_pointer (&drm_props, drmModeFreeObjectProperties);
+
+  g_hash_table_insert (atomic_device->object_props,
+                       GUINT_TO_POINTER (object_id),
+                       props);
+
+  return props;
+}
+
+static uint32_t
+find_property (AtomicDevice *atomic_device,
+               uint32_t      object_id,
+               uint32_t      object_type,
+               const char   *name)
+{
+  GHashTable *props;
+
+  props = ensure_object_props (atomic_device, object_id, object_type);
+
+  return GPOINTER_TO_UINT (g_hash_table_lookup (props, name));
+}
+
+static gboolean
+is_property (AtomicDevice *atomic_device,
+             uint32_t      object_id,
+             uint32_t      object_type,
+             uint32_t      prop_id,
+             const char   *name)
+{
+  uint32_t named_prop_id;
+
+  named_prop_id = find_property (atomic_device, object_id, object_type, name);
+
+  return named_prop_id != 0 && named_prop_id == prop_id;
+}
+
+static gboolean
+add_property (AtomicCommit  *commit,
+              uint32_t       object_id,
+              uint32_t       object_type,
+              const char    *name,
+              uint64_t       value,
+              GError       **error)
+{
+  uint32_t prop_id;
+
+  prop_id = find_property (commit->atomic_device, object_id, object_type,
+                           name);
+  if (!prop_id)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "KMS object %u has no property '%s'", object_id, name);
+      return FALSE;
+    }
+
+  if (drmModeAtomicAddProperty (commit->req, object_id, prop_id, value) < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to add property '%s' of KMS object %u",
+                   name, object_id);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+add_raw_property (AtomicCommit  *commit,
+                  uint32_t       object_id,
+                  uint32_t       prop_id,
+                  uint64_t       value,
+                  GError       **error)
+{
+  if (drmModeAtomicAddProperty (commit->req, object_id, prop_id, value) < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to add property %u of KMS object %u",
+                   prop_id, object_id);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static AtomicCommit *
+atomic_commit_new (AtomicDevice  *atomic_device,
+                   MetaKmsDevice *device)
+{
+  AtomicCommit *commit;
+
+  commit = g_new0 (AtomicCommit, 1);
+  *commit = (AtomicCommit) {
+    .atomic_device = atomic_device,
+    .device = device,
+    .new_mode_blobs = g_hash_table_new (NULL, NULL),
+    .new_gamma_blobs = g_hash_table_new (NULL, NULL),
+  };
+
+  return commit;
+}
+
+static void
+atomic_commit_free (AtomicCommit *commit)
+{
+  /* blobs that were not committed */
+  destroy_blobs (commit->atomic_device, commit->new_mode_blobs);
+  destroy_blobs (commit->atomic_device, commit->new_gamma_blobs);
+  g_hash_table_destroy (commit->new_mode_blobs);
+  g_hash_table_destroy (commit->new_gamma_blobs);
+
+  g_clear_pointer (&commit->req, drmModeAtomicFree);
+  g_list_free (commit->optional_plane_assignments);
+  g_list_free (commit->page_flips);
+  g_list_free (commit->legacy_gammas);
+  g_free (commit);
+}
+
+static gboolean
+ensure_blob (AtomicCommit  *commit,
+             GHashTable    *blobs,
+             MetaKmsCrtc   *crtc,
+             const void    *data,
+             size_t         size,
+             uint32_t      *out_blob_id,
+             GError       **error)
+{
+  uint32_t blob_id;
+  int ret;
+
+  blob_id = GPOINTER_TO_UINT (g_hash_table_lookup (blobs, crtc));
+  if (blob_id)
+    {
+      *out_blob_id = blob_id;
+      return TRUE;
+    }
+
+  ret = drmModeCreatePropertyBlob (get_fd (commit->atomic_device),
+                                   data, size, &blob_id);
+  if (ret != 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "Failed to create property blob for CRTC %u: %s",
+                   meta_kms_crtc_get_id (crtc), g_strerror (-ret));
+      return FALSE;
+    }
+
+  g_hash_table_insert (blobs, crtc, GUINT_TO_POINTER (blob_id));
+  *out_blob_id = blob_id;
+
+  return TRUE;
+}
+
+static gboolean
+is_optional_plane (MetaKmsPlane *plane)
+{
+  return meta_kms_plane_get_plane_type (plane) != META_KMS_PLANE_TYPE_PRIMARY;
+}
+
+static gboolean
+add_plane_assignment (AtomicCommit            *commit,
+                      MetaKmsPlaneAssignment  *plane_assignment,
+                      GError                 **error)
+{
+  uint32_t plane_id = meta_kms_plane_get_id (plane_assignment->plane);
+  uint32_t type = DRM_MODE_OBJECT_PLANE;
+  GList *l;
+
+  if (plane_assignment->fb_id == 0 && plane_assignment->cursor_bo.is_valid)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "No framebuffer for the cursor on plane %u", plane_id);
+      return FALSE;
+    }
+
+  if (plane_assignment->fb_id == 0)
+    {
+      return (add_property (commit, plane_id, type, "FB_ID", 0, error) &&
+              add_property (commit, plane_id, type, "CRTC_ID", 0, error));
+    }
+
+  if (!add_property (commit, plane_id, type, "FB_ID",
+                     plane_assignment->fb_id, error) ||
+      !add_property (commit, plane_id, type, "CRTC_ID",
+                     meta_kms_crtc_get_id (plane_assignment->crtc), error) ||
+      !add_property (commit, plane_id, type, "SRC_X",
+                     plane_assignment->src_rect.x, error) ||
+      !add_property (commit, plane_id, type, "SRC_Y",
+                     plane_assignment->src_rect.y, error) ||
+      !add_property (commit, plane_id, type, "SRC_W",
+                     plane_assignment->src_rect.width, error) ||
+      !add_property (commit, plane_id, type, "SRC_H",
+                     plane_assignment->src_rect.height, error) ||
+      !add_property (commit, plane_id, type, "CRTC_X",
+                     meta_fixed_16_to_int (plane_assignment->dst_rect.x),
+                     error) ||
+      !add_property (commit, plane_id, type, "CRTC_Y",
+                     meta_fixed_16_to_int (plane_assignment->dst_rect.y),
+                     error) ||
+      !add_property (commit, plane_id, type, "CRTC_W",
+                     meta_fixed_16_to_int (plane_assignment->dst_rect.width),
+                     error) ||
+      !add_property (commit, plane_id, type, "CRTC_H",
+                     meta_fixed_16_to_int (plane_assignment->dst_rect.height),
+                     error))
+    return FALSE;
+
+  for (l = plane_assignment->plane_properties; l; l = l->next)
+    {
+      MetaKmsProperty *prop = l->data;
+
+      if (!add_raw_property (commit, plane_id, prop->prop_id, prop->value,
+                             error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+is_plane_assigned (MetaKmsUpdate *update,
+                   MetaKmsPlane  *plane)
+{
+  GList *l;
+
+  for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+
+      if (plane_assignment->plane == plane)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* A CRTC can't be disabled while planes are still scanning out on it */
+static gboolean
+disable_planes_on_crtc (AtomicCommit   *commit,
+                        MetaKmsUpdate  *update,
+                        MetaKmsCrtc    *crtc,
+                        GError        **error)
+{
+  MetaKmsImplDevice *impl_device = commit->atomic_device->impl_device;
+  g_autoptr (GList) planes = NULL;
+  GList *l;
+
+  planes = meta_kms_impl_device_copy_planes (impl_device);
+  for (l = planes; l; l = l->next)
+    {
+      MetaKmsPlane *plane = l->data;
+      uint32_t plane_id = meta_kms_plane_get_id (plane);
+      drmModePlane *drm_plane;
+      uint32_t plane_crtc_id;
+
+      if (is_plane_assigned (update, plane))
+        continue;
+
+      drm_plane = drmModeGetPlane (get_fd (commit->atomic_device), plane_id);
+      if (!drm_plane)
+        continue;
+
+      plane_crtc_id = drm_plane->crtc_id;
+      drmModeFreePlane (drm_plane);
+
+      if (plane_crtc_id != meta_kms_crtc_get_id (crtc))
+        continue;
+
+      if (!add_property (commit, plane_id, DRM_MODE_OBJECT_PLANE,
+                         "FB_ID", 0, error) ||
+          !add_property (commit, plane_id, DRM_MODE_OBJECT_PLANE,
+                         "CRTC_ID", 0, error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+is_connector_mode_set (MetaKmsUpdate    *update,
+                       MetaKmsConnector *connector)
+{
+  GList *l;
+
+  for (l = meta_kms_update_get_mode_sets (update); l; l = l->next)
+    {
+      MetaKmsModeSet *mode_set = l->data;
+
+      if (mode_set->drm_mode && g_list_find (mode_set->connectors, connector))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+is_crtc_mode_set (MetaKmsUpdate *update,
+                  MetaKmsCrtc   *crtc)
+{
+  GList *l;
+
+  for (l = meta_kms_update_get_mode_sets (update); l; l = l->next)
+    {
+      MetaKmsModeSet *mode_set = l->data;
+
+      if (mode_set->crtc == crtc)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+add_mode_set (AtomicCommit    *commit,
+              MetaKmsUpdate   *update,
+              MetaKmsModeSet  *mode_set,
+              GError         **error)
+{
+  MetaKmsCrtc *crtc = mode_set->crtc;
+  uint32_t crtc_id = meta_kms_crtc_get_id (crtc);
+  GList *l;
+
+  if (mode_set->drm_mode)
+    {
+      uint32_t blob_id;
+
+      if (!ensure_blob (commit, commit->new_mode_blobs, crtc,
+                        mode_set->drm_mode, sizeof (*mode_set->drm_mode),
+                        &blob_id, error))
+        return FALSE;
+
+      if (!add_property (commit, crtc_id, DRM_MODE_OBJECT_CRTC,
+                         "MODE_ID", blob_id, error) ||
+          !add_property (commit, crtc_id, DRM_MODE_OBJECT_CRTC,
+                         "ACTIVE", 1, error))
+        return FALSE;
+
+      for (l = mode_set->connectors; l; l = l->next)
+        {
+          MetaKmsConnector *connector = l->data;
+
+          if (!add_property (commit, meta_kms_connector_get_id (connector),
+                             DRM_MODE_OBJECT_CONNECTOR,
+                             "CRTC_ID", crtc_id, error))
+            return FALSE;
+        }
+    }
+  else
+    {
+      const MetaKmsCrtcState *crtc_state;
+
+      /* Including an already disabled CRTC would make the kernel reject
+       * the page flip events of the commit */
+      crtc_state = meta_kms_crtc_get_current_state (crtc);
+      if (crtc_state && !crtc_state->is_drm_mode_valid)
+        return TRUE;
+
+      if (!add_property (commit, crtc_id, DRM_MODE_OBJECT_CRTC,
+                         "MODE_ID", 0, error) ||
+          !add_property (commit, crtc_id, DRM_MODE_OBJECT_CRTC,
+                         "ACTIVE", 0, error))
+        return FALSE;
+
+      if (!disable_planes_on_crtc (commit, update, crtc, error))
+        return FALSE;
+    }
+
+  /* Detach the connectors previously driven by the CRTC, unless they
+   * are driven by a CRTC of this update */
+  for (l = meta_kms_device_get_connectors (commit->device); l; l = l->next)
+    {
+      MetaKmsConnector *connector = l->data;
+      const MetaKmsConnectorState *connector_state;
+
+      connector_state = meta_kms_connector_get_current_state (connector);
+      if (!connector_state || connector_state->current_crtc_id != crtc_id)
+        continue;
+
+      if (is_connector_mode_set (update, connector))
+        continue;
+
+      if (!add_property (commit, meta_kms_connector_get_id (connector),
+                         DRM_MODE_OBJECT_CONNECTOR,
+                         "CRTC_ID", 0, error))
+        return FALSE;
+    }
+
+  commit->flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+
+  return TRUE;
+}
+
+static MetaKmsCrtc *
+find_crtc (MetaKmsDevice *device,
+           uint32_t       crtc_id)
+{
+  GList *l;
+
+  for (l = meta_kms_device_get_crtcs (device); l; l = l->next)
+    {
+      MetaKmsCrtc *crtc = l->data;
+
+      if (meta_kms_crtc_get_id (crtc) == crtc_id)
+        return crtc;
+    }
+
+  return NULL;
+}
+
+static gboolean
+add_connector_property (AtomicCommit              *commit,
+                        MetaKmsUpdate             *update,
+                        MetaKmsConnectorProperty  *connector_property,
+                        GError                   **error)
+{
+  MetaKmsConnector *connector = connector_property->connector;
+  uint32_t connector_id = meta_kms_connector_get_id (connector);
+
+  /* DPMS can't be set through the atomic API; the CRTC driving the
+   * connector is deactivated instead */
+  if (is_property (commit->atomic_device, connector_id,
+                   DRM_MODE_OBJECT_CONNECTOR,
+                   connector_property->prop_id, "DPMS"))
+    {
+      const MetaKmsConnectorState *connector_state;
+      MetaKmsCrtc *crtc;
+
+      connector_state = meta_kms_connector_get_current_state (connector);
+      if (!connector_state || !connector_state->current_crtc_id)
+        return TRUE;
+
+      crtc = find_crtc (commit->device, connector_state->current_crtc_id);
+      if (!crtc || is_crtc_mode_set (update, crtc))
+        return TRUE;
+
+      commit->flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
+
+      return add_property (commit, meta_kms_crtc_get_id (crtc),
+                           DRM_MODE_OBJECT_CRTC, "ACTIVE",
+                           connector_property->value == DRM_MODE_DPMS_ON,
+                           error);
+    }
+
+  return add_raw_property (commit, connector_id,
+                           connector_property->prop_id,
+                           connector_property->value,
+                           error);
+}
+
+static gboolean
+add_crtc_gamma (AtomicCommit      *commit,
+                MetaKmsCrtcGamma  *gamma,
+                GError           **error)
+{
+  MetaKmsCrtc *crtc = gamma->crtc;
+  uint32_t crtc_id = meta_kms_crtc_get_id (crtc);
+  g_autofree struct drm_color_lut *lut = NULL;
+  uint32_t blob_id;
+  int i;
+
+  if (!find_property (commit->atomic_device, crtc_id, DRM_MODE_OBJECT_CRTC,
+                      "GAMMA_LUT"))
+    {
+      commit->legacy_gammas = g_list_prepend (commit->legacy_gammas, gamma);
+      return TRUE;
+    }
+
+  if (!g_hash_table_contains (commit->new_gamma_blobs, crtc))
+    {
+      lut = g_new0 (struct drm_color_lut, gamma->size);
+      for (i = 0; i < gamma->size; i++)
+        {
+          lut[i].red = gamma->red[i];
+          lut[i].green = gamma->green[i];
+          lut[i].blue = gamma->blue[i];
+        }
+    }
+
+  if (!ensure_blob (commit, commit->new_gamma_blobs, crtc,
+                    lut, sizeof (struct drm_color_lut) * gamma->size,
+                    &blob_id, error))
+    return FALSE;
+
+  return add_property (commit, crtc_id, DRM_MODE_OBJECT_CRTC,
+                       "GAMMA_LUT", blob_id, error);
+}
+
+static gboolean
+build_request (AtomicCommit   *commit,
+               MetaKmsUpdate  *update,
+               GError        **error)
+{
+  GList *l;
+
+  g_clear_pointer (&commit->req, drmModeAtomicFree);
+  commit->req = drmModeAtomicAlloc ();
+  commit->flags = 0;
+  g_clear_pointer (&commit->legacy_gammas, g_list_free);
+
+  for (l = meta_kms_update_get_connector_properties (update); l; l = l->next)
+    {
+      MetaKmsConnectorProperty *connector_property = l->data;
+
+      if (connector_property->device != commit->device)
+        continue;
+
+      if (!add_connector_property (commit, update, connector_property, error))
+        return FALSE;
+    }
+
+  for (l = meta_kms_update_get_mode_sets (update); l; l = l->next)
+    {
+      MetaKmsModeSet *mode_set = l->data;
+
+      if (meta_kms_crtc_get_device (mode_set->crtc) != commit->device)
+        continue;
+
+      if (!add_mode_set (commit, update, mode_set, error))
+        return FALSE;
+    }
+
+  for (l = meta_kms_update_get_crtc_gammas (update); l; l = l->next)
+    {
+      MetaKmsCrtcGamma *gamma = l->data;
+
+      if (meta_kms_crtc_get_device (gamma->crtc) != commit->device)
+        continue;
+
+      if (!add_crtc_gamma (commit, gamma, error))
+        return FALSE;
+    }
+
+  for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+      MetaKmsPlane *plane = plane_assignment->plane;
+
+      if (meta_kms_plane_get_device (plane) != commit->device)
+        continue;
+
+      if (is_optional_plane (plane) && commit->skip_optional_planes)
+        continue;
+
+      if (!add_plane_assignment (commit, plane_assignment, error))
+        return FALSE;
+    }
+
+  if (commit->page_flips)
+    commit->flags |= DRM_MODE_PAGE_FLIP_EVENT;
+
+  /* Mode sets block, as with the legacy API, while page flips and
+   * plane updates are queued for the next vblank */
+  if (!(commit->flags & DRM_MODE_ATOMIC_ALLOW_MODESET) && commit->page_flips)
+    commit->flags |= DRM_MODE_ATOMIC_NONBLOCK;
+
+  return TRUE;
+}
+
+static gboolean
+test_request (AtomicCommit  *commit,
+              GError       **error)
+{
+  uint32_t flags;
+  int ret;
+
+  /* The kernel refuses to send events for test commits */
+  flags = commit->flags & ~DRM_MODE_PAGE_FLIP_EVENT;
+  flags |= DRM_MODE_ATOMIC_TEST_ONLY;
+
+  ret = drmModeAtomicCommit (get_fd (commit->atomic_device),
+                             commit->req,
+                             flags,
+                             commit->atomic_device->event_token);
+  if (ret != 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "Atomic test commit on %s failed: %s",
+                   meta_kms_device_get_path (commit->device),
+                   g_strerror (-ret));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Validates the configuration of @commit, leaving the cursor and
+ * overlay planes out if the configuration is only valid without them.
+ */
+static gboolean
+prepare_commit (AtomicCommit   *commit,
+                MetaKmsUpdate  *update,
+                GError        **error)
+{
+  g_autoptr (GError) local_error = NULL;
+
+  if (!build_request (commit, update, error))
+    return FALSE;
+
+  if (test_request (commit, &local_error))
+    return TRUE;
+
+  if (!commit->optional_plane_assignments)
+    {
+      g_propagate_error (error, g_steal_pointer (&local_error));
+      return FALSE;
+    }
+
+  commit->skip_optional_planes = TRUE;
+
+  return (build_request (commit, update, error) &&
+          test_request (commit, error));
+}
+
+static gboolean
+apply_commit (AtomicCommit   *commit,
+              GError        **error)
+{
+  AtomicDevice *atomic_device = commit->atomic_device;
+  GHashTableIter iter;
+  gpointer key, value;
+  GList *l;
+  int ret;
+
+  ret = drmModeAtomicCommit (get_fd (atomic_device),
+                             commit->req,
+                             commit->flags,
+                             atomic_device->event_token);
+  if (ret != 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "Atomic commit on %s failed: %s",
+                   meta_kms_device_get_path (commit->device),
+                   g_strerror (-ret));
+      return FALSE;
+    }
+
+  /* the blobs of the previous state are not referenced anymore */
+  g_hash_table_iter_init (&iter, commit->new_mode_blobs);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      gpointer old_blob;
+
+      if (g_hash_table_lookup_extended (atomic_device->mode_blobs, key,
+                                        NULL, &old_blob))
+        drmModeDestroyPropertyBlob (get_fd (atomic_device),
+                                    GPOINTER_TO_UINT (old_blob));
+      g_hash_table_insert (atomic_device->mode_blobs, key, value);
+      g_hash_table_iter_remove (&iter);
+    }
+
+  g_hash_table_iter_init (&iter, commit->new_gamma_blobs);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      gpointer old_blob;
+
+      if (g_hash_table_lookup_extended (atomic_device->gamma_blobs, key,
+                                        NULL, &old_blob))
+        drmModeDestroyPropertyBlob (get_fd (atomic_device),
+                                    GPOINTER_TO_UINT (old_blob));
+      g_hash_table_insert (atomic_device->gamma_blobs, key, value);
+      g_hash_table_iter_remove (&iter);
+    }
+
+  for (l = commit->legacy_gammas; l; l = l->next)
+    {
+      MetaKmsCrtcGamma *gamma = l->data;
+
+      drmModeCrtcSetGamma (get_fd (atomic_device),
+                           meta_kms_crtc_get_id (gamma->crtc),
+                           gamma->size,
+                           gamma->red, gamma->green, gamma->blue);
+    }
+
+  return TRUE;
+}
+
+static void
+discard_page_flips (MetaKmsImpl  *impl,
+                    GList        *page_flips,
+                    const GError *error)
+{
+  GList *l;
+
+  for (l = page_flips; l; l = l->next)
+    {
+      MetaKmsPageFlip *page_flip = l->data;
+      MetaKmsPageFlipData *page_flip_data;
+
+      page_flip_data = meta_kms_page_flip_data_new (impl,
+                                                    page_flip->crtc,
+                                                    page_flip->feedback,
+                                                    page_flip->user_data);
+      meta_kms_page_flip_data_discard_in_impl (page_flip_data, error);
+      meta_kms_page_flip_data_unref (page_flip_data);
+    }
+}
+
+static void
+queue_page_flips (MetaKmsImpl  *impl,
+                  AtomicCommit *commit)
+{
+  GList *l;
+
+  for (l = commit->page_flips; l; l = l->next)
+    {
+      MetaKmsPageFlip *page_flip = l->data;
+      MetaKmsPageFlipData *page_flip_data;
+
+      page_flip_data = meta_kms_page_flip_data_new (impl,
+                                                    page_flip->crtc,
+                                                    page_flip->feedback,
+                                                    page_flip->user_data);
+      g_hash_table_replace (commit->atomic_device->pending_page_flips,
+                            page_flip->crtc,
+                            page_flip_data);
+    }
+}
+
+static GList *
+generate_failed_plane_feedbacks (GList        *plane_assignments,
+                                 const GError *error)
+{
+  GList *failed_planes = NULL;
+  GList *l;
+
+  for (l = plane_assignments; l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+      MetaKmsPlaneFeedback *plane_feedback;
+
+      plane_feedback =
+        meta_kms_plane_feedback_new_take_error (plane_assignment->plane,
+                                                plane_assignment->crtc,
+                                                g_error_copy (error));
+      failed_planes = g_list_prepend (failed_planes, plane_feedback);
+    }
+
+  return failed_planes;
+}
+
+static void
+add_device (GList         **devices,
+            MetaKmsDevice  *device)
+{
+  if (!g_list_find (*devices, device))
+    *devices = g_list_append (*devices, device);
+}
+
+static GList *
+get_update_devices (MetaKmsUpdate *update)
+{
+  GList *devices = NULL;
+  GList *l;
+
+  for (l = meta_kms_update_get_connector_properties (update); l; l = l->next)
+    {
+      MetaKmsConnectorProperty *connector_property = l->data;
+
+      add_device (&devices, connector_property->device);
+    }
+
+  for (l = meta_kms_update_get_mode_sets (update); l; l = l->next)
+    {
+      MetaKmsModeSet *mode_set = l->data;
+
+      add_device (&devices, meta_kms_crtc_get_device (mode_set->crtc));
+    }
+
+  for (l = meta_kms_update_get_crtc_gammas (update); l; l = l->next)
+    {
+      MetaKmsCrtcGamma *gamma = l->data;
+
+      add_device (&devices, meta_kms_crtc_get_device (gamma->crtc));
+    }
+
+  for (l = meta_kms_update_get_plane_assignments (update); l; l = l->next)
+    {
+      MetaKmsPlaneAssignment *plane_assignment = l->data;
+
+      add_device (&devices, meta_kms_plane_get_device (plane_assignment->plane));
+    }
+
+  for (l = meta_kms_update_get_page_flips (update); l; l = l->next)
+    {
+      MetaKmsPageFlip *page_flip = l->data;
+
+      add_device (&devices, meta_kms_crtc_get_device (page_flip->crtc));
+    }
+
+  return devices;
+}
+
+static gboolean
+can_process_atomically (MetaKmsImplAtomic *impl_atomic,
+                        MetaKmsUpdate     *update,
+                        GList             *devices)
+{
+  GList *l;
+
+  for (l = devices; l; l = l->next)
+    {
+      if (!get_atomic_device (impl_atomic, l->data))
+        return FALSE;
+    }
+
+  /* Custom page flips are driven by EGL through the legacy API */
+  for (l = meta_kms_update_get_page_flips (update); l; l = l->next)
+    {
+      MetaKmsPageFlip *page_flip = l->data;
+
+      if (page_flip->custom_page_flip_func)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static MetaKmsFeedback *
+meta_kms_impl_atomic_process_update (MetaKmsImpl   *impl,
+                                     MetaKmsUpdate *update)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+  g_autoptr (GList) devices = NULL;
+  GList *commits = NULL;
+  GList *failed_planes = NULL;
+  GError *error = NULL;
+  GList *l;
+
+  meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl));
+
+  devices = get_update_devices (update);
+  if (!can_process_atomically (impl_atomic, update, devices))
+    {
+      return meta_kms_impl_process_update (META_KMS_IMPL (impl_atomic->fallback),
+                                           update);
+    }
+
+  for (l = devices; l; l = l->next)
+    {
+      MetaKmsDevice *device = l->data;
+      AtomicCommit *commit;
+      GList *k;
+
+      commit = atomic_commit_new (get_atomic_device (impl_atomic, device),
+                                  device);
+
+      for (k = meta_kms_update_get_plane_assignments (update); k; k = k->next)
+        {
+          MetaKmsPlaneAssignment *plane_assignment = k->data;
+
+          if (meta_kms_plane_get_device (plane_assignment->plane) == device &&
+              is_optional_plane (plane_assignment->plane))
+            {
+              commit->optional_plane_assignments =
+                g_list_prepend (commit->optional_plane_assignments,
+                                plane_assignment);
+            }
+        }
+
+      for (k = meta_kms_update_get_page_flips (update); k; k = k->next)
+        {
+          MetaKmsPageFlip *page_flip = k->data;
+
+          if (meta_kms_crtc_get_device (page_flip->crtc) == device)
+            commit->page_flips = g_list_prepend (commit->page_flips, page_flip);
+        }
+
+      commits = g_list_append (commits, commit);
+    }
+
+  /* Validate the configuration of every device before committing any,
+   * so that a configuration spanning several devices is either applied
+   * as a whole or not at all */
+  for (l = commits; l; l = l->next)
+    {
+      AtomicCommit *commit = l->data;
+
+      if (!prepare_commit (commit, update, &error))
+        goto err;
+    }
+
+  for (l = commits; l; l = l->next)
+    {
+      AtomicCommit *commit = l->data;
+      g_autoptr (GError) commit_error = NULL;
+
+      if (commit->skip_optional_planes)
+        {
+          g_autoptr (GError) plane_error = NULL;
+
+          plane_error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_FAILED,
+                                             "Rejected by the atomic check");
+          failed_planes =
+            g_list_concat (failed_planes,
+                           generate_failed_plane_feedbacks (commit->optional_plane_assignments,
+                                                            plane_error));
+        }
+
+      if (!apply_commit (commit, &commit_error))
+        {
+          discard_page_flips (impl, commit->page_flips, commit_error);
+          if (!error)
+            error = g_steal_pointer (&commit_error);
+          continue;
+        }
+
+      queue_page_flips (impl, commit);
+    }
+
+  g_list_free_full (commits, (GDestroyNotify) atomic_commit_free);
+
+  if (error)
+    return meta_kms_feedback_new_failed (failed_planes, error);
+
+  if (failed_planes)
+    {
+      g_set_error (&error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to assign one or more planes");
+      return meta_kms_feedback_new_failed (failed_planes, error);
+    }
+
+  return meta_kms_feedback_new_passed ();
+
+err:
+  for (l = commits; l; l = l->next)
+    {
+      AtomicCommit *commit = l->data;
+
+      discard_page_flips (impl, commit->page_flips, error);
+      failed_planes =
+        g_list_concat (failed_planes,
+                       generate_failed_plane_feedbacks (commit->optional_plane_assignments,
+                                                        error));
+    }
+
+  g_list_free_full (commits, (GDestroyNotify) atomic_commit_free);
+
+  return meta_kms_feedback_new_failed (failed_planes, error);
+}
+
+static MetaKmsFeedback *
+meta_kms_impl_atomic_test_update (MetaKmsImpl   *impl,
+                                  MetaKmsUpdate *update)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+  g_autoptr (GList) devices = NULL;
+  GError *error = NULL;
+  GList *l;
+
+  meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl));
+
+  devices = get_update_devices (update);
+  if (!can_process_atomically (impl_atomic, update, devices))
+    {
+      error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                   "Update can't be tested atomically");
+      return meta_kms_feedback_new_failed (NULL, error);
+    }
+
+  for (l = devices; l; l = l->next)
+    {
+      MetaKmsDevice *device = l->data;
+      AtomicCommit *commit;
+      gboolean passed;
+
+      commit = atomic_commit_new (get_atomic_device (impl_atomic, device),
+                                  device);
+      passed = (build_request (commit, update, &error) &&
+                test_request (commit, &error));
+      atomic_commit_free (commit);
+
+      if (!passed)
+        {
+          g_autoptr (GList) device_plane_assignments = NULL;
+          GList *failed_planes;
+          GList *k;
+
+          /* the assignments of the other devices were not the problem */
+          for (k = meta_kms_update_get_plane_assignments (update); k; k = k->next)
+            {
+              MetaKmsPlaneAssignment *plane_assignment = k->data;
+
+              if (meta_kms_plane_get_device (plane_assignment->plane) == device)
+                device_plane_assignments =
+                  g_list_prepend (device_plane_assignments, plane_assignment);
+            }
+
+          failed_planes =
+            generate_failed_plane_feedbacks (device_plane_assignments, error);
+          return meta_kms_feedback_new_failed (failed_planes, error);
+        }
+    }
+
+  return meta_kms_feedback_new_passed ();
+}
+
+static AtomicDevice *
+find_atomic_device_for_token (MetaKmsImplAtomic   *impl_atomic,
+                              MetaKmsPageFlipData *page_flip_data)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, impl_atomic->atomic_devices);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      AtomicDevice *atomic_device = value;
+
+      if (atomic_device->event_token == page_flip_data)
+        return atomic_device;
+    }
+
+  return NULL;
+}
+
+static void
+meta_kms_impl_atomic_handle_page_flip_event (MetaKmsImpl         *impl,
+                                             MetaKmsPageFlipData *page_flip_data,
+                                             uint32_t             crtc_id,
+                                             unsigned int         sequence,
+                                             unsigned int         sec,
+                                             unsigned int         usec)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+  AtomicDevice *atomic_device;
+  MetaKmsDevice *device;
+  MetaKmsCrtc *crtc;
+  gpointer crtc_page_flip_data;
+
+  atomic_device = find_atomic_device_for_token (impl_atomic, page_flip_data);
+  g_return_if_fail (atomic_device);
+
+  device = meta_kms_impl_device_get_device (atomic_device->impl_device);
+  crtc = find_crtc (device, crtc_id);
+
+  /* Every CRTC affected by a commit gets an event, not only the ones
+   * which had a page flip queued */
+  if (!crtc ||
+      !g_hash_table_steal_extended (atomic_device->pending_page_flips, crtc,
+                                    NULL, &crtc_page_flip_data))
+    return;
+
+  meta_kms_page_flip_data_set_timings_in_impl (crtc_page_flip_data,
+                                               sequence, sec, usec);
+  meta_kms_page_flip_data_flipped_in_impl (crtc_page_flip_data);
+  meta_kms_page_flip_data_unref (crtc_page_flip_data);
+}
+
+static void
+meta_kms_impl_atomic_handle_page_flip_callback (MetaKmsImpl         *impl,
+                                                MetaKmsPageFlipData *page_flip_data)
+{
+  meta_kms_page_flip_data_flipped_in_impl (page_flip_data);
+  meta_kms_page_flip_data_unref (page_flip_data);
+}
+
+static void
+meta_kms_impl_atomic_discard_pending_page_flips (MetaKmsImpl *impl)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+
+  /* Atomic page flips are never retried, so there is nothing pending
+   * besides what the kernel will complete */
+  meta_kms_impl_discard_pending_page_flips (META_KMS_IMPL (impl_atomic->fallback));
+}
+
+static void
+meta_kms_impl_atomic_dispatch_idle (MetaKmsImpl *impl)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+
+  meta_kms_impl_dispatch_idle (META_KMS_IMPL (impl_atomic->fallback));
+}
+
+static void
+meta_kms_impl_atomic_notify_device_created (MetaKmsImpl   *impl,
+                                            MetaKmsDevice *device)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (impl);
+  MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
+  int fd;
+
+  fd = meta_kms_impl_device_get_fd (impl_device);
+  if (drmSetClientCap (fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0)
+    {
+      g_message ("Atomic mode setting not supported by %s, "
+                 "using the legacy API",
+                 meta_kms_device_get_path (device));
+      meta_kms_impl_notify_device_created (META_KMS_IMPL (impl_atomic->fallback),
+                                           device);
+      return;
+    }
+
+  g_hash_table_insert (impl_atomic->atomic_devices,
+                       device,
+                       atomic_device_new (impl_atomic, impl_device));
+}
+
+static void
+meta_kms_impl_atomic_finalize (GObject *object)
+{
+  MetaKmsImplAtomic *impl_atomic = META_KMS_IMPL_ATOMIC (object);
+
+  g_hash_table_destroy (impl_atomic->atomic_devices);
+  g_clear_object (&impl_atomic->fallback);
+
+  G_OBJECT_CLASS (meta_kms_impl_atomic_parent_class)->finalize (object);
+}
+
+static void
+meta_kms_impl_atomic_init (MetaKmsImplAtomic *impl_atomic)
+{
+  impl_atomic->atomic_devices =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL, (GDestroyNotify) atomic_device_free);
+}
+
+static void
+meta_kms_impl_atomic_class_init (MetaKmsImplAtomicClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  MetaKmsImplClass *impl_class = META_KMS_IMPL_CLASS (klass);
+
+  object_class->finalize = meta_kms_impl_atomic_finalize;
+
+  impl_class->process_update = meta_kms_impl_atomic_process_update;
+  impl_class->test_update = meta_kms_impl_atomic_test_update;
+  impl_class->handle_page_flip_callback = meta_kms_impl_atomic_handle_page_flip_callback;
+  impl_class->handle_page_flip_event = meta_kms_impl_atomic_handle_page_flip_event;
+  impl_class->discard_pending_page_flips = meta_kms_impl_atomic_discard_pending_page_flips;
+  impl_class->dispatch_idle = meta_kms_impl_atomic_dispatch_idle;
+  impl_class->notify_device_created = meta_kms_impl_atomic_notify_device_created;
+}
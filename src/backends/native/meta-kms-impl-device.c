@@ -89,16 +89,15 @@ page_flip_handler (int           fd,
                    unsigned int  sequence,
                    unsigned int  sec,
                    unsigned int  usec,
+                   unsigned int  crtc_id,
                    void         *user_data)
 {
   MetaKmsPageFlipData *page_flip_data = user_data;
   MetaKmsImpl *impl;
 
-  meta_kms_page_flip_data_set_timings_in_impl (page_flip_data,
-                                               sequence, sec, usec);
-
   impl = meta_kms_page_flip_data_get_kms_impl (page_flip_data);
-  meta_kms_impl_handle_page_flip_callback (impl, page_flip_data);
+  meta_kms_impl_handle_page_flip_event (impl, page_flip_data, crtc_id,
+                                        sequence, sec, usec);
 }
 
 gboolean
@@ -110,8 +109,8 @@ meta_kms_impl_device_dispatch (MetaKmsImplDevice  *impl_device,
   meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl_device->impl));
 
   drm_event_context = (drmEventContext) { 0 };
-  drm_event_context.version = 2;
-  drm_event_context.page_flip_handler = page_flip_handler;
+  drm_event_context.version = 3;
+  drm_event_context.page_flip_handler2 = page_flip_handler;
 
   while (TRUE)
     {
@@ -239,11 +238,13 @@ find_existing_connector (MetaKmsImplDevice *impl_device,
   return NULL;
 }
 
-static void
+static gboolean
 update_connectors (MetaKmsImplDevice *impl_device,
                    drmModeRes        *drm_resources)
 {
   GList *connectors = NULL;
+  unsigned int n_kept = 0;
+  gboolean changed = FALSE;
   unsigned int i;
 
   for (i = 0; i < drm_resources->count_connectors; i++)
@@ -258,17 +259,48 @@ update_connectors (MetaKmsImplDevice *impl_device,
 
       connector = find_existing_connector (impl_device, drm_connector);
       if (connector)
-        connector = g_object_ref (connector);
+        {
+          connector = g_object_ref (connector);
+          if (meta_kms_connector_update_state (connector, drm_connector,
+                                               drm_resources))
+            changed = TRUE;
+          n_kept++;
+        }
       else
-        connector = meta_kms_connector_new (impl_device, drm_connector,
-                                            drm_resources);
+        {
+          connector = meta_kms_connector_new (impl_device, drm_connector,
+                                              drm_resources);
+          changed = TRUE;
+        }
       drmModeFreeConnector (drm_connector);
 
       connectors = g_list_prepend (connectors, connector);
     }
 
+  if (n_kept != g_list_length (impl_device->connectors))
+    changed = TRUE;
+
   g_list_free_full (impl_device->connectors, g_object_unref);
   impl_device->connectors = g_list_reverse (connectors);
+
+  return changed;
+}
+
+static MetaKmsConnector *
+find_connector_by_id (MetaKmsImplDevice *impl_device,
+                      uint32_t           connector_id)
+{
+  GList *l;
+
+  for (l = impl_device->connectors; l; l = l->next)
+    {
+      MetaKmsConnector *connector = l->data;
+
+      if (meta_kms_connector_get_id (connector) == connector_id)
+        return connector;
+    }
+
+  return NULL;
 }
 
 static MetaKmsPlaneType
@@ -357,32 +389,80 @@ init_planes (MetaKmsImplDevice *impl_device)
   impl_device->planes = g_list_reverse (impl_device->planes);
 }
 
-void
+/*
+ * Returns whether anything changed the monitor configuration depends on.
+ */
+gboolean
 meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device)
 {
   drmModeRes *drm_resources;
+  gboolean changed;
 
   meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl_device->impl));
 
   drm_resources = drmModeGetResources (impl_device->fd);
   if (!drm_resources)
     {
+      changed = impl_device->connectors != NULL;
+
       g_list_free_full (impl_device->planes, g_object_unref);
       g_list_free_full (impl_device->crtcs, g_object_unref);
       g_list_free_full (impl_device->connectors, g_object_unref);
       impl_device->planes = NULL;
       impl_device->crtcs = NULL;
       impl_device->connectors = NULL;
-      return;
+      return changed;
     }
 
-  update_connectors (impl_device, drm_resources);
+  changed = update_connectors (impl_device, drm_resources);
+
+  g_list_foreach (impl_device->crtcs, (GFunc) meta_kms_crtc_update_state,
+                  NULL);
+  drmModeFreeResources (drm_resources);
+
+  return changed;
+}
+
+/*
+ * Only re-reads the state of a single connector, as hinted by a hotplug
+ * uevent. Unless @probe is set, the connector isn't probed again, which is
+ * enough when it was a property of it that changed.
+ */
+gboolean
+meta_kms_impl_device_update_connector_state (MetaKmsImplDevice *impl_device,
+                                             uint32_t           connector_id,
+                                             gboolean           probe)
+{
+  MetaKmsConnector *connector;
+  drmModeRes *drm_resources;
+  drmModeConnector *drm_connector;
+  gboolean changed;
+
+  meta_assert_in_kms_impl (meta_kms_impl_get_kms (impl_device->impl));
+
+  connector = find_connector_by_id (impl_device, connector_id);
+  if (!connector)
+    return meta_kms_impl_device_update_states (impl_device);
+
+  drm_resources = drmModeGetResources (impl_device->fd);
+  if (!drm_resources)
+    return meta_kms_impl_device_update_states (impl_device);
+
+  if (probe)
+    drm_connector = drmModeGetConnector (impl_device->fd, connector_id);
+  else
+    drm_connector = drmModeGetConnectorCurrent (impl_device->fd, connector_id);
+
+  changed = meta_kms_connector_update_state (connector, drm_connector,
+                                             drm_resources);
+  if (drm_connector)
+    drmModeFreeConnector (drm_connector);
 
   g_list_foreach (impl_device->crtcs, (GFunc) meta_kms_crtc_update_state,
                   NULL);
-  g_list_foreach (impl_device->connectors, (GFunc) meta_kms_connector_update_state,
-                  drm_resources);
   drmModeFreeResources (drm_resources);
+
+  return changed;
 }
 
 void
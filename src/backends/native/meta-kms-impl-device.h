@@ -62,7 +62,11 @@ int meta_kms_impl_device_get_fd (MetaKmsImplDevice *impl_device);
 
 int meta_kms_impl_device_leak_fd (MetaKmsImplDevice *impl_device);
 
-void meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device);
+gboolean meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device);
+
+gboolean meta_kms_impl_device_update_connector_state (MetaKmsImplDevice *impl_device,
+                                                      uint32_t           connector_id,
+                                                      gboolean           probe);
 
 void meta_kms_impl_device_predict_states (MetaKmsImplDevice *impl_device,
                                           MetaKmsUpdate     *update);
@@ -793,16 +793,22 @@ process_cursor_plane_assignment (MetaKmsImpl             *impl,
 
   if (!(plane_assignment->flags & META_KMS_ASSIGN_PLANE_FLAG_FB_UNCHANGED))
     {
+      uint32_t handle;
       int width, height;
       int ret = -1;
 
+      if (plane_assignment->cursor_bo.is_valid)
+        handle = plane_assignment->cursor_bo.handle;
+      else
+        handle = plane_assignment->fb_id;
+
       width = meta_fixed_16_to_int (plane_assignment->dst_rect.width);
       height = meta_fixed_16_to_int (plane_assignment->dst_rect.height);
 
       if (plane_assignment->cursor_hotspot.is_valid)
         {
           ret = drmModeSetCursor2 (fd, meta_kms_crtc_get_id (plane_assignment->crtc),
-                                   plane_assignment->fb_id,
+                                   handle,
                                    width, height,
                                    plane_assignment->cursor_hotspot.x,
                                    plane_assignment->cursor_hotspot.y);
@@ -811,7 +817,7 @@ process_cursor_plane_assignment (MetaKmsImpl             *impl,
       if (ret != 0)
         {
           ret = drmModeSetCursor (fd, meta_kms_crtc_get_id (plane_assignment->crtc),
-                                  plane_assignment->fb_id,
+                                  handle,
                                   width, height);
         }
 
@@ -22,6 +22,10 @@
 
 #include "backends/native/meta-kms-impl.h"
 
+#include <gio/gio.h>
+
+#include "backends/native/meta-kms-update-private.h"
+
 enum
 {
   PROP_0,
@@ -51,6 +55,26 @@ meta_kms_impl_process_update (MetaKmsImpl   *impl,
   return META_KMS_IMPL_GET_CLASS (impl)->process_update (impl, update);
 }
 
+/*
+ * Checks whether @update would be accepted by the device, without applying
+ * it. Implementations that can't check an update without applying it
+ * reject every update.
+ */
+MetaKmsFeedback *
+meta_kms_impl_test_update (MetaKmsImpl   *impl,
+                           MetaKmsUpdate *update)
+{
+  MetaKmsImplClass *klass = META_KMS_IMPL_GET_CLASS (impl);
+  GError *error;
+
+  if (klass->test_update)
+    return klass->test_update (impl, update);
+
+  error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               "Updates can't be tested");
+  return meta_kms_feedback_new_failed (NULL, error);
+}
+
 void
 meta_kms_impl_handle_page_flip_callback (MetaKmsImpl         *impl,
                                          MetaKmsPageFlipData *page_flip_data)
@@ -59,6 +83,33 @@ meta_kms_impl_handle_page_flip_callback (MetaKmsImpl         *impl,
                                                              page_flip_data);
 }
 
+/*
+ * Called for each page flip event read from a device. Unless the
+ * implementation handles the events itself, @page_flip_data is the
+ * data the flip was queued with, and the event is reported for it.
+ */
+void
+meta_kms_impl_handle_page_flip_event (MetaKmsImpl         *impl,
+                                      MetaKmsPageFlipData *page_flip_data,
+                                      uint32_t             crtc_id,
+                                      unsigned int         sequence,
+                                      unsigned int         sec,
+                                      unsigned int         usec)
+{
+  MetaKmsImplClass *klass = META_KMS_IMPL_GET_CLASS (impl);
+
+  if (klass->handle_page_flip_event)
+    {
+      klass->handle_page_flip_event (impl, page_flip_data, crtc_id,
+                                     sequence, sec, usec);
+      return;
+    }
+
+  meta_kms_page_flip_data_set_timings_in_impl (page_flip_data,
+                                               sequence, sec, usec);
+  klass->handle_page_flip_callback (impl, page_flip_data);
+}
+
 void
 meta_kms_impl_discard_pending_page_flips (MetaKmsImpl *impl)
 {
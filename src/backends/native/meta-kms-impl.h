@@ -35,8 +35,16 @@ struct _MetaKmsImplClass
 
   MetaKmsFeedback * (* process_update) (MetaKmsImpl   *impl,
                                         MetaKmsUpdate *update);
+  MetaKmsFeedback * (* test_update) (MetaKmsImpl   *impl,
+                                     MetaKmsUpdate *update);
   void (* handle_page_flip_callback) (MetaKmsImpl         *impl,
                                       MetaKmsPageFlipData *page_flip_data);
+  void (* handle_page_flip_event) (MetaKmsImpl         *impl,
+                                   MetaKmsPageFlipData *page_flip_data,
+                                   uint32_t             crtc_id,
+                                   unsigned int         sequence,
+                                   unsigned int         sec,
+                                   unsigned int         usec);
   void (* discard_pending_page_flips) (MetaKmsImpl *impl);
   void (* dispatch_idle) (MetaKmsImpl *impl);
   void (* notify_device_created) (MetaKmsImpl   *impl,
@@ -48,9 +56,19 @@ MetaKms * meta_kms_impl_get_kms (MetaKmsImpl *impl);
 MetaKmsFeedback * meta_kms_impl_process_update (MetaKmsImpl   *impl,
                                                 MetaKmsUpdate *update);
 
+MetaKmsFeedback * meta_kms_impl_test_update (MetaKmsImpl   *impl,
+                                             MetaKmsUpdate *update);
+
 void meta_kms_impl_handle_page_flip_callback (MetaKmsImpl         *impl,
                                               MetaKmsPageFlipData *page_flip_data);
 
+void meta_kms_impl_handle_page_flip_event (MetaKmsImpl         *impl,
+                                           MetaKmsPageFlipData *page_flip_data,
+                                           uint32_t             crtc_id,
+                                           unsigned int         sequence,
+                                           unsigned int         sec,
+                                           unsigned int         usec);
+
 void meta_kms_impl_discard_pending_page_flips (MetaKmsImpl *impl);
 
 void meta_kms_impl_dispatch_idle (MetaKmsImpl *impl);
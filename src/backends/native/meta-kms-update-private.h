@@ -57,6 +57,12 @@ typedef struct _MetaKmsPlaneAssignment
     int x;
     int y;
   } cursor_hotspot;
+
+  /* GEM handle for the legacy cursor ioctls, which don't take a FB */
+  struct {
+    gboolean is_valid;
+    uint32_t handle;
+  } cursor_bo;
 } MetaKmsPlaneAssignment;
 
 typedef struct _MetaKmsModeSet
@@ -350,6 +350,14 @@ meta_kms_plane_assignment_set_cursor_hotspot (MetaKmsPlaneAssignment *plane_assi
   plane_assignment->cursor_hotspot.y = y;
 }
 
+void
+meta_kms_plane_assignment_set_cursor_bo_handle (MetaKmsPlaneAssignment *plane_assignment,
+                                                uint32_t                handle)
+{
+  plane_assignment->cursor_bo.is_valid = TRUE;
+  plane_assignment->cursor_bo.handle = handle;
+}
+
 MetaKmsPlaneAssignment *
 meta_kms_update_get_primary_plane_assignment (MetaKmsUpdate *update,
                                               MetaKmsCrtc   *crtc)
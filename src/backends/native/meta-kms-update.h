@@ -112,6 +112,9 @@ void meta_kms_plane_assignment_set_cursor_hotspot (MetaKmsPlaneAssignment *plane
                                                    int                     x,
                                                    int                     y);
 
+void meta_kms_plane_assignment_set_cursor_bo_handle (MetaKmsPlaneAssignment *plane_assignment,
+                                                     uint32_t                handle);
+
 static inline MetaFixed16
 meta_fixed_16_from_int (int16_t d)
 {
@@ -24,7 +24,9 @@
 
 #include "backends/native/meta-backend-native.h"
 #include "backends/native/meta-kms-device-private.h"
+#include "backends/native/meta-kms-device.h"
 #include "backends/native/meta-kms-impl.h"
+#include "backends/native/meta-kms-impl-atomic.h"
 #include "backends/native/meta-kms-impl-simple.h"
 #include "backends/native/meta-kms-update-private.h"
 #include "backends/native/meta-udev.h"
@@ -44,9 +46,13 @@
  * runs in. It uses the main GLib main loop and main context and always runs in
  * the main thread.
  *
- * The impl context is where all underlying API is being executed. While in the
- * current state, it always runs in the main thread, the aim is to be able to
- * execute the impl context in a dedicated thread.
+ * The impl context is where all underlying API is being executed. By default
+ * it runs in the main thread. When the MUFFIN_DEBUG_ENABLE_KMS_THREAD
+ * environment variable is set, it instead runs in a dedicated thread with its
+ * own GLib main context, so that page flip events are handled without waiting
+ * for the main thread to be idle. Tasks posted from the main context block
+ * until the impl thread has executed them, while results of events handled in
+ * the impl context are passed back to the main context as queued callbacks.
  *
  * The public facing MetaKms API is always assumed to be executed from the main
  * context.
@@ -98,7 +104,8 @@
  *
  * The KMS backend implementation, running in the impl context. #MetaKmsImpl
  * itself is an abstract object, with potentially multiple implementations.
- * Currently only #MetaKmsImplSimple exists.
+ * #MetaKmsImplSimple is used by default; #MetaKmsImplAtomic is used instead
+ * when the MUFFIN_DEBUG_ENABLE_ATOMIC_KMS environment variable is set.
  *
  * #MetaKmsImplSimple:
  *
@@ -106,6 +113,14 @@
  * interacted with using the transactional API, the #MetaKmsUpdate is processed
  * non-atomically.
  *
+ * #MetaKmsImplAtomic:
+ *
+ * A KMS backend implementation using the atomic API. Each #MetaKmsUpdate is
+ * validated as a whole with a test commit before being committed, with the
+ * cursor and overlay planes left out if the configuration is only valid
+ * without them. Devices without atomic support are handled by an internal
+ * #MetaKmsImplSimple.
+ *
  * #MetaKmsImplDevice:
  *
  * An object linked to a #MetaKmsDevice, but where it is executed in the impl
@@ -142,6 +157,20 @@ typedef struct _MetaKmsSimpleImplSource
   MetaKms *kms;
 } MetaKmsSimpleImplSource;
 
+typedef struct _MetaKmsImplTask
+{
+  MetaKms *kms;
+
+  MetaKmsImplTaskFunc func;
+  gpointer user_data;
+  GError **error;
+
+  GMutex mutex;
+  GCond cond;
+  gboolean done;
+  gpointer ret;
+} MetaKmsImplTask;
+
 typedef struct _MetaKmsFdImplSource
 {
   GSource source;
@@ -164,12 +193,20 @@ struct _MetaKms
 
   MetaKmsImpl *impl;
   gboolean in_impl_task;
-  gboolean waiting_for_impl_task;
+
+  /* number of threads waiting for an impl task to complete */
+  int waiting_for_impl_task;
+
+  GThread *impl_thread;
+  GMainContext *impl_context;
+  GMainLoop *impl_loop;
 
   GList *devices;
 
   MetaKmsUpdate *pending_update;
 
+  /* callbacks can be queued from the impl thread */
+  GMutex callbacks_mutex;
   GList *pending_callbacks;
   guint callback_source_id;
 };
@@ -216,7 +253,19 @@ meta_kms_process_update_in_impl (MetaKmsImpl  *impl,
   return feedback;
 }
 
-static MetaKmsFeedback *
+/**
+ * meta_kms_post_update_sync:
+ * @kms: a #MetaKms
+ * @update: (transfer full): the update to post
+ *
+ * Posts @update, which, contrary to the pending update, doesn't need to be
+ * created from the main context. When the impl context runs in its own
+ * thread (see meta_kms_has_impl_thread()), this can be called from any
+ * thread, e.g. to move the cursor plane from the input thread.
+ *
+ * Returns: (transfer full): the feedback of the update
+ */
+MetaKmsFeedback *
 meta_kms_post_update_sync (MetaKms       *kms,
                            MetaKmsUpdate *update)
 {
@@ -231,6 +280,41 @@ meta_kms_post_update_sync (MetaKms       *kms,
                                       NULL);
 }
 
+static gpointer
+meta_kms_test_update_in_impl (MetaKmsImpl  *impl,
+                              gpointer      user_data,
+                              GError      **error)
+{
+  MetaKmsUpdate *update = user_data;
+
+  return meta_kms_impl_test_update (impl, update);
+}
+
+/**
+ * meta_kms_test_update_sync:
+ * @kms: a #MetaKms
+ * @update: the update to test
+ *
+ * Checks whether @update would be accepted by the devices it touches,
+ * without applying it and without affecting the pending update. Only the
+ * atomic implementation can test updates; otherwise every update is
+ * reported as failed.
+ *
+ * Returns: (transfer full): the feedback of the test
+ */
+MetaKmsFeedback *
+meta_kms_test_update_sync (MetaKms       *kms,
+                           MetaKmsUpdate *update)
+{
+  COGL_TRACE_BEGIN_SCOPED (MetaKmsTestUpdateSync,
+                           "KMS (test update)");
+
+  return meta_kms_run_impl_task_sync (kms,
+                                      meta_kms_test_update_in_impl,
+                                      update,
+                                      NULL);
+}
+
 MetaKmsFeedback *
 meta_kms_post_pending_update_sync (MetaKms *kms)
 {
@@ -265,14 +349,15 @@ meta_kms_callback_data_free (MetaKmsCallbackData *callback_data)
 }
 
 static int
-flush_callbacks (MetaKms *kms)
+flush_callbacks (MetaKms *kms,
+                 GList   *callbacks)
 {
   GList *l;
   int callback_count = 0;
 
   meta_assert_not_in_kms_impl (kms);
 
-  for (l = kms->pending_callbacks; l; l = l->next)
+  for (l = callbacks; l; l = l->next)
     {
       MetaKmsCallbackData *callback_data = l->data;
 
@@ -281,8 +366,7 @@ flush_callbacks (MetaKms *kms)
       callback_count++;
     }
 
-  g_list_free (kms->pending_callbacks);
-  kms->pending_callbacks = NULL;
+  g_list_free (callbacks);
 
   return callback_count;
 }
@@ -291,10 +375,15 @@ static gboolean
 callback_idle (gpointer user_data)
 {
   MetaKms *kms = user_data;
+  GList *callbacks;
 
-  flush_callbacks (kms);
-
+  g_mutex_lock (&kms->callbacks_mutex);
+  callbacks = g_steal_pointer (&kms->pending_callbacks);
   kms->callback_source_id = 0;
+  g_mutex_unlock (&kms->callbacks_mutex);
+
+  flush_callbacks (kms, callbacks);
+
   return G_SOURCE_REMOVE;
 }
 
@@ -312,21 +401,84 @@ meta_kms_queue_callback (MetaKms         *kms,
     .user_data = user_data,
     .user_data_destroy = user_data_destroy,
   };
+
+  g_mutex_lock (&kms->callbacks_mutex);
   kms->pending_callbacks = g_list_append (kms->pending_callbacks,
                                           callback_data);
   if (!kms->callback_source_id)
     kms->callback_source_id = g_idle_add (callback_idle, kms);
+  g_mutex_unlock (&kms->callbacks_mutex);
 }
 
 int
 meta_kms_flush_callbacks (MetaKms *kms)
 {
-  int callback_count;
+  GList *callbacks;
 
-  callback_count = flush_callbacks (kms);
+  /* Callbacks queued from now on get a new idle source */
+  g_mutex_lock (&kms->callbacks_mutex);
+  callbacks = g_steal_pointer (&kms->pending_callbacks);
   g_clear_handle_id (&kms->callback_source_id, g_source_remove);
+  g_mutex_unlock (&kms->callbacks_mutex);
 
-  return callback_count;
+  return flush_callbacks (kms, callbacks);
+}
+
+static gboolean
+impl_task_dispatch (gpointer user_data)
+{
+  MetaKmsImplTask *task = user_data;
+  gpointer ret;
+
+  ret = task->func (task->kms->impl, task->user_data, task->error);
+
+  g_mutex_lock (&task->mutex);
+  task->ret = ret;
+  task->done = TRUE;
+  g_cond_signal (&task->cond);
+  g_mutex_unlock (&task->mutex);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+run_impl_task_in_thread (MetaKms              *kms,
+                         MetaKmsImplTaskFunc   func,
+                         gpointer              user_data,
+                         GError              **error)
+{
+  MetaKmsImplTask task;
+
+  task = (MetaKmsImplTask) {
+    .kms = kms,
+    .func = func,
+    .user_data = user_data,
+    .error = error,
+  };
+  g_mutex_init (&task.mutex);
+  g_cond_init (&task.cond);
+
+  g_atomic_int_inc (&kms->waiting_for_impl_task);
+
+  /* Run before any other source of the impl context, e.g. page flip
+   * retries, as the caller is blocked until the task is done */
+  g_main_context_invoke_full (kms->impl_context,
+                              G_PRIORITY_HIGH,
+                              impl_task_dispatch,
+                              &task,
+                              NULL);
+
+  g_mutex_lock (&task.mutex);
+  while (!task.done)
+    g_cond_wait (&task.cond, &task.mutex);
+  g_mutex_unlock (&task.mutex);
+
+  g_atomic_int_add (&kms->waiting_for_impl_task, -1);
+
+  g_mutex_clear (&task.mutex);
+  g_cond_clear (&task.cond);
+
+  return task.ret;
 }
 
 gpointer
@@ -337,10 +489,18 @@ meta_kms_run_impl_task_sync (MetaKms              *kms,
 {
   gpointer ret;
 
+  if (kms->impl_thread)
+    {
+      if (g_thread_self () == kms->impl_thread)
+        return func (kms->impl, user_data, error);
+      else
+        return run_impl_task_in_thread (kms, func, user_data, error);
+    }
+
   kms->in_impl_task = TRUE;
-  kms->waiting_for_impl_task = TRUE;
+  kms->waiting_for_impl_task++;
   ret = func (kms->impl, user_data, error);
-  kms->waiting_for_impl_task = FALSE;
+  kms->waiting_for_impl_task--;
   kms->in_impl_task = FALSE;
 
   return ret;
@@ -456,26 +616,61 @@ meta_kms_register_fd_in_impl (MetaKms             *kms,
 gboolean
 meta_kms_in_impl_task (MetaKms *kms)
 {
+  if (kms->impl_thread)
+    return g_thread_self () == kms->impl_thread;
+
   return kms->in_impl_task;
 }
 
+gboolean
+meta_kms_has_impl_thread (MetaKms *kms)
+{
+  return kms->impl_thread != NULL;
+}
+
 gboolean
 meta_kms_is_waiting_for_impl_task (MetaKms *kms)
 {
-  return kms->waiting_for_impl_task;
+  return g_atomic_int_get (&kms->waiting_for_impl_task) > 0;
 }
 
+/*
+ * What a hotplug uevent tells about what changed. Everything that is left
+ * unset is updated.
+ */
+typedef struct _MetaKmsUpdateStatesHint
+{
+  const char *device_path;
+  uint32_t connector_id;
+  uint32_t property_id;
+
+  gboolean changed;
+} MetaKmsUpdateStatesHint;
+
 static void
-meta_kms_update_states_in_impl (MetaKms *kms)
+meta_kms_update_states_in_impl (MetaKms                 *kms,
+                                MetaKmsUpdateStatesHint *hint)
 {
+  GList *l;
+
   COGL_TRACE_BEGIN_SCOPED (MetaKmsUpdateStates,
                            "KMS (update states)");
 
   meta_assert_in_kms_impl (kms);
 
-  g_list_foreach (kms->devices,
-                  (GFunc) meta_kms_device_update_states_in_impl,
-                  NULL);
+  for (l = kms->devices; l; l = l->next)
+    {
+      MetaKmsDevice *device = l->data;
+
+      if (hint->device_path &&
+          g_strcmp0 (meta_kms_device_get_path (device), hint->device_path) != 0)
+        continue;
+
+      if (meta_kms_device_update_states_in_impl (device,
+                                                 hint->connector_id,
+                                                 hint->property_id))
+        hint->changed = TRUE;
+    }
 }
 
 static gpointer
@@ -483,39 +678,57 @@ update_states_in_impl (MetaKmsImpl  *impl,
                        gpointer      user_data,
                        GError      **error)
 {
-  MetaKms *kms = meta_kms_impl_get_kms (impl);;
+  MetaKms *kms = meta_kms_impl_get_kms (impl);
+  MetaKmsUpdateStatesHint *hint = user_data;
 
-  meta_kms_update_states_in_impl (kms);
+  meta_kms_update_states_in_impl (kms, hint);
 
   return GINT_TO_POINTER (TRUE);
 }
 
 static gboolean
-meta_kms_update_states_sync (MetaKms  *kms,
-                             GError  **error)
+meta_kms_update_states_sync (MetaKms                  *kms,
+                             MetaKmsUpdateStatesHint  *hint,
+                             GError                  **error)
 {
   gpointer ret;
 
-  ret = meta_kms_run_impl_task_sync (kms, update_states_in_impl, NULL, error);
+  ret = meta_kms_run_impl_task_sync (kms, update_states_in_impl, hint, error);
   return GPOINTER_TO_INT (ret);
 }
 
 static void
-handle_hotplug_event (MetaKms *kms)
+handle_hotplug_event (MetaKms                 *kms,
+                      MetaKmsUpdateStatesHint *hint)
 {
   g_autoptr (GError) error = NULL;
 
-  if (!meta_kms_update_states_sync (kms, &error))
-    g_warning ("Updating KMS state failed: %s", error->message);
+  if (!meta_kms_update_states_sync (kms, hint, &error))
+    {
+      g_warning ("Updating KMS state failed: %s", error->message);
+      hint->changed = TRUE;
+    }
+
+  /* Reconfiguring the monitors is the expensive part, so don't when all
+   * that changed is invisible to it */
+  if (!hint->changed)
+    return;
 
   g_signal_emit (kms, signals[RESOURCES_CHANGED], 0);
 }
 
 static void
-on_udev_hotplug (MetaUdev *udev,
-                 MetaKms  *kms)
+on_udev_hotplug (MetaUdev    *udev,
+                 GUdevDevice *device,
+                 MetaKms     *kms)
 {
-  handle_hotplug_event (kms);
+  MetaKmsUpdateStatesHint hint = { 0 };
+
+  hint.device_path = g_udev_device_get_device_file (device);
+  hint.connector_id = g_udev_device_get_property_as_int (device, "CONNECTOR");
+  hint.property_id = g_udev_device_get_property_as_int (device, "PROPERTY");
+
+  handle_hotplug_event (kms, &hint);
 }
 
 static void
@@ -523,7 +736,10 @@ on_udev_device_removed (MetaUdev    *udev,
                         GUdevDevice *device,
                         MetaKms     *kms)
 {
-  handle_hotplug_event (kms);
+  MetaKmsUpdateStatesHint hint = { 0 };
+
+  hint.changed = TRUE;
+  handle_hotplug_event (kms, &hint);
 }
 
 MetaBackend *
@@ -564,6 +780,47 @@ meta_kms_create_device (MetaKms            *kms,
   return device;
 }
 
+static gpointer
+impl_thread_func (gpointer user_data)
+{
+  MetaKms *kms = user_data;
+
+  g_main_context_push_thread_default (kms->impl_context);
+  g_main_loop_run (kms->impl_loop);
+  g_main_context_pop_thread_default (kms->impl_context);
+
+  return NULL;
+}
+
+static void
+start_impl_thread (MetaKms *kms)
+{
+  kms->impl_context = g_main_context_new ();
+  kms->impl_loop = g_main_loop_new (kms->impl_context, FALSE);
+  kms->impl_thread = g_thread_new ("KMS thread", impl_thread_func, kms);
+}
+
+static gboolean
+quit_impl_loop (gpointer user_data)
+{
+  MetaKms *kms = user_data;
+
+  g_main_loop_quit (kms->impl_loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+stop_impl_thread (MetaKms *kms)
+{
+  g_main_context_invoke (kms->impl_context, quit_impl_loop, kms);
+  g_thread_join (kms->impl_thread);
+  kms->impl_thread = NULL;
+
+  g_clear_pointer (&kms->impl_loop, g_main_loop_unref);
+  g_clear_pointer (&kms->impl_context, g_main_context_unref);
+}
+
 MetaKms *
 meta_kms_new (MetaBackend  *backend,
               GError      **error)
@@ -574,13 +831,19 @@ meta_kms_new (MetaBackend  *backend,
 
   kms = g_object_new (META_TYPE_KMS, NULL);
   kms->backend = backend;
-  kms->impl = META_KMS_IMPL (meta_kms_impl_simple_new (kms, error));
+  if (g_getenv ("MUFFIN_DEBUG_ENABLE_ATOMIC_KMS"))
+    kms->impl = META_KMS_IMPL (meta_kms_impl_atomic_new (kms, error));
+  else
+    kms->impl = META_KMS_IMPL (meta_kms_impl_simple_new (kms, error));
   if (!kms->impl)
     {
       g_object_unref (kms);
       return NULL;
     }
 
+  if (g_getenv ("MUFFIN_DEBUG_ENABLE_KMS_THREAD"))
+    start_impl_thread (kms);
+
   kms->hotplug_handler_id =
     g_signal_connect (udev, "hotplug", G_CALLBACK (on_udev_hotplug), kms);
   kms->removed_handler_id =
@@ -598,13 +861,17 @@ meta_kms_finalize (GObject *object)
   MetaUdev *udev = meta_backend_native_get_udev (backend_native);
   GList *l;
 
+  g_list_free_full (kms->devices, g_object_unref);
+
+  if (kms->impl_thread)
+    stop_impl_thread (kms);
+
   for (l = kms->pending_callbacks; l; l = l->next)
     meta_kms_callback_data_free (l->data);
   g_list_free (kms->pending_callbacks);
 
   g_clear_handle_id (&kms->callback_source_id, g_source_remove);
-
-  g_list_free_full (kms->devices, g_object_unref);
+  g_mutex_clear (&kms->callbacks_mutex);
 
   g_clear_signal_handler (&kms->hotplug_handler_id, udev);
   g_clear_signal_handler (&kms->removed_handler_id, udev);
@@ -615,6 +882,7 @@ meta_kms_finalize (GObject *object)
 static void
 meta_kms_init (MetaKms *kms)
 {
+  g_mutex_init (&kms->callbacks_mutex);
 }
 
 static void
@@ -34,6 +34,14 @@ MetaKmsUpdate * meta_kms_get_pending_update (MetaKms *kms);
 
 MetaKmsFeedback * meta_kms_post_pending_update_sync (MetaKms *kms);
 
+MetaKmsFeedback * meta_kms_post_update_sync (MetaKms       *kms,
+                                             MetaKmsUpdate *update);
+
+MetaKmsFeedback * meta_kms_test_update_sync (MetaKms       *kms,
+                                             MetaKmsUpdate *update);
+
+gboolean meta_kms_has_impl_thread (MetaKms *kms);
+
 void meta_kms_discard_pending_page_flips (MetaKms *kms);
 
 MetaBackend * meta_kms_get_backend (MetaKms *kms);
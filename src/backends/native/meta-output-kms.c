@@ -389,7 +389,7 @@ meta_create_kms_output (MetaGpuKms        *gpu_kms,
   output->supports_underscanning =
     meta_kms_connector_is_underscanning_supported (kms_connector);
 
-  meta_output_parse_edid (output, connector_state->edid_data);
+  meta_output_set_edid_info (output, connector_state->edid_info);
 
   output->connector_type = meta_kms_connector_get_connector_type (kms_connector);
 
@@ -46,10 +46,29 @@
 #endif
 
 static void
-paint_egl_image (MetaGles3   *gles3,
-                 EGLImageKHR  egl_image,
-                 int          width,
-                 int          height)
+blit_rectangle (MetaGles3                   *gles3,
+                const cairo_rectangle_int_t *rect,
+                int                          height)
+{
+  int x1 = rect->x;
+  int x2 = rect->x + rect->width;
+
+  /* The image rows are stored top to bottom, while the surface is
+   * addressed bottom to top */
+  GLBAS (gles3, glBlitFramebuffer, (x1, rect->y + rect->height,
+                                    x2, rect->y,
+                                    x1, height - rect->y - rect->height,
+                                    x2, height - rect->y,
+                                    GL_COLOR_BUFFER_BIT,
+                                    GL_NEAREST));
+}
+
+static void
+paint_egl_image (MetaGles3            *gles3,
+                 EGLImageKHR           egl_image,
+                 int                   width,
+                 int                   height,
+                 const cairo_region_t *region)
 {
   GLuint texture;
   GLuint framebuffer;
@@ -78,23 +97,44 @@ paint_egl_image (MetaGles3   *gles3,
                                          GL_TEXTURE_2D, texture, 0));
 
   GLBAS (gles3, glBindFramebuffer, (GL_READ_FRAMEBUFFER, framebuffer));
-  GLBAS (gles3, glBlitFramebuffer, (0, height, width, 0,
-                                    0, 0, width, height,
-                                    GL_COLOR_BUFFER_BIT,
-                                    GL_NEAREST));
+
+  if (region)
+    {
+      int n_rects, i;
+
+      n_rects = cairo_region_num_rectangles (region);
+      for (i = 0; i < n_rects; i++)
+        {
+          cairo_rectangle_int_t rect;
+
+          cairo_region_get_rectangle (region, i, &rect);
+          blit_rectangle (gles3, &rect, height);
+        }
+    }
+  else
+    {
+      cairo_rectangle_int_t rect = { 0, 0, width, height };
+
+      blit_rectangle (gles3, &rect, height);
+    }
 
   GLBAS (gles3, glDeleteTextures, (1, &texture));
   GLBAS (gles3, glDeleteFramebuffers, (1, &framebuffer));
 }
 
+/*
+ * Only the part of the surface in @region is updated, the whole of it if
+ * @region is %NULL.
+ */
 gboolean
-meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
-                                           MetaGles3      *gles3,
-                                           EGLDisplay      egl_display,
-                                           EGLContext      egl_context,
-                                           EGLSurface      egl_surface,
-                                           struct gbm_bo  *shared_bo,
-                                           GError        **error)
+meta_renderer_native_gles3_blit_shared_bo (MetaEgl              *egl,
+                                           MetaGles3            *gles3,
+                                           EGLDisplay            egl_display,
+                                           EGLContext            egl_context,
+                                           EGLSurface            egl_surface,
+                                           struct gbm_bo        *shared_bo,
+                                           const cairo_region_t *region,
+                                           GError              **error)
 {
   int shared_bo_fd;
   unsigned int width;
@@ -152,7 +192,7 @@ meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
   if (!egl_image)
     return FALSE;
 
-  paint_egl_image (gles3, egl_image, width, height);
+  paint_egl_image (gles3, egl_image, width, height, region);
 
   meta_egl_destroy_image (egl, egl_display, egl_image, NULL);
 
@@ -24,17 +24,19 @@
 #ifndef META_RENDERER_NATIVE_GLES3_H
 #define META_RENDERER_NATIVE_GLES3_H
 
+#include <cairo.h>
 #include <gbm.h>
 
 #include "backends/meta-egl.h"
 #include "backends/meta-gles3.h"
 
-gboolean meta_renderer_native_gles3_blit_shared_bo (MetaEgl       *egl,
-                                                    MetaGles3     *gles3,
-                                                    EGLDisplay     egl_display,
-                                                    EGLContext     egl_context,
-                                                    EGLSurface     egl_surface,
-                                                    struct gbm_bo *shared_bo,
-                                                    GError       **error);
+gboolean meta_renderer_native_gles3_blit_shared_bo (MetaEgl              *egl,
+                                                    MetaGles3            *gles3,
+                                                    EGLDisplay            egl_display,
+                                                    EGLContext            egl_context,
+                                                    EGLSurface            egl_surface,
+                                                    struct gbm_bo        *shared_bo,
+                                                    const cairo_region_t *region,
+                                                    GError              **error);
 
 #endif /* META_RENDERER_NATIVE_GLES3_H */
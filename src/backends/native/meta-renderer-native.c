@@ -63,12 +63,16 @@
 #include "backends/native/meta-drm-buffer-import.h"
 #include "backends/native/meta-drm-buffer.h"
 #include "backends/native/meta-gpu-kms.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device.h"
+#include "backends/native/meta-kms-plane.h"
 #include "backends/native/meta-kms-update.h"
 #include "backends/native/meta-kms-utils.h"
 #include "backends/native/meta-kms.h"
 #include "backends/native/meta-output-kms.h"
 #include "backends/native/meta-renderer-native-gles3.h"
 #include "backends/native/meta-renderer-native.h"
+#include "clutter/clutter-muffin.h"
 //#include "cogl/cogl-framebuffer.h"
 #include "cogl/cogl.h"
 #include "core/boxes-private.h"
@@ -77,6 +81,18 @@
 #define EGL_DRM_MASTER_FD_EXT 0x333C
 #endif
 
+#ifndef EGL_BUFFER_AGE_EXT
+#define EGL_BUFFER_AGE_EXT 0x313D
+#endif
+
+/* Read backs into dumb buffers of at least this many pixels go through
+ * cached memory, from where they are copied by several threads */
+#define PARALLEL_COPY_MIN_PIXELS (512 * 512)
+#define MAX_COPY_THREADS 4
+
+/* Number of overlay plane test results remembered per onscreen */
+#define MAX_OVERLAY_TEST_RESULTS 64
+
 /* added in libdrm 2.4.95 */
 #ifndef DRM_FORMAT_INVALID
 #define DRM_FORMAT_INVALID 0
@@ -129,6 +145,7 @@ typedef struct _MetaRendererNativeGpuData
     MetaSharedFramebufferCopyMode copy_mode;
     gboolean is_hardware_rendering;
     gboolean has_EGL_EXT_image_dma_buf_import_modifiers;
+    gboolean has_EGL_EXT_buffer_age;
 
     /* For GPU blit mode */
     EGLContext egl_context;
@@ -175,8 +192,20 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   struct {
     MetaDumbBuffer *dumb_fb;
     MetaDumbBuffer dumb_fbs[2];
+
+    /* the frame each of dumb_fbs was last copied to in, 0 if never */
+    int64_t dumb_fb_frames[2];
+
+    /* laid out like the dumb buffers, see read_pixels_into_dumb_buffer() */
+    uint8_t *staging;
   } cpu;
 
+  /* the damage of the primary GPU framebuffer in the last frames, so that
+   * only what a buffer misses is copied to it */
+  ClutterDamageHistory *damage_history;
+  int64_t frame_count;
+  int64_t last_gpu_copy_frame;
+
   int pending_flips;
 
   gboolean noted_primary_gpu_copy_ok;
@@ -184,6 +213,27 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   MetaSharedFramebufferImportStatus import_status;
 } MetaOnscreenNativeSecondaryGpuState;
 
+/* A buffer scanned out directly on an overlay plane */
+typedef struct _MetaOnscreenNativeOverlay
+{
+  MetaKmsPlane *plane;
+  MetaDrmBuffer *buffer;
+  MetaFixed16Rectangle src_rect;
+  MetaFixed16Rectangle dst_rect;
+} MetaOnscreenNativeOverlay;
+
+/* What the result of testing an overlay plane assignment depends on */
+typedef struct _MetaOverlayTestKey
+{
+  MetaKmsPlane *plane;
+  uint32_t drm_format;
+  uint64_t drm_modifier;
+  int src_width;
+  int src_height;
+  int dst_width;
+  int dst_height;
+} MetaOverlayTestKey;
+
 typedef struct _MetaOnscreenNative
 {
   MetaRendererNative *renderer_native;
@@ -199,6 +249,18 @@ typedef struct _MetaOnscreenNative
     MetaDrmBuffer *next_fb;
   } gbm;
 
+  /* MetaOnscreenNativeOverlay, see meta_onscreen_native_try_assign_overlay() */
+  struct {
+    GList *current;
+    GList *next;
+
+    /* set when the overlays were dropped when committing the last frame */
+    gboolean rejected;
+
+    /* MetaOverlayTestKey -> whether the test passed */
+    GHashTable *test_results;
+  } overlays;
+
 #ifdef HAVE_EGL_DEVICE
   struct {
     EGLStreamKHR stream;
@@ -239,6 +301,8 @@ struct _MetaRendererNative
 
   GList *power_save_page_flip_onscreens;
   guint power_save_page_flip_source_id;
+
+  GThreadPool *copy_thread_pool;
 };
 
 static void
@@ -475,6 +539,7 @@ init_secondary_gpu_state_gpu_copy_mode (MetaRendererNative         *renderer_nat
   secondary_gpu_state->renderer_gpu_data = renderer_gpu_data;
   secondary_gpu_state->gbm.surface = gbm_surface;
   secondary_gpu_state->egl_surface = egl_surface;
+  secondary_gpu_state->damage_history = clutter_damage_history_new ();
 
   onscreen_native->secondary_gpu_state = secondary_gpu_state;
 
@@ -513,10 +578,87 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
 
   secondary_gpu_release_dumb (secondary_gpu_state);
+  g_clear_pointer (&secondary_gpu_state->cpu.staging, g_free);
+
+  g_clear_pointer (&secondary_gpu_state->damage_history,
+                   clutter_damage_history_free);
 
   g_free (secondary_gpu_state);
 }
 
+static void
+secondary_gpu_record_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                             CoglOnscreen                        *onscreen,
+                             const int                           *rectangles,
+                             int                                  n_rectangles)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
+  cairo_rectangle_int_t fb_rect;
+  cairo_region_t *damage;
+
+  fb_rect = (cairo_rectangle_int_t) {
+    .width = cogl_framebuffer_get_width (framebuffer),
+    .height = cogl_framebuffer_get_height (framebuffer),
+  };
+
+  if (n_rectangles == 0)
+    {
+      damage = cairo_region_create_rectangle (&fb_rect);
+    }
+  else
+    {
+      g_autofree cairo_rectangle_int_t *rects = NULL;
+      int i;
+
+      rects = g_new (cairo_rectangle_int_t, n_rectangles);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          rects[i] = (cairo_rectangle_int_t) {
+            .x = rectangles[i * 4],
+            .y = rectangles[i * 4 + 1],
+            .width = rectangles[i * 4 + 2],
+            .height = rectangles[i * 4 + 3],
+          };
+        }
+
+      damage = cairo_region_create_rectangles (rects, n_rectangles);
+      cairo_region_intersect_rectangle (damage, &fb_rect);
+    }
+
+  clutter_damage_history_step (secondary_gpu_state->damage_history);
+  clutter_damage_history_record (secondary_gpu_state->damage_history, damage);
+  secondary_gpu_state->frame_count++;
+
+  cairo_region_destroy (damage);
+}
+
+/*
+ * Returns the part of the output a buffer that was last updated @age
+ * frames ago misses, or NULL if all of it has to be copied.
+ */
+static cairo_region_t *
+secondary_gpu_get_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                               int64_t                              age)
+{
+  ClutterDamageHistory *damage_history = secondary_gpu_state->damage_history;
+  cairo_region_t *region;
+  int i;
+
+  if (age < 1 || age > G_MAXINT)
+    return NULL;
+
+  if (age > 1 &&
+      !clutter_damage_history_is_age_valid (damage_history, (int) age - 1))
+    return NULL;
+
+  region = cairo_region_copy (clutter_damage_history_lookup (damage_history, 0));
+  for (i = 1; i < age; i++)
+    cairo_region_union (region,
+                        clutter_damage_history_lookup (damage_history, i));
+
+  return region;
+}
+
 static uint32_t
 pick_secondary_gpu_framebuffer_format_for_cpu (CoglOnscreen *onscreen)
 {
@@ -616,6 +758,7 @@ init_secondary_gpu_state_cpu_copy_mode (MetaRendererNative         *renderer_nat
   secondary_gpu_state->renderer_gpu_data = renderer_gpu_data;
   secondary_gpu_state->gpu_kms = gpu_kms;
   secondary_gpu_state->egl_surface = EGL_NO_SURFACE;
+  secondary_gpu_state->damage_history = clutter_damage_history_new ();
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
     {
@@ -761,6 +904,13 @@ free_current_secondary_bo (CoglOnscreen *onscreen)
   g_clear_object (&secondary_gpu_state->gbm.current_fb);
 }
 
+static void
+meta_onscreen_native_overlay_free (MetaOnscreenNativeOverlay *overlay)
+{
+  g_object_unref (overlay->buffer);
+  g_free (overlay);
+}
+
 static void
 free_current_bo (CoglOnscreen *onscreen)
 {
@@ -768,6 +918,9 @@ free_current_bo (CoglOnscreen *onscreen)
   MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
 
   g_clear_object (&onscreen_native->gbm.current_fb);
+  g_list_free_full (onscreen_native->overlays.current,
+                    (GDestroyNotify) meta_onscreen_native_overlay_free);
+  onscreen_native->overlays.current = NULL;
   free_current_secondary_bo (onscreen);
 }
 
@@ -1081,6 +1234,9 @@ meta_onscreen_native_swap_drm_fb (CoglOnscreen *onscreen)
   g_set_object (&onscreen_native->gbm.current_fb, onscreen_native->gbm.next_fb);
   g_clear_object (&onscreen_native->gbm.next_fb);
 
+  onscreen_native->overlays.current = onscreen_native->overlays.next;
+  onscreen_native->overlays.next = NULL;
+
   swap_secondary_drm_fb (onscreen);
 }
 
@@ -1320,6 +1476,64 @@ queue_dummy_power_save_page_flip (CoglOnscreen *onscreen)
                     cogl_object_ref (onscreen));
 }
 
+static MetaOnscreenNativeOverlay *
+find_overlay (GList        *overlays,
+              MetaKmsPlane *plane)
+{
+  GList *l;
+
+  for (l = overlays; l; l = l->next)
+    {
+      MetaOnscreenNativeOverlay *overlay = l->data;
+
+      if (overlay->plane == plane)
+        return overlay;
+    }
+
+  return NULL;
+}
+
+static void
+assign_overlay (MetaOnscreenNativeOverlay *overlay,
+                MetaKmsCrtc               *kms_crtc,
+                MetaKmsUpdate             *kms_update)
+{
+  meta_kms_update_assign_plane (kms_update,
+                                kms_crtc,
+                                overlay->plane,
+                                meta_drm_buffer_get_fb_id (overlay->buffer),
+                                overlay->src_rect,
+                                overlay->dst_rect,
+                                META_KMS_ASSIGN_PLANE_FLAG_NONE);
+}
+
+static void
+meta_onscreen_native_flip_overlays (CoglOnscreen  *onscreen,
+                                    MetaCrtc      *crtc,
+                                    MetaKmsUpdate *kms_update)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc);
+  GList *l;
+
+  if (crtc != onscreen_native->crtc)
+    return;
+
+  for (l = onscreen_native->overlays.next; l; l = l->next)
+    assign_overlay (l->data, kms_crtc, kms_update);
+
+  for (l = onscreen_native->overlays.current; l; l = l->next)
+    {
+      MetaOnscreenNativeOverlay *overlay = l->data;
+
+      if (!find_overlay (onscreen_native->overlays.next, overlay->plane))
+        meta_kms_update_unassign_plane (kms_update, kms_crtc, overlay->plane);
+    }
+
+  onscreen_native->overlays.rejected = FALSE;
+}
+
 static void
 meta_onscreen_native_flip_crtc (CoglOnscreen     *onscreen,
                                 MetaRendererView *view,
@@ -1355,6 +1569,8 @@ meta_onscreen_native_flip_crtc (CoglOnscreen     *onscreen,
         }
 
       meta_crtc_kms_assign_primary_plane (crtc, fb_id, kms_update);
+      if (gpu_kms == render_gpu)
+        meta_onscreen_native_flip_overlays (onscreen, crtc, kms_update);
       meta_crtc_kms_page_flip (crtc,
                                &page_flip_feedback,
                                g_object_ref (view),
@@ -1553,6 +1769,8 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
   GError *error = NULL;
   MetaDrmBufferGbm *buffer_gbm;
   struct gbm_bo *bo;
+  cairo_region_t *copy_region = NULL;
+  gboolean ret;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferSecondaryGpu,
                            "FB Copy (secondary GPU)");
@@ -1574,15 +1792,36 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
 
   *egl_context_changed = TRUE;
 
+  /* The age of the back buffer only tells what it misses if the surface
+   * got all the frames since */
+  if (renderer_gpu_data->secondary.has_EGL_EXT_buffer_age &&
+      secondary_gpu_state->last_gpu_copy_frame ==
+      secondary_gpu_state->frame_count - 1)
+    {
+      EGLint age;
+
+      if (meta_egl_query_surface (egl,
+                                  renderer_gpu_data->egl_display,
+                                  secondary_gpu_state->egl_surface,
+                                  EGL_BUFFER_AGE_EXT,
+                                  &age,
+                                  NULL))
+        copy_region = secondary_gpu_get_copy_region (secondary_gpu_state, age);
+    }
+
   buffer_gbm = META_DRM_BUFFER_GBM (onscreen_native->gbm.next_fb);
   bo =  meta_drm_buffer_gbm_get_bo (buffer_gbm);
-  if (!meta_renderer_native_gles3_blit_shared_bo (egl,
-                                                  renderer_native->gles3,
-                                                  renderer_gpu_data->egl_display,
-                                                  renderer_gpu_data->secondary.egl_context,
-                                                  secondary_gpu_state->egl_surface,
-                                                  bo,
-                                                  &error))
+  ret = meta_renderer_native_gles3_blit_shared_bo (egl,
+                                                   renderer_native->gles3,
+                                                   renderer_gpu_data->egl_display,
+                                                   renderer_gpu_data->secondary.egl_context,
+                                                   secondary_gpu_state->egl_surface,
+                                                   bo,
+                                                   copy_region,
+                                                   &error);
+  g_clear_pointer (&copy_region, cairo_region_destroy);
+
+  if (!ret)
     {
       g_warning ("Failed to blit shared framebuffer: %s", error->message);
       g_error_free (error);
@@ -1599,6 +1838,8 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
       return;
     }
 
+  secondary_gpu_state->last_gpu_copy_frame = secondary_gpu_state->frame_count;
+
   buffer_gbm =
     meta_drm_buffer_gbm_new_lock_front (secondary_gpu_state->gpu_kms,
                                         secondary_gpu_state->gbm.surface,
@@ -1627,6 +1868,47 @@ secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *seconda
     return &secondary_gpu_state->cpu.dumb_fbs[0];
 }
 
+static cairo_region_t *
+secondary_gpu_get_dumb_buffer_copy_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                           MetaDumbBuffer                      *dumb_fb)
+{
+  int64_t last_frame;
+  cairo_region_t *region = NULL;
+
+  last_frame =
+    secondary_gpu_state->cpu.dumb_fb_frames[dumb_fb -
+                                            secondary_gpu_state->cpu.dumb_fbs];
+  if (last_frame > 0)
+    {
+      region =
+        secondary_gpu_get_copy_region (secondary_gpu_state,
+                                       secondary_gpu_state->frame_count -
+                                       last_frame);
+    }
+
+  if (!region)
+    {
+      cairo_rectangle_int_t rect = {
+        .width = dumb_fb->width,
+        .height = dumb_fb->height,
+      };
+
+      region = cairo_region_create_rectangle (&rect);
+    }
+
+  return region;
+}
+
+static void
+secondary_gpu_set_dumb_buffer_copied (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                      MetaDumbBuffer                      *dumb_fb,
+                                      gboolean                             copied)
+{
+  secondary_gpu_state->cpu.dumb_fb_frames[dumb_fb -
+                                          secondary_gpu_state->cpu.dumb_fbs] =
+    copied ? secondary_gpu_state->frame_count : 0;
+}
+
 static CoglContext *
 cogl_context_from_renderer_native (MetaRendererNative *renderer_native)
 {
@@ -1727,6 +2009,8 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   int dmabuf_fd;
   g_autoptr (GError) error = NULL;
   CoglPixelFormat cogl_format;
+  cairo_region_t *copy_region;
+  int n_rects, i;
   int ret;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
@@ -1769,18 +2053,35 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
       return FALSE;
     }
 
-  if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
-                              0, 0, 0, 0,
-                              dumb_fb->width,
-                              dumb_fb->height,
-                              &error))
+  copy_region = secondary_gpu_get_dumb_buffer_copy_region (secondary_gpu_state,
+                                                           dumb_fb);
+
+  n_rects = cairo_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
     {
-      cogl_object_unref (dmabuf_fb);
-      return FALSE;
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
+      if (!cogl_blit_framebuffer (framebuffer, COGL_FRAMEBUFFER (dmabuf_fb),
+                                  rect.x, rect.y,
+                                  rect.x, rect.y,
+                                  rect.width,
+                                  rect.height,
+                                  &error))
+        {
+          secondary_gpu_set_dumb_buffer_copied (secondary_gpu_state,
+                                                dumb_fb, FALSE);
+          cairo_region_destroy (copy_region);
+          cogl_object_unref (dmabuf_fb);
+          return FALSE;
+        }
     }
 
+  cairo_region_destroy (copy_region);
   cogl_object_unref (dmabuf_fb);
 
+  secondary_gpu_set_dumb_buffer_copied (secondary_gpu_state, dumb_fb, TRUE);
+
   g_clear_object (&secondary_gpu_state->gbm.next_fb);
   buffer_dumb = meta_drm_buffer_dumb_new (dumb_fb->fb_id);
   secondary_gpu_state->gbm.next_fb = META_DRM_BUFFER (buffer_dumb);
@@ -1848,16 +2149,202 @@ cogl_pixel_format_from_drm_format (uint32_t               drm_format,
   return TRUE;
 }
 
+typedef struct _CopyRowsJob
+{
+  GMutex mutex;
+  GCond cond;
+  int n_pending;
+} CopyRowsJob;
+
+typedef struct _CopyRowsBand
+{
+  CopyRowsJob *job;
+  const uint8_t *src;
+  uint8_t *dst;
+  int stride;
+  int row_size;
+  int n_rows;
+} CopyRowsBand;
+
+static void
+copy_rows_band (CopyRowsBand *band)
+{
+  int i;
+
+  for (i = 0; i < band->n_rows; i++)
+    {
+      memcpy (band->dst + i * band->stride,
+              band->src + i * band->stride,
+              band->row_size);
+    }
+}
+
+static void
+copy_rows_band_in_thread (gpointer data,
+                          gpointer user_data)
+{
+  CopyRowsBand *band = data;
+  CopyRowsJob *job = band->job;
+
+  copy_rows_band (band);
+
+  g_mutex_lock (&job->mutex);
+  job->n_pending--;
+  if (job->n_pending == 0)
+    g_cond_signal (&job->cond);
+  g_mutex_unlock (&job->mutex);
+}
+
+static GThreadPool *
+ensure_copy_thread_pool (MetaRendererNative *renderer_native)
+{
+  int n_threads;
+
+  if (renderer_native->copy_thread_pool)
+    return renderer_native->copy_thread_pool;
+
+  /* The calling thread copies its share too */
+  n_threads = MIN ((int) g_get_num_processors () - 1, MAX_COPY_THREADS);
+  if (n_threads < 1)
+    return NULL;
+
+  renderer_native->copy_thread_pool =
+    g_thread_pool_new (copy_rows_band_in_thread, NULL,
+                       n_threads, FALSE, NULL);
+
+  return renderer_native->copy_thread_pool;
+}
+
+static void
+copy_rows_in_parallel (GThreadPool   *thread_pool,
+                       const uint8_t *src,
+                       uint8_t       *dst,
+                       int            stride,
+                       int            row_size,
+                       int            n_rows)
+{
+  CopyRowsBand bands[MAX_COPY_THREADS + 1];
+  CopyRowsJob job;
+  int n_bands;
+  int rows_per_band;
+  int i;
+
+  n_bands = g_thread_pool_get_max_threads (thread_pool) + 1;
+  n_bands = CLAMP (n_bands, 1, (int) G_N_ELEMENTS (bands));
+  rows_per_band = (n_rows + n_bands - 1) / n_bands;
+
+  g_mutex_init (&job.mutex);
+  g_cond_init (&job.cond);
+  job.n_pending = n_bands - 1;
+
+  for (i = 0; i < n_bands; i++)
+    {
+      int first_row = MIN (i * rows_per_band, n_rows);
+
+      bands[i] = (CopyRowsBand) {
+        .job = &job,
+        .src = src + first_row * stride,
+        .dst = dst + first_row * stride,
+        .stride = stride,
+        .row_size = row_size,
+        .n_rows = MIN (rows_per_band, n_rows - first_row),
+      };
+    }
+
+  for (i = 1; i < n_bands; i++)
+    g_thread_pool_push (thread_pool, &bands[i], NULL);
+
+  copy_rows_band (&bands[0]);
+
+  g_mutex_lock (&job.mutex);
+  while (job.n_pending > 0)
+    g_cond_wait (&job.cond, &job.mutex);
+  g_mutex_unlock (&job.mutex);
+
+  g_cond_clear (&job.cond);
+  g_mutex_clear (&job.mutex);
+}
+
+/*
+ * Dumb buffers are usually mapped write-combined, which the read back is
+ * slow to write to. Large areas are read back into cached memory instead,
+ * from where they are streamed to the dumb buffer by several threads.
+ */
+static gboolean
+read_pixels_into_dumb_buffer (MetaRendererNative                  *renderer_native,
+                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                              CoglFramebuffer                     *framebuffer,
+                              MetaDumbBuffer                      *dumb_fb,
+                              CoglPixelFormat                      cogl_format,
+                              const cairo_rectangle_int_t         *rect)
+{
+  CoglContext *cogl_context = framebuffer->context;
+  GThreadPool *thread_pool = NULL;
+  int bpp;
+  size_t offset;
+  uint8_t *data;
+  CoglBitmap *bitmap;
+  gboolean ret;
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+  offset = (size_t) rect->y * dumb_fb->stride_bytes + (size_t) rect->x * bpp;
+
+  if (rect->width * rect->height >= PARALLEL_COPY_MIN_PIXELS)
+    thread_pool = ensure_copy_thread_pool (renderer_native);
+
+  if (thread_pool)
+    {
+      if (!secondary_gpu_state->cpu.staging)
+        {
+          secondary_gpu_state->cpu.staging =
+            g_malloc ((size_t) dumb_fb->stride_bytes * dumb_fb->height);
+        }
+
+      data = secondary_gpu_state->cpu.staging + offset;
+    }
+  else
+    {
+      data = (uint8_t *) dumb_fb->map + offset;
+    }
+
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     rect->width,
+                                     rect->height,
+                                     cogl_format,
+                                     dumb_fb->stride_bytes,
+                                     data);
+  ret = cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  rect->x,
+                                                  rect->y,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER,
+                                                  bitmap);
+  cogl_object_unref (bitmap);
+
+  if (ret && thread_pool)
+    {
+      copy_rows_in_parallel (thread_pool,
+                             data,
+                             (uint8_t *) dumb_fb->map + offset,
+                             dumb_fb->stride_bytes,
+                             rect->width * bpp,
+                             rect->height);
+    }
+
+  return ret;
+}
+
 static void
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
                              MetaRendererNativeGpuData           *renderer_gpu_data)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
-  CoglContext *cogl_context = framebuffer->context;
+  MetaRendererNative *renderer_native = renderer_gpu_data->renderer_native;
   MetaDumbBuffer *dumb_fb;
-  CoglBitmap *dumb_bitmap;
   CoglPixelFormat cogl_format;
+  cairo_region_t *copy_region;
+  gboolean copied = TRUE;
+  int n_rects, i;
   gboolean ret;
   MetaDrmBufferDumb *buffer_dumb;
 
@@ -1874,21 +2361,31 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                                            NULL);
   g_assert (ret);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          dumb_fb->width,
-                                          dumb_fb->height,
-                                          cogl_format,
-                                          dumb_fb->stride_bytes,
-                                          dumb_fb->map);
+  copy_region = secondary_gpu_get_dumb_buffer_copy_region (secondary_gpu_state,
+                                                           dumb_fb);
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  n_rects = cairo_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (copy_region, i, &rect);
+      if (!read_pixels_into_dumb_buffer (renderer_native,
+                                         secondary_gpu_state,
+                                         framebuffer,
+                                         dumb_fb,
+                                         cogl_format,
+                                         &rect))
+        {
+          g_warning ("Failed to CPU-copy to a secondary GPU output");
+          copied = FALSE;
+          break;
+        }
+    }
 
-  cogl_object_unref (dumb_bitmap);
+  cairo_region_destroy (copy_region);
+
+  secondary_gpu_set_dumb_buffer_copied (secondary_gpu_state, dumb_fb, copied);
 
   g_clear_object (&secondary_gpu_state->gbm.next_fb);
   buffer_dumb = meta_drm_buffer_dumb_new (dumb_fb->fb_id);
@@ -1897,7 +2394,9 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
 }
 
 static void
-update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
+update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
+                                             const int    *rectangles,
+                                             int           n_rectangles)
 {
   CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
   MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
@@ -1911,6 +2410,9 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen)
     {
       MetaRendererNativeGpuData *renderer_gpu_data;
 
+      secondary_gpu_record_damage (secondary_gpu_state, onscreen,
+                                   rectangles, n_rectangles);
+
       renderer_gpu_data = secondary_gpu_state->renderer_gpu_data;
       switch (renderer_gpu_data->secondary.copy_mode)
         {
@@ -2062,6 +2564,54 @@ post_pending_update (MetaKms *kms)
     }
 }
 
+/*
+ * The overlay planes were checked before painting the frame, but the
+ * atomic commit can still leave them out, in which case the surfaces they
+ * were showing are missing from the frame. Paint another frame without
+ * overlay planes.
+ */
+static void
+handle_rejected_overlays (CoglOnscreen    *onscreen,
+                          MetaKmsFeedback *kms_feedback)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaRenderer *renderer = META_RENDERER (onscreen_native->renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  GList *l;
+
+  for (l = meta_kms_feedback_get_failed_planes (kms_feedback); l; l = l->next)
+    {
+      MetaKmsPlaneFeedback *plane_feedback = l->data;
+
+      if (!find_overlay (onscreen_native->overlays.next, plane_feedback->plane))
+        continue;
+
+      g_debug ("Overlay plane rejected: %s", plane_feedback->error->message);
+
+      onscreen_native->overlays.rejected = TRUE;
+      if (onscreen_native->overlays.test_results)
+        g_hash_table_remove_all (onscreen_native->overlays.test_results);
+      clutter_actor_queue_redraw (meta_backend_get_stage (backend));
+      break;
+    }
+}
+
+static void
+handle_swap_feedback (CoglOnscreen    *onscreen,
+                      MetaKmsFeedback *kms_feedback)
+{
+  if (meta_kms_feedback_get_result (kms_feedback) != META_KMS_FEEDBACK_PASSED)
+    {
+      const GError *error = meta_kms_feedback_get_error (kms_feedback);
+
+      handle_rejected_overlays (onscreen, kms_feedback);
+
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+        g_warning ("Failed to post KMS update: %s", error->message);
+    }
+}
+
 static void
 meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
                                                const int    *rectangles,
@@ -2104,7 +2654,9 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
   frame_info = g_queue_peek_tail (&onscreen->pending_frame_infos);
   frame_info->global_frame_counter = renderer_native->frame_counter;
 
-  update_secondary_gpu_state_pre_swap_buffers (onscreen);
+  update_secondary_gpu_state_pre_swap_buffers (onscreen,
+                                               rectangles,
+                                               n_rectangles);
 
   parent_vtable->onscreen_swap_buffers_with_damage (onscreen,
                                                     rectangles,
@@ -2157,7 +2709,8 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen *onscreen,
 
   COGL_TRACE_BEGIN (MetaRendererNativePostKmsUpdate,
                     "Onscreen (post pending update)");
-  post_pending_update (kms);
+  kms_feedback = meta_kms_post_pending_update_sync (kms);
+  handle_swap_feedback (onscreen, kms_feedback);
   COGL_TRACE_END (MetaRendererNativePostKmsUpdate);
 }
 
@@ -2278,6 +2831,305 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   return TRUE;
 }
 
+/**
+ * meta_onscreen_native_has_pending_flip: (skip)
+ * @onscreen: a #CoglOnscreen
+ *
+ * Returns: %TRUE if a frame of @onscreen was committed but not yet flipped
+ * to, in which case the overlays assigned for it are in use by the device
+ */
+gboolean
+meta_onscreen_native_has_pending_flip (CoglOnscreen *onscreen)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+
+  return onscreen_native->total_pending_flips > 0;
+}
+
+/**
+ * meta_onscreen_native_reset_overlays: (skip)
+ * @onscreen: a #CoglOnscreen
+ *
+ * Forgets about the overlays assigned for the next frame of @onscreen, so
+ * that the assignment can start over. The overlays of the frame currently
+ * on screen are kept until the next frame replaces them. Must not be called
+ * while a flip is pending, see meta_onscreen_native_has_pending_flip().
+ */
+void
+meta_onscreen_native_reset_overlays (CoglOnscreen *onscreen)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+
+  g_return_if_fail (onscreen_native->total_pending_flips == 0);
+
+  g_list_free_full (onscreen_native->overlays.next,
+                    (GDestroyNotify) meta_onscreen_native_overlay_free);
+  onscreen_native->overlays.next = NULL;
+}
+
+static gboolean
+is_overlay_plane_used_elsewhere (MetaRendererNative *renderer_native,
+                                 MetaOnscreenNative *onscreen_native,
+                                 MetaKmsPlane       *plane)
+{
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  GList *l;
+
+  /* Overlay planes can often be used with more than one CRTC */
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+      CoglFramebuffer *framebuffer =
+        clutter_stage_view_get_onscreen (stage_view);
+      CoglOnscreenEGL *other_onscreen_egl;
+      MetaOnscreenNative *other_onscreen_native;
+
+      other_onscreen_egl = COGL_ONSCREEN (framebuffer)->winsys;
+      if (!other_onscreen_egl)
+        continue;
+
+      other_onscreen_native = other_onscreen_egl->platform;
+      if (other_onscreen_native == onscreen_native)
+        continue;
+
+      if (find_overlay (other_onscreen_native->overlays.current, plane) ||
+          find_overlay (other_onscreen_native->overlays.next, plane))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static guint
+overlay_test_key_hash (gconstpointer data)
+{
+  const MetaOverlayTestKey *key = data;
+
+  return (g_direct_hash (key->plane) ^
+          key->drm_format ^
+          g_int64_hash (&key->drm_modifier) ^
+          (key->src_width << 16) ^ key->src_height ^
+          (key->dst_width << 8) ^ (key->dst_height << 24));
+}
+
+static gboolean
+overlay_test_key_equal (gconstpointer a,
+                        gconstpointer b)
+{
+  const MetaOverlayTestKey *key_a = a;
+  const MetaOverlayTestKey *key_b = b;
+
+  return (key_a->plane == key_b->plane &&
+          key_a->drm_format == key_b->drm_format &&
+          key_a->drm_modifier == key_b->drm_modifier &&
+          key_a->src_width == key_b->src_width &&
+          key_a->src_height == key_b->src_height &&
+          key_a->dst_width == key_b->dst_width &&
+          key_a->dst_height == key_b->dst_height);
+}
+
+/*
+ * Test commits are synchronous ioctls, so their results are remembered
+ * per plane, format and size rather than testing every frame. The commit
+ * of the frame remains the authority; if it rejects the overlays, the
+ * remembered results are dropped.
+ */
+static gboolean
+test_overlay (MetaOnscreenNative        *onscreen_native,
+              MetaKms                   *kms,
+              MetaKmsCrtc               *kms_crtc,
+              MetaOnscreenNativeOverlay *overlay,
+              uint32_t                   drm_format,
+              uint64_t                   drm_modifier)
+{
+  g_autoptr (MetaKmsUpdate) kms_update = NULL;
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  MetaOverlayTestKey key;
+  MetaOverlayTestKey *cached_key;
+  gpointer passed;
+  GList *l;
+
+  key = (MetaOverlayTestKey) {
+    .plane = overlay->plane,
+    .drm_format = drm_format,
+    .drm_modifier = drm_modifier,
+    .src_width = meta_fixed_16_to_int (overlay->src_rect.width),
+    .src_height = meta_fixed_16_to_int (overlay->src_rect.height),
+    .dst_width = meta_fixed_16_to_int (overlay->dst_rect.width),
+    .dst_height = meta_fixed_16_to_int (overlay->dst_rect.height),
+  };
+
+  if (!onscreen_native->overlays.test_results)
+    {
+      onscreen_native->overlays.test_results =
+        g_hash_table_new_full (overlay_test_key_hash,
+                               overlay_test_key_equal,
+                               g_free,
+                               NULL);
+    }
+
+  if (g_hash_table_lookup_extended (onscreen_native->overlays.test_results,
+                                    &key, NULL, &passed))
+    return GPOINTER_TO_INT (passed);
+
+  kms_update = meta_kms_update_new ();
+  for (l = onscreen_native->overlays.next; l; l = l->next)
+    assign_overlay (l->data, kms_crtc, kms_update);
+  assign_overlay (overlay, kms_crtc, kms_update);
+
+  kms_feedback = meta_kms_test_update_sync (kms, kms_update);
+  passed = GINT_TO_POINTER (meta_kms_feedback_get_result (kms_feedback) ==
+                            META_KMS_FEEDBACK_PASSED);
+
+  if (g_hash_table_size (onscreen_native->overlays.test_results) >=
+      MAX_OVERLAY_TEST_RESULTS)
+    g_hash_table_remove_all (onscreen_native->overlays.test_results);
+
+  cached_key = g_memdup2 (&key, sizeof (key));
+  g_hash_table_insert (onscreen_native->overlays.test_results,
+                       cached_key, passed);
+
+  return GPOINTER_TO_INT (passed);
+}
+
+static gboolean
+is_plane_format_supported (MetaKmsPlane *plane,
+                           uint32_t      drm_format,
+                           uint64_t      drm_modifier)
+{
+  GArray *modifiers;
+  unsigned int i;
+
+  if (!meta_kms_plane_is_format_supported (plane, drm_format))
+    return FALSE;
+
+  if (drm_modifier == DRM_FORMAT_MOD_INVALID)
+    return TRUE;
+
+  modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
+  if (!modifiers)
+    return drm_modifier == DRM_FORMAT_MOD_LINEAR;
+
+  for (i = 0; i < modifiers->len; i++)
+    {
+      if (g_array_index (modifiers, uint64_t, i) == drm_modifier)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/**
+ * meta_onscreen_native_try_assign_overlay: (skip)
+ * @onscreen: a #CoglOnscreen
+ * @scanout: the buffer to scan out
+ * @dst_rect: where to show @scanout, in framebuffer coordinates
+ *
+ * Tries to put @scanout on a free overlay plane of the CRTC of @onscreen
+ * for the next frame, above what is painted into @onscreen. The assignment,
+ * together with the overlays already assigned for the next frame, is
+ * tested against the device first, so that the caller can paint @scanout
+ * itself if it failed.
+ *
+ * Returns: %TRUE if @scanout will be shown on an overlay plane
+ */
+gboolean
+meta_onscreen_native_try_assign_overlay (CoglOnscreen        *onscreen,
+                                         CoglScanout         *scanout,
+                                         const MetaRectangle *dst_rect)
+{
+  CoglOnscreenEGL *onscreen_egl = onscreen->winsys;
+  MetaOnscreenNative *onscreen_native = onscreen_egl->platform;
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsDevice *kms_device;
+  struct gbm_bo *gbm_bo;
+  uint32_t drm_format;
+  uint64_t drm_modifier;
+  MetaFixed16Rectangle src_rect;
+  GList *l;
+
+  if (onscreen_native->overlays.rejected)
+    return FALSE;
+
+  if (onscreen_native->crtc->config->transform != META_MONITOR_TRANSFORM_NORMAL)
+    return FALSE;
+
+  if (onscreen_native->secondary_gpu_state)
+    return FALSE;
+
+  if (!onscreen_native->gbm.surface)
+    return FALSE;
+
+  if (!META_IS_DRM_BUFFER_GBM (scanout))
+    return FALSE;
+
+  gbm_bo = meta_drm_buffer_gbm_get_bo (META_DRM_BUFFER_GBM (scanout));
+  drm_format = gbm_bo_get_format (gbm_bo);
+  drm_modifier = gbm_bo_get_modifier (gbm_bo);
+
+  src_rect = (MetaFixed16Rectangle) {
+    .x = meta_fixed_16_from_int (0),
+    .y = meta_fixed_16_from_int (0),
+    .width = meta_fixed_16_from_int (gbm_bo_get_width (gbm_bo)),
+    .height = meta_fixed_16_from_int (gbm_bo_get_height (gbm_bo)),
+  };
+
+  kms_crtc = meta_crtc_kms_get_kms_crtc (onscreen_native->crtc);
+  kms_device = meta_kms_crtc_get_device (kms_crtc);
+
+  for (l = meta_kms_device_get_planes (kms_device); l; l = l->next)
+    {
+      MetaKmsPlane *plane = l->data;
+      MetaOnscreenNativeOverlay *overlay;
+
+      if (meta_kms_plane_get_plane_type (plane) != META_KMS_PLANE_TYPE_OVERLAY)
+        continue;
+
+      if (!meta_kms_plane_is_usable_with (plane, kms_crtc))
+        continue;
+
+      if (find_overlay (onscreen_native->overlays.next, plane) ||
+          is_overlay_plane_used_elsewhere (renderer_native, onscreen_native,
+                                           plane))
+        continue;
+
+      if (!is_plane_format_supported (plane, drm_format, drm_modifier))
+        continue;
+
+      overlay = g_new0 (MetaOnscreenNativeOverlay, 1);
+      overlay->plane = plane;
+      overlay->buffer = g_object_ref (META_DRM_BUFFER (scanout));
+      overlay->src_rect = src_rect;
+      overlay->dst_rect = (MetaFixed16Rectangle) {
+        .x = meta_fixed_16_from_int (dst_rect->x),
+        .y = meta_fixed_16_from_int (dst_rect->y),
+        .width = meta_fixed_16_from_int (dst_rect->width),
+        .height = meta_fixed_16_from_int (dst_rect->height),
+      };
+
+      if (!test_overlay (onscreen_native, kms, kms_crtc, overlay,
+                         drm_format, drm_modifier))
+        {
+          meta_onscreen_native_overlay_free (overlay);
+          continue;
+        }
+
+      onscreen_native->overlays.next =
+        g_list_append (onscreen_native->overlays.next, overlay);
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
 static void
 meta_onscreen_native_direct_scanout (CoglOnscreen *onscreen,
                                      CoglScanout  *scanout)
@@ -2890,6 +3742,9 @@ meta_renderer_native_release_onscreen (CoglOnscreen *onscreen)
        * never be outstanding flips when we reach here. */
       g_return_if_fail (onscreen_native->gbm.next_fb == NULL);
 
+      meta_onscreen_native_reset_overlays (onscreen);
+      g_clear_pointer (&onscreen_native->overlays.test_results,
+                       g_hash_table_destroy);
       free_current_bo (onscreen);
 
       destroy_egl_surface (onscreen);
@@ -3260,6 +4115,7 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
                        "offscreen", offscreen,
                        "use-shadowfb", use_shadowfb,
                        "transform", view_transform,
+                       "refresh-rate", crtc_config->mode->refresh_rate,
                        NULL);
   g_clear_pointer (&offscreen, cogl_object_unref);
 
@@ -3471,6 +4327,10 @@ init_secondary_gpu_data_gpu (MetaRendererNativeGpuData *renderer_gpu_data,
     meta_egl_has_extensions (egl, egl_display, NULL,
                              "EGL_EXT_image_dma_buf_import_modifiers",
                              NULL);
+  renderer_gpu_data->secondary.has_EGL_EXT_buffer_age =
+    meta_egl_has_extensions (egl, egl_display, NULL,
+                             "EGL_EXT_buffer_age",
+                             NULL);
 
   /* The context only had to be current for the queries above; the blit path
    * makes it current again before each use. Leaving it bound would keep it
@@ -4251,6 +5111,9 @@ meta_renderer_native_finalize (GObject *object)
                          g_source_remove);
     }
 
+  if (renderer_native->copy_thread_pool)
+    g_thread_pool_free (renderer_native->copy_thread_pool, FALSE, TRUE);
+
   g_hash_table_destroy (renderer_native->gpu_datas);
   g_clear_object (&renderer_native->gles3);
 
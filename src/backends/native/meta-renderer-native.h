@@ -64,4 +64,12 @@ gboolean meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscre
                                                             uint64_t      drm_modifier,
                                                             uint32_t      stride);
 
+gboolean meta_onscreen_native_has_pending_flip (CoglOnscreen *onscreen);
+
+void meta_onscreen_native_reset_overlays (CoglOnscreen *onscreen);
+
+gboolean meta_onscreen_native_try_assign_overlay (CoglOnscreen        *onscreen,
+                                                  CoglScanout         *scanout,
+                                                  const MetaRectangle *dst_rect);
+
 #endif /* META_RENDERER_NATIVE_H */
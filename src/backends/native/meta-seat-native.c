@@ -28,6 +28,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <float.h>
 #include <libinput.h>
 #include <linux/input.h>
 #include <math.h>
@@ -82,6 +83,14 @@ struct _MetaEventSource
   GPollFD event_poll_fd;
 };
 
+typedef struct _MetaInputThreadSource
+{
+  GSource source;
+
+  MetaSeatNative *seat;
+  gpointer fd_tag;
+} MetaInputThreadSource;
+
 static MetaOpenDeviceCallback  device_open_callback;
 static MetaCloseDeviceCallback device_close_callback;
 static gpointer                device_callback_data;
@@ -227,10 +236,33 @@ meta_seat_native_clear_repeat_timer (MetaSeatNative *seat)
 static void
 dispatch_libinput (MetaSeatNative *seat)
 {
-  libinput_dispatch (seat->libinput);
+  /* With an input thread, reading is done there, and the events it read
+   * are waiting to be processed */
+  if (!seat->input_thread)
+    {
+      meta_seat_native_lock_libinput (seat);
+      libinput_dispatch (seat->libinput);
+      meta_seat_native_unlock_libinput (seat);
+    }
+
   process_events (seat);
 }
 
+static gboolean
+has_queued_libinput_events (MetaSeatNative *seat)
+{
+  gboolean has_events;
+
+  if (!seat->input_thread)
+    return FALSE;
+
+  meta_seat_native_lock_libinput (seat);
+  has_events = !g_queue_is_empty (&seat->libinput_events);
+  meta_seat_native_unlock_libinput (seat);
+
+  return has_events;
+}
+
 static gboolean
 keyboard_repeat (gpointer data)
 {
@@ -465,6 +497,7 @@ meta_seat_native_notify_relative_motion (MetaSeatNative     *seat,
                                          float               dy_unaccel)
 {
   float new_x, new_y;
+  float predicted_x, predicted_y;
   ClutterEvent *event;
 
   /* We can drop the event on the floor if no stage has been
@@ -472,6 +505,9 @@ meta_seat_native_notify_relative_motion (MetaSeatNative     *seat,
   if (!_clutter_input_device_get_stage (input_device))
     return;
 
+  predicted_x = seat->pointer_x + dx;
+  predicted_y = seat->pointer_y + dy;
+
   meta_seat_native_filter_relative_motion (seat,
                                            input_device,
                                            seat->pointer_x,
@@ -484,6 +520,12 @@ meta_seat_native_notify_relative_motion (MetaSeatNative     *seat,
   event = new_absolute_motion_event (seat, input_device,
                                      time_us, new_x, new_y, NULL);
 
+  /* The input thread can't know about barriers, pointer constraints and
+   * the like; stop predicting the pointer position while they affect it */
+  g_atomic_int_set (&seat->pointer_prediction_inhibited,
+                    (fabsf (predicted_x - seat->pointer_x) > FLT_EPSILON ||
+                     fabsf (predicted_y - seat->pointer_y) > FLT_EPSILON));
+
   meta_event_native_set_relative_motion (event,
                                          dx, dy,
                                          dx_unaccel, dy_unaccel);
@@ -883,12 +925,14 @@ static gboolean
 meta_event_prepare (GSource *source,
                     gint    *timeout)
 {
+  MetaEventSource *event_source = (MetaEventSource *) source;
   gboolean retval;
 
   _clutter_threads_acquire_lock ();
 
   *timeout = -1;
-  retval = clutter_events_pending ();
+  retval = (clutter_events_pending () ||
+            has_queued_libinput_events (event_source->seat));
 
   _clutter_threads_release_lock ();
 
@@ -904,7 +948,8 @@ meta_event_check (GSource *source)
   _clutter_threads_acquire_lock ();
 
   retval = ((event_source->event_poll_fd.revents & G_IO_IN) ||
-            clutter_events_pending ());
+            clutter_events_pending () ||
+            has_queued_libinput_events (event_source->seat));
 
   _clutter_threads_release_lock ();
 
@@ -1392,7 +1437,8 @@ meta_event_source_new (MetaSeatNative *seat)
 
   /* and finally configure and attach the GSource */
   g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
-  g_source_add_poll (source, &event_source->event_poll_fd);
+  if (!seat->input_thread)
+    g_source_add_poll (source, &event_source->event_poll_fd);
   g_source_set_can_recurse (source, TRUE);
   g_source_attach (source, NULL);
 
@@ -2464,16 +2510,196 @@ process_event (MetaSeatNative        *seat,
     return;
 }
 
+static struct libinput_event *
+pop_libinput_event (MetaSeatNative *seat)
+{
+  struct libinput_event *event;
+
+  meta_seat_native_lock_libinput (seat);
+
+  event = g_queue_pop_head (&seat->libinput_events);
+  if (!event)
+    event = libinput_get_event (seat->libinput);
+
+  /* Further predictions start from where the processed events moved
+   * the pointer */
+  if (!event)
+    {
+      seat->predicted_pointer_x = seat->pointer_x;
+      seat->predicted_pointer_y = seat->pointer_y;
+    }
+
+  meta_seat_native_unlock_libinput (seat);
+
+  return event;
+}
+
+/*
+ * The libinput lock is only held while touching libinput itself, so that
+ * the input thread can keep reading while events are processed.
+ */
 static void
 process_events (MetaSeatNative *seat)
 {
   struct libinput_event *event;
 
+  while ((event = pop_libinput_event (seat)))
+    {
+      process_event (seat, event);
+
+      meta_seat_native_lock_libinput (seat);
+      libinput_event_destroy (event);
+      meta_seat_native_unlock_libinput (seat);
+    }
+}
+
+static void stop_input_thread (MetaSeatNative *seat);
+
+static gboolean
+fall_back_to_main_thread_input (gpointer user_data)
+{
+  MetaSeatNative *seat = user_data;
+  MetaEventSource *event_source = seat->event_source;
+
+  if (!seat->input_thread)
+    return G_SOURCE_REMOVE;
+
+  stop_input_thread (seat);
+  g_source_add_poll ((GSource *) event_source, &event_source->event_poll_fd);
+
+  /* Process what the input thread read before it stopped */
+  process_events (seat);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+input_thread_source_dispatch (GSource     *source,
+                              GSourceFunc  callback,
+                              gpointer     user_data)
+{
+  MetaInputThreadSource *input_source = (MetaInputThreadSource *) source;
+  MetaSeatNative *seat = input_source->seat;
+  struct libinput_event *event;
+  gboolean pointer_moved = FALSE;
+  MetaPointerPredictionCallback prediction_callback;
+  gpointer prediction_user_data;
+  GIOCondition condition;
+  float x, y;
+
+  condition = g_source_query_unix_fd (source, input_source->fd_tag);
+  if (condition & (G_IO_ERR | G_IO_HUP))
+    {
+      g_warning ("Error on the libinput fd, reading input in the main "
+                 "thread from now on");
+      g_main_context_invoke_full (NULL, G_PRIORITY_DEFAULT,
+                                  fall_back_to_main_thread_input,
+                                  g_object_ref (seat),
+                                  g_object_unref);
+      return G_SOURCE_REMOVE;
+    }
+
+  if (!(condition & G_IO_IN))
+    return G_SOURCE_CONTINUE;
+
+  meta_seat_native_lock_libinput (seat);
+
+  libinput_dispatch (seat->libinput);
+
   while ((event = libinput_get_event (seat->libinput)))
     {
-      process_event(seat, event);
-      libinput_event_destroy(event);
+      if (libinput_event_get_type (event) == LIBINPUT_EVENT_POINTER_MOTION)
+        {
+          struct libinput_event_pointer *pointer_event =
+            libinput_event_get_pointer_event (event);
+
+          seat->predicted_pointer_x +=
+            libinput_event_pointer_get_dx (pointer_event);
+          seat->predicted_pointer_y +=
+            libinput_event_pointer_get_dy (pointer_event);
+          pointer_moved = TRUE;
+        }
+
+      g_queue_push_tail (&seat->libinput_events, event);
     }
+
+  pointer_moved = (pointer_moved &&
+                   !g_atomic_int_get (&seat->pointer_prediction_inhibited));
+  x = seat->predicted_pointer_x;
+  y = seat->predicted_pointer_y;
+  prediction_callback = seat->prediction_callback;
+  prediction_user_data = seat->prediction_user_data;
+
+  meta_seat_native_unlock_libinput (seat);
+
+  if (pointer_moved && prediction_callback)
+    prediction_callback (x, y, prediction_user_data);
+
+  g_main_context_wakeup (NULL);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs input_thread_source_funcs = {
+  .dispatch = input_thread_source_dispatch,
+};
+
+static gpointer
+input_thread_func (gpointer user_data)
+{
+  MetaSeatNative *seat = user_data;
+
+  g_main_context_push_thread_default (seat->input_context);
+  g_main_loop_run (seat->input_loop);
+  g_main_context_pop_thread_default (seat->input_context);
+
+  return NULL;
+}
+
+static void
+start_input_thread (MetaSeatNative *seat)
+{
+  MetaInputThreadSource *input_source;
+  GSource *source;
+
+  seat->input_context = g_main_context_new ();
+  seat->input_loop = g_main_loop_new (seat->input_context, FALSE);
+
+  source = g_source_new (&input_thread_source_funcs,
+                         sizeof (MetaInputThreadSource));
+  input_source = (MetaInputThreadSource *) source;
+  input_source->seat = seat;
+  input_source->fd_tag = g_source_add_unix_fd (source,
+                                               libinput_get_fd (seat->libinput),
+                                               G_IO_IN | G_IO_ERR | G_IO_HUP);
+  g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
+  g_source_attach (source, seat->input_context);
+  seat->input_source = source;
+
+  seat->input_thread = g_thread_new ("Input thread", input_thread_func, seat);
+}
+
+static gboolean
+quit_input_loop (gpointer user_data)
+{
+  MetaSeatNative *seat = user_data;
+
+  g_main_loop_quit (seat->input_loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+stop_input_thread (MetaSeatNative *seat)
+{
+  g_main_context_invoke (seat->input_context, quit_input_loop, seat);
+  g_thread_join (seat->input_thread);
+  seat->input_thread = NULL;
+
+  g_source_destroy (seat->input_source);
+  g_clear_pointer (&seat->input_source, g_source_unref);
+  g_clear_pointer (&seat->input_loop, g_main_loop_unref);
+  g_clear_pointer (&seat->input_context, g_main_context_unref);
 }
 
 static int
@@ -2577,6 +2803,11 @@ meta_seat_native_constructed (GObject *object)
 
   seat->udev_client = g_udev_client_new ((const gchar *[]) { "input", NULL });
 
+  seat->predicted_pointer_x = seat->pointer_x;
+  seat->predicted_pointer_y = seat->pointer_y;
+  if (g_getenv ("MUFFIN_DEBUG_ENABLE_INPUT_THREAD"))
+    start_input_thread (seat);
+
   source = meta_event_source_new (seat);
   seat->event_source = source;
 
@@ -2656,6 +2887,12 @@ meta_seat_native_dispose (GObject *object)
       seat->stage_manager = NULL;
     }
 
+  if (seat->input_thread)
+    stop_input_thread (seat);
+
+  g_queue_clear_full (&seat->libinput_events,
+                      (GDestroyNotify) libinput_event_destroy);
+
   if (seat->libinput)
     {
       libinput_unref (seat->libinput);
@@ -2696,6 +2933,8 @@ meta_seat_native_finalize (GObject *object)
   if (seat->constrain_data_notify != NULL)
     seat->constrain_data_notify (seat->constrain_data);
 
+  g_rec_mutex_clear (&seat->libinput_lock);
+
   g_free (seat->seat_id);
 
   G_OBJECT_CLASS (meta_seat_native_parent_class)->finalize (object);
@@ -2909,6 +3148,8 @@ meta_seat_native_stage_removed_cb (ClutterStageManager *manager,
 static void
 meta_seat_native_init (MetaSeatNative *seat)
 {
+  g_rec_mutex_init (&seat->libinput_lock);
+
   seat->stage_manager = clutter_stage_manager_get_default ();
   g_object_ref (seat->stage_manager);
 
@@ -3045,6 +3286,57 @@ meta_seat_native_set_relative_motion_filter (MetaSeatNative           *seat,
   seat->relative_motion_filter_user_data = user_data;
 }
 
+/**
+ * meta_seat_native_set_pointer_prediction_callback: (skip)
+ * @seat: the #ClutterSeat created by the evdev backend
+ * @callback: the callback
+ * @user_data: data to pass to the callback
+ *
+ * Sets a callback to be invoked from the input thread with the position
+ * the pointer is predicted to move to, e.g. to move the hardware cursor
+ * without waiting for the main thread. It is only used when input is
+ * read in a dedicated thread.
+ */
+void
+meta_seat_native_set_pointer_prediction_callback (MetaSeatNative                *seat,
+                                                  MetaPointerPredictionCallback  callback,
+                                                  gpointer                       user_data)
+{
+  g_return_if_fail (META_IS_SEAT_NATIVE (seat));
+
+  meta_seat_native_lock_libinput (seat);
+  seat->prediction_callback = callback;
+  seat->prediction_user_data = user_data;
+  meta_seat_native_unlock_libinput (seat);
+}
+
+/**
+ * meta_seat_native_lock_libinput: (skip)
+ * @seat: the #ClutterSeat created by the evdev backend
+ *
+ * Acquires the lock serializing the use of the libinput context with the
+ * input thread. It must be held around calls into libinput made outside
+ * of event processing, e.g. when configuring devices. The lock is
+ * recursive.
+ */
+void
+meta_seat_native_lock_libinput (MetaSeatNative *seat)
+{
+  g_rec_mutex_lock (&seat->libinput_lock);
+}
+
+/**
+ * meta_seat_native_unlock_libinput: (skip)
+ * @seat: the #ClutterSeat created by the evdev backend
+ *
+ * Releases the lock acquired with meta_seat_native_lock_libinput().
+ */
+void
+meta_seat_native_unlock_libinput (MetaSeatNative *seat)
+{
+  g_rec_mutex_unlock (&seat->libinput_lock);
+}
+
 /**
  * meta_seat_native_add_filter: (skip)
  * @func: (closure data): a filter function
@@ -3203,8 +3495,10 @@ meta_seat_native_release_devices (MetaSeatNative *seat)
       return;
     }
 
+  meta_seat_native_lock_libinput (seat);
   libinput_suspend (seat->libinput);
   process_events (seat);
+  meta_seat_native_unlock_libinput (seat);
 
   seat->released = TRUE;
 }
@@ -3230,9 +3524,11 @@ meta_seat_native_reclaim_devices (MetaSeatNative *seat)
       return;
     }
 
+  meta_seat_native_lock_libinput (seat);
   libinput_resume (seat->libinput);
   meta_seat_native_update_xkb_state (seat);
   process_events (seat);
+  meta_seat_native_unlock_libinput (seat);
 
   seat->released = FALSE;
 }
@@ -65,6 +65,21 @@ typedef void (* MetaRelativeMotionFilter) (ClutterInputDevice *device,
                                            float              *dy,
                                            gpointer            user_data);
 
+/**
+ * MetaPointerPredictionCallback:
+ * @x: the predicted X coordinate
+ * @y: the predicted Y coordinate
+ * @user_data: user data passed to this function
+ *
+ * This callback is called from the input thread when relative pointer
+ * motion was read, before the main thread had the chance to process it.
+ * (@x, @y) is where the pointer will end up, unless the motion gets
+ * constrained or filtered once processed.
+ */
+typedef void (* MetaPointerPredictionCallback) (float    x,
+                                                float    y,
+                                                gpointer user_data);
+
 struct _MetaTouchState
 {
   MetaSeatNative *seat;
@@ -114,6 +129,25 @@ struct _MetaSeatNative
   MetaRelativeMotionFilter relative_motion_filter;
   gpointer relative_motion_filter_user_data;
 
+  /* input thread */
+  GThread *input_thread;
+  GMainContext *input_context;
+  GMainLoop *input_loop;
+  GSource *input_source;
+
+  /* protects the libinput context, and the fields below, when there is
+   * an input thread */
+  GRecMutex libinput_lock;
+  GQueue libinput_events;
+  float predicted_pointer_x;
+  float predicted_pointer_y;
+
+  /* accessed atomically, set from the main thread */
+  gboolean pointer_prediction_inhibited;
+
+  MetaPointerPredictionCallback prediction_callback;
+  gpointer prediction_user_data;
+
   GSList *event_filters;
 
   MetaKeymapNative *keymap;
@@ -287,6 +321,14 @@ void  meta_seat_native_set_pointer_constrain_callback (MetaSeatNative
                                                        gpointer                      user_data,
                                                        GDestroyNotify                user_data_notify);
 
+void meta_seat_native_set_pointer_prediction_callback (MetaSeatNative                *seat,
+                                                      MetaPointerPredictionCallback  callback,
+                                                      gpointer                       user_data);
+
+void meta_seat_native_lock_libinput (MetaSeatNative *seat);
+
+void meta_seat_native_unlock_libinput (MetaSeatNative *seat);
+
 void meta_seat_native_set_relative_motion_filter (MetaSeatNative           *seat,
                                                   MetaRelativeMotionFilter  filter,
                                                   gpointer                  user_data);
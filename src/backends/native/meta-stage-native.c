@@ -53,6 +53,25 @@ G_DEFINE_TYPE_WITH_CODE (MetaStageNative, meta_stage_native,
                          G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_STAGE_WINDOW,
                                                 clutter_stage_window_iface_init))
 
+static ClutterStageView *
+find_view_for_onscreen (CoglOnscreen *onscreen)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  GList *l;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+
+      if (clutter_stage_view_get_onscreen (stage_view) ==
+          COGL_FRAMEBUFFER (onscreen))
+        return stage_view;
+    }
+
+  return NULL;
+}
+
 static void
 frame_cb (CoglOnscreen  *onscreen,
           CoglFrameEvent frame_event,
@@ -65,9 +84,26 @@ frame_cb (CoglOnscreen  *onscreen,
   int64_t global_frame_counter;
   int64_t presented_frame_counter;
   ClutterFrameInfo clutter_frame_info;
+  ClutterStageView *stage_view;
 
   global_frame_counter = cogl_frame_info_get_global_frame_counter (frame_info);
 
+  clutter_frame_info = (ClutterFrameInfo) {
+    .frame_counter = global_frame_counter,
+    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
+    .presentation_time = cogl_frame_info_get_presentation_time (frame_info)
+  };
+
+  /* Each view is scheduled by its own frame clock, which needs the
+   * feedback of every onscreen, even when frames of several views were
+   * presented together */
+  stage_view = find_view_for_onscreen (onscreen);
+  if (stage_view)
+    {
+      _clutter_stage_cogl_view_presented (stage_cogl, stage_view,
+                                          frame_event, &clutter_frame_info);
+    }
+
   switch (frame_event)
     {
     case COGL_FRAME_EVENT_SYNC:
@@ -85,12 +121,6 @@ frame_cb (CoglOnscreen  *onscreen,
   if (global_frame_counter <= presented_frame_counter)
     return;
 
-  clutter_frame_info = (ClutterFrameInfo) {
-    .frame_counter = global_frame_counter,
-    .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info),
-    .presentation_time = cogl_frame_info_get_presentation_time (frame_info)
-  };
-
   _clutter_stage_cogl_presented (stage_cogl, frame_event, &clutter_frame_info);
 }
 
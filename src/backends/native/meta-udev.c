@@ -201,7 +201,7 @@ on_uevent (GUdevClient *client,
     g_signal_emit (udev, signals[DEVICE_REMOVED], 0, device);
 
   if (g_udev_device_get_property_as_boolean (device, "HOTPLUG"))
-    g_signal_emit (udev, signals[HOTPLUG], 0);
+    g_signal_emit (udev, signals[HOTPLUG], 0, device);
 }
 
 MetaUdev *
@@ -249,7 +249,8 @@ meta_udev_class_init (MetaUdevClass *klass)
                   G_TYPE_FROM_CLASS (object_class),
                   G_SIGNAL_RUN_LAST,
                   0, NULL, NULL, NULL,
-                  G_TYPE_NONE, 0);
+                  G_TYPE_NONE, 1,
+                  G_UDEV_TYPE_DEVICE);
   signals[DEVICE_ADDED] =
     g_signal_new ("device-added",
                   G_TYPE_FROM_CLASS (object_class),
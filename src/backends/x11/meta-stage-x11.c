@@ -306,6 +306,9 @@ frame_cb (CoglOnscreen  *onscreen,
     .refresh_rate = cogl_frame_info_get_refresh_rate (frame_info)
   };
 
+  /* All views are presented through the single onscreen of the stage */
+  _clutter_stage_cogl_view_presented (stage_cogl, NULL,
+                                      frame_event, &clutter_frame_info);
   _clutter_stage_cogl_presented (stage_cogl, frame_event, &clutter_frame_info);
 }
 
@@ -219,6 +219,7 @@ meta_renderer_x11_nested_create_view (MetaRenderer       *renderer,
                        "offscreen", COGL_FRAMEBUFFER (offscreen),
                        "transform", view_transform,
                        "scale", view_scale,
+                       "refresh-rate", crtc->config->mode->refresh_rate,
                        NULL);
   g_object_set_data (G_OBJECT (view), "crtc", crtc);
 
@@ -22,12 +22,23 @@
 
 #include "compositor/meta-compositor-native.h"
 
+#include <math.h>
+
 #include "backends/meta-logical-monitor.h"
+#include "backends/meta-stage-private.h"
+#include "backends/native/meta-renderer-native.h"
+#include "clutter/clutter-muffin.h"
+#include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-surface-actor-wayland.h"
+#include "core/boxes-private.h"
+#include "meta/compositor-muffin.h"
 
 struct _MetaCompositorNative
 {
     MetaCompositorServer parent;
+
+    /* MetaSurfaceActor shown on overlay planes */
+    GList *overlay_actors;
 };
 
 G_DEFINE_TYPE (MetaCompositorNative, meta_compositor_native,
@@ -59,7 +70,7 @@ get_window_view (MetaRenderer *renderer,
     return view_found;
 }
 
-static void
+static MetaRendererView *
 maybe_assign_primary_plane (MetaCompositor *compositor)
 {
     MetaBackend *backend = meta_get_backend ();
@@ -74,53 +85,324 @@ maybe_assign_primary_plane (MetaCompositor *compositor)
     g_autoptr (CoglScanout) scanout = NULL;
 
     if (meta_compositor_is_unredirect_inhibited (compositor))
-      return;
+      return NULL;
 
     window_actor = meta_compositor_get_top_window_actor (compositor);
     if (!window_actor)
-      return;
+      return NULL;
 
     if (meta_window_actor_effect_in_progress (window_actor))
-      return;
+      return NULL;
 
     if (clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
-      return;
+      return NULL;
 
     if (clutter_actor_get_n_children (CLUTTER_ACTOR (window_actor)) != 1)
-      return;
+      return NULL;
 
     window = meta_window_actor_get_meta_window (window_actor);
     if (!window)
-      return;
+      return NULL;
 
     view = get_window_view (renderer, window);
     if (!view)
-      return;
+      return NULL;
 
     framebuffer = clutter_stage_view_get_framebuffer (CLUTTER_STAGE_VIEW (view));
     if (!cogl_is_onscreen (framebuffer))
-      return;
+      return NULL;
 
     surface_actor = meta_window_actor_get_surface (window_actor);
     if (!META_IS_SURFACE_ACTOR_WAYLAND (surface_actor))
-      return;
+      return NULL;
 
     surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
     onscreen = COGL_ONSCREEN (framebuffer);
     scanout = meta_surface_actor_wayland_try_acquire_scanout (surface_actor_wayland,
                                                               onscreen);
     if (!scanout)
-      return;
+      return NULL;
 
     clutter_stage_view_assign_next_scanout (CLUTTER_STAGE_VIEW (view), scanout);
+
+    return view;
+}
+
+static gboolean
+has_effects_or_clones (ClutterActor *actor)
+{
+    for (; actor; actor = clutter_actor_get_parent (actor))
+      {
+          if (clutter_actor_has_effects (actor) ||
+              clutter_actor_has_mapped_clones (actor))
+            return TRUE;
+      }
+
+    return FALSE;
+}
+
+/*
+ * Checks whether anything painted after @actor, i.e. above it, overlaps
+ * @rect. Actors without a known paint box are assumed to overlap it.
+ */
+static gboolean
+is_obscured (ClutterActor          *actor,
+             const graphene_rect_t *rect)
+{
+    ClutterActor *ancestor;
+
+    for (ancestor = actor;
+         clutter_actor_get_parent (ancestor);
+         ancestor = clutter_actor_get_parent (ancestor))
+      {
+          ClutterActor *sibling;
+
+          for (sibling = clutter_actor_get_next_sibling (ancestor);
+               sibling;
+               sibling = clutter_actor_get_next_sibling (sibling))
+            {
+                ClutterActorBox box;
+                graphene_rect_t sibling_rect;
+
+                if (!clutter_actor_is_mapped (sibling))
+                  continue;
+
+                if (!clutter_actor_get_paint_box (sibling, &box))
+                  return TRUE;
+
+                sibling_rect = GRAPHENE_RECT_INIT (box.x1, box.y1,
+                                                   box.x2 - box.x1,
+                                                   box.y2 - box.y1);
+                if (graphene_rect_intersection (&sibling_rect, rect, NULL))
+                  return TRUE;
+            }
+      }
+
+    return meta_stage_has_overlays_in_rect (META_STAGE (clutter_actor_get_stage (actor)),
+                                            rect);
+}
+
+static MetaRendererView *
+get_view_containing (MetaRenderer          *renderer,
+                     const graphene_rect_t *rect)
+{
+    GList *l;
+
+    for (l = meta_renderer_get_views (renderer); l; l = l->next)
+      {
+          ClutterStageView *stage_view = l->data;
+          MetaRectangle view_layout;
+          graphene_rect_t view_rect;
+
+          clutter_stage_view_get_layout (stage_view, &view_layout);
+          view_rect = meta_rectangle_to_graphene_rect (&view_layout);
+
+          if (graphene_rect_contains_rect (&view_rect, rect))
+            return META_RENDERER_VIEW (stage_view);
+      }
+
+    return NULL;
+}
+
+static gboolean
+maybe_assign_overlay_plane (MetaCompositorNative *compositor_native,
+                            MetaWindowActor      *window_actor,
+                            MetaRendererView     *primary_plane_view,
+                            GList                *reassigned_views)
+{
+    MetaBackend *backend = meta_get_backend ();
+    MetaRenderer *renderer = meta_backend_get_renderer (backend);
+    MetaSurfaceActor *surface_actor;
+    ClutterActor *actor;
+    MetaShapedTexture *stex;
+    CoglTexture *texture;
+    MetaRendererView *view;
+    CoglFramebuffer *framebuffer;
+    MetaRectangle view_layout;
+    graphene_rect_t rect;
+    MetaRectangle dst_rect;
+    float x, y, width, height;
+    float view_scale;
+    g_autoptr (CoglScanout) scanout = NULL;
+
+    if (meta_window_actor_effect_in_progress (window_actor))
+      return FALSE;
+
+    if (clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
+      return FALSE;
+
+    if (clutter_actor_get_n_children (CLUTTER_ACTOR (window_actor)) != 1)
+      return FALSE;
+
+    surface_actor = meta_window_actor_get_surface (window_actor);
+    if (!META_IS_SURFACE_ACTOR_WAYLAND (surface_actor))
+      return FALSE;
+
+    if (g_list_find (compositor_native->overlay_actors, surface_actor))
+      return FALSE;
+
+    actor = CLUTTER_ACTOR (surface_actor);
+    if (!clutter_actor_is_mapped (actor) ||
+        clutter_actor_get_n_children (actor) != 0)
+      return FALSE;
+
+    /* Planes show buffers as they are */
+    if (clutter_actor_get_paint_opacity (actor) != 0xff ||
+        clutter_actor_is_scaled (actor) ||
+        clutter_actor_is_rotated (actor) ||
+        has_effects_or_clones (actor))
+      return FALSE;
+
+    stex = meta_surface_actor_get_texture (surface_actor);
+    if (!meta_shaped_texture_is_untransformed (stex))
+      return FALSE;
+
+    clutter_actor_get_transformed_position (actor, &x, &y);
+    clutter_actor_get_size (actor, &width, &height);
+    rect = GRAPHENE_RECT_INIT (x, y, width, height);
+
+    view = get_view_containing (renderer, &rect);
+    if (!view || view == primary_plane_view ||
+        !g_list_find (reassigned_views, view))
+      return FALSE;
+
+    if (is_obscured (actor, &rect))
+      return FALSE;
+
+    clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+    view_scale = clutter_stage_view_get_scale (CLUTTER_STAGE_VIEW (view));
+    dst_rect = (MetaRectangle) {
+      .x = roundf ((x - view_layout.x) * view_scale),
+      .y = roundf ((y - view_layout.y) * view_scale),
+      .width = roundf (width * view_scale),
+      .height = roundf (height * view_scale),
+    };
+
+    texture = meta_shaped_texture_get_texture (stex);
+    if (cogl_texture_get_width (texture) != dst_rect.width ||
+        cogl_texture_get_height (texture) != dst_rect.height)
+      return FALSE;
+
+    framebuffer = clutter_stage_view_get_onscreen (CLUTTER_STAGE_VIEW (view));
+    if (!cogl_is_onscreen (framebuffer))
+      return FALSE;
+
+    scanout =
+      meta_surface_actor_wayland_try_acquire_overlay_scanout (META_SURFACE_ACTOR_WAYLAND (surface_actor));
+    if (!scanout)
+      return FALSE;
+
+    if (!meta_onscreen_native_try_assign_overlay (COGL_ONSCREEN (framebuffer),
+                                                  scanout,
+                                                  &dst_rect))
+      return FALSE;
+
+    meta_surface_actor_set_overlay_view (surface_actor,
+                                         CLUTTER_STAGE_VIEW (view));
+    compositor_native->overlay_actors =
+      g_list_prepend (compositor_native->overlay_actors,
+                      g_object_ref (surface_actor));
+
+    return TRUE;
+}
+
+/*
+ * The overlays of a view can only be assigned anew when it is going to
+ * be painted, and when the frame it painted last has been flipped to, as
+ * the device still uses the overlays of a frame until then.
+ */
+static gboolean
+can_reassign_overlays (ClutterStageView *stage_view)
+{
+    CoglFramebuffer *framebuffer;
+
+    framebuffer = clutter_stage_view_get_onscreen (stage_view);
+    if (!cogl_is_onscreen (framebuffer))
+      return FALSE;
+
+    return (clutter_stage_view_has_redraw_clip (stage_view) &&
+            !meta_onscreen_native_has_pending_flip (COGL_ONSCREEN (framebuffer)));
+}
+
+/*
+ * Puts the buffers of unobscured and untransformed Wayland surfaces on
+ * overlay planes, so that they don't need to be composited. The surfaces
+ * that can't be put on a plane are painted as usual.
+ */
+static void
+maybe_assign_overlay_planes (MetaCompositor   *compositor,
+                             MetaRendererView *primary_plane_view)
+{
+    MetaCompositorNative *compositor_native = META_COMPOSITOR_NATIVE (compositor);
+    MetaBackend *backend = meta_get_backend ();
+    MetaRenderer *renderer = meta_backend_get_renderer (backend);
+    MetaDisplay *display = meta_compositor_get_display (compositor);
+    GList *old_overlay_actors;
+    GList *reassigned_views = NULL;
+    GList *l;
+
+    for (l = meta_renderer_get_views (renderer); l; l = l->next)
+      {
+          ClutterStageView *stage_view = l->data;
+          CoglFramebuffer *framebuffer;
+
+          if (!can_reassign_overlays (stage_view))
+            continue;
+
+          framebuffer = clutter_stage_view_get_onscreen (stage_view);
+          meta_onscreen_native_reset_overlays (COGL_ONSCREEN (framebuffer));
+          reassigned_views = g_list_prepend (reassigned_views, stage_view);
+      }
+
+    if (!reassigned_views)
+      return;
+
+    old_overlay_actors = g_steal_pointer (&compositor_native->overlay_actors);
+
+    /* surfaces on the overlays of the other views stay there */
+    for (l = old_overlay_actors; l; l = l->next)
+      {
+          MetaSurfaceActor *surface_actor = l->data;
+          ClutterStageView *overlay_view;
+
+          overlay_view = meta_surface_actor_get_overlay_view (surface_actor);
+          if (overlay_view && !g_list_find (reassigned_views, overlay_view))
+            {
+              compositor_native->overlay_actors =
+                g_list_prepend (compositor_native->overlay_actors,
+                                g_object_ref (surface_actor));
+            }
+      }
+
+    if (!meta_compositor_is_unredirect_inhibited (compositor))
+      {
+          /* from the top of the stack, so that the windows the most likely
+           * to be unobscured get the planes */
+          for (l = g_list_last (meta_get_window_actors (display)); l; l = l->prev)
+            maybe_assign_overlay_plane (compositor_native, l->data,
+                                        primary_plane_view,
+                                        reassigned_views);
+      }
+
+    for (l = old_overlay_actors; l; l = l->next)
+      {
+          MetaSurfaceActor *surface_actor = l->data;
+
+          if (!g_list_find (compositor_native->overlay_actors, surface_actor))
+            meta_surface_actor_set_overlay_view (surface_actor, NULL);
+      }
+    g_list_free_full (old_overlay_actors, g_object_unref);
+    g_list_free (reassigned_views);
 }
 
 static void
 meta_compositor_native_pre_paint (MetaCompositor *compositor)
 {
     MetaCompositorClass *parent_class;
+    MetaRendererView *primary_plane_view;
 
-    maybe_assign_primary_plane (compositor);
+    primary_plane_view = maybe_assign_primary_plane (compositor);
+    maybe_assign_overlay_planes (compositor, primary_plane_view);
 
     parent_class = META_COMPOSITOR_CLASS (meta_compositor_native_parent_class);
     parent_class->pre_paint (compositor);
@@ -134,6 +416,17 @@ meta_compositor_native_new (MetaDisplay *display)
                          NULL);
 }
 
+static void
+meta_compositor_native_dispose (GObject *object)
+{
+    MetaCompositorNative *compositor_native = META_COMPOSITOR_NATIVE (object);
+
+    g_list_free_full (compositor_native->overlay_actors, g_object_unref);
+    compositor_native->overlay_actors = NULL;
+
+    G_OBJECT_CLASS (meta_compositor_native_parent_class)->dispose (object);
+}
+
 static void
 meta_compositor_native_init (MetaCompositorNative *compositor_native)
 {
@@ -142,7 +435,10 @@ meta_compositor_native_init (MetaCompositorNative *compositor_native)
 static void
 meta_compositor_native_class_init (MetaCompositorNativeClass *klass)
 {
+    GObjectClass *object_class = G_OBJECT_CLASS (klass);
     MetaCompositorClass *compositor_class = META_COMPOSITOR_CLASS (klass);
 
+    object_class->dispose = meta_compositor_native_dispose;
+
     compositor_class->pre_paint = meta_compositor_native_pre_paint;
 }
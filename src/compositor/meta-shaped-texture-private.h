@@ -71,4 +71,9 @@ void meta_shaped_texture_set_clip_region (MetaShapedTexture *stex,
 
 void meta_shaped_texture_ensure_size_valid (MetaShapedTexture *stex);
 
+gboolean meta_shaped_texture_is_untransformed (MetaShapedTexture *stex);
+
+void meta_shaped_texture_set_overlay_view (MetaShapedTexture *stex,
+                                           ClutterStageView  *view);
+
 #endif
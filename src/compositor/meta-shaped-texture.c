@@ -109,6 +109,9 @@ struct _MetaShapedTexture
 
   int buffer_scale;
 
+  /* the view where the texture is shown on an overlay plane instead */
+  ClutterStageView *overlay_view;
+
   guint create_mipmaps : 1;
 };
 
@@ -776,6 +779,23 @@ select_texture_for_paint (MetaShapedTexture   *stex,
   return texture;
 }
 
+static gboolean
+is_shown_on_overlay (MetaShapedTexture   *stex,
+                     ClutterPaintContext *paint_context)
+{
+  CoglFramebuffer *framebuffer;
+
+  if (!stex->overlay_view)
+    return FALSE;
+
+  if (clutter_paint_context_get_stage_view (paint_context) != stex->overlay_view)
+    return FALSE;
+
+  /* Still paint into offscreen framebuffers, e.g. for screenshots */
+  framebuffer = clutter_paint_context_get_framebuffer (paint_context);
+  return framebuffer == clutter_stage_view_get_framebuffer (stex->overlay_view);
+}
+
 static void
 meta_shaped_texture_paint_content (ClutterContent      *content,
                                    ClutterActor        *actor,
@@ -790,6 +810,9 @@ meta_shaped_texture_paint_content (ClutterContent      *content,
   if (stex->clip_region && cairo_region_is_empty (stex->clip_region))
     return;
 
+  if (is_shown_on_overlay (stex, paint_context))
+    return;
+
   /* The GL EXT_texture_from_pixmap extension does allow for it to be
    * used together with SGIS_generate_mipmap, however this is very
    * rarely supported. Also, even when it is supported there
@@ -1533,3 +1556,39 @@ meta_shaped_texture_get_height (MetaShapedTexture *stex)
 
   return stex->dst_height;
 }
+
+/**
+ * meta_shaped_texture_is_untransformed: (skip)
+ *
+ * Checks whether the texture is painted as is, i.e. that its pixels map one
+ * to one to the pixels of its buffer, ignoring the scale of the actor.
+ */
+gboolean
+meta_shaped_texture_is_untransformed (MetaShapedTexture *stex)
+{
+  g_return_val_if_fail (META_IS_SHAPED_TEXTURE (stex), FALSE);
+
+  return (stex->texture &&
+          !stex->mask_texture &&
+          !stex->snippet &&
+          stex->is_y_inverted &&
+          stex->transform == META_MONITOR_TRANSFORM_NORMAL &&
+          !stex->has_viewport_src_rect &&
+          !stex->has_viewport_dst_size);
+}
+
+/**
+ * meta_shaped_texture_set_overlay_view: (skip)
+ * @view: (nullable): the view where the texture is shown on an overlay plane
+ *
+ * Makes the texture not paint itself on @view, where the buffer it shows
+ * is scanned out directly on an overlay plane.
+ */
+void
+meta_shaped_texture_set_overlay_view (MetaShapedTexture *stex,
+                                      ClutterStageView  *view)
+{
+  g_return_if_fail (META_IS_SHAPED_TEXTURE (stex));
+
+  stex->overlay_view = view;
+}
@@ -86,6 +86,18 @@ meta_surface_actor_wayland_try_acquire_scanout (MetaSurfaceActorWayland *self,
   return scanout;
 }
 
+CoglScanout *
+meta_surface_actor_wayland_try_acquire_overlay_scanout (MetaSurfaceActorWayland *self)
+{
+  MetaWaylandSurface *surface;
+
+  surface = meta_surface_actor_wayland_get_surface (self);
+  if (!surface)
+    return NULL;
+
+  return meta_wayland_surface_try_acquire_overlay_scanout (surface);
+}
+
 static void
 meta_surface_actor_wayland_dispose (GObject *object)
 {
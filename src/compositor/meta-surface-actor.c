@@ -39,6 +39,8 @@ typedef struct _MetaSurfaceActorPrivate
   /* Freeze/thaw accounting */
   cairo_region_t *pending_damage;
   guint frozen : 1;
+
+  ClutterStageView *overlay_view;
 } MetaSurfaceActorPrivate;
 
 static void cullable_iface_init (MetaCullableInterface *iface);
@@ -547,6 +549,15 @@ meta_surface_actor_process_damage (MetaSurfaceActor *self,
 {
   MetaSurfaceActorPrivate *priv =
     meta_surface_actor_get_instance_private (self);
+  MetaWindowActor *window_actor;
+
+  window_actor = meta_window_actor_from_actor (CLUTTER_ACTOR (self));
+  if (window_actor)
+    {
+      cairo_rectangle_int_t rect = { .x = x, .y = y, .width = width, .height = height };
+
+      meta_window_actor_add_surface_damage (window_actor, self, &rect);
+    }
 
   if (meta_surface_actor_is_frozen (self))
     {
@@ -617,6 +628,39 @@ meta_surface_actor_is_frozen (MetaSurfaceActor *self)
   return priv->frozen;
 }
 
+/**
+ * meta_surface_actor_set_overlay_view: (skip)
+ * @view: (nullable): the view where the surface is on an overlay plane
+ *
+ * Tells the actor that its buffer is scanned out on an overlay plane of
+ * @view, so that it doesn't get painted there too.
+ */
+void
+meta_surface_actor_set_overlay_view (MetaSurfaceActor *self,
+                                     ClutterStageView *view)
+{
+  MetaSurfaceActorPrivate *priv =
+    meta_surface_actor_get_instance_private (self);
+
+  if (priv->overlay_view == view)
+    return;
+
+  priv->overlay_view = view;
+  meta_shaped_texture_set_overlay_view (priv->texture, view);
+
+  /* The views losing or gaining the overlay need to paint the area again */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+}
+
+ClutterStageView *
+meta_surface_actor_get_overlay_view (MetaSurfaceActor *self)
+{
+  MetaSurfaceActorPrivate *priv =
+    meta_surface_actor_get_instance_private (self);
+
+  return priv->overlay_view;
+}
+
 void
 meta_surface_actor_set_transform (MetaSurfaceActor     *self,
                                   MetaMonitorTransform  transform)
@@ -83,6 +83,10 @@ void meta_window_actor_set_geometry_scale (MetaWindowActor *window_actor,
 
 int meta_window_actor_get_geometry_scale (MetaWindowActor *window_actor);
 
+void meta_window_actor_add_surface_damage (MetaWindowActor             *window_actor,
+                                           MetaSurfaceActor            *surface_actor,
+                                           const cairo_rectangle_int_t *rect);
+
 void meta_window_actor_notify_damaged (MetaWindowActor *window_actor);
 
 gboolean meta_window_actor_is_frozen (MetaWindowActor *self);
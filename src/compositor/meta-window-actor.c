@@ -57,6 +57,12 @@ typedef struct _MetaWindowActorPrivate
 
   int geometry_scale;
 
+  /*
+   * Damage since the last "damaged" emission, in buffer coordinates of the
+   * main surface, or NULL if none was reported.
+   */
+  cairo_region_t *damage;
+
   /*
    * These need to be counters rather than flags, since more plugins
    * can implement same effect; the practicality of stacking effects
@@ -413,6 +419,7 @@ meta_window_actor_dispose (GObject *object)
   meta_compositor_remove_window_actor (compositor, self);
 
   g_clear_object (&priv->window);
+  g_clear_pointer (&priv->damage, cairo_region_destroy);
 
   if (priv->surface)
     {
@@ -1216,7 +1223,8 @@ meta_window_actor_transform_cursor_position (MetaScreenCastWindow *screen_cast_w
 static void
 meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
                                 MetaRectangle        *bounds,
-                                uint8_t              *data)
+                                uint8_t              *data,
+                                int                   stride)
 {
   MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
   cairo_surface_t *image;
@@ -1235,7 +1243,8 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
   cr_height = cairo_image_surface_get_height (image);
   cr_stride = cairo_image_surface_get_stride (image);
 
-  if (cr_width == bounds->width && cr_height == bounds->height)
+  if (cr_width == bounds->width && cr_height == bounds->height &&
+      cr_stride == stride)
     {
       memcpy (data, cr_data, cr_height * cr_stride);
     }
@@ -1243,7 +1252,7 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
     {
       int width = MIN (bounds->width, cr_width);
       int height = MIN (bounds->height, cr_height);
-      int stride = width * bpp;
+      int row_size = width * bpp;
       uint8_t *src, *dst;
 
       src = cr_data;
@@ -1251,18 +1260,18 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
 
       for (int i = 0; i < height; i++)
         {
-          memcpy (dst, src, stride);
+          memcpy (dst, src, row_size);
           if (width < bounds->width)
-            memset (dst + stride, 0, (bounds->width * bpp) - stride);
+            memset (dst + row_size, 0, (bounds->width * bpp) - row_size);
 
           src += cr_stride;
-          dst += bounds->width * bpp;
+          dst += stride;
         }
 
       for (int i = height; i < bounds->height; i++)
         {
           memset (dst, 0, bounds->width * bpp);
-          dst += bounds->width * bpp;
+          dst += stride;
         }
     }
 
@@ -1342,6 +1351,16 @@ meta_window_actor_has_damage (MetaScreenCastWindow *screen_cast_window)
   return clutter_actor_has_damage (CLUTTER_ACTOR (screen_cast_window));
 }
 
+static const cairo_region_t *
+meta_window_actor_get_damage (MetaScreenCastWindow *screen_cast_window)
+{
+  MetaWindowActor *window_actor = META_WINDOW_ACTOR (screen_cast_window);
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+
+  return priv->damage;
+}
+
 static void
 screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface)
 {
@@ -1351,6 +1370,7 @@ screen_cast_window_iface_init (MetaScreenCastWindowInterface *iface)
   iface->capture_into = meta_window_actor_capture_into;
   iface->blit_to_framebuffer = meta_window_actor_blit_to_framebuffer;
   iface->has_damage = meta_window_actor_has_damage;
+  iface->get_damage = meta_window_actor_get_damage;
 }
 
 MetaWindowActor *
@@ -1371,10 +1391,41 @@ meta_window_actor_from_actor (ClutterActor *actor)
   return NULL;
 }
 
+void
+meta_window_actor_add_surface_damage (MetaWindowActor             *window_actor,
+                                      MetaSurfaceActor            *surface_actor,
+                                      const cairo_rectangle_int_t *rect)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+
+  if (!priv->damage)
+    priv->damage = cairo_region_create ();
+
+  if (surface_actor == priv->surface)
+    {
+      cairo_region_union_rectangle (priv->damage, rect);
+    }
+  else
+    {
+      MetaRectangle bounds;
+
+      /* Subsurface damage isn't mapped into the main surface buffer */
+      meta_window_actor_get_buffer_bounds (META_SCREEN_CAST_WINDOW (window_actor),
+                                           &bounds);
+      cairo_region_union_rectangle (priv->damage, &bounds);
+    }
+}
+
 void
 meta_window_actor_notify_damaged (MetaWindowActor *window_actor)
 {
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+
   g_signal_emit (window_actor, signals[DAMAGED], 0);
+
+  g_clear_pointer (&priv->damage, cairo_region_destroy);
 }
 
 /**
@@ -0,0 +1,99 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define EVENT_TIME 1000
+#define N_MOTION_EVENTS 4
+
+static gboolean
+on_stage_captured_event (ClutterActor  *stage,
+                         ClutterEvent  *event,
+                         ClutterEvent **captured_event)
+{
+  g_clear_pointer (captured_event, clutter_event_free);
+  *captured_event = clutter_event_copy (event);
+  return TRUE;
+}
+
+static void
+actor_event_motion_history (void)
+{
+  ClutterActor *stage;
+  ClutterBackend *backend;
+  ClutterSeat *seat;
+  ClutterInputDevice *device;
+  ClutterEvent *captured_event = NULL;
+  const ClutterEventHistoryEntry *history;
+  guint n_entries;
+  gfloat x, y;
+  int i;
+
+  stage = clutter_test_get_stage ();
+  g_signal_connect (stage, "captured-event::motion",
+                    G_CALLBACK (on_stage_captured_event),
+                    &captured_event);
+  clutter_actor_show (stage);
+
+  backend = clutter_get_default_backend ();
+  seat = clutter_backend_get_default_seat (backend);
+  device = clutter_seat_get_pointer (seat);
+
+  /* Queue all the events before the stage gets to process them, so
+   * that they are compressed into a single one */
+  for (i = 0; i < N_MOTION_EVENTS; i++)
+    {
+      ClutterEvent *event;
+
+      event = clutter_event_new (CLUTTER_MOTION);
+      event->motion.time = EVENT_TIME + i * 10;
+      event->motion.stage = CLUTTER_STAGE (stage);
+      clutter_event_set_coords (event, 10 * (i + 1), 20 * (i + 1));
+      clutter_event_set_device (event, device);
+
+      clutter_event_put (event);
+      clutter_event_free (event);
+    }
+
+  while (captured_event == NULL)
+    g_main_context_iteration (NULL, FALSE);
+
+  /* The delivered event is the most recent one */
+  clutter_event_get_coords (captured_event, &x, &y);
+  g_assert_cmpfloat (x, ==, 10 * N_MOTION_EVENTS);
+  g_assert_cmpfloat (y, ==, 20 * N_MOTION_EVENTS);
+  g_assert_cmpuint (clutter_event_get_time (captured_event), ==,
+                    EVENT_TIME + (N_MOTION_EVENTS - 1) * 10);
+
+  /* and the other ones are in its history, oldest first */
+  history = clutter_event_get_history (captured_event, &n_entries);
+  g_assert_nonnull (history);
+  g_assert_cmpuint (n_entries, ==, N_MOTION_EVENTS - 1);
+
+  for (i = 0; i < n_entries; i++)
+    {
+      g_assert_cmpuint (history[i].time, ==, EVENT_TIME + i * 10);
+      g_assert_cmpfloat (history[i].x, ==, 10 * (i + 1));
+      g_assert_cmpfloat (history[i].y, ==, 20 * (i + 1));
+      g_assert_null (history[i].axes);
+    }
+
+  clutter_event_free (captured_event);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/event/motion-history", actor_event_motion_history)
+)
@@ -0,0 +1,180 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct _FooEffectClass
+{
+  ClutterOffscreenEffectClass parent_class;
+} FooEffectClass;
+
+typedef struct _FooEffect
+{
+  ClutterOffscreenEffect parent;
+
+  CoglHandle texture;
+  float target_width;
+  float target_height;
+  graphene_rect_t target_rect;
+  int paint_count;
+} FooEffect;
+
+GType foo_effect_get_type (void);
+
+G_DEFINE_TYPE (FooEffect, foo_effect, CLUTTER_TYPE_OFFSCREEN_EFFECT)
+
+static void
+foo_effect_paint_target (ClutterOffscreenEffect *effect,
+                         ClutterPaintContext    *paint_context)
+{
+  FooEffect *foo_effect = (FooEffect *) effect;
+
+  foo_effect->texture = clutter_offscreen_effect_get_texture (effect);
+  G_GNUC_BEGIN_IGNORE_DEPRECATIONS
+  g_assert_true (clutter_offscreen_effect_get_target_size (effect,
+                                                           &foo_effect->target_width,
+                                                           &foo_effect->target_height));
+  G_GNUC_END_IGNORE_DEPRECATIONS
+  g_assert_true (clutter_offscreen_effect_get_target_rect (effect,
+                                                           &foo_effect->target_rect));
+  foo_effect->paint_count++;
+
+  CLUTTER_OFFSCREEN_EFFECT_CLASS (foo_effect_parent_class)->paint_target (effect,
+                                                                          paint_context);
+}
+
+static void
+foo_effect_class_init (FooEffectClass *klass)
+{
+  ClutterOffscreenEffectClass *offscreen_effect_class =
+    CLUTTER_OFFSCREEN_EFFECT_CLASS (klass);
+
+  offscreen_effect_class->paint_target = foo_effect_paint_target;
+}
+
+static void
+foo_effect_init (FooEffect *self)
+{
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  GMainLoop *main_loop = g_main_loop_new (NULL, TRUE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_data (stage,
+                                         "after-paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED | G_CONNECT_AFTER);
+
+  clutter_actor_queue_redraw (stage);
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+  g_main_loop_unref (main_loop);
+}
+
+static void
+assert_target_size (FooEffect *effect,
+                    float      width,
+                    float      height)
+{
+  g_assert_cmpfloat (effect->target_width, ==, width);
+  g_assert_cmpfloat (effect->target_height, ==, height);
+  g_assert_cmpfloat (effect->target_rect.size.width, ==, width);
+  g_assert_cmpfloat (effect->target_rect.size.height, ==, height);
+}
+
+static void
+assert_pixel_color (ClutterActor *stage,
+                    int           x,
+                    int           y,
+                    guint8        red,
+                    guint8        green,
+                    guint8        blue)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), x, y, 1, 1);
+
+  g_assert_cmpint (ABS ((int) red - (int) pixel[0]), <=, 2);
+  g_assert_cmpint (ABS ((int) green - (int) pixel[1]), <=, 2);
+  g_assert_cmpint (ABS ((int) blue - (int) pixel[2]), <=, 2);
+
+  g_free (pixel);
+}
+
+static void
+actor_offscreen_effect_pool (void)
+{
+  ClutterActor *stage;
+  ClutterActor *actor1, *actor2;
+  FooEffect *effect1, *effect2;
+  CoglHandle texture;
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_White);
+
+  actor1 = clutter_actor_new ();
+  clutter_actor_set_background_color (actor1, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (actor1, 100, 50);
+  clutter_actor_add_child (stage, actor1);
+
+  effect1 = g_object_new (foo_effect_get_type (), NULL);
+  clutter_actor_add_effect (actor1, CLUTTER_EFFECT (effect1));
+
+  clutter_actor_show (stage);
+  wait_for_paint (stage);
+
+  /* the texture comes from the pool, and is larger than the actor, but
+   * the reported target size is the size of the actor */
+  g_assert_cmpint (effect1->paint_count, >, 0);
+  g_assert_nonnull (effect1->texture);
+  g_assert_cmpint (cogl_texture_get_width (effect1->texture), >=, 100);
+  g_assert_cmpint (cogl_texture_get_height (effect1->texture), >=, 50);
+  assert_target_size (effect1, 100, 50);
+
+  /* only the target area of the texture is painted */
+  assert_pixel_color (stage, 50, 25, 255, 0, 0);
+  assert_pixel_color (stage, 50, 55, 255, 255, 255);
+  assert_pixel_color (stage, 105, 25, 255, 255, 255);
+
+  /* growing a little keeps the same render target */
+  texture = effect1->texture;
+  clutter_actor_set_size (actor1, 110, 60);
+  wait_for_paint (stage);
+
+  g_assert_true (effect1->texture == texture);
+  assert_target_size (effect1, 110, 60);
+  assert_pixel_color (stage, 105, 55, 255, 0, 0);
+
+  /* removing the effect releases the render target to the pool, where
+   * the effect of another actor of a similar size picks it up */
+  clutter_actor_remove_effect (actor1, CLUTTER_EFFECT (effect1));
+
+  actor2 = clutter_actor_new ();
+  clutter_actor_set_background_color (actor2, CLUTTER_COLOR_Blue);
+  clutter_actor_set_position (actor2, 0, 100);
+  clutter_actor_set_size (actor2, 90, 40);
+  clutter_actor_add_child (stage, actor2);
+
+  effect2 = g_object_new (foo_effect_get_type (), NULL);
+  clutter_actor_add_effect (actor2, CLUTTER_EFFECT (effect2));
+
+  wait_for_paint (stage);
+
+  g_assert_cmpint (effect2->paint_count, >, 0);
+  g_assert_true (effect2->texture == texture);
+  assert_target_size (effect2, 90, 40);
+  assert_pixel_color (stage, 45, 120, 0, 0, 255);
+  assert_pixel_color (stage, 95, 120, 255, 255, 255);
+
+  clutter_actor_destroy (actor2);
+  clutter_actor_destroy (actor1);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/offscreen/effect-pool", actor_offscreen_effect_pool)
+)
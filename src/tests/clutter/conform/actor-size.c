@@ -140,6 +140,40 @@ actor_preferred_size (void)
   clutter_actor_destroy (test);
 }
 
+static void
+actor_preferred_size_cache_growth (void)
+{
+  ClutterActor *test;
+  TestActor *self;
+  gfloat min_width, nat_width;
+  int i;
+
+  test = g_object_new (TEST_TYPE_ACTOR, NULL);
+  self = (TestActor *) test;
+
+  if (g_test_verbose ())
+    g_print ("Preferred width for more sizes than the initial cache\n");
+
+  for (i = 0; i < 6; i++)
+    {
+      self->preferred_width_called = FALSE;
+      clutter_actor_get_preferred_width (test, 10 + i, &min_width, &nat_width);
+      g_assert (self->preferred_width_called);
+    }
+
+  if (g_test_verbose ())
+    g_print ("Preferred width (cache grown)\n");
+
+  for (i = 0; i < 6; i++)
+    {
+      self->preferred_width_called = FALSE;
+      clutter_actor_get_preferred_width (test, 10 + i, &min_width, &nat_width);
+      g_assert (!self->preferred_width_called);
+    }
+
+  clutter_actor_destroy (test);
+}
+
 static void
 actor_fixed_size (void)
 {
@@ -214,5 +248,6 @@ actor_fixed_size (void)
 
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/size/preferred", actor_preferred_size)
+  CLUTTER_TEST_UNIT ("/actor/size/preferred-cache-growth", actor_preferred_size_cache_growth)
   CLUTTER_TEST_UNIT ("/actor/size/fixed", actor_fixed_size)
 )
@@ -0,0 +1,186 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct
+{
+  int n_state_changes;
+  gboolean last_state_value;
+
+  int n_inserts;
+  int last_insert_position;
+  int last_insert_length;
+
+  int n_caret_moves;
+  int last_caret_position;
+} NotifyData;
+
+static gboolean
+on_post_paint (gpointer user_data)
+{
+  gboolean *was_painted = user_data;
+
+  *was_painted = TRUE;
+
+  return FALSE;
+}
+
+/* Queued notifications are flushed by a post-paint repaint function,
+ * which runs right after ours in the same frame */
+static void
+wait_for_frame (ClutterActor *stage)
+{
+  gboolean was_painted = FALSE;
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         on_post_paint,
+                                         &was_painted,
+                                         NULL);
+  clutter_actor_queue_redraw (stage);
+
+  while (!was_painted)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+on_state_change (AtkObject  *accessible,
+                 const char *name,
+                 gboolean    value,
+                 NotifyData *data)
+{
+  data->n_state_changes++;
+  data->last_state_value = value;
+}
+
+static void
+on_text_insert (AtkObject  *accessible,
+                int         position,
+                int         length,
+                NotifyData *data)
+{
+  data->n_inserts++;
+  data->last_insert_position = position;
+  data->last_insert_length = length;
+}
+
+static void
+on_text_caret_moved (AtkObject  *accessible,
+                     int         position,
+                     NotifyData *data)
+{
+  data->n_caret_moves++;
+  data->last_caret_position = position;
+}
+
+static void
+cally_notify_state_coalescing (void)
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  AtkObject *accessible;
+  NotifyData data = { 0 };
+
+  if (!clutter_get_accessibility_enabled ())
+    {
+      g_test_skip ("Accessibility support is disabled");
+      return;
+    }
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_show (stage);
+
+  actor = clutter_actor_new ();
+  clutter_actor_add_child (stage, actor);
+
+  accessible = clutter_actor_get_accessible (actor);
+  g_assert_nonnull (accessible);
+  wait_for_frame (stage);
+
+  g_signal_connect (accessible, "state-change::sensitive",
+                    G_CALLBACK (on_state_change), &data);
+
+  clutter_actor_set_reactive (actor, TRUE);
+  clutter_actor_set_reactive (actor, FALSE);
+  clutter_actor_set_reactive (actor, TRUE);
+
+  /* nothing is emitted until the end of the frame */
+  g_assert_cmpint (data.n_state_changes, ==, 0);
+
+  wait_for_frame (stage);
+
+  g_assert_cmpint (data.n_state_changes, ==, 1);
+  g_assert_true (data.last_state_value);
+
+  /* the next frame has nothing left to notify */
+  wait_for_frame (stage);
+
+  g_assert_cmpint (data.n_state_changes, ==, 1);
+
+  clutter_actor_destroy (actor);
+}
+
+static void
+cally_notify_text_coalescing (void)
+{
+  ClutterActor *stage;
+  ClutterActor *text;
+  AtkObject *accessible;
+  NotifyData data = { 0 };
+
+  if (!clutter_get_accessibility_enabled ())
+    {
+      g_test_skip ("Accessibility support is disabled");
+      return;
+    }
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_show (stage);
+
+  text = clutter_text_new ();
+  clutter_text_set_editable (CLUTTER_TEXT (text), TRUE);
+  clutter_actor_add_child (stage, text);
+
+  accessible = clutter_actor_get_accessible (text);
+  g_assert_nonnull (accessible);
+
+  clutter_text_set_cursor_position (CLUTTER_TEXT (text), 0);
+  wait_for_frame (stage);
+
+  g_signal_connect (accessible, "text-changed::insert",
+                    G_CALLBACK (on_text_insert), &data);
+  g_signal_connect (accessible, "text-caret-moved",
+                    G_CALLBACK (on_text_caret_moved), &data);
+
+  /* typing inserts contiguous text and moves the caret each time */
+  clutter_text_insert_unichar (CLUTTER_TEXT (text), 'a');
+  clutter_text_insert_unichar (CLUTTER_TEXT (text), 'b');
+  clutter_text_insert_unichar (CLUTTER_TEXT (text), 'c');
+
+  g_assert_cmpint (data.n_inserts, ==, 0);
+  g_assert_cmpint (data.n_caret_moves, ==, 0);
+
+  wait_for_frame (stage);
+
+  g_assert_cmpint (data.n_inserts, ==, 1);
+  g_assert_cmpint (data.last_insert_position, ==, 0);
+  g_assert_cmpint (data.last_insert_length, ==, 3);
+
+  g_assert_cmpint (data.n_caret_moves, ==, 1);
+  g_assert_cmpint (data.last_caret_position, ==, 3);
+
+  /* moving the caret back and forth within a frame doesn't notify */
+  clutter_text_set_cursor_position (CLUTTER_TEXT (text), 1);
+  clutter_text_set_cursor_position (CLUTTER_TEXT (text), 3);
+
+  wait_for_frame (stage);
+
+  g_assert_cmpint (data.n_inserts, ==, 1);
+  g_assert_cmpint (data.n_caret_moves, ==, 1);
+
+  clutter_actor_destroy (text);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/cally/notify/state-coalescing", cally_notify_state_coalescing)
+  CLUTTER_TEST_UNIT ("/cally/notify/text-coalescing", cally_notify_text_coalescing)
+)
@@ -0,0 +1,242 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define CANVAS_SIZE 100
+
+typedef struct
+{
+  ClutterColor color;
+
+  int n_draws;
+  int last_width;
+  int last_height;
+} DrawData;
+
+static gboolean
+on_draw (ClutterCanvas *canvas,
+         cairo_t       *cr,
+         int            width,
+         int            height,
+         DrawData      *data)
+{
+  data->n_draws++;
+  data->last_width = width;
+  data->last_height = height;
+
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  clutter_cairo_set_source_color (cr, &data->color);
+  cairo_paint (cr);
+
+  return TRUE;
+}
+
+static ClutterContent *
+create_canvas (DrawData *data,
+               gboolean  async)
+{
+  ClutterContent *canvas;
+
+  canvas = clutter_canvas_new ();
+  clutter_canvas_set_async (CLUTTER_CANVAS (canvas), async);
+  g_signal_connect (canvas, "draw", G_CALLBACK (on_draw), data);
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas), CANVAS_SIZE, CANVAS_SIZE);
+
+  return canvas;
+}
+
+static ClutterActor *
+create_canvas_actor (ClutterActor   *stage,
+                     ClutterContent *canvas,
+                     float           x)
+{
+  ClutterActor *actor;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_content (actor, canvas);
+  clutter_actor_set_content_gravity (actor, CLUTTER_CONTENT_GRAVITY_TOP_LEFT);
+  clutter_actor_set_position (actor, x, 0);
+  clutter_actor_set_size (actor, CANVAS_SIZE, CANVAS_SIZE);
+  clutter_actor_add_child (stage, actor);
+
+  return actor;
+}
+
+/* The tasks rasterizing an asynchronous canvas keep a reference on it
+ * until their result has been processed on the main thread, which is
+ * also where the draw coalesced in the meantime gets started */
+static void
+wait_for_async_draws (ClutterContent *canvas,
+                      guint           n_refs)
+{
+  while (G_OBJECT (canvas)->ref_count > n_refs)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+assert_pixel_color (ClutterActor       *stage,
+                    int                 x,
+                    int                 y,
+                    const ClutterColor *color)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), x, y, 1, 1);
+
+  g_assert_cmpint (ABS ((int) color->red - (int) pixel[0]), <=, 2);
+  g_assert_cmpint (ABS ((int) color->green - (int) pixel[1]), <=, 2);
+  g_assert_cmpint (ABS ((int) color->blue - (int) pixel[2]), <=, 2);
+
+  g_free (pixel);
+}
+
+static void
+canvas_async_same_as_sync (void)
+{
+  ClutterActor *stage;
+  ClutterContent *sync_canvas, *async_canvas;
+  DrawData sync_data = { .color = { 255, 0, 0, 255 } };
+  DrawData async_data = { .color = { 255, 0, 0, 255 } };
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_White);
+  clutter_actor_show (stage);
+
+  sync_canvas = create_canvas (&sync_data, FALSE);
+  async_canvas = create_canvas (&async_data, TRUE);
+
+  /* the draw handlers always run on the main thread, right away */
+  g_assert_cmpint (sync_data.n_draws, ==, 1);
+  g_assert_cmpint (async_data.n_draws, ==, 1);
+
+  create_canvas_actor (stage, sync_canvas, 0);
+  create_canvas_actor (stage, async_canvas, CANVAS_SIZE);
+
+  wait_for_async_draws (async_canvas, 2);
+
+  assert_pixel_color (stage, CANVAS_SIZE / 2, CANVAS_SIZE / 2,
+                      &sync_data.color);
+  assert_pixel_color (stage, CANVAS_SIZE + CANVAS_SIZE / 2, CANVAS_SIZE / 2,
+                      &async_data.color);
+
+  /* invalidating draws again, in both modes */
+  sync_data.color = (ClutterColor) { 0, 0, 255, 255 };
+  async_data.color = (ClutterColor) { 0, 0, 255, 255 };
+  clutter_content_invalidate (sync_canvas);
+  clutter_content_invalidate (async_canvas);
+
+  g_assert_cmpint (sync_data.n_draws, ==, 2);
+  g_assert_cmpint (async_data.n_draws, ==, 2);
+
+  wait_for_async_draws (async_canvas, 2);
+
+  assert_pixel_color (stage, CANVAS_SIZE / 2, CANVAS_SIZE / 2,
+                      &sync_data.color);
+  assert_pixel_color (stage, CANVAS_SIZE + CANVAS_SIZE / 2, CANVAS_SIZE / 2,
+                      &async_data.color);
+
+  g_assert_cmpint (async_data.last_width, ==, sync_data.last_width);
+  g_assert_cmpint (async_data.last_height, ==, sync_data.last_height);
+
+  g_object_unref (async_canvas);
+  g_object_unref (sync_canvas);
+}
+
+static void
+canvas_async_resize (void)
+{
+  ClutterActor *stage;
+  ClutterContent *canvas;
+  DrawData data = { .color = { 255, 0, 0, 255 } };
+  ClutterColor green = { 0, 255, 0, 255 };
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_set_background_color (stage, CLUTTER_COLOR_White);
+  clutter_actor_show (stage);
+
+  canvas = create_canvas (&data, TRUE);
+  create_canvas_actor (stage, canvas, 0);
+  wait_for_async_draws (canvas, 2);
+
+  g_assert_cmpint (data.n_draws, ==, 1);
+
+  /* resizing while a draw is in flight, and invalidating some more,
+   * results in a single follow-up draw once it is done */
+  data.color = (ClutterColor) { 0, 0, 255, 255 };
+  clutter_content_invalidate (canvas);
+  g_assert_cmpint (data.n_draws, ==, 2);
+
+  data.color = green;
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas),
+                           CANVAS_SIZE / 2, CANVAS_SIZE);
+  clutter_content_invalidate (canvas);
+  clutter_content_invalidate (canvas);
+  g_assert_cmpint (data.n_draws, ==, 2);
+
+  wait_for_async_draws (canvas, 2);
+
+  g_assert_cmpint (data.n_draws, ==, 3);
+  g_assert_cmpint (data.last_width, ==, CANVAS_SIZE / 2);
+  g_assert_cmpint (data.last_height, ==, CANVAS_SIZE);
+
+  assert_pixel_color (stage, CANVAS_SIZE / 4, CANVAS_SIZE / 2, &green);
+  assert_pixel_color (stage, CANVAS_SIZE * 3 / 4, CANVAS_SIZE / 2,
+                      CLUTTER_COLOR_White);
+
+  /* switching to synchronous drawing drops the draw in flight */
+  data.color = (ClutterColor) { 0, 0, 255, 255 };
+  clutter_content_invalidate (canvas);
+  g_assert_cmpint (data.n_draws, ==, 4);
+
+  data.color = (ClutterColor) { 255, 0, 0, 255 };
+  clutter_canvas_set_async (CLUTTER_CANVAS (canvas), FALSE);
+  g_assert_cmpint (data.n_draws, ==, 5);
+
+  wait_for_async_draws (canvas, 2);
+
+  g_assert_cmpint (data.n_draws, ==, 5);
+  assert_pixel_color (stage, CANVAS_SIZE / 4, CANVAS_SIZE / 2, &data.color);
+
+  g_object_unref (canvas);
+}
+
+static void
+canvas_async_finalize (void)
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+  ClutterContent *canvas;
+  DrawData data = { .color = { 255, 0, 0, 255 } };
+  int n_draws;
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_show (stage);
+
+  canvas = create_canvas (&data, TRUE);
+  actor = create_canvas_actor (stage, canvas, 0);
+
+  /* leave a draw in flight, and another one pending */
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas),
+                           CANVAS_SIZE / 2, CANVAS_SIZE / 2);
+
+  g_object_add_weak_pointer (G_OBJECT (canvas), (gpointer *) &canvas);
+  clutter_actor_destroy (actor);
+  g_object_unref (canvas);
+
+  /* the canvas goes away once its draws are done */
+  g_assert_nonnull (canvas);
+  while (canvas)
+    g_main_context_iteration (NULL, TRUE);
+
+  n_draws = data.n_draws;
+  g_assert_cmpint (n_draws, ==, 2);
+
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert_cmpint (data.n_draws, ==, n_draws);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/canvas/async/same-as-sync", canvas_async_same_as_sync)
+  CLUTTER_TEST_UNIT ("/canvas/async/resize", canvas_async_resize)
+  CLUTTER_TEST_UNIT ("/canvas/async/finalize", canvas_async_finalize)
+)
@@ -547,6 +547,43 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *foo, *bar;
+
+  foo = CLUTTER_TEXT (clutter_text_new_full ("Sans 10", "Shared", NULL));
+  g_object_ref_sink (foo);
+  bar = CLUTTER_TEXT (clutter_text_new_full ("Sans 10", "Shared", NULL));
+  g_object_ref_sink (bar);
+
+  if (g_test_verbose ())
+    g_print ("Same contents share the same layout\n");
+
+  g_assert (clutter_text_get_layout (foo) == clutter_text_get_layout (bar));
+
+  if (g_test_verbose ())
+    g_print ("Different contents use different layouts\n");
+
+  clutter_text_set_text (bar, "Not shared");
+  g_assert (clutter_text_get_layout (foo) != clutter_text_get_layout (bar));
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (foo)),
+                   ==,
+                   "Shared");
+
+  if (g_test_verbose ())
+    g_print ("Editable actors never share layouts\n");
+
+  clutter_text_set_text (bar, "Shared");
+  clutter_text_set_editable (bar, TRUE);
+  g_assert (clutter_text_get_layout (foo) != clutter_text_get_layout (bar));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (foo));
+  g_object_unref (foo);
+  clutter_actor_destroy (CLUTTER_ACTOR (bar));
+  g_object_unref (bar);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -561,4 +598,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
 )
@@ -0,0 +1,128 @@
+#include <clutter/clutter.h>
+
+#include <stdlib.h>
+#include "test-common.h"
+
+#define STAGE_WIDTH  800
+#define STAGE_HEIGHT 600
+
+#define N_COLS 4
+#define N_ROWS 3
+
+#define CHILD_SIZE 48
+
+static float radius;
+
+static void
+on_new_frame (ClutterTimeline *timeline,
+              int              elapsed_msecs,
+              GPtrArray       *children)
+{
+  double progress = clutter_timeline_get_progress (timeline);
+  int i;
+
+  /* moving a child around makes the contents of each blurred actor
+   * change, so that every frame runs all the passes of the blur */
+  for (i = 0; i < children->len; i++)
+    {
+      ClutterActor *child = g_ptr_array_index (children, i);
+      float width;
+
+      width = clutter_actor_get_width (clutter_actor_get_parent (child));
+      clutter_actor_set_x (child, progress * (width - CHILD_SIZE));
+    }
+}
+
+static ClutterActor *
+create_panel (float      width,
+              float      height,
+              GPtrArray *children)
+{
+  ClutterColor panel_color = { 0x40, 0x40, 0x80, 0xff };
+  ClutterColor child_color = { 0xff, 0xc0, 0x20, 0xff };
+  ClutterActor *panel;
+  ClutterActor *child;
+  ClutterEffect *effect;
+
+  panel = clutter_actor_new ();
+  clutter_actor_set_size (panel, width, height);
+  clutter_actor_set_background_color (panel, &panel_color);
+
+  child = clutter_actor_new ();
+  clutter_actor_set_size (child, CHILD_SIZE, CHILD_SIZE);
+  clutter_actor_set_y (child, (height - CHILD_SIZE) / 2);
+  clutter_actor_set_background_color (child, &child_color);
+  clutter_actor_add_child (panel, child);
+  g_ptr_array_add (children, child);
+
+  effect = clutter_blur_effect_new ();
+  clutter_blur_effect_set_radius (CLUTTER_BLUR_EFFECT (effect), radius);
+  clutter_actor_add_effect (panel, effect);
+
+  return panel;
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterActor    *stage;
+  ClutterColor     stage_color = { 0x00, 0x00, 0x00, 0xff };
+  ClutterTimeline *timeline;
+  GPtrArray       *children;
+  float            width, height;
+  int              row, col;
+  char            *id;
+
+  clutter_perf_fps_init ();
+
+  if (CLUTTER_INIT_SUCCESS != clutter_init (&argc, &argv))
+    g_error ("Failed to initialize Clutter");
+
+  if (argc != 2)
+    radius = 32.0f;
+  else
+    radius = atof (argv[1]);
+
+  g_print ("Blur radius = %.1f\n", radius);
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_color (CLUTTER_STAGE (stage), &stage_color);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Blur Performance");
+  g_signal_connect (stage, "destroy", G_CALLBACK (clutter_main_quit), NULL);
+
+  children = g_ptr_array_new ();
+
+  width = STAGE_WIDTH / N_COLS;
+  height = STAGE_HEIGHT / N_ROWS;
+
+  for (row = 0; row < N_ROWS; row++)
+    for (col = 0; col < N_COLS; col++)
+      {
+        ClutterActor *panel;
+
+        panel = create_panel (width, height, children);
+        clutter_actor_set_position (panel, width * col, height * row);
+        clutter_actor_add_child (stage, panel);
+      }
+
+  timeline = clutter_timeline_new (1000);
+  clutter_timeline_set_repeat_count (timeline, -1);
+  clutter_timeline_set_auto_reverse (timeline, TRUE);
+  g_signal_connect (timeline, "new-frame", G_CALLBACK (on_new_frame), children);
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_timeline_start (timeline);
+  clutter_main ();
+
+  id = g_strdup_printf ("test-blur-perf-%d", (int) radius);
+  clutter_perf_fps_report (id);
+
+  g_free (id);
+  g_object_unref (timeline);
+  g_ptr_array_free (children, TRUE);
+
+  return 0;
+}
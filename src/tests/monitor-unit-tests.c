@@ -6297,6 +6297,158 @@ meta_test_monitor_migrated_wiggle (void)
     g_error ("Failed to remove test data output file: %s", error->message);
 }
 
+#define BENCHMARK_N_MODES 256
+#define BENCHMARK_N_OUTPUTS 4
+#define BENCHMARK_N_ITERATIONS 50
+
+static MetaOutput *
+create_benchmark_output (MetaMonitorTestSetup *test_setup,
+                         int                   index,
+                         MetaTileInfo         *tile_info)
+{
+  MetaOutput *output;
+  MetaOutputTest *output_test;
+  MetaCrtc *crtc;
+  GList *l;
+  int i;
+
+  output_test = g_new0 (MetaOutputTest, 1);
+  output_test->scale = 1;
+
+  crtc = g_list_nth_data (test_setup->crtcs, index);
+
+  output = g_object_new (META_TYPE_OUTPUT, NULL);
+  output->winsys_id = index;
+  output->name = g_strdup_printf ("DP-%d", index + 1);
+  output->vendor = g_strdup ("MetaProduct's Inc.");
+  output->product = g_strdup ("MetaMonitor");
+  output->serial = g_strdup_printf ("0x%06x", index);
+  output->suggested_x = -1;
+  output->suggested_y = -1;
+  output->hotplug_mode_update = TRUE;
+  output->width_mm = 600;
+  output->height_mm = 340;
+  output->subpixel_order = COGL_SUBPIXEL_ORDER_UNKNOWN;
+  output->preferred_mode = test_setup->modes->data;
+  output->n_modes = BENCHMARK_N_MODES;
+  output->modes = g_new0 (MetaCrtcMode *, BENCHMARK_N_MODES);
+  for (l = test_setup->modes, i = 0; l; l = l->next, i++)
+    output->modes[i] = l->data;
+  output->n_possible_crtcs = 1;
+  output->possible_crtcs = g_new0 (MetaCrtc *, 1);
+  output->possible_crtcs[0] = crtc;
+  output->backlight = -1;
+  output->connector_type = META_CONNECTOR_TYPE_DisplayPort;
+  if (tile_info)
+    output->tile_info = *tile_info;
+  output->driver_private = output_test;
+  output->driver_notify = (GDestroyNotify) meta_output_test_destroy_notify;
+
+  return output;
+}
+
+/*
+ * Two tiles of a tiled monitor and two normal monitors, all supporting
+ * many modes, as monitors with plenty of resolutions and refresh rates do.
+ */
+static MetaMonitorTestSetup *
+create_benchmark_test_setup (void)
+{
+  static const float refresh_rates[] = { 60.0, 59.94, 50.0, 30.0 };
+  MetaMonitorTestSetup *test_setup;
+  int i;
+
+  test_setup = g_new0 (MetaMonitorTestSetup, 1);
+
+  for (i = 0; i < BENCHMARK_N_MODES; i++)
+    {
+      MetaCrtcMode *mode;
+      int step = i / G_N_ELEMENTS (refresh_rates);
+
+      mode = g_object_new (META_TYPE_CRTC_MODE, NULL);
+      mode->mode_id = i;
+      mode->width = 1920 - step * 16;
+      mode->height = 2160 - step * 18;
+      mode->refresh_rate = refresh_rates[i % G_N_ELEMENTS (refresh_rates)];
+      mode->flags = META_CRTC_MODE_FLAG_NONE;
+
+      test_setup->modes = g_list_prepend (test_setup->modes, mode);
+    }
+  test_setup->modes = g_list_reverse (test_setup->modes);
+
+  for (i = 0; i < BENCHMARK_N_OUTPUTS; i++)
+    {
+      MetaCrtc *crtc;
+
+      crtc = g_object_new (META_TYPE_CRTC, NULL);
+      crtc->crtc_id = i + 1;
+      crtc->all_transforms = ALL_TRANSFORMS;
+
+      test_setup->crtcs = g_list_prepend (test_setup->crtcs, crtc);
+    }
+  test_setup->crtcs = g_list_reverse (test_setup->crtcs);
+
+  for (i = 0; i < BENCHMARK_N_OUTPUTS; i++)
+    {
+      MetaTileInfo tile_info = {
+        .group_id = 1,
+        .max_h_tiles = 2,
+        .max_v_tiles = 1,
+        .loc_h_tile = i,
+        .loc_v_tile = 0,
+        .tile_w = 1920,
+        .tile_h = 2160
+      };
+      MetaOutput *output;
+
+      output = create_benchmark_output (test_setup, i,
+                                        i < 2 ? &tile_info : NULL);
+      test_setup->outputs = g_list_prepend (test_setup->outputs, output);
+    }
+  test_setup->outputs = g_list_reverse (test_setup->outputs);
+
+  return test_setup;
+}
+
+static void
+meta_test_monitor_benchmark_read_current_state (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaMonitorManagerTest *monitor_manager_test =
+    META_MONITOR_MANAGER_TEST (monitor_manager);
+  MetaMonitorTestSetup *test_setups[BENCHMARK_N_ITERATIONS];
+  MetaMonitorTestSetup *initial_test_setup;
+  double elapsed;
+  int i;
+
+  for (i = 0; i < BENCHMARK_N_ITERATIONS; i++)
+    test_setups[i] = create_benchmark_test_setup ();
+
+  g_test_timer_start ();
+
+  for (i = 0; i < BENCHMARK_N_ITERATIONS; i++)
+    meta_monitor_manager_test_emulate_hotplug (monitor_manager_test,
+                                               test_setups[i]);
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpint (g_list_length (meta_monitor_manager_get_monitors (monitor_manager)),
+                   ==, BENCHMARK_N_OUTPUTS - 1);
+  g_assert_cmpint (meta_monitor_manager_test_get_tiled_monitor_count (monitor_manager_test),
+                   ==, 1);
+
+  g_test_minimized_result (elapsed / BENCHMARK_N_ITERATIONS,
+                           "Read %d monitor setups with %d modes per output in %.3f s",
+                           BENCHMARK_N_ITERATIONS, BENCHMARK_N_MODES, elapsed);
+
+  initial_test_setup = create_monitor_test_setup (&initial_test_case,
+                                                  MONITOR_TEST_FLAG_NO_STORED);
+  emulate_hotplug (initial_test_setup);
+  check_monitor_configuration (&initial_test_case);
+}
+
 static void
 test_case_setup (void       **fixture,
                  const void   *data)
@@ -6418,6 +6570,10 @@ init_monitor_tests (void)
 
   add_monitor_test ("/backends/monitor/wm/tiling",
                     meta_test_monitor_wm_tiling);
+
+  if (g_test_perf ())
+    add_monitor_test ("/backends/monitor/benchmark/read-current-state",
+                      meta_test_monitor_benchmark_read_current_state);
 }
 
 void
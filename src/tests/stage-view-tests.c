@@ -17,10 +17,12 @@
 
 #include "config.h"
 
+#include "clutter/clutter-muffin.h"
 #include "compositor/meta-plugin-manager.h"
 #include "core/main-private.h"
 #include "meta/main.h"
 #include "tests/meta-backend-test.h"
+#include "tests/meta-monitor-manager-test.h"
 #include "tests/monitor-test-utils.h"
 #include "tests/test-utils.h"
 
@@ -462,6 +464,361 @@ meta_test_actor_stage_views_hide_parent (void)
   clutter_actor_destroy (outer_container);
 }
 
+#define N_INCREMENTAL_TEST_ACTORS 20
+
+static void
+meta_test_actor_stage_views_incremental (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterActor *stage, *container, *test_actor = NULL;
+  GList *stage_views;
+  guint n_visited, n_updated;
+  int i;
+
+  stage = meta_backend_get_stage (backend);
+  stage_views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+
+  container = clutter_actor_new ();
+  clutter_actor_set_size (container, 200, 200);
+  clutter_actor_add_child (stage, container);
+
+  for (i = 0; i < N_INCREMENTAL_TEST_ACTORS; i++)
+    {
+      test_actor = clutter_actor_new ();
+      clutter_actor_set_size (test_actor, 10, 10);
+      clutter_actor_set_position (test_actor, i * 10, 0);
+      clutter_actor_add_child (container, test_actor);
+    }
+
+  clutter_actor_show (stage);
+
+  wait_for_paint (stage);
+
+  is_on_stage_views (test_actor, 1, stage_views->data);
+
+  /* Moving the container updates all its children */
+  clutter_actor_set_x (container, 10);
+  wait_for_paint (stage);
+
+  clutter_actor_get_stage_views_update_stats (&n_visited, &n_updated);
+  g_assert_cmpuint (n_updated, >=, N_INCREMENTAL_TEST_ACTORS + 1);
+
+  /* Transforming a single child only updates that child; the container
+   * is only visited on the way */
+  clutter_actor_set_translation (test_actor, 1024, 0, 0);
+  wait_for_paint (stage);
+
+  clutter_actor_get_stage_views_update_stats (&n_visited, &n_updated);
+  g_assert_cmpuint (n_updated, <, N_INCREMENTAL_TEST_ACTORS / 2);
+  g_assert_cmpuint (n_visited, <, N_INCREMENTAL_TEST_ACTORS / 2);
+
+  /* The translation moved it onto the second view */
+  is_on_stage_views (test_actor, 1, stage_views->next->data);
+
+  clutter_actor_destroy (container);
+}
+
+static MonitorTestCaseSetup mixed_refresh_rate_test_case_setup = {
+  .modes = {
+    {
+      .width = 1024,
+      .height = 768,
+      .refresh_rate = 144.0
+    },
+    {
+      .width = 1024,
+      .height = 768,
+      .refresh_rate = 60.0
+    }
+  },
+  .n_modes = 2,
+  .outputs = {
+     {
+      .crtc = 0,
+      .modes = { 0 },
+      .n_modes = 1,
+      .preferred_mode = 0,
+      .possible_crtcs = { 0 },
+      .n_possible_crtcs = 1,
+      .width_mm = 222,
+      .height_mm = 125
+    },
+    {
+      .crtc = 1,
+      .modes = { 1 },
+      .n_modes = 1,
+      .preferred_mode = 0,
+      .possible_crtcs = { 1 },
+      .n_possible_crtcs = 1,
+      .width_mm = 220,
+      .height_mm = 124
+    }
+  },
+  .n_outputs = 2,
+  .crtcs = {
+    {
+      .current_mode = 0
+    },
+    {
+      .current_mode = 1
+    }
+  },
+  .n_crtcs = 2
+};
+
+static void
+emulate_hotplug (MonitorTestCaseSetup *test_case_setup)
+{
+  MetaBackend *backend = meta_get_backend ();
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaMonitorManagerTest *monitor_manager_test =
+    META_MONITOR_MANAGER_TEST (monitor_manager);
+  MetaMonitorTestSetup *test_setup;
+
+  test_setup = create_monitor_test_setup (test_case_setup,
+                                          MONITOR_TEST_FLAG_NO_STORED);
+  meta_monitor_manager_test_emulate_hotplug (monitor_manager_test, test_setup);
+}
+
+static int64_t
+get_refresh_interval_us (ClutterStageView *view)
+{
+  return (int64_t) (0.5 + G_USEC_PER_SEC /
+                    clutter_stage_view_get_refresh_rate (view));
+}
+
+static int64_t
+get_next_presentation_time (ClutterStageView *view)
+{
+  return clutter_stage_view_cogl_get_next_presentation_time (
+    CLUTTER_STAGE_VIEW_COGL (view));
+}
+
+static void
+meta_test_stage_views_mixed_refresh_rates (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterStageWindow *stage_window;
+  ClutterStageCogl *stage_cogl;
+  ClutterStageView *fast_view = NULL;
+  ClutterStageView *slow_view = NULL;
+  GList *stage_views;
+  GList *l;
+  int64_t fast_interval_us;
+  int64_t slow_interval_us;
+  int64_t now_us;
+
+  emulate_hotplug (&mixed_refresh_rate_test_case_setup);
+
+  stage_views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+  g_assert_cmpint (g_list_length (stage_views), ==, 2);
+
+  for (l = stage_views; l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      float refresh_rate = clutter_stage_view_get_refresh_rate (view);
+
+      if (refresh_rate == 144.0f)
+        fast_view = view;
+      else if (refresh_rate == 60.0f)
+        slow_view = view;
+    }
+
+  g_assert_nonnull (fast_view);
+  g_assert_nonnull (slow_view);
+
+  wait_for_paint (stage);
+
+  fast_interval_us = get_refresh_interval_us (fast_view);
+  slow_interval_us = get_refresh_interval_us (slow_view);
+
+  /* Drive the frame clocks from known presentation times rather than
+   * from the actual vblanks, so that the schedule doesn't depend on how
+   * fast the test gets to run */
+  stage_window = _clutter_stage_get_window (CLUTTER_STAGE (stage));
+  stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  now_us = g_get_monotonic_time ();
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl, now_us);
+
+  _clutter_stage_cogl_view_presented_at (stage_cogl, fast_view, now_us);
+  _clutter_stage_cogl_view_presented_at (stage_cogl, slow_view, now_us);
+  clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+
+  /* Each view is scheduled for the next vblank of its own monitor */
+  g_assert_cmpint (get_next_presentation_time (fast_view), ==,
+                   now_us + fast_interval_us);
+  g_assert_cmpint (get_next_presentation_time (slow_view), ==,
+                   now_us + slow_interval_us);
+
+  /* Presenting a frame on the fast monitor moves only its own schedule
+   * forward, while the slow view keeps waiting for its vblank */
+  now_us += fast_interval_us;
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl, now_us);
+  _clutter_stage_cogl_view_presented_at (stage_cogl, fast_view, now_us);
+
+  g_assert_cmpint (get_next_presentation_time (fast_view), ==,
+                   now_us + fast_interval_us);
+  g_assert_cmpint (get_next_presentation_time (slow_view), ==,
+                   now_us - fast_interval_us + slow_interval_us);
+
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl, 0);
+
+  emulate_hotplug (&initial_test_case_setup);
+}
+
+#define N_JITTERY_FRAMES 30
+
+static void
+meta_test_stage_views_jittery_dispatch (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterStageWindow *stage_window;
+  ClutterStageCogl *stage_cogl;
+  GList *stage_views;
+  GList *l;
+  int64_t refresh_interval_us;
+  int64_t vblank_time_us;
+  int64_t prev_sample_time_us = 0;
+  int i;
+
+  stage_views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+  refresh_interval_us = get_refresh_interval_us (stage_views->data);
+
+  wait_for_paint (stage);
+
+  stage_window = _clutter_stage_get_window (CLUTTER_STAGE (stage));
+  stage_cogl = CLUTTER_STAGE_COGL (stage_window);
+  vblank_time_us = g_get_monotonic_time ();
+
+  for (i = 0; i < N_JITTERY_FRAMES; i++)
+    {
+      int64_t presentation_time_us;
+      int64_t update_time_us;
+      int64_t next_presentation_time_us;
+      int64_t sample_time_us;
+
+      /* Frames reach the screen on the vblank grid, but their presentation
+       * times are reported with some jitter, and a bit later */
+      presentation_time_us =
+        vblank_time_us + g_test_rand_int_range (-refresh_interval_us / 16,
+                                                refresh_interval_us / 16 + 1);
+      _clutter_stage_cogl_set_frame_clock_time (
+        stage_cogl,
+        vblank_time_us + refresh_interval_us / 16 +
+        g_test_rand_int_range (0, refresh_interval_us / 8));
+
+      for (l = stage_views; l; l = l->next)
+        {
+          _clutter_stage_cogl_view_presented_at (stage_cogl, l->data,
+                                                 presentation_time_us);
+        }
+      clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+
+      /* Dispatch the next update at a random point before its vblank */
+      update_time_us = _clutter_stage_window_get_update_time (stage_window);
+      next_presentation_time_us =
+        get_next_presentation_time (stage_views->data);
+      g_assert_cmpint (update_time_us, <, next_presentation_time_us);
+
+      _clutter_stage_cogl_set_frame_clock_time (
+        stage_cogl,
+        update_time_us + g_test_rand_int_range (0, next_presentation_time_us -
+                                                   update_time_us));
+
+      sample_time_us =
+        _clutter_stage_window_get_next_presentation_time (stage_window);
+      _clutter_stage_window_clear_update_time (stage_window);
+
+      /* Animations are sampled in whole refresh intervals, give or take
+       * the slow correction of the phase */
+      if (prev_sample_time_us)
+        {
+          int64_t delta_us = sample_time_us - prev_sample_time_us;
+          int64_t n_intervals;
+
+          n_intervals = (delta_us + refresh_interval_us / 2) /
+                        refresh_interval_us;
+
+          g_assert_cmpint (n_intervals, >=, 1);
+          g_assert_cmpint (ABS (delta_us - n_intervals * refresh_interval_us),
+                           <=, refresh_interval_us / 32);
+        }
+
+      prev_sample_time_us = sample_time_us;
+      vblank_time_us += refresh_interval_us;
+    }
+
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl, 0);
+
+  emulate_hotplug (&initial_test_case_setup);
+}
+
+typedef struct _BogusPrediction
+{
+  gboolean started;
+  int first_elapsed_msecs;
+  gboolean advanced;
+} BogusPrediction;
+
+static void
+on_bogus_prediction_new_frame (ClutterTimeline *timeline,
+                               int              elapsed_msecs,
+                               BogusPrediction *prediction)
+{
+  if (!prediction->started)
+    {
+      prediction->first_elapsed_msecs = elapsed_msecs;
+      prediction->started = TRUE;
+    }
+  else if (elapsed_msecs > prediction->first_elapsed_msecs)
+    {
+      prediction->advanced = TRUE;
+    }
+}
+
+static void
+meta_test_stage_views_bogus_prediction (void)
+{
+  MetaBackend *backend = meta_get_backend ();
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterStageCogl *stage_cogl;
+  ClutterTimeline *timeline;
+  BogusPrediction prediction = { 0 };
+  int64_t timeout_us;
+
+  wait_for_paint (stage);
+
+  /* Leave the frame clocks ten seconds behind, so that every update is
+   * due right away but predicted to be presented long ago */
+  stage_cogl =
+    CLUTTER_STAGE_COGL (_clutter_stage_get_window (CLUTTER_STAGE (stage)));
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl,
+                                            g_get_monotonic_time () -
+                                            10 * G_USEC_PER_SEC);
+
+  timeline = clutter_timeline_new (100000);
+  g_signal_connect (timeline, "new-frame",
+                    G_CALLBACK (on_bogus_prediction_new_frame), &prediction);
+  clutter_timeline_start (timeline);
+
+  /* Animations must keep going rather than wait for the prediction */
+  timeout_us = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+  while (!prediction.advanced && g_get_monotonic_time () < timeout_us)
+    g_main_context_iteration (NULL, FALSE);
+
+  _clutter_stage_cogl_set_frame_clock_time (stage_cogl, 0);
+
+  g_assert_true (prediction.advanced);
+
+  clutter_timeline_stop (timeline);
+  g_object_unref (timeline);
+
+  emulate_hotplug (&initial_test_case_setup);
+}
+
 static void
 init_tests (int argc, char **argv)
 {
@@ -480,6 +837,14 @@ init_tests (int argc, char **argv)
                    meta_test_actor_stage_views_reparent);
   g_test_add_func ("/stage-views/actor-stage-views-hide-parent",
                    meta_test_actor_stage_views_hide_parent);
+  g_test_add_func ("/stage-views/actor-stage-views-incremental",
+                   meta_test_actor_stage_views_incremental);
+  g_test_add_func ("/stage-views/mixed-refresh-rates",
+                   meta_test_stage_views_mixed_refresh_rates);
+  g_test_add_func ("/stage-views/jittery-dispatch",
+                   meta_test_stage_views_jittery_dispatch);
+  g_test_add_func ("/stage-views/bogus-prediction",
+                   meta_test_stage_views_bogus_prediction);
 }
 
 int
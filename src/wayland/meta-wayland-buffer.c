@@ -747,6 +747,21 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer *buffer,
   return NULL;
 }
 
+CoglScanout *
+meta_wayland_buffer_try_acquire_overlay_scanout (MetaWaylandBuffer *buffer)
+{
+  MetaWaylandDmaBufBuffer *dma_buf;
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    return NULL;
+
+  dma_buf = meta_wayland_dma_buf_from_buffer (buffer);
+  if (!dma_buf)
+    return NULL;
+
+  return meta_wayland_dma_buf_try_acquire_overlay_scanout (dma_buf);
+}
+
 static void
 meta_wayland_buffer_finalize (GObject *object)
 {
@@ -99,5 +99,6 @@ void                    meta_wayland_buffer_process_damage      (MetaWaylandBuff
 void meta_wayland_init_shm (MetaWaylandCompositor *compositor);
 CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                                                                  CoglOnscreen          *onscreen);
+CoglScanout *           meta_wayland_buffer_try_acquire_overlay_scanout (MetaWaylandBuffer *buffer);
 
 #endif /* META_WAYLAND_BUFFER_H */
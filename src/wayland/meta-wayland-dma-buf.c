@@ -81,6 +81,15 @@ struct _MetaWaylandDmaBufBuffer
   int fds[META_WAYLAND_DMA_BUF_MAX_FDS];
   uint32_t offsets[META_WAYLAND_DMA_BUF_MAX_FDS];
   uint32_t strides[META_WAYLAND_DMA_BUF_MAX_FDS];
+
+#ifdef HAVE_NATIVE_BACKEND
+  /* Imported the first time the buffer is scanned out, and kept until the
+   * buffer is destroyed, so flipping to it again doesn't add a new FB. Each
+   * scanout gets its own buffer sharing it, whose finalization tells that
+   * the scanout ended. */
+  MetaDrmBufferGbm *scanout_fb;
+  MetaGpuKms *scanout_gpu_kms;
+#endif
 };
 
 G_DEFINE_TYPE (MetaWaylandDmaBufBuffer, meta_wayland_dma_buf_buffer, G_TYPE_OBJECT);
@@ -314,40 +323,37 @@ import_scanout_gbm_bo (MetaWaylandDmaBufBuffer *dma_buf,
 }
 #endif
 
-CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandDmaBufBuffer *dma_buf,
-                                          CoglOnscreen            *onscreen)
+#ifdef HAVE_NATIVE_BACKEND
+static CoglScanout *
+import_scanout (MetaWaylandDmaBufBuffer *dma_buf)
 {
-  #ifdef HAVE_NATIVE_BACKEND
   MetaBackend *backend = meta_get_backend ();
   MetaRenderer *renderer = meta_backend_get_renderer (backend);
   MetaRendererNative *renderer_native = META_RENDERER_NATIVE (renderer);
   MetaGpuKms *gpu_kms;
   int n_planes;
-  uint32_t drm_format;
-  uint64_t drm_modifier;
-  uint32_t stride;
   struct gbm_bo *gbm_bo;
   gboolean use_modifier;
   g_autoptr (GError) error = NULL;
   MetaDrmBufferGbm *fb;
 
+  gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
+
+  if (dma_buf->scanout_fb)
+    {
+      if (dma_buf->scanout_gpu_kms == gpu_kms)
+        return COGL_SCANOUT (meta_drm_buffer_gbm_new_shared (dma_buf->scanout_fb));
+
+      g_clear_object (&dma_buf->scanout_fb);
+      dma_buf->scanout_gpu_kms = NULL;
+    }
+
   for (n_planes = 0; n_planes < META_WAYLAND_DMA_BUF_MAX_FDS; n_planes++)
     {
       if (dma_buf->fds[n_planes] < 0)
         break;
     }
 
-  drm_format = dma_buf->drm_format;
-  drm_modifier = dma_buf->drm_modifier;
-  stride = dma_buf->strides[0];
-  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen,
-    drm_format,
-    drm_modifier,
-    stride))
-    return NULL;
-
-  gpu_kms = meta_renderer_native_get_primary_gpu (renderer_native);
   gbm_bo = import_scanout_gbm_bo (dma_buf, gpu_kms, n_planes, &use_modifier);
   if (!gbm_bo)
     {
@@ -365,7 +371,40 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandDmaBufBuffer *dma_buf,
       return NULL;
   }
 
-  return COGL_SCANOUT (fb);
+  dma_buf->scanout_fb = fb;
+  dma_buf->scanout_gpu_kms = gpu_kms;
+
+  return COGL_SCANOUT (meta_drm_buffer_gbm_new_shared (fb));
+}
+#endif
+
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandDmaBufBuffer *dma_buf,
+                                          CoglOnscreen            *onscreen)
+{
+  #ifdef HAVE_NATIVE_BACKEND
+  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen,
+    dma_buf->drm_format,
+    dma_buf->drm_modifier,
+    dma_buf->strides[0]))
+    return NULL;
+
+  return import_scanout (dma_buf);
+#else
+  return NULL;
+#endif
+}
+
+/*
+ * Contrary to meta_wayland_dma_buf_try_acquire_scanout(), the buffer
+ * doesn't need to be compatible with the primary plane, as it is shown on
+ * an overlay plane instead.
+ */
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_overlay_scanout (MetaWaylandDmaBufBuffer *dma_buf)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  return import_scanout (dma_buf);
 #else
   return NULL;
 #endif
@@ -1311,6 +1350,10 @@ meta_wayland_dma_buf_buffer_finalize (GObject *object)
   MetaWaylandDmaBufBuffer *dma_buf = META_WAYLAND_DMA_BUF_BUFFER (object);
   int i;
 
+#ifdef HAVE_NATIVE_BACKEND
+  g_clear_object (&dma_buf->scanout_fb);
+#endif
+
   for (i = 0; i < META_WAYLAND_DMA_BUF_MAX_FDS; i++)
     {
       if (dma_buf->fds[i] != -1)
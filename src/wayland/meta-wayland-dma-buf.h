@@ -59,4 +59,7 @@ CoglScanout *
 meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandDmaBufBuffer *dma_buf,
                                           CoglOnscreen            *onscreen);
 
+CoglScanout *
+meta_wayland_dma_buf_try_acquire_overlay_scanout (MetaWaylandDmaBufBuffer *dma_buf);
+
 #endif /* META_WAYLAND_DMA_BUF_H */
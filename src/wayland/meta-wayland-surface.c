@@ -2103,12 +2103,22 @@ scanout_destroyed (gpointer  data,
   meta_wayland_buffer_ref_unref (buffer_ref);
 }
 
+static void
+hold_buffer_for_scanout (MetaWaylandSurface *surface,
+                         CoglScanout        *scanout)
+{
+  MetaWaylandBufferRef *buffer_ref;
+
+  buffer_ref = meta_wayland_buffer_ref_ref (surface->buffer_ref);
+  meta_wayland_buffer_ref_inc_use_count (buffer_ref);
+  g_object_weak_ref (G_OBJECT (scanout), scanout_destroyed, buffer_ref);
+}
+
 CoglScanout *
 meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
                                           CoglOnscreen       *onscreen)
 {
   CoglScanout *scanout;
-  MetaWaylandBufferRef *buffer_ref;
 
   if (!surface->buffer_ref->buffer)
     return NULL;
@@ -2121,14 +2131,33 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
   if (!scanout)
     return NULL;
 
-  buffer_ref = meta_wayland_buffer_ref_ref (surface->buffer_ref);
-  meta_wayland_buffer_ref_inc_use_count (buffer_ref);
-  g_object_weak_ref (G_OBJECT (scanout), scanout_destroyed, buffer_ref);
+  hold_buffer_for_scanout (surface, scanout);
 
   return scanout;
 
 }
 
+CoglScanout *
+meta_wayland_surface_try_acquire_overlay_scanout (MetaWaylandSurface *surface)
+{
+  CoglScanout *scanout;
+
+  if (!surface->buffer_ref->buffer)
+    return NULL;
+
+  if (surface->buffer_ref->use_count == 0)
+    return NULL;
+
+  scanout =
+    meta_wayland_buffer_try_acquire_overlay_scanout (surface->buffer_ref->buffer);
+  if (!scanout)
+    return NULL;
+
+  hold_buffer_for_scanout (surface, scanout);
+
+  return scanout;
+}
+
 void
 meta_wayland_surface_notify_actor_changed (MetaWaylandSurface *surface)
 {